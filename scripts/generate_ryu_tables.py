@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Generates types/internal/ryu_tables.h.
+
+The tables hold the 125-bit approximations of 5^i and 2^k / 5^i used by the
+Ryu shortest round-trip algorithm (https://github.com/ulfjack/ryu), stored as
+{low 64 bits, high 64 bits} pairs.
+
+Usage:
+  ./scripts/generate_ryu_tables.py > types/internal/ryu_tables.h
+"""
+
+POW5_INV_BITCOUNT = 125
+POW5_BITCOUNT = 125
+POW5_INV_TABLE_SIZE = 342
+POW5_TABLE_SIZE = 326
+
+MASK64 = (1 << 64) - 1
+
+
+def pow5_inv_split(i):
+    pow5 = 5**i
+    j = pow5.bit_length() - 1 + POW5_INV_BITCOUNT
+    return (1 << j) // pow5 + 1
+
+
+def pow5_split(i):
+    pow5 = 5**i
+    shift = pow5.bit_length() - POW5_BITCOUNT
+    return pow5 >> shift if shift >= 0 else pow5 << -shift
+
+
+def emit_table(name, size, fn):
+    print("template <typename T>")
+    print("const uint64_t ryu_tables<T>::%s[%d][2] = {" % (name, size))
+    for i in range(size):
+        value = fn(i)
+        assert value >> 128 == 0
+        print("    {%du, %du}," % (value & MASK64, value >> 64))
+    print("};")
+
+
+def main():
+    print("// Generated by scripts/generate_ryu_tables.py. DO NOT EDIT.")
+    print("#ifndef TYPES_INTERNAL_RYU_TABLES")
+    print("#define TYPES_INTERNAL_RYU_TABLES")
+    print()
+    print("#include <cstdint>")
+    print()
+    print("namespace david {")
+    print("namespace internal {")
+    print()
+    print("// Templated so the tables can live in a header without violating the")
+    print("// one definition rule.")
+    print("template <typename T = void>")
+    print("struct ryu_tables {")
+    print("  static constexpr int kPow5InvBitCount = %d;" % POW5_INV_BITCOUNT)
+    print("  static constexpr int kPow5BitCount = %d;" % POW5_BITCOUNT)
+    print("  static const uint64_t kPow5InvSplit[%d][2];" % POW5_INV_TABLE_SIZE)
+    print("  static const uint64_t kPow5Split[%d][2];" % POW5_TABLE_SIZE)
+    print("};")
+    print()
+    print("template <typename T>")
+    print("constexpr int ryu_tables<T>::kPow5InvBitCount;")
+    print()
+    print("template <typename T>")
+    print("constexpr int ryu_tables<T>::kPow5BitCount;")
+    print()
+    emit_table("kPow5InvSplit", POW5_INV_TABLE_SIZE, pow5_inv_split)
+    print()
+    emit_table("kPow5Split", POW5_TABLE_SIZE, pow5_split)
+    print()
+    print("}  // namespace internal")
+    print("}  // namespace david")
+    print()
+    print("#endif  // TYPES_INTERNAL_RYU_TABLES")
+
+
+if __name__ == "__main__":
+    main()
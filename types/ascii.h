@@ -0,0 +1,156 @@
+#ifndef TYPES_ASCII
+#define TYPES_ASCII
+
+#include <cstddef>
+#include <cstdint>
+
+#include "types/cpu_dispatch.h"
+#include "types/internal/ascii_kernels.h"
+#include "types/string_view.h"
+
+// Trimming, case mapping and char class tests of ASCII text, as in the C
+// locale. Chars from 0x80 up are in no class and keep their case.
+//
+// The scans run through the kernels of types/internal/ascii_kernels.h, 32
+// chars per step when the tier of the string_view kernels has AVX2, see
+// types/cpu_dispatch.h.
+namespace david {
+namespace ascii {
+
+// Classes of chars, which combine with | into their union.
+enum class char_class : uint8_t {
+  // 0-9.
+  kDigit = 1 << 0,
+  // a-z.
+  kLower = 1 << 1,
+  // A-Z.
+  kUpper = 1 << 2,
+  kAlpha = kLower | kUpper,
+  kAlnum = kAlpha | kDigit,
+  // 0-9, a-f and A-F.
+  kHexDigit = 1 << 3,
+  // Space, \t, \n, \v, \f and \r.
+  kSpace = 1 << 4,
+  // Printable chars other than space, letters and digits.
+  kPunct = 1 << 5,
+  // 0x20 to 0x7e.
+  kPrintable = 1 << 6,
+  // 0x00 to 0x1f, and 0x7f.
+  kControl = 1 << 7,
+};
+
+constexpr char_class operator|(char_class a, char_class b) {
+  return static_cast<char_class>(static_cast<uint8_t>(a) |
+                                 static_cast<uint8_t>(b));
+}
+
+}  // namespace ascii
+
+namespace internal {
+
+// Table of a union of classes, see ascii_kernels.h.
+class char_class_table {
+ public:
+  explicit char_class_table(ascii::char_class classes) : bits_() {
+    const unsigned set = static_cast<uint8_t>(classes);
+    for (unsigned c = 0; c < 8; ++c) {
+      if ((set >> c & 1) == 0) continue;
+      for (size_t i = 0; i < 16; ++i) bits_[i] |= kCharClassTables[c][i];
+    }
+  }
+
+  const uint8_t* data() const { return bits_; }
+
+ private:
+  uint8_t bits_[16];
+};
+
+// Table of a single class, without building one.
+inline const uint8_t* single_class_table(ascii::char_class cls) {
+  return kCharClassTables[__builtin_ctz(static_cast<uint8_t>(cls))];
+}
+
+inline size_t find_not_in_class(const uint8_t* table, const char* p,
+                                size_t n) {
+#if DAVID_HAS_X86_KERNELS
+  if (n >= 32 && cpu_tier_at_least(cpu_tier::kAvx2)) {
+    return avx2::find_not_in_class(table, p, n);
+  }
+#endif
+  return scalar::find_not_in_class(table, p, n);
+}
+
+inline size_t rfind_not_in_class(const uint8_t* table, const char* p,
+                                 size_t n) {
+#if DAVID_HAS_X86_KERNELS
+  if (n >= 32 && cpu_tier_at_least(cpu_tier::kAvx2)) {
+    return avx2::rfind_not_in_class(table, p, n);
+  }
+#endif
+  return scalar::rfind_not_in_class(table, p, n);
+}
+
+}  // namespace internal
+
+namespace ascii {
+
+// Offset of the first char of s in none of classes, or string_view::npos.
+inline size_t find_first_not_of_class(string_view s, char_class classes) {
+  const internal::char_class_table table(classes);
+  const size_t i = internal::find_not_in_class(table.data(), s.data(),
+                                               s.size());
+  return i == s.size() ? string_view::npos : i;
+}
+
+// Whether every char of s is in one of classes, which holds for an empty s.
+inline bool all_of_class(string_view s, char_class classes) {
+  return find_first_not_of_class(s, classes) == string_view::npos;
+}
+
+// s without its leading whitespace.
+inline string_view ltrim(string_view s) {
+  const uint8_t* const table = internal::single_class_table(char_class::kSpace);
+  const size_t begin = internal::find_not_in_class(table, s.data(), s.size());
+  return string_view(s.data() + begin, s.size() - begin);
+}
+
+// s without its trailing whitespace.
+inline string_view rtrim(string_view s) {
+  const uint8_t* const table = internal::single_class_table(char_class::kSpace);
+  return string_view(s.data(),
+                     internal::rfind_not_in_class(table, s.data(), s.size()));
+}
+
+// s without its leading and trailing whitespace.
+inline string_view trim(string_view s) { return rtrim(ltrim(s)); }
+
+// Writes s, with A-Z mapped to a-z, into out[0, s.size()), which may be
+// s.data(). Returns s.size().
+inline size_t to_lower_into(string_view s, char* out) {
+#if DAVID_HAS_X86_KERNELS
+  if (s.size() >= 32 && internal::cpu_tier_at_least(cpu_tier::kAvx2)) {
+    internal::avx2::to_lower(s.data(), s.size(), out);
+    return s.size();
+  }
+#endif
+  internal::scalar::to_lower(s.data(), s.size(), out);
+  return s.size();
+}
+
+// Writes s, with a-z mapped to A-Z, into out[0, s.size()), which may be
+// s.data(). Returns s.size().
+inline size_t to_upper_into(string_view s, char* out) {
+#if DAVID_HAS_X86_KERNELS
+  if (s.size() >= 32 && internal::cpu_tier_at_least(cpu_tier::kAvx2)) {
+    internal::avx2::to_upper(s.data(), s.size(), out);
+    return s.size();
+  }
+#endif
+  internal::scalar::to_upper(s.data(), s.size(), out);
+  return s.size();
+}
+
+}  // namespace ascii
+}  // namespace david
+
+#endif  // TYPES_ASCII
@@ -0,0 +1,114 @@
+#include <cctype>
+#include <random>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "types/ascii.h"
+#include "types/cpu_dispatch.h"
+
+namespace david {
+namespace {
+
+// Each benchmark takes the tier as state.range(0), and is skipped on CPUs
+// without it, and the input size as state.range(1): a field and a document.
+bool use_tier(benchmark::State& state) {
+  const cpu_tier tier = static_cast<cpu_tier>(state.range(0));
+  if (!set_cpu_tier(tier)) {
+    state.SkipWithError("tier not supported");
+    return false;
+  }
+  state.SetLabel(cpu_tier_name(tier));
+  return true;
+}
+
+void tiers_and_sizes(benchmark::internal::Benchmark* b) {
+  for (int t = 0; t <= static_cast<int>(cpu_tier::kAvx512); ++t) {
+    b->Args({t, 64})->Args({t, 64 << 10});
+  }
+}
+
+// size chars of mixed case text, with size / 4 blanks on each side.
+std::string padded_text(size_t size) {
+  std::mt19937 rng(42);
+  std::string s(size, ' ');
+  for (size_t i = size / 4; i < size - size / 4; ++i) {
+    s[i] = static_cast<char>('A' + rng() % 58);
+  }
+  return s;
+}
+
+// The trim of the current find_first_not_of path.
+string_view find_trim(string_view s) {
+  const char* const kSpaces = " \t\n\v\f\r";
+  const size_t begin = s.find_first_not_of(kSpaces);
+  if (begin == string_view::npos) return string_view();
+  return s.substr(begin, s.find_last_not_of(kSpaces) - begin + 1);
+}
+
+void BM_FindFirstNotOfTrim(benchmark::State& state) {
+  const std::string s = padded_text(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(find_trim(s));
+  }
+  state.SetBytesProcessed(state.iterations() * (s.size() / 2));
+}
+BENCHMARK(BM_FindFirstNotOfTrim)->Arg(64)->Arg(64 << 10);
+
+void BM_Trim(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string s = padded_text(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ascii::trim(s));
+  }
+  state.SetBytesProcessed(state.iterations() * (s.size() / 2));
+}
+BENCHMARK(BM_Trim)->Apply(tiers_and_sizes);
+
+void BM_FindFirstNotOfDigits(benchmark::State& state) {
+  const std::string s(state.range(0), '7');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(string_view(s).find_first_not_of("0123456789") ==
+                             string_view::npos);
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_FindFirstNotOfDigits)->Arg(64)->Arg(64 << 10);
+
+void BM_AllOfDigits(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string s(state.range(1), '7');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ascii::all_of_class(s, ascii::char_class::kDigit));
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_AllOfDigits)->Apply(tiers_and_sizes);
+
+void BM_TolowerLoop(benchmark::State& state) {
+  const std::string s = padded_text(state.range(0));
+  std::string out(s.size(), '\0');
+  for (auto _ : state) {
+    for (size_t i = 0; i < s.size(); ++i) {
+      const unsigned char c = static_cast<unsigned char>(s[i]);
+      out[i] = static_cast<char>(std::tolower(c));
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_TolowerLoop)->Arg(64)->Arg(64 << 10);
+
+void BM_ToLowerInto(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string s = padded_text(state.range(1));
+  std::string out(s.size(), '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ascii::to_lower_into(s, &out[0]));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_ToLowerInto)->Apply(tiers_and_sizes);
+
+}  // namespace
+}  // namespace david
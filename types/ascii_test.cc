@@ -0,0 +1,175 @@
+#include "types/ascii.h"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "types/cpu_dispatch.h"
+
+namespace david {
+namespace {
+
+using ascii::char_class;
+
+std::vector<cpu_tier> supported_tiers() {
+  std::vector<cpu_tier> tiers;
+  for (int t = 0; t <= static_cast<int>(detected_cpu_tier()); ++t) {
+    tiers.push_back(static_cast<cpu_tier>(t));
+  }
+  return tiers;
+}
+
+class AsciiTest : public ::testing::TestWithParam<cpu_tier> {
+ protected:
+  void SetUp() override { ASSERT_TRUE(set_cpu_tier(GetParam())); }
+  void TearDown() override { set_cpu_tier(detected_cpu_tier()); }
+};
+
+// Whether c is in the class, as told by <cctype> in the C locale.
+bool in_ctype_class(unsigned char c, char_class cls) {
+  if (c >= 0x80) return false;
+  switch (cls) {
+    case char_class::kDigit:
+      return std::isdigit(c);
+    case char_class::kLower:
+      return std::islower(c);
+    case char_class::kUpper:
+      return std::isupper(c);
+    case char_class::kAlpha:
+      return std::isalpha(c);
+    case char_class::kAlnum:
+      return std::isalnum(c);
+    case char_class::kHexDigit:
+      return std::isxdigit(c);
+    case char_class::kSpace:
+      return std::isspace(c);
+    case char_class::kPunct:
+      return std::ispunct(c);
+    case char_class::kPrintable:
+      return std::isprint(c);
+    case char_class::kControl:
+      return std::iscntrl(c);
+  }
+  return false;
+}
+
+const char_class kClasses[] = {
+    char_class::kDigit,    char_class::kLower,  char_class::kUpper,
+    char_class::kAlpha,    char_class::kAlnum,  char_class::kHexDigit,
+    char_class::kSpace,    char_class::kPunct,  char_class::kPrintable,
+    char_class::kControl,
+};
+
+TEST_P(AsciiTest, ClassesMatchCtype) {
+  for (const char_class cls : kClasses) {
+    for (int c = 0; c < 256; ++c) {
+      // Alone, and in the middle of a block of the first char of the class.
+      unsigned char member = 0;
+      while (!in_ctype_class(member, cls)) ++member;
+      std::string s(64, static_cast<char>(member));
+      ASSERT_TRUE(ascii::all_of_class(s, cls));
+      s[37] = static_cast<char>(c);
+      const bool in = in_ctype_class(static_cast<unsigned char>(c), cls);
+      EXPECT_EQ(ascii::all_of_class(s, cls), in)
+          << "class " << int(cls) << " char " << c;
+      EXPECT_EQ(ascii::find_first_not_of_class(s, cls),
+                in ? string_view::npos : 37);
+      EXPECT_EQ(ascii::all_of_class(s.substr(37, 1), cls), in);
+    }
+  }
+}
+
+TEST_P(AsciiTest, ClassUnions) {
+  const char_class id = char_class::kAlnum | char_class::kPunct;
+  EXPECT_TRUE(ascii::all_of_class("snake_case_name_42", id));
+  EXPECT_FALSE(ascii::all_of_class("snake case", id));
+  EXPECT_TRUE(ascii::all_of_class("0123abcdEF",
+                                  char_class::kDigit | char_class::kHexDigit));
+  EXPECT_EQ(ascii::find_first_not_of_class("123 456", char_class::kDigit),
+            3u);
+  EXPECT_EQ(ascii::find_first_not_of_class(std::string(40, '7') + "x",
+                                           char_class::kDigit),
+            40u);
+  EXPECT_TRUE(ascii::all_of_class("", char_class::kDigit));
+  EXPECT_EQ(ascii::find_first_not_of_class("", char_class::kDigit),
+            string_view::npos);
+}
+
+TEST_P(AsciiTest, HighCharsAreInNoClass) {
+  std::string s(100, 'a');
+  s[70] = '\xe1';
+  const char_class all = char_class::kAlnum | char_class::kPunct |
+                         char_class::kSpace | char_class::kControl;
+  EXPECT_FALSE(ascii::all_of_class(s, all));
+  EXPECT_EQ(ascii::find_first_not_of_class(s, all), 70u);
+}
+
+TEST_P(AsciiTest, Trim) {
+  EXPECT_EQ(ascii::trim("  hello world \t\r\n"), "hello world");
+  EXPECT_EQ(ascii::ltrim("  hello "), "hello ");
+  EXPECT_EQ(ascii::rtrim("  hello "), "  hello");
+  EXPECT_EQ(ascii::trim(""), "");
+  EXPECT_EQ(ascii::trim(" \v\f "), "");
+  EXPECT_EQ(ascii::trim("x"), "x");
+  EXPECT_EQ(ascii::trim("\xa0x\xa0"), "\xa0x\xa0");
+}
+
+TEST_P(AsciiTest, TrimAtAllPositions) {
+  for (size_t n = 0; n <= 100; ++n) {
+    for (size_t lead = 0; lead <= n; lead += 7) {
+      for (size_t trail = 0; lead + trail <= n; trail += 5) {
+        std::string s(n, 'x');
+        for (size_t i = 0; i < lead; ++i) s[i] = " \t\n"[i % 3];
+        for (size_t i = 0; i < trail; ++i) s[n - 1 - i] = "\r \f"[i % 3];
+        const string_view body(s.data() + lead, n - lead - trail);
+        const string_view trimmed = ascii::trim(s);
+        EXPECT_EQ(trimmed, lead + trail == n ? string_view("") : body);
+        EXPECT_EQ(ascii::ltrim(s).data(),
+                  s.data() + (lead + trail == n ? n : lead));
+        if (lead + trail < n) {
+          EXPECT_EQ(trimmed.data(), body.data());
+          EXPECT_EQ(ascii::rtrim(s).size(), n - trail);
+        }
+      }
+    }
+  }
+}
+
+TEST_P(AsciiTest, CaseMapping) {
+  std::string in;
+  for (int c = 0; c < 256; ++c) in += static_cast<char>(c);
+  in += in;
+  for (size_t n = 0; n <= in.size(); n += n < 70 ? 1 : 61) {
+    std::string lower(n, '\0');
+    std::string upper(n, '\0');
+    EXPECT_EQ(ascii::to_lower_into(string_view(in.data(), n), &lower[0]), n);
+    EXPECT_EQ(ascii::to_upper_into(string_view(in.data(), n), &upper[0]), n);
+    for (size_t i = 0; i < n; ++i) {
+      const unsigned char c = static_cast<unsigned char>(in[i]);
+      const bool ascii_char = c < 0x80;
+      EXPECT_EQ(lower[i], ascii_char ? std::tolower(c) : in[i]);
+      EXPECT_EQ(upper[i], ascii_char ? std::toupper(c) : in[i]);
+    }
+  }
+}
+
+TEST_P(AsciiTest, CaseMappingInPlace) {
+  // The UTF-8 of É and é keeps its bytes.
+  const std::string q(40, 'Q');
+  std::string s = "Hello, World! " + q + " \xc3\x89t\xc3\xa9";
+  ascii::to_lower_into(s, &s[0]);
+  EXPECT_EQ(s, "hello, world! " + std::string(40, 'q') + " \xc3\x89t\xc3\xa9");
+  ascii::to_upper_into(s, &s[0]);
+  EXPECT_EQ(s, "HELLO, WORLD! " + q + " \xc3\x89T\xc3\xa9");
+}
+
+INSTANTIATE_TEST_SUITE_P(Tiers, AsciiTest,
+                         ::testing::ValuesIn(supported_tiers()),
+                         [](const ::testing::TestParamInfo<cpu_tier>& info) {
+                           return std::string(cpu_tier_name(info.param));
+                         });
+
+}  // namespace
+}  // namespace david
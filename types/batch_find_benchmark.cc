@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/batch_find.h"
+
+namespace david {
+namespace {
+
+constexpr size_t kNumKeys = 1 << 20;
+
+// Short keys scattered over the heap, like the keys of a large table.
+std::vector<std::string> make_keys() {
+  std::mt19937 rng(42);
+  std::vector<std::string> keys(kNumKeys);
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    keys[i].resize(16 + rng() % 32);
+    for (size_t j = 0; j < keys[i].size(); ++j) {
+      keys[i][j] = static_cast<char>('a' + rng() % 26);
+    }
+  }
+  std::shuffle(keys.begin(), keys.end(), rng);
+  return keys;
+}
+
+void BM_FindLoop(benchmark::State& state) {
+  const std::vector<std::string> keys = make_keys();
+  const std::vector<string_view> haystacks(keys.begin(), keys.end());
+  std::vector<size_t> positions(haystacks.size());
+  string_view needle = "xyz";
+  benchmark::DoNotOptimize(needle);
+  for (auto _ : state) {
+    for (size_t i = 0; i < haystacks.size(); ++i) {
+      positions[i] = haystacks[i].find(needle);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * haystacks.size());
+}
+BENCHMARK(BM_FindLoop);
+
+void BM_BatchFind(benchmark::State& state) {
+  const std::vector<std::string> keys = make_keys();
+  const std::vector<string_view> haystacks(keys.begin(), keys.end());
+  std::vector<size_t> positions(haystacks.size());
+  string_view needle = "xyz";
+  benchmark::DoNotOptimize(needle);
+  for (auto _ : state) {
+    batch_find(haystacks.data(), haystacks.size(), needle, positions.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * haystacks.size());
+}
+BENCHMARK(BM_BatchFind);
+
+void BM_BatchContains(benchmark::State& state) {
+  const std::vector<std::string> keys = make_keys();
+  const std::vector<string_view> haystacks(keys.begin(), keys.end());
+  std::vector<uint64_t> bitmap((haystacks.size() + 63) / 64);
+  string_view needle = "xyz";
+  benchmark::DoNotOptimize(needle);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(batch_contains(
+        haystacks.data(), haystacks.size(), needle, bitmap.data()));
+  }
+  state.SetItemsProcessed(state.iterations() * haystacks.size());
+}
+BENCHMARK(BM_BatchContains);
+
+}  // namespace
+}  // namespace david
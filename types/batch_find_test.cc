@@ -0,0 +1,81 @@
+#include "types/batch_find.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<std::string> random_keys(size_t n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> keys(n);
+  for (size_t i = 0; i < n; ++i) {
+    keys[i].resize(rng() % 40);
+    for (size_t j = 0; j < keys[i].size(); ++j) {
+      keys[i][j] = static_cast<char>('a' + rng() % 3);
+    }
+  }
+  return keys;
+}
+
+TEST(BatchFind, Positions) {
+  const string_view haystacks[] = {"hello", "world", "", "lo", "yellow", "l"};
+  size_t positions[6];
+  batch_find(haystacks, 6, "lo", positions);
+  EXPECT_THAT(positions, ElementsAre(3, string_view::npos, string_view::npos, 0,
+                                     3, string_view::npos));
+}
+
+TEST(BatchFind, EmptyNeedle) {
+  const string_view haystacks[] = {"a", "", "abc"};
+  size_t positions[3];
+  batch_find(haystacks, 3, "", positions);
+  EXPECT_THAT(positions, ElementsAre(0, 0, 0));
+}
+
+TEST(BatchFind, Bitmap) {
+  const string_view haystacks[] = {"hello", "world", "", "lo", "yellow", "l"};
+  uint64_t bitmap[1] = {~uint64_t(0)};
+  EXPECT_EQ(batch_contains(haystacks, 6, "l", bitmap), 5);
+  EXPECT_EQ(bitmap[0], 0x3bu);
+}
+
+TEST(BatchFind, MatchesFind) {
+  const std::vector<std::string> keys = random_keys(5000, 1);
+  const std::vector<string_view> haystacks(keys.begin(), keys.end());
+  thread_pool pool(3);
+  batch_find_options parallel_opts;
+  parallel_opts.pool = &pool;
+  parallel_opts.task_size = 100;
+  for (const char* needle : {"a", "ab", "cab", "abcab"}) {
+    SCOPED_TRACE(needle);
+    for (const batch_find_options& opts :
+         {batch_find_options(), parallel_opts}) {
+      std::vector<size_t> positions(haystacks.size());
+      batch_find(haystacks.data(), haystacks.size(), needle, positions.data(),
+                 opts);
+      std::vector<uint64_t> bitmap((haystacks.size() + 63) / 64);
+      const size_t matches = batch_contains(haystacks.data(), haystacks.size(),
+                                            needle, bitmap.data(), opts);
+      size_t expected_matches = 0;
+      for (size_t i = 0; i < haystacks.size(); ++i) {
+        const size_t expected = haystacks[i].find(needle);
+        ASSERT_EQ(positions[i], expected) << i;
+        ASSERT_EQ((bitmap[i / 64] >> (i % 64)) & 1,
+                  expected != string_view::npos)
+            << i;
+        expected_matches += expected != string_view::npos;
+      }
+      EXPECT_EQ(matches, expected_matches);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace david
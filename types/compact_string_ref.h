@@ -0,0 +1,190 @@
+#ifndef TYPES_COMPACT_STRING_REF
+#define TYPES_COMPACT_STRING_REF
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+
+#include "types/string_view.h"
+
+namespace david {
+
+// A 16-byte handle to a string, laid out as in Umbra ("German strings"):
+//
+//   | size (4 bytes) | first 4 chars | next 8 chars, or a pointer (8 bytes) |
+//
+// Strings of up to 12 chars are stored entirely inside the handle, zero
+// padded. Longer strings keep their first 4 chars inline and point to the
+// whole string, which the handle does not own: like a string_view, it must
+// outlive the handle.
+//
+// Equality compares the size and the prefix in one 64-bit compare and most
+// orderings are decided by the prefix, so they rarely dereference the
+// pointer. Short strings never leave the handle.
+class compact_string_ref {
+ public:
+  using size_type = uint32_t;
+  static constexpr size_t kMaxInlineSize = 12;
+  static constexpr size_t kPrefixSize = 4;
+
+  // Construction.
+  compact_string_ref() noexcept : size_(0), prefix_(), rest_() {}
+  // Throws std::length_error for views of 4 GiB or more.
+  explicit compact_string_ref(string_view s) : prefix_(), rest_() {
+    if (s.size() > 0xffffffffu) {
+      throw std::length_error("string_view does not fit compact_string_ref");
+    }
+    size_ = static_cast<size_type>(s.size());
+    if (s.size() == 0) {
+      // Leave the zero-filled handle: s.data() may be null.
+    } else if (s.size() <= kMaxInlineSize) {
+      std::memcpy(prefix_, s.data(),
+                  s.size() < kPrefixSize ? s.size() : size_t(kPrefixSize));
+      if (s.size() > kPrefixSize) {
+        std::memcpy(rest_.chars, s.data() + kPrefixSize,
+                    s.size() - kPrefixSize);
+      }
+    } else {
+      std::memcpy(prefix_, s.data(), kPrefixSize);
+      rest_.ptr = s.data();
+    }
+  }
+
+  // Capacity.
+  size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  bool is_inline() const noexcept { return size_ <= kMaxInlineSize; }
+
+  // Points inside the handle for inline strings.
+  const char* data() const noexcept {
+    return is_inline() ? prefix_ : rest_.ptr;
+  }
+  string_view view() const noexcept { return string_view(data(), size_); }
+  operator string_view() const noexcept { return view(); }
+
+  int compare(const compact_string_ref& other) const noexcept {
+    const uint32_t a = load_prefix_big_endian();
+    const uint32_t b = other.load_prefix_big_endian();
+    if (a != b) return a < b ? -1 : 1;
+    if (size_ <= kPrefixSize || other.size_ <= kPrefixSize) {
+      // One of them ends within the equal prefix, so they can only differ
+      // in trailing '\0's.
+      return size_ == other.size_ ? 0 : (size_ < other.size_ ? -1 : 1);
+    }
+    if (is_inline() && other.is_inline()) {
+      // Zero padded, so comparing the words orders like comparing the
+      // chars, and equal words leave only trailing '\0's to tell them apart.
+      const uint64_t a_rest = load_big_endian(rest_.word);
+      const uint64_t b_rest = load_big_endian(other.rest_.word);
+      if (a_rest != b_rest) return a_rest < b_rest ? -1 : 1;
+      return size_ == other.size_ ? 0 : (size_ < other.size_ ? -1 : 1);
+    }
+    // The first 4 chars of both are equal or past the end of the shorter
+    // one, which is inline.
+    return string_view(data() + kPrefixSize, size_ - kPrefixSize)
+        .compare(string_view(other.data() + kPrefixSize,
+                             other.size_ - kPrefixSize));
+  }
+
+  friend inline bool operator==(const compact_string_ref& a,
+                                const compact_string_ref& b) noexcept {
+    if (a.head() != b.head()) return false;
+    if (a.is_inline()) return a.rest_.word == b.rest_.word;
+    return a.rest_.ptr == b.rest_.ptr ||
+           string_view(a.rest_.ptr + kPrefixSize, a.size_ - kPrefixSize) ==
+               string_view(b.rest_.ptr + kPrefixSize, b.size_ - kPrefixSize);
+  }
+  friend inline bool operator!=(const compact_string_ref& a,
+                                const compact_string_ref& b) noexcept {
+    return !(a == b);
+  }
+  friend inline bool operator<(const compact_string_ref& a,
+                               const compact_string_ref& b) noexcept {
+    return a.compare(b) < 0;
+  }
+  friend inline bool operator>(const compact_string_ref& a,
+                               const compact_string_ref& b) noexcept {
+    return a.compare(b) > 0;
+  }
+  friend inline bool operator<=(const compact_string_ref& a,
+                                const compact_string_ref& b) noexcept {
+    return a.compare(b) <= 0;
+  }
+  friend inline bool operator>=(const compact_string_ref& a,
+                                const compact_string_ref& b) noexcept {
+    return a.compare(b) >= 0;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const compact_string_ref& s) {
+    return os << s.view();
+  }
+
+  // Hash of the string. Inline strings are hashed from the two words of the
+  // handle; longer strings hash their chars.
+  size_t hash() const noexcept {
+    if (is_inline()) {
+      return static_cast<size_t>(mix(head() ^ mix(rest_.word)));
+    }
+    return static_cast<size_t>(
+        mix(head() ^ std::hash<string_view>()(view())));
+  }
+
+ private:
+  // The size and the prefix as one word.
+  uint64_t head() const noexcept {
+    uint64_t word;
+    std::memcpy(&word, this, sizeof(word));
+    return word;
+  }
+  static uint64_t load_big_endian(uint64_t word) noexcept {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+  }
+  uint32_t load_prefix_big_endian() const noexcept {
+    uint32_t word;
+    std::memcpy(&word, prefix_, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+  }
+  // Finalizer from MurmurHash3.
+  static uint64_t mix(uint64_t x) noexcept {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+  }
+
+  size_type size_;
+  char prefix_[kPrefixSize];
+  union rest {
+    char chars[8];
+    const char* ptr;
+    uint64_t word;
+  } rest_;
+};
+
+static_assert(sizeof(compact_string_ref) == 16,
+              "compact_string_ref must stay 16 bytes");
+
+}  // namespace david
+
+namespace std {
+template <>
+struct hash<david::compact_string_ref> {
+  size_t operator()(const david::compact_string_ref& s) const noexcept {
+    return s.hash();
+  }
+};
+}  // namespace std
+
+#endif  // TYPES_COMPACT_STRING_REF
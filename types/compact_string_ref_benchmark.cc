@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/compact_string_ref.h"
+
+namespace david {
+namespace {
+
+// Column values as in a typical dimension table: mostly short codes and
+// names, some longer descriptions, with their chars scattered on the heap.
+std::vector<std::string> make_column(size_t n) {
+  std::mt19937 rng(42);
+  std::vector<std::string> column(n);
+  for (size_t i = 0; i < n; ++i) {
+    const size_t size = rng() % 4 == 0 ? 16 + rng() % 32 : 2 + rng() % 10;
+    for (size_t j = 0; j < size; ++j) {
+      column[i].push_back(static_cast<char>('a' + rng() % 26));
+    }
+  }
+  std::shuffle(column.begin(), column.end(), rng);
+  return column;
+}
+
+template <class T>
+void BM_Sort(benchmark::State& state) {
+  const std::vector<std::string> column = make_column(state.range(0));
+  const std::vector<T> input(column.begin(), column.end());
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<T> values = input;
+    state.ResumeTiming();
+    std::sort(values.begin(), values.end());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK_TEMPLATE(BM_Sort, string_view)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Sort, compact_string_ref)->Arg(1 << 20);
+
+// Builds a hash table on one column and probes it with another, half of
+// whose values are in the table.
+template <class T>
+void BM_HashJoin(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const std::vector<std::string> build_column = make_column(n);
+  std::vector<std::string> probe_column = make_column(2 * n);
+  std::copy(build_column.begin(), build_column.begin() + n / 2,
+            probe_column.begin());
+  std::shuffle(probe_column.begin(), probe_column.end(), std::mt19937(7));
+  const std::vector<T> build(build_column.begin(), build_column.end());
+  const std::vector<T> probe(probe_column.begin(), probe_column.end());
+  for (auto _ : state) {
+    std::unordered_set<T> table(build.begin(), build.end());
+    size_t matches = 0;
+    for (const T& value : probe) matches += table.count(value);
+    benchmark::DoNotOptimize(matches);
+  }
+  state.SetItemsProcessed(state.iterations() * (build.size() + probe.size()));
+}
+BENCHMARK_TEMPLATE(BM_HashJoin, string_view)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_HashJoin, compact_string_ref)->Arg(1 << 18);
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,146 @@
+#include "types/compact_string_ref.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+TEST(CompactStringRef, Layout) {
+  EXPECT_EQ(sizeof(compact_string_ref), 16);
+  EXPECT_TRUE(std::is_trivially_copyable<compact_string_ref>::value);
+}
+
+TEST(CompactStringRef, DefaultConstructor) {
+  const compact_string_ref s;
+  EXPECT_THAT(s, IsEmpty());
+  EXPECT_TRUE(s.is_inline());
+  EXPECT_EQ(s.view(), "");
+}
+
+TEST(CompactStringRef, FromEmptyView) {
+  const compact_string_ref s{string_view()};
+  EXPECT_THAT(s, IsEmpty());
+  EXPECT_TRUE(s.is_inline());
+  EXPECT_EQ(s, compact_string_ref());
+}
+
+TEST(CompactStringRef, ShortStringsAreInline) {
+  const std::string str = "hello world!";
+  const compact_string_ref s(str);
+  EXPECT_THAT(s, SizeIs(12));
+  EXPECT_TRUE(s.is_inline());
+  EXPECT_NE(s.data(), str.data());
+  EXPECT_EQ(s.view(), str);
+}
+
+TEST(CompactStringRef, LongStringsPointToTheirChars) {
+  const std::string str = "hello world!!";
+  const compact_string_ref s(str);
+  EXPECT_THAT(s, SizeIs(13));
+  EXPECT_FALSE(s.is_inline());
+  EXPECT_EQ(s.data(), str.data());
+  const string_view v = s;
+  EXPECT_EQ(v, str);
+}
+
+TEST(CompactStringRef, KeepsEmbeddedZeros) {
+  const compact_string_ref s(string_view("a\0b\0", 4));
+  EXPECT_EQ(s.view(), string_view("a\0b\0", 4));
+  EXPECT_NE(s, compact_string_ref(string_view("a\0b", 3)));
+}
+
+TEST(CompactStringRef, Output) {
+  std::ostringstream out;
+  out << compact_string_ref("columnar storage");
+  EXPECT_EQ(out.str(), "columnar storage");
+}
+
+// Strings around the prefix and inline boundaries, with zeros and high
+// bytes where the padding would be.
+std::vector<std::string> edge_cases() {
+  std::vector<std::string> cases = {"", "a", "ab", "abc", "abcd", "abce"};
+  for (const std::string base : {"abcd", "abcdefghijkl", "abcdefghijklmnop"}) {
+    for (size_t n = 0; n <= base.size(); ++n) {
+      std::string s = base.substr(0, n);
+      cases.push_back(s);
+      cases.push_back(s + '\0');
+      cases.push_back(s + std::string(2, '\0'));
+      cases.push_back(s + '\xff');
+      cases.push_back(s + 'a');
+      cases.push_back(s + "zz");
+    }
+  }
+  cases.push_back(std::string(12, '\0'));
+  cases.push_back(std::string(13, '\0'));
+  cases.push_back(std::string(12, '\xff'));
+  cases.push_back(std::string(20, '\xff'));
+  return cases;
+}
+
+TEST(CompactStringRef, ComparesLikeViews) {
+  const std::vector<std::string> cases = edge_cases();
+  for (const std::string& a : cases) {
+    for (const std::string& b : cases) {
+      const compact_string_ref ra(a);
+      const compact_string_ref rb(b);
+      const string_view va(a);
+      const string_view vb(b);
+      SCOPED_TRACE(testing::PrintToString(a) + " vs " +
+                   testing::PrintToString(b));
+      const int expected = va.compare(vb);
+      EXPECT_EQ(ra.compare(rb) < 0, expected < 0);
+      EXPECT_EQ(ra.compare(rb) > 0, expected > 0);
+      EXPECT_EQ(ra == rb, va == vb);
+      EXPECT_EQ(ra != rb, va != vb);
+      EXPECT_EQ(ra < rb, va < vb);
+      EXPECT_EQ(ra > rb, va > vb);
+      EXPECT_EQ(ra <= rb, va <= vb);
+      EXPECT_EQ(ra >= rb, va >= vb);
+    }
+  }
+}
+
+TEST(CompactStringRef, EqualStringsHashEqually) {
+  const std::vector<std::string> cases = edge_cases();
+  for (const std::string& s : cases) {
+    const std::string copy = s;
+    EXPECT_EQ(compact_string_ref(s).hash(), compact_string_ref(copy).hash());
+  }
+
+  std::unordered_set<compact_string_ref> set;
+  for (const std::string& s : cases) set.insert(compact_string_ref(s));
+  std::vector<std::string> distinct = cases;
+  std::sort(distinct.begin(), distinct.end());
+  distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                 distinct.end());
+  EXPECT_THAT(set, SizeIs(distinct.size()));
+  for (const std::string& s : distinct) {
+    EXPECT_EQ(set.count(compact_string_ref(s)), 1);
+  }
+}
+
+TEST(CompactStringRef, SortsLikeViews) {
+  const std::vector<std::string> cases = edge_cases();
+  std::vector<compact_string_ref> refs(cases.begin(), cases.end());
+  std::sort(refs.begin(), refs.end());
+  std::vector<std::string> sorted = cases;
+  std::sort(sorted.begin(), sorted.end());
+  ASSERT_EQ(refs.size(), sorted.size());
+  for (size_t i = 0; i < refs.size(); ++i) {
+    EXPECT_EQ(refs[i].view(), sorted[i]);
+  }
+}
+
+}  // namespace
+}  // namespace david
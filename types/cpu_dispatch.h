@@ -0,0 +1,268 @@
+#ifndef TYPES_CPU_DISPATCH
+#define TYPES_CPU_DISPATCH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "types/internal/string_kernels.h"
+
+#if DAVID_HAS_X86_KERNELS
+#include <cpuid.h>
+#endif
+
+namespace david {
+
+// Instruction set tiers of the kernels behind string_view<char>, from the
+// most to the least portable. A single binary carries all of them, and the
+// best tier the CPU supports is picked the first time a kernel runs.
+//
+// Setting the DAVID_CPU_TIER environment variable to the name of a tier
+// ("scalar", "sse2", "avx2" or "avx512") caps the pick at that tier, to test
+// or benchmark the lower tiers on a machine that has the higher ones.
+enum class cpu_tier {
+  kScalar,
+  kSse2,
+  // AVX2 and POPCNT.
+  kAvx2,
+  // AVX-512 F and BW, and POPCNT.
+  kAvx512,
+};
+
+inline const char* cpu_tier_name(cpu_tier tier) {
+  switch (tier) {
+    case cpu_tier::kScalar:
+      return "scalar";
+    case cpu_tier::kSse2:
+      return "sse2";
+    case cpu_tier::kAvx2:
+      return "avx2";
+    case cpu_tier::kAvx512:
+      return "avx512";
+  }
+  return "unknown";
+}
+
+// Parses the name of a tier. Returns false if there is no such tier.
+inline bool parse_cpu_tier(const char* name, cpu_tier* tier) {
+  for (int t = 0; t <= static_cast<int>(cpu_tier::kAvx512); ++t) {
+    if (std::strcmp(name, cpu_tier_name(static_cast<cpu_tier>(t))) == 0) {
+      *tier = static_cast<cpu_tier>(t);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Best tier of this CPU and operating system, regardless of DAVID_CPU_TIER.
+inline cpu_tier detected_cpu_tier() {
+#if DAVID_HAS_X86_KERNELS
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return cpu_tier::kScalar;
+  if ((edx & bit_SSE2) == 0) return cpu_tier::kScalar;
+  // The wider registers also need the operating system to save them, as
+  // reported by XCR0.
+  if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0) {
+    return cpu_tier::kSse2;
+  }
+  uint32_t xcr0_lo, xcr0_hi;
+  __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  const uint32_t kYmmState = 0x6;
+  const uint32_t kZmmState = 0xe6;
+  if ((xcr0_lo & kYmmState) != kYmmState) return cpu_tier::kSse2;
+  const bool popcnt = (ecx & bit_POPCNT) != 0;
+  if (!popcnt || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) ||
+      (ebx & bit_AVX2) == 0) {
+    return cpu_tier::kSse2;
+  }
+  if ((ebx & bit_AVX512F) != 0 && (ebx & bit_AVX512BW) != 0 &&
+      (xcr0_lo & kZmmState) == kZmmState) {
+    return cpu_tier::kAvx512;
+  }
+  return cpu_tier::kAvx2;
+#else
+  return cpu_tier::kScalar;
+#endif
+}
+
+namespace internal {
+
+// One entry per kernel of string_kernels.h.
+struct string_kernel_table {
+  size_t (*find)(const char* h, size_t n, const char* s, size_t m);
+  size_t (*rfind)(const char* h, size_t n, const char* s, size_t m);
+  size_t (*find_of)(const char* h, size_t n, const char* s, size_t m,
+                    bool negate);
+  size_t (*rfind_of)(const char* h, size_t n, const char* s, size_t m,
+                     bool negate);
+  size_t (*mismatch)(const char* a, const char* b, size_t n);
+  int (*compare)(const char* a, const char* b, size_t n);
+  uint64_t (*hash)(const char* p, size_t n);
+  size_t (*count)(const char* h, size_t n, char c);
+};
+
+#define DAVID_STRING_KERNEL_TABLE(ns)                                     \
+  {                                                                       \
+    &ns::find, &ns::rfind, &ns::find_of, &ns::rfind_of, &ns::mismatch,    \
+        &ns::compare, &ns::hash, &ns::count                               \
+  }
+
+inline const string_kernel_table* string_kernels_for(cpu_tier tier) {
+  static const string_kernel_table kScalar = DAVID_STRING_KERNEL_TABLE(scalar);
+#if DAVID_HAS_X86_KERNELS
+  static const string_kernel_table kSse2 = DAVID_STRING_KERNEL_TABLE(sse2);
+  static const string_kernel_table kAvx2 = DAVID_STRING_KERNEL_TABLE(avx2);
+  static const string_kernel_table kAvx512 =
+      DAVID_STRING_KERNEL_TABLE(avx512);
+  switch (tier) {
+    case cpu_tier::kScalar:
+      return &kScalar;
+    case cpu_tier::kSse2:
+      return &kSse2;
+    case cpu_tier::kAvx2:
+      return &kAvx2;
+    case cpu_tier::kAvx512:
+      return &kAvx512;
+  }
+#endif
+  (void)tier;
+  return &kScalar;
+}
+
+#undef DAVID_STRING_KERNEL_TABLE
+
+// The tier picked at startup: the detected one, capped by DAVID_CPU_TIER.
+inline cpu_tier default_cpu_tier() {
+  cpu_tier tier = detected_cpu_tier();
+  const char* forced = std::getenv("DAVID_CPU_TIER");
+  cpu_tier cap;
+  if (forced != nullptr && parse_cpu_tier(forced, &cap) && cap < tier) {
+    tier = cap;
+  }
+  return tier;
+}
+
+inline const string_kernel_table* resolve_string_kernels();
+
+// The active table. It starts out as a table of trampolines that pick the
+// real table on their first call, so that calls need no check of whether a
+// table was picked, and static initializers can already call the kernels.
+template <typename T = void>
+struct string_kernel_dispatch {
+  static size_t find(const char* h, size_t n, const char* s, size_t m) {
+    return resolve_string_kernels()->find(h, n, s, m);
+  }
+  static size_t rfind(const char* h, size_t n, const char* s, size_t m) {
+    return resolve_string_kernels()->rfind(h, n, s, m);
+  }
+  static size_t find_of(const char* h, size_t n, const char* s, size_t m,
+                        bool negate) {
+    return resolve_string_kernels()->find_of(h, n, s, m, negate);
+  }
+  static size_t rfind_of(const char* h, size_t n, const char* s, size_t m,
+                         bool negate) {
+    return resolve_string_kernels()->rfind_of(h, n, s, m, negate);
+  }
+  static size_t mismatch(const char* a, const char* b, size_t n) {
+    return resolve_string_kernels()->mismatch(a, b, n);
+  }
+  static int compare(const char* a, const char* b, size_t n) {
+    return resolve_string_kernels()->compare(a, b, n);
+  }
+  static uint64_t hash(const char* p, size_t n) {
+    return resolve_string_kernels()->hash(p, n);
+  }
+  static size_t count(const char* h, size_t n, char c) {
+    return resolve_string_kernels()->count(h, n, c);
+  }
+
+  static const string_kernel_table resolving;
+  static std::atomic<const string_kernel_table*> table;
+  static std::atomic<int> tier;
+};
+
+template <typename T>
+const string_kernel_table string_kernel_dispatch<T>::resolving = {
+    &string_kernel_dispatch<T>::find,     &string_kernel_dispatch<T>::rfind,
+    &string_kernel_dispatch<T>::find_of,  &string_kernel_dispatch<T>::rfind_of,
+    &string_kernel_dispatch<T>::mismatch, &string_kernel_dispatch<T>::compare,
+    &string_kernel_dispatch<T>::hash,     &string_kernel_dispatch<T>::count};
+
+template <typename T>
+std::atomic<const string_kernel_table*> string_kernel_dispatch<T>::table(
+    &string_kernel_dispatch<T>::resolving);
+
+// -1 until a tier is picked.
+template <typename T>
+std::atomic<int> string_kernel_dispatch<T>::tier(-1);
+
+inline void activate_cpu_tier(cpu_tier tier) {
+  string_kernel_dispatch<>::tier.store(static_cast<int>(tier),
+                                       std::memory_order_relaxed);
+  string_kernel_dispatch<>::table.store(string_kernels_for(tier),
+                                        std::memory_order_relaxed);
+}
+
+inline const string_kernel_table* resolve_string_kernels() {
+  // Threads racing here all pick the same tier, unless set_cpu_tier() picked
+  // one first.
+  static const cpu_tier picked = default_cpu_tier();
+  int tier = -1;
+  if (string_kernel_dispatch<>::tier.compare_exchange_strong(
+          tier, static_cast<int>(picked), std::memory_order_relaxed)) {
+    tier = static_cast<int>(picked);
+  }
+  const string_kernel_table* table =
+      string_kernels_for(static_cast<cpu_tier>(tier));
+  const string_kernel_table* resolving = &string_kernel_dispatch<>::resolving;
+  string_kernel_dispatch<>::table.compare_exchange_strong(
+      resolving, table, std::memory_order_relaxed);
+  return table;
+}
+
+// The kernels of the active tier.
+inline const string_kernel_table& string_kernels() {
+  return *string_kernel_dispatch<>::table.load(std::memory_order_relaxed);
+}
+
+}  // namespace internal
+
+// Tier of the kernels in use.
+inline cpu_tier active_cpu_tier() {
+  internal::resolve_string_kernels();
+  return static_cast<cpu_tier>(
+      internal::string_kernel_dispatch<>::tier.load(std::memory_order_relaxed));
+}
+
+namespace internal {
+
+// Whether the active tier is at least tier, for kernels outside the table
+// above that follow its tier. Once a tier is picked, this is a plain load.
+inline bool cpu_tier_at_least(cpu_tier tier) {
+  int active = string_kernel_dispatch<>::tier.load(std::memory_order_relaxed);
+  if (active < 0) active = static_cast<int>(active_cpu_tier());
+  return active >= static_cast<int>(tier);
+}
+
+}  // namespace internal
+
+// Switches the kernels to tier, for tests and benchmarks that compare tiers.
+// Returns false, and changes nothing, if the CPU does not support tier. Not
+// meant to be called while other threads use string_view.
+inline bool set_cpu_tier(cpu_tier tier) {
+  if (tier > detected_cpu_tier()) return false;
+  internal::activate_cpu_tier(tier);
+  return true;
+}
+
+// 64-bit hash of the bytes of p[0, n), computed by the kernels of the active
+// tier. Every tier returns the same hash, which differs from std::hash.
+inline uint64_t hash_bytes(const char* p, size_t n) {
+  return internal::string_kernels().hash(p, n);
+}
+
+}  // namespace david
+
+#endif  // TYPES_CPU_DISPATCH
@@ -0,0 +1,133 @@
+#include <functional>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "types/cpu_dispatch.h"
+#include "types/string_view.h"
+
+namespace david {
+namespace {
+
+// Each benchmark takes the tier as state.range(0), and is skipped on CPUs
+// without it.
+bool use_tier(benchmark::State& state) {
+  const cpu_tier tier = static_cast<cpu_tier>(state.range(0));
+  if (!set_cpu_tier(tier)) {
+    state.SkipWithError("tier not supported");
+    return false;
+  }
+  state.SetLabel(cpu_tier_name(tier));
+  return true;
+}
+
+void tiers(benchmark::internal::Benchmark* b) {
+  for (int t = 0; t <= static_cast<int>(cpu_tier::kAvx512); ++t) b->Arg(t);
+}
+
+// 64 KiB of text where the first char of the needle is frequent.
+std::string make_text() {
+  std::string text;
+  while (text.size() < (64 << 10)) text += "the quick brown fox jumps ";
+  return text;
+}
+
+template <typename T>
+T opaque(T value) {
+  benchmark::DoNotOptimize(value);
+  return value;
+}
+
+void BM_Find(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string text = make_text();
+  const string_view haystack(text);
+  const string_view needle = opaque(string_view("the lazy dog"));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(haystack.find(needle));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Find)->Apply(tiers);
+
+void BM_Rfind(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string text = make_text();
+  const string_view haystack(text);
+  const string_view needle = opaque(string_view("the lazy dog"));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(haystack.rfind(needle));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Rfind)->Apply(tiers);
+
+void BM_FindFirstOf(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string text = make_text();
+  const string_view haystack(text);
+  const string_view set = opaque(string_view("\t\r\n;"));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(haystack.find_first_of(set));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_FindFirstOf)->Apply(tiers);
+
+void BM_FindLastNotOf(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string text = make_text();
+  const string_view haystack(text);
+  const string_view set = opaque(string_view("abcdefghijklmnopqrstuvwxyz "));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(haystack.find_last_not_of(set));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_FindLastNotOf)->Apply(tiers);
+
+// Equal strings of state.range(1) chars, so compare reads them whole.
+void BM_Compare(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string a(state.range(1), 'x');
+  const std::string b = a;
+  const string_view va = opaque(string_view(a));
+  const string_view vb = opaque(string_view(b));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(va.compare(vb));
+  }
+  state.SetBytesProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_Compare)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int t = 0; t <= static_cast<int>(cpu_tier::kAvx512); ++t) {
+        b->Args({t, 16})->Args({t, 256})->Args({t, 4096});
+      }
+    });
+
+void BM_HashBytes(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string s(state.range(1), 'x');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hash_bytes(s.data(), s.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_HashBytes)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int t = 0; t <= static_cast<int>(cpu_tier::kAvx512); ++t) {
+        b->Args({t, 16})->Args({t, 4096});
+      }
+    });
+
+void BM_StdHash(benchmark::State& state) {
+  const std::string s(state.range(0), 'x');
+  const string_view v(s);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::hash<string_view>()(v));
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_StdHash)->Arg(16)->Arg(4096);
+
+}  // namespace
+}  // namespace david
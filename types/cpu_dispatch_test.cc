@@ -0,0 +1,185 @@
+#include "types/cpu_dispatch.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "types/string_view.h"
+
+namespace david {
+namespace {
+
+// Same chars as string_view, but the operations take the generic loops
+// rather than the kernels, so they serve as a reference.
+struct reference_traits : std::char_traits<char> {};
+using reference_view = basic_string_view<char, reference_traits>;
+
+reference_view reference(string_view s) {
+  return reference_view(s.data(), s.size());
+}
+
+std::vector<cpu_tier> supported_tiers() {
+  std::vector<cpu_tier> tiers;
+  for (int t = 0; t <= static_cast<int>(detected_cpu_tier()); ++t) {
+    tiers.push_back(static_cast<cpu_tier>(t));
+  }
+  return tiers;
+}
+
+class CpuDispatchTest : public ::testing::TestWithParam<cpu_tier> {
+ protected:
+  void SetUp() override { ASSERT_TRUE(set_cpu_tier(GetParam())); }
+  void TearDown() override { set_cpu_tier(detected_cpu_tier()); }
+};
+
+TEST_P(CpuDispatchTest, ActiveTier) {
+  EXPECT_EQ(active_cpu_tier(), GetParam());
+}
+
+// Strings over a small alphabet, so that needles and sets often match.
+std::string random_string(std::mt19937* rng, size_t max_size) {
+  std::string s(std::uniform_int_distribution<size_t>(0, max_size)(*rng), 0);
+  for (char& c : s) c = "abc\xff"[(*rng)() % 4];
+  return s;
+}
+
+TEST_P(CpuDispatchTest, MatchesReference) {
+  std::mt19937 rng(42);
+  for (int i = 0; i < 20000; ++i) {
+    const std::string text = random_string(&rng, 200);
+    const std::string needle = random_string(&rng, i % 2 == 0 ? 3 : 12);
+    const string_view h(text);
+    const string_view s(needle);
+    const reference_view rh = reference(h);
+    const reference_view rs = reference(s);
+    const size_t pos = rng() % (text.size() + 2);
+    SCOPED_TRACE("text: " + text + ", needle: " + needle +
+                 ", pos: " + std::to_string(pos));
+
+    EXPECT_EQ(h.find(s, pos), rh.find(rs, pos));
+    EXPECT_EQ(h.rfind(s, pos), rh.rfind(rs, pos));
+    EXPECT_EQ(h.find_first_of(s, pos), rh.find_first_of(rs, pos));
+    EXPECT_EQ(h.find_last_of(s, pos), rh.find_last_of(rs, pos));
+    EXPECT_EQ(h.find_first_not_of(s, pos), rh.find_first_not_of(rs, pos));
+    EXPECT_EQ(h.find_last_not_of(s, pos), rh.find_last_not_of(rs, pos));
+    EXPECT_EQ(h.find(s), rh.find(rs));
+    EXPECT_EQ(h.rfind(s), rh.rfind(rs));
+    const int c = h.compare(s);
+    const int rc = rh.compare(rs);
+    EXPECT_EQ(c < 0, rc < 0);
+    EXPECT_EQ(c > 0, rc > 0);
+    EXPECT_EQ(common_prefix_length(h, s), common_prefix_length(rh, rs));
+    const string_view prefix = h.substr(0, pos);
+    const string_view suffix = h.substr(text.size() - pos % (text.size() + 1));
+    EXPECT_TRUE(h.starts_with(prefix));
+    EXPECT_TRUE(h.ends_with(suffix));
+    EXPECT_EQ(h.starts_with(s), rh.starts_with(rs));
+    EXPECT_EQ(h.ends_with(s), rh.ends_with(rs));
+    EXPECT_EQ(count(h, needle[0]), count(rh, needle[0]));
+    const size_t from = pos % (text.size() + 1);
+    EXPECT_EQ(count(h.substr(from), needle[0]),
+              count(rh.substr(from), needle[0]));
+  }
+}
+
+TEST_P(CpuDispatchTest, CommonPrefixLengthAcrossBlocks) {
+  const std::string a(300, 'a');
+  for (size_t i = 0; i < a.size(); ++i) {
+    std::string b = a;
+    b[i] = '\xff';
+    EXPECT_EQ(common_prefix_length(string_view(a), string_view(b)), i);
+    EXPECT_EQ(common_prefix_length(string_view(a).substr(0, i),
+                                   string_view(b)),
+              i);
+  }
+}
+
+TEST_P(CpuDispatchTest, CountAcrossBlocks) {
+  // Past the 31 words of one scalar sum and the 64 bytes of one popcount.
+  std::string text(1000, '\n');
+  for (size_t i = 0; i < text.size(); i += 3) text[i] = 'x';
+  for (size_t n = 0; n <= text.size(); ++n) {
+    const string_view h = string_view(text).substr(0, n);
+    EXPECT_EQ(count(h, '\n'), n - (n + 2) / 3) << n;
+    EXPECT_EQ(count(h, 'x'), (n + 2) / 3) << n;
+  }
+  EXPECT_EQ(count(string_view(std::string(4096, '\xff')), '\xff'), 4096u);
+}
+
+TEST_P(CpuDispatchTest, LargeSets) {
+  const std::string set = "0123456789abcdef";
+  const std::string text = std::string(100, 'x') + "7" + std::string(100, 'y');
+  const string_view h(text);
+  EXPECT_EQ(h.find_first_of(set), 100);
+  EXPECT_EQ(h.find_last_of(set), 100);
+  EXPECT_EQ(h.find_first_not_of("xy7"), string_view::npos);
+  EXPECT_EQ(h.find_last_not_of("xy"), 100);
+}
+
+TEST_P(CpuDispatchTest, CompareIsUnsigned) {
+  EXPECT_LT(string_view("a\x01").compare("a\xff"), 0);
+  EXPECT_GT(string_view(std::string(100, 'a') + "\xff")
+                .compare(std::string(100, 'a') + "\x01"),
+            0);
+}
+
+TEST_P(CpuDispatchTest, HashIsTheSameOnEveryTier) {
+  std::mt19937 rng(7);
+  for (int i = 0; i < 2000; ++i) {
+    const std::string s = random_string(&rng, 300);
+    const uint64_t h = hash_bytes(s.data(), s.size());
+    EXPECT_EQ(h, internal::scalar::hash(s.data(), s.size()));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Tiers, CpuDispatchTest,
+                         ::testing::ValuesIn(supported_tiers()),
+                         [](const ::testing::TestParamInfo<cpu_tier>& info) {
+                           return std::string(cpu_tier_name(info.param));
+                         });
+
+TEST(CpuTierTest, Names) {
+  cpu_tier tier;
+  ASSERT_TRUE(parse_cpu_tier("avx2", &tier));
+  EXPECT_EQ(tier, cpu_tier::kAvx2);
+  ASSERT_TRUE(parse_cpu_tier("scalar", &tier));
+  EXPECT_EQ(tier, cpu_tier::kScalar);
+  EXPECT_FALSE(parse_cpu_tier("avx3", &tier));
+  EXPECT_STREQ(cpu_tier_name(cpu_tier::kAvx512), "avx512");
+}
+
+TEST(CpuTierTest, EnvironmentCapsTier) {
+  setenv("DAVID_CPU_TIER", "scalar", 1);
+  EXPECT_EQ(internal::default_cpu_tier(), cpu_tier::kScalar);
+  // A tier above the detected one leaves the detected one.
+  setenv("DAVID_CPU_TIER", "avx512", 1);
+  EXPECT_EQ(internal::default_cpu_tier(), detected_cpu_tier());
+  setenv("DAVID_CPU_TIER", "bogus", 1);
+  EXPECT_EQ(internal::default_cpu_tier(), detected_cpu_tier());
+  unsetenv("DAVID_CPU_TIER");
+}
+
+TEST(CpuTierTest, RejectsUnsupportedTier) {
+  if (detected_cpu_tier() == cpu_tier::kAvx512) return;
+  EXPECT_FALSE(set_cpu_tier(cpu_tier::kAvx512));
+}
+
+TEST(CpuTierTest, HashSpreadsKeys) {
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 1000; ++i) {
+    const std::string s = "key" + std::to_string(i);
+    hashes.push_back(hash_bytes(s.data(), s.size()) >> 54);
+  }
+  std::sort(hashes.begin(), hashes.end());
+  const size_t distinct =
+      std::unique(hashes.begin(), hashes.end()) - hashes.begin();
+  // 1000 keys in 1024 buckets fill about 630 of them.
+  EXPECT_GT(distinct, 550);
+}
+
+}  // namespace
+}  // namespace david
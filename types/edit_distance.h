@@ -0,0 +1,212 @@
+#ifndef TYPES_EDIT_DISTANCE
+#define TYPES_EDIT_DISTANCE
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types/string_view.h"
+
+// Levenshtein distance, the least number of single char insertions,
+// deletions and substitutions that turn one string into another, by Myers'
+// bit-parallel algorithm ("A fast bit-vector algorithm for approximate string
+// matching based on dynamic programming", 1999) in the block form of Hyyrö.
+//
+// The DP matrix of a pattern of m chars against a text is computed a column
+// at a time, one column per text char, as the bit vectors of its vertical
+// deltas: bit i of pv (mv) is set when row i + 1 is one more (less) than row
+// i. A column is 64 rows per word, so a pattern of up to 64 chars takes a few
+// word operations per text char, in place of a row of m cells. Chars are
+// bytes.
+namespace david {
+namespace internal {
+
+// Moves a block of 64 rows to the next column, for a text char matching the
+// pattern chars of the bits of eq. hin is the horizontal delta, -1, 0 or 1,
+// into the top row of the block. Returns the one out of row out_bit.
+inline int advance_myers_block(uint64_t* pv, uint64_t* mv, uint64_t eq,
+                               int hin, unsigned out_bit) {
+  const uint64_t hin_neg = hin < 0 ? 1 : 0;
+  const uint64_t xv = eq | *mv;
+  eq |= hin_neg;
+  const uint64_t xh = (((eq & *pv) + *pv) ^ *pv) | eq;
+  uint64_t ph = *mv | ~(xh | *pv);
+  uint64_t mh = *pv & xh;
+  const int hout = static_cast<int>((ph >> out_bit) & 1) -
+                   static_cast<int>((mh >> out_bit) & 1);
+  ph = (ph << 1) | (hin > 0 ? 1 : 0);
+  mh = (mh << 1) | hin_neg;
+  *pv = mh | ~(xv | ph);
+  *mv = ph & xv;
+  return hout;
+}
+
+// Whether a distance of score at column j of n can no longer end at most
+// max_k: each of the n - j columns left lowers the bottom row by at most one.
+inline bool myers_past_max(size_t score, size_t j, size_t n, size_t max_k) {
+  const size_t left = n - j;
+  return score > left && score - left > max_k;
+}
+
+inline size_t clamp_distance(size_t distance, size_t max_k) {
+  return distance <= max_k ? distance : max_k + 1;
+}
+
+// The distance of a pattern of 1 to 64 chars to text, with peq[c] the
+// pattern chars equal to c.
+inline size_t myers_distance(const uint64_t* peq, size_t m, string_view text,
+                             size_t max_k) {
+  const unsigned last = static_cast<unsigned>(m - 1);
+  uint64_t pv = ~uint64_t(0);
+  uint64_t mv = 0;
+  size_t score = m;
+  const size_t n = text.size();
+  for (size_t j = 0; j < n; ++j) {
+    const uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+    score += advance_myers_block(&pv, &mv, eq, 1, last);
+    if (myers_past_max(score, j + 1, n, max_k)) return max_k + 1;
+  }
+  return clamp_distance(score, max_k);
+}
+
+// As above for a pattern of words blocks, with peq[c * words + b] the chars
+// of block b equal to c, and pv and mv words of scratch.
+inline size_t myers_distance(const uint64_t* peq, size_t words, size_t m,
+                             string_view text, size_t max_k, uint64_t* pv,
+                             uint64_t* mv) {
+  const unsigned last = static_cast<unsigned>((m - 1) % 64);
+  std::fill(pv, pv + words, ~uint64_t(0));
+  std::fill(mv, mv + words, uint64_t(0));
+  size_t score = m;
+  const size_t n = text.size();
+  for (size_t j = 0; j < n; ++j) {
+    const uint64_t* eq = peq + static_cast<unsigned char>(text[j]) * words;
+    // The top row is j, one more than in the last column.
+    int h = 1;
+    for (size_t b = 0; b + 1 < words; ++b) {
+      h = advance_myers_block(&pv[b], &mv[b], eq[b], h, 63);
+    }
+    score += advance_myers_block(&pv[words - 1], &mv[words - 1],
+                                 eq[words - 1], h, last);
+    if (myers_past_max(score, j + 1, n, max_k)) return max_k + 1;
+  }
+  return clamp_distance(score, max_k);
+}
+
+}  // namespace internal
+
+// A pattern whose distance to many strings is wanted, as a query scored
+// against candidates: its bit vectors are built once, not per string.
+class edit_distance_query {
+ public:
+  explicit edit_distance_query(string_view query)
+      : query_(query.data(), query.size()),
+        words_((query.size() + 63) / 64) {
+    uint64_t* peq = small_peq_;
+    if (words_ > 1) {
+      peq_.assign(256 * words_, 0);
+      peq = peq_.data();
+    } else {
+      std::fill(small_peq_, small_peq_ + 256, uint64_t(0));
+    }
+    for (size_t i = 0; i < query.size(); ++i) {
+      peq[static_cast<unsigned char>(query[i]) * words_ + i / 64] |=
+          uint64_t(1) << (i % 64);
+    }
+  }
+
+  const std::string& query() const noexcept { return query_; }
+
+  // The edit distance of the query to candidate if at most max_k, and
+  // max_k + 1 otherwise. Stops as soon as the distance is known to be past
+  // max_k. Allocates only for queries longer than 512 chars.
+  size_t distance(string_view candidate,
+                  size_t max_k = string_view::npos) const {
+    const size_t m = query_.size();
+    const size_t n = candidate.size();
+    if (std::max(m, n) - std::min(m, n) > max_k) return max_k + 1;
+    if (m == 0) return internal::clamp_distance(n, max_k);
+    if (words_ == 1) {
+      return internal::myers_distance(small_peq_, m, candidate, max_k);
+    }
+    if (words_ <= kStackWords) {
+      uint64_t pv[kStackWords];
+      uint64_t mv[kStackWords];
+      return internal::myers_distance(peq_.data(), words_, m, candidate,
+                                      max_k, pv, mv);
+    }
+    std::vector<uint64_t> scratch(2 * words_);
+    return internal::myers_distance(peq_.data(), words_, m, candidate, max_k,
+                                    scratch.data(), scratch.data() + words_);
+  }
+
+  // Sets distances[i] to distance(candidates[i], max_k) for every i in
+  // [0, n).
+  void distances(const string_view* candidates, size_t n, size_t max_k,
+                 size_t* distances) const {
+    for (size_t i = 0; i < n; ++i) {
+      distances[i] = distance(candidates[i], max_k);
+    }
+  }
+
+ private:
+  static constexpr size_t kStackWords = 8;
+
+  std::string query_;
+  size_t words_;
+  // peq[c * words_ + b]: bit i set when query char 64 * b + i is c. Inline
+  // for queries of up to 64 chars, on the heap for longer ones.
+  uint64_t small_peq_[256];
+  std::vector<uint64_t> peq_;
+};
+
+// The edit distance of a and b if at most max_k, and max_k + 1 otherwise.
+// Stops as soon as the distance is known to be past max_k, and allocates
+// nothing when either string is at most 64 chars. To score one string
+// against many, edit_distance_query builds its bit vectors once.
+inline size_t edit_distance(string_view a, string_view b,
+                            size_t max_k = string_view::npos) {
+  // The common prefix and suffix are free.
+  size_t prefix = 0;
+  const size_t shorter = std::min(a.size(), b.size());
+  while (prefix < shorter && a[prefix] == b[prefix]) ++prefix;
+  size_t suffix = 0;
+  while (suffix < shorter - prefix &&
+         a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix]) {
+    ++suffix;
+  }
+  a = a.substr(prefix, a.size() - prefix - suffix);
+  b = b.substr(prefix, b.size() - prefix - suffix);
+
+  // The shorter string is the pattern, so fewer words per column.
+  if (a.size() > b.size()) std::swap(a, b);
+  const size_t m = a.size();
+  const size_t n = b.size();
+  if (n - m > max_k) return max_k + 1;
+  if (m == 0) return internal::clamp_distance(n, max_k);
+  if (m > 64) return edit_distance_query(a).distance(b, max_k);
+
+  // Only the entries of chars in a or b are read, so only they are cleared.
+  uint64_t peq[256];
+  for (size_t j = 0; j < n; ++j) peq[static_cast<unsigned char>(b[j])] = 0;
+  for (size_t i = 0; i < m; ++i) peq[static_cast<unsigned char>(a[i])] = 0;
+  for (size_t i = 0; i < m; ++i) {
+    peq[static_cast<unsigned char>(a[i])] |= uint64_t(1) << i;
+  }
+  return internal::myers_distance(peq, m, b, max_k);
+}
+
+// Sets distances[i] to edit_distance(query, candidates[i], max_k) for every
+// i in [0, n), building the bit vectors of query once.
+inline void batch_edit_distance(string_view query,
+                                const string_view* candidates, size_t n,
+                                size_t max_k, size_t* distances) {
+  edit_distance_query(query).distances(candidates, n, max_k, distances);
+}
+
+}  // namespace david
+
+#endif  // TYPES_EDIT_DISTANCE
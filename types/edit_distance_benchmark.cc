@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/edit_distance.h"
+
+namespace david {
+namespace {
+
+// The DP with heap rows that edit_distance replaces.
+size_t dp_distance(string_view a, string_view b) {
+  std::vector<size_t> row(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) row[j] = j;
+  for (size_t i = 1; i <= a.size(); ++i) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      const size_t above = row[j];
+      row[j] = std::min({above + 1, row[j - 1] + 1,
+                         diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+      diagonal = above;
+    }
+  }
+  return row[b.size()];
+}
+
+// 4096 words of size random lower case letters, or of 4 to 16 when size is 0,
+// as suggestion candidates.
+std::vector<std::string> candidates(size_t size = 0) {
+  std::mt19937 rng(42);
+  std::vector<std::string> words(4096);
+  for (std::string& w : words) {
+    w.resize(size != 0 ? size : 4 + rng() % 13);
+    for (char& c : w) c = static_cast<char>('a' + rng() % 26);
+  }
+  return words;
+}
+
+std::vector<string_view> views(const std::vector<std::string>& words) {
+  return std::vector<string_view>(words.begin(), words.end());
+}
+
+const char kQuery[] = "suggestion";
+
+void BM_DpTopK(benchmark::State& state) {
+  const std::vector<std::string> words = candidates(state.range(0));
+  const std::string query =
+      state.range(0) == 0 ? kQuery : candidates(state.range(0))[1];
+  for (auto _ : state) {
+    size_t close = 0;
+    for (const std::string& w : words) close += dp_distance(query, w) <= 2;
+    benchmark::DoNotOptimize(close);
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_DpTopK)->Arg(0)->Arg(200);
+
+void BM_EditDistanceTopK(benchmark::State& state) {
+  const std::vector<std::string> words = candidates(state.range(0));
+  const std::string query =
+      state.range(0) == 0 ? kQuery : candidates(state.range(0))[1];
+  for (auto _ : state) {
+    size_t close = 0;
+    for (const std::string& w : words) close += edit_distance(query, w, 2) <= 2;
+    benchmark::DoNotOptimize(close);
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_EditDistanceTopK)->Arg(0)->Arg(200);
+
+void BM_EditDistanceUnbounded(benchmark::State& state) {
+  const std::vector<std::string> words = candidates(state.range(0));
+  const std::string query =
+      state.range(0) == 0 ? kQuery : candidates(state.range(0))[1];
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (const std::string& w : words) sum += edit_distance(query, w);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_EditDistanceUnbounded)->Arg(0)->Arg(200);
+
+void BM_BatchEditDistance(benchmark::State& state) {
+  const std::vector<std::string> words = candidates(state.range(0));
+  const std::vector<string_view> v = views(words);
+  const std::string query =
+      state.range(0) == 0 ? kQuery : candidates(state.range(0))[1];
+  std::vector<size_t> distances(v.size());
+  for (auto _ : state) {
+    batch_edit_distance(query, v.data(), v.size(), 2, distances.data());
+    benchmark::DoNotOptimize(distances.data());
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_BatchEditDistance)->Arg(0)->Arg(200);
+
+}  // namespace
+}  // namespace david
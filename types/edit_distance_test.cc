@@ -0,0 +1,141 @@
+#include "types/edit_distance.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+
+// The textbook DP, a row at a time.
+size_t reference_distance(const std::string& a, const std::string& b) {
+  std::vector<size_t> row(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) row[j] = j;
+  for (size_t i = 1; i <= a.size(); ++i) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      const size_t above = row[j];
+      row[j] = std::min({above + 1, row[j - 1] + 1,
+                         diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+      diagonal = above;
+    }
+  }
+  return row[b.size()];
+}
+
+// A string of size chars out of the first alphabet chars of "abcd...", so
+// that small alphabets give many matches.
+std::string random_string(std::mt19937& rng, size_t size, int alphabet) {
+  std::string s(size, '\0');
+  for (char& c : s) c = static_cast<char>('a' + rng() % alphabet);
+  return s;
+}
+
+TEST(EditDistanceTest, Examples) {
+  EXPECT_EQ(edit_distance("kitten", "sitting"), 3u);
+  EXPECT_EQ(edit_distance("sitting", "kitten"), 3u);
+  EXPECT_EQ(edit_distance("flaw", "lawn"), 2u);
+  EXPECT_EQ(edit_distance("", ""), 0u);
+  EXPECT_EQ(edit_distance("", "abc"), 3u);
+  EXPECT_EQ(edit_distance("abc", ""), 3u);
+  EXPECT_EQ(edit_distance("same", "same"), 0u);
+  EXPECT_EQ(edit_distance("a", "b"), 1u);
+  EXPECT_EQ(edit_distance("\xff\x80", "\x80\xff"), 2u);
+}
+
+TEST(EditDistanceTest, MaxK) {
+  EXPECT_EQ(edit_distance("kitten", "sitting", 3), 3u);
+  EXPECT_EQ(edit_distance("kitten", "sitting", 2), 3u);
+  EXPECT_EQ(edit_distance("kitten", "sitting", 0), 1u);
+  EXPECT_EQ(edit_distance("same", "same", 0), 0u);
+  // Past max_k from the lengths alone.
+  EXPECT_EQ(edit_distance("a", "abcdefgh", 3), 4u);
+  EXPECT_EQ(edit_distance("", "abcdefgh", 3), 4u);
+  const std::string x(200, 'x');
+  const std::string y(200, 'y');
+  EXPECT_EQ(edit_distance(x, y, 10), 11u);
+  EXPECT_EQ(edit_distance(x, y), 200u);
+}
+
+TEST(EditDistanceTest, MatchesReference) {
+  std::mt19937 rng(7);
+  for (int iter = 0; iter < 3000; ++iter) {
+    // Up to three words of pattern, past the common prefix and suffix.
+    const size_t max_size = iter % 3 == 0 ? 200 : 70;
+    const int alphabet = 1 + iter % 4;
+    std::string a = random_string(rng, rng() % max_size, alphabet);
+    std::string b = random_string(rng, rng() % max_size, alphabet);
+    if (iter % 5 == 0) b = "common" + b + "end";
+    if (iter % 5 == 0) a = "common" + a + "end";
+    const size_t want = reference_distance(a, b);
+    ASSERT_EQ(edit_distance(a, b), want) << a << " " << b;
+    const size_t max_k = rng() % (want + 3);
+    ASSERT_EQ(edit_distance(a, b, max_k), std::min(want, max_k + 1))
+        << a << " " << b << " " << max_k;
+    const edit_distance_query query(a);
+    ASSERT_EQ(query.distance(b), want) << a << " " << b;
+    ASSERT_EQ(query.distance(b, max_k), std::min(want, max_k + 1));
+  }
+}
+
+TEST(EditDistanceTest, PatternAtWordBoundaries) {
+  std::mt19937 rng(11);
+  for (size_t m : {63, 64, 65, 127, 128, 129, 511, 512, 513, 600}) {
+    const std::string a = random_string(rng, m, 3);
+    std::string b = a;
+    for (int edits = 0; edits < 20; ++edits) {
+      const size_t at = rng() % (b.size() + 1);
+      switch (rng() % 3) {
+        case 0:
+          b.insert(at, 1, 'z');
+          break;
+        case 1:
+          if (at < b.size()) b.erase(at, 1);
+          break;
+        default:
+          if (at < b.size()) b[at] = 'y';
+      }
+    }
+    const size_t want = reference_distance(a, b);
+    EXPECT_EQ(edit_distance_query(a).distance(b), want) << m;
+    EXPECT_EQ(edit_distance_query(b).distance(a), want) << m;
+    EXPECT_EQ(edit_distance(a, b, 5), std::min<size_t>(want, 6)) << m;
+  }
+}
+
+TEST(EditDistanceTest, Query) {
+  const edit_distance_query query("levenshtein");
+  EXPECT_EQ(query.query(), "levenshtein");
+  EXPECT_EQ(query.distance("levenstein"), 1u);
+  EXPECT_EQ(query.distance("levenshtein"), 0u);
+  EXPECT_EQ(query.distance(""), 11u);
+  EXPECT_EQ(query.distance("meilenstein", 2), 3u);
+
+  const edit_distance_query empty("");
+  EXPECT_EQ(empty.distance("abc"), 3u);
+  EXPECT_EQ(empty.distance("abc", 1), 2u);
+}
+
+TEST(EditDistanceTest, Batch) {
+  const std::vector<string_view> candidates = {"apple", "apply", "ample",
+                                               "maple", "", "applesauce"};
+  std::vector<size_t> distances(candidates.size());
+  batch_edit_distance("apple", candidates.data(), candidates.size(), 2,
+                      distances.data());
+  EXPECT_THAT(distances, ElementsAre(0, 1, 1, 2, 3, 3));
+
+  const edit_distance_query query("apple");
+  query.distances(candidates.data(), candidates.size(), string_view::npos,
+                  distances.data());
+  EXPECT_THAT(distances, ElementsAre(0, 1, 1, 2, 5, 5));
+}
+
+}  // namespace
+}  // namespace david
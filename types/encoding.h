@@ -0,0 +1,400 @@
+#ifndef TYPES_ENCODING
+#define TYPES_ENCODING
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include "types/cpu_dispatch.h"
+#include "types/expected.h"
+#include "types/internal/encoding_kernels.h"
+#include "types/string_arena.h"
+#include "types/string_view.h"
+
+// Base64 and hex codecs over string_view, writing into a caller's buffer or
+// a string_arena. Every function has an exact size function, so buffers
+// need no slack, and decoding is strict: it fails with
+// std::errc::invalid_argument on anything but the canonical encoding.
+//
+// Whole groups run through the kernels of types/internal/encoding_kernels.h,
+// which use AVX2 when the tier of the string_view kernels allows it, see
+// types/cpu_dispatch.h.
+namespace david {
+namespace internal {
+
+inline void base64_encode_groups(const char* in, size_t n, char* out,
+                                 bool url) {
+#if DAVID_HAS_X86_KERNELS
+  if (cpu_tier_at_least(cpu_tier::kAvx2)) {
+    return avx2::base64_encode(in, n, out, url);
+  }
+#endif
+  scalar::base64_encode(in, n, out, url);
+}
+
+inline bool base64_decode_groups(const char* in, size_t n, char* out,
+                                 bool url) {
+#if DAVID_HAS_X86_KERNELS
+  if (cpu_tier_at_least(cpu_tier::kAvx2)) {
+    return avx2::base64_decode(in, n, out, url);
+  }
+#endif
+  return scalar::base64_decode(in, n, out, url);
+}
+
+inline void hex_encode_digits(const char* in, size_t n, char* out) {
+#if DAVID_HAS_X86_KERNELS
+  if (cpu_tier_at_least(cpu_tier::kAvx2)) {
+    return avx2::hex_encode(in, n, out);
+  }
+#endif
+  scalar::hex_encode(in, n, out);
+}
+
+inline bool hex_decode_digits(const char* in, size_t n, char* out) {
+#if DAVID_HAS_X86_KERNELS
+  if (cpu_tier_at_least(cpu_tier::kAvx2)) {
+    return avx2::hex_decode(in, n, out);
+  }
+#endif
+  return scalar::hex_decode(in, n, out);
+}
+
+inline unexpected<std::errc> invalid_encoding() {
+  return unexpected<std::errc>(std::errc::invalid_argument);
+}
+
+// Encodes the last n < 3 bytes of an input, padded unless url. Returns the
+// number of chars written.
+inline size_t base64_encode_tail(const char* in, size_t n, char* out,
+                                 bool url) {
+  if (n == 0) return 0;
+  const char* const alphabet = url ? kBase64Url : kBase64Standard;
+  const uint32_t v =
+      uint32_t(static_cast<unsigned char>(in[0])) << 16 |
+      (n == 2 ? uint32_t(static_cast<unsigned char>(in[1])) << 8 : 0);
+  out[0] = alphabet[v >> 18];
+  out[1] = alphabet[(v >> 12) & 63];
+  if (n == 2) out[2] = alphabet[(v >> 6) & 63];
+  if (url) return n + 1;
+  if (n == 1) out[2] = '=';
+  out[3] = '=';
+  return 4;
+}
+
+// Decodes the last group of an input, of n <= 4 chars, padded unless url.
+// Returns the number of bytes written.
+inline expected<size_t, std::errc> base64_decode_tail(const char* in,
+                                                      size_t n, char* out,
+                                                      bool url) {
+  if (n == 0) return size_t(0);
+  if (!url) {
+    if (n != 4) return invalid_encoding();
+    n = in[3] != '=' ? 4 : in[2] != '=' ? 3 : 2;
+  }
+  if (n == 1) return invalid_encoding();
+  const decode_table& table = base64_decode_table(url);
+  uint32_t v = 0;
+  uint8_t invalid = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const uint8_t d = table[in[i]];
+    invalid |= d;
+    v = v << 6 | (d & 63);
+  }
+  // The chars hold 6 * n bits, whose last ones, past the last byte, must be
+  // zero for the encoding to be canonical.
+  const size_t bytes = n * 6 / 8;
+  const size_t extra_bits = n * 6 - bytes * 8;
+  if ((invalid & 0x80) != 0 || (v & ((1u << extra_bits) - 1)) != 0) {
+    return invalid_encoding();
+  }
+  v >>= extra_bits;
+  for (size_t i = bytes; i-- > 0; v >>= 8) out[i] = static_cast<char>(v);
+  return bytes;
+}
+
+}  // namespace internal
+
+namespace base64 {
+
+// Alphabets of RFC 4648. Standard encodings are padded with '=' to a
+// multiple of 4 chars; URL-safe ones are not padded, as in JSON Web Tokens.
+enum class alphabet {
+  kStandard,
+  kUrl,
+};
+
+// Number of chars that encode() writes for n bytes.
+inline size_t encoded_size(size_t n, alphabet a = alphabet::kStandard) {
+  if (a == alphabet::kStandard) return (n + 2) / 3 * 4;
+  return n / 3 * 4 + (n % 3 == 0 ? 0 : n % 3 + 1);
+}
+
+// Number of bytes that decode() writes for in, if in is valid, and at most
+// for any in. Only reads the padding.
+inline size_t decoded_size(string_view in, alphabet a = alphabet::kStandard) {
+  const size_t n = in.size();
+  if (a == alphabet::kUrl) return n / 4 * 3 + (n % 4 == 0 ? 0 : n % 4 - 1);
+  size_t size = n / 4 * 3;
+  if (n % 4 == 0 && n > 0) size -= (in[n - 1] == '=') + (in[n - 2] == '=');
+  return size;
+}
+
+// Encodes in into out[0, encoded_size(in.size(), a)). Returns the number of
+// chars written.
+inline size_t encode(string_view in, char* out,
+                     alphabet a = alphabet::kStandard) {
+  const bool url = a == alphabet::kUrl;
+  const size_t whole = in.size() / 3 * 3;
+  internal::base64_encode_groups(in.data(), whole, out, url);
+  return whole / 3 * 4 + internal::base64_encode_tail(in.data() + whole,
+                                                      in.size() - whole,
+                                                      out + whole / 3 * 4,
+                                                      url);
+}
+
+inline string_view encode(string_view in, string_arena& arena,
+                          alphabet a = alphabet::kStandard) {
+  const size_t size = encoded_size(in.size(), a);
+  char* const out = arena.allocate(size);
+  encode(in, out, a);
+  return string_view(out, size);
+}
+
+// Decodes in into out[0, decoded_size(in, a)). Returns the number of bytes
+// written, or std::errc::invalid_argument if a char is outside the alphabet,
+// the length or padding is wrong, or the unused bits of the last char are
+// not zero. Out holds garbage after an error.
+inline expected<size_t, std::errc> decode(string_view in, char* out,
+                                          alphabet a = alphabet::kStandard) {
+  const bool url = a == alphabet::kUrl;
+  const size_t n = in.size();
+  // Every group but the last is whole and unpadded.
+  const size_t body = n == 0 ? 0 : (n - 1) / 4 * 4;
+  if (!internal::base64_decode_groups(in.data(), body, out, url)) {
+    return internal::invalid_encoding();
+  }
+  const expected<size_t, std::errc> tail = internal::base64_decode_tail(
+      in.data() + body, n - body, out + body / 4 * 3, url);
+  if (!tail.has_value()) return tail;
+  return body / 4 * 3 + *tail;
+}
+
+// On error, the bytes taken from arena are not returned to it.
+inline expected<string_view, std::errc> decode(
+    string_view in, string_arena& arena, alphabet a = alphabet::kStandard) {
+  char* const out = arena.allocate(decoded_size(in, a));
+  const expected<size_t, std::errc> size = decode(in, out, a);
+  if (!size.has_value()) return unexpected<std::errc>(size.error());
+  return string_view(out, *size);
+}
+
+// Encodes an input that arrives in chunks, with the same result as encode()
+// on the whole input.
+class encoder {
+ public:
+  explicit encoder(alphabet a = alphabet::kStandard)
+      : url_(a == alphabet::kUrl) {}
+
+  // Most chars that update() writes for a chunk of n bytes.
+  static size_t max_update_size(size_t n) { return (n + 2) / 3 * 4; }
+
+  // Encodes the groups of 3 bytes that chunk completes into out, and returns
+  // the number of chars written. Up to 2 bytes are kept for later calls.
+  size_t update(string_view chunk, char* out) {
+    const char* p = chunk.data();
+    size_t n = chunk.size();
+    size_t written = 0;
+    if (pending_size_ > 0) {
+      const size_t take = std::min(3 - pending_size_, n);
+      std::memcpy(pending_ + pending_size_, p, take);
+      pending_size_ += take;
+      p += take;
+      n -= take;
+      if (pending_size_ < 3) return 0;
+      internal::base64_encode_groups(pending_, 3, out, url_);
+      pending_size_ = 0;
+      written = 4;
+    }
+    const size_t whole = n / 3 * 3;
+    internal::base64_encode_groups(p, whole, out + written, url_);
+    std::memcpy(pending_, p + whole, n - whole);
+    pending_size_ = n - whole;
+    return written + whole / 3 * 4;
+  }
+
+  // Number of chars that finish() writes.
+  size_t finish_size() const {
+    return encoded_size(pending_size_,
+                        url_ ? alphabet::kUrl : alphabet::kStandard);
+  }
+
+  // Encodes the bytes kept, with padding, and resets the encoder. Returns
+  // the number of chars written.
+  size_t finish(char* out) {
+    const size_t written =
+        internal::base64_encode_tail(pending_, pending_size_, out, url_);
+    pending_size_ = 0;
+    return written;
+  }
+
+ private:
+  bool url_;
+  char pending_[3];
+  size_t pending_size_ = 0;
+};
+
+// Decodes an input that arrives in chunks, with the same result as decode()
+// on the whole input. After an error, the decoder must be reset().
+class decoder {
+ public:
+  explicit decoder(alphabet a = alphabet::kStandard)
+      : url_(a == alphabet::kUrl) {}
+
+  // Most bytes that update() writes for a chunk of n chars.
+  static size_t max_update_size(size_t n) { return (n + 3) / 4 * 3; }
+
+  // Decodes the groups of 4 chars that chunk completes into out, and returns
+  // the number of bytes written. The last group seen is kept for later
+  // calls, since it may be the padded end of the input.
+  expected<size_t, std::errc> update(string_view chunk, char* out) {
+    const char* p = chunk.data();
+    size_t n = chunk.size();
+    size_t written = 0;
+    if (pending_size_ > 0) {
+      const size_t take = std::min(4 - pending_size_, n);
+      std::memcpy(pending_ + pending_size_, p, take);
+      pending_size_ += take;
+      p += take;
+      n -= take;
+      if (n == 0) return size_t(0);
+      if (!internal::base64_decode_groups(pending_, 4, out, url_)) {
+        return internal::invalid_encoding();
+      }
+      pending_size_ = 0;
+      written = 3;
+    }
+    if (n == 0) return written;
+    const size_t body = (n - 1) / 4 * 4;
+    if (!internal::base64_decode_groups(p, body, out + written, url_)) {
+      return internal::invalid_encoding();
+    }
+    std::memcpy(pending_, p + body, n - body);
+    pending_size_ = n - body;
+    return written + body / 4 * 3;
+  }
+
+  // Decodes the last group, into at most 3 bytes, and resets the decoder.
+  expected<size_t, std::errc> finish(char* out) {
+    const size_t n = pending_size_;
+    pending_size_ = 0;
+    return internal::base64_decode_tail(pending_, n, out, url_);
+  }
+
+  void reset() { pending_size_ = 0; }
+
+ private:
+  bool url_;
+  char pending_[4];
+  size_t pending_size_ = 0;
+};
+
+}  // namespace base64
+
+namespace hex {
+
+// Number of chars that encode() writes for n bytes.
+inline size_t encoded_size(size_t n) { return 2 * n; }
+
+// Number of bytes that decode() writes for in, if in is valid.
+inline size_t decoded_size(string_view in) { return in.size() / 2; }
+
+// Encodes in as lower case digits into out[0, encoded_size(in.size())).
+// Returns the number of chars written. Chunks encode independently, so
+// chunked input needs no encoder.
+inline size_t encode(string_view in, char* out) {
+  internal::hex_encode_digits(in.data(), in.size(), out);
+  return 2 * in.size();
+}
+
+inline string_view encode(string_view in, string_arena& arena) {
+  char* const out = arena.allocate(encoded_size(in.size()));
+  return string_view(out, encode(in, out));
+}
+
+// Decodes digits of either case into out[0, decoded_size(in)). Returns the
+// number of bytes written, or std::errc::invalid_argument if in has an odd
+// size or a char that is not a digit.
+inline expected<size_t, std::errc> decode(string_view in, char* out) {
+  if (in.size() % 2 != 0 ||
+      !internal::hex_decode_digits(in.data(), in.size(), out)) {
+    return internal::invalid_encoding();
+  }
+  return in.size() / 2;
+}
+
+// On error, the bytes taken from arena are not returned to it.
+inline expected<string_view, std::errc> decode(string_view in,
+                                               string_arena& arena) {
+  char* const out = arena.allocate(decoded_size(in));
+  const expected<size_t, std::errc> size = decode(in, out);
+  if (!size.has_value()) return unexpected<std::errc>(size.error());
+  return string_view(out, *size);
+}
+
+// Decodes an input that arrives in chunks, which may split a byte. After an
+// error, the decoder must be reset().
+class decoder {
+ public:
+  // Most bytes that update() writes for a chunk of n chars.
+  static size_t max_update_size(size_t n) { return (n + 1) / 2; }
+
+  // Decodes the pairs of digits that chunk completes into out, and returns
+  // the number of bytes written.
+  expected<size_t, std::errc> update(string_view chunk, char* out) {
+    const char* p = chunk.data();
+    size_t n = chunk.size();
+    size_t written = 0;
+    if (n == 0) return written;
+    if (has_pending_) {
+      const char pair[2] = {pending_, p[0]};
+      if (!internal::hex_decode_digits(pair, 2, out)) {
+        return internal::invalid_encoding();
+      }
+      has_pending_ = false;
+      ++p;
+      --n;
+      written = 1;
+    }
+    const size_t whole = n / 2 * 2;
+    if (!internal::hex_decode_digits(p, whole, out + written)) {
+      return internal::invalid_encoding();
+    }
+    if (whole < n) {
+      pending_ = p[whole];
+      has_pending_ = true;
+    }
+    return written + whole / 2;
+  }
+
+  // Checks that no digit is left over, and resets the decoder.
+  expected<size_t, std::errc> finish() {
+    const bool odd = has_pending_;
+    has_pending_ = false;
+    if (odd) return internal::invalid_encoding();
+    return size_t(0);
+  }
+
+  void reset() { has_pending_ = false; }
+
+ private:
+  char pending_ = 0;
+  bool has_pending_ = false;
+};
+
+}  // namespace hex
+}  // namespace david
+
+#endif  // TYPES_ENCODING
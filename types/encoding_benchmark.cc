@@ -0,0 +1,118 @@
+#include <random>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "types/cpu_dispatch.h"
+#include "types/encoding.h"
+
+namespace david {
+namespace {
+
+// Each benchmark takes the tier as state.range(0), and is skipped on CPUs
+// without it, and the input size as state.range(1): a token and a blob.
+bool use_tier(benchmark::State& state) {
+  const cpu_tier tier = static_cast<cpu_tier>(state.range(0));
+  if (!set_cpu_tier(tier)) {
+    state.SkipWithError("tier not supported");
+    return false;
+  }
+  state.SetLabel(cpu_tier_name(tier));
+  return true;
+}
+
+void tiers_and_sizes(benchmark::internal::Benchmark* b) {
+  for (int t = 0; t <= static_cast<int>(cpu_tier::kAvx512); ++t) {
+    b->Args({t, 32})->Args({t, 64 << 10});
+  }
+}
+
+std::string random_bytes(size_t size) {
+  std::mt19937 rng(42);
+  std::string s(size, '\0');
+  for (char& c : s) c = static_cast<char>(rng());
+  return s;
+}
+
+// Appends char by char to a std::string, as a baseline.
+std::string append_base64(string_view in) {
+  const char* const alphabet = internal::kBase64Standard;
+  std::string out;
+  size_t i = 0;
+  for (; i + 3 <= in.size(); i += 3) {
+    const uint32_t v = uint32_t(static_cast<unsigned char>(in[i])) << 16 |
+                       uint32_t(static_cast<unsigned char>(in[i + 1])) << 8 |
+                       uint32_t(static_cast<unsigned char>(in[i + 2]));
+    out += alphabet[v >> 18];
+    out += alphabet[(v >> 12) & 63];
+    out += alphabet[(v >> 6) & 63];
+    out += alphabet[v & 63];
+  }
+  char tail[4];
+  out.append(tail, internal::base64_encode_tail(in.data() + i, in.size() - i,
+                                                tail, false));
+  return out;
+}
+
+void BM_AppendBase64Encode(benchmark::State& state) {
+  const std::string in = random_bytes(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(append_base64(in));
+  }
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_AppendBase64Encode)->Arg(32)->Arg(64 << 10);
+
+void BM_Base64Encode(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string in = random_bytes(state.range(1));
+  std::string out(base64::encoded_size(in.size()), '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base64::encode(in, &out[0]));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_Base64Encode)->Apply(tiers_and_sizes);
+
+void BM_Base64Decode(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string in = random_bytes(state.range(1));
+  std::string encoded(base64::encoded_size(in.size()), '\0');
+  base64::encode(in, &encoded[0]);
+  std::string out(in.size(), '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base64::decode(encoded, &out[0]));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_Base64Decode)->Apply(tiers_and_sizes);
+
+void BM_HexEncode(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string in = random_bytes(state.range(1));
+  std::string out(hex::encoded_size(in.size()), '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hex::encode(in, &out[0]));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_HexEncode)->Apply(tiers_and_sizes);
+
+void BM_HexDecode(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const std::string in = random_bytes(state.range(1));
+  std::string encoded(hex::encoded_size(in.size()), '\0');
+  hex::encode(in, &encoded[0]);
+  std::string out(in.size(), '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hex::decode(encoded, &out[0]));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_HexDecode)->Apply(tiers_and_sizes);
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,303 @@
+#include "types/encoding.h"
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "types/cpu_dispatch.h"
+
+namespace david {
+namespace {
+
+std::vector<cpu_tier> supported_tiers() {
+  std::vector<cpu_tier> tiers;
+  for (int t = 0; t <= static_cast<int>(detected_cpu_tier()); ++t) {
+    tiers.push_back(static_cast<cpu_tier>(t));
+  }
+  return tiers;
+}
+
+class EncodingTest : public ::testing::TestWithParam<cpu_tier> {
+ protected:
+  void SetUp() override { ASSERT_TRUE(set_cpu_tier(GetParam())); }
+  void TearDown() override { set_cpu_tier(detected_cpu_tier()); }
+};
+
+std::string base64_encode(const std::string& in,
+                          base64::alphabet a = base64::alphabet::kStandard) {
+  std::string out(base64::encoded_size(in.size(), a), '\0');
+  EXPECT_EQ(base64::encode(in, &out[0], a), out.size());
+  return out;
+}
+
+// The decoded string, or "error".
+std::string base64_decode(const std::string& in,
+                          base64::alphabet a = base64::alphabet::kStandard) {
+  std::string out(base64::decoded_size(in, a), '\0');
+  const expected<size_t, std::errc> size = base64::decode(in, &out[0], a);
+  if (!size.has_value()) return "error";
+  EXPECT_EQ(*size, out.size());
+  return out;
+}
+
+std::string hex_encode(const std::string& in) {
+  std::string out(hex::encoded_size(in.size()), '\0');
+  EXPECT_EQ(hex::encode(in, &out[0]), out.size());
+  return out;
+}
+
+std::string hex_decode(const std::string& in) {
+  std::string out(hex::decoded_size(in), '\0');
+  const expected<size_t, std::errc> size = hex::decode(in, &out[0]);
+  if (!size.has_value()) return "error";
+  EXPECT_EQ(*size, out.size());
+  return out;
+}
+
+// Bit by bit, as a reference.
+std::string reference_base64(const std::string& in, base64::alphabet a) {
+  const char* const alphabet = a == base64::alphabet::kUrl
+                                   ? internal::kBase64Url
+                                   : internal::kBase64Standard;
+  std::string out;
+  size_t bits = 0;
+  uint32_t buffer = 0;
+  for (const char c : in) {
+    buffer = buffer << 8 | static_cast<unsigned char>(c);
+    bits += 8;
+    for (; bits >= 6; bits -= 6) out += alphabet[(buffer >> (bits - 6)) & 63];
+  }
+  if (bits > 0) out += alphabet[(buffer << (6 - bits)) & 63];
+  if (a == base64::alphabet::kStandard) {
+    while (out.size() % 4 != 0) out += '=';
+  }
+  return out;
+}
+
+std::string random_bytes(std::mt19937* rng, size_t size) {
+  std::string s(size, '\0');
+  for (char& c : s) c = static_cast<char>((*rng)());
+  return s;
+}
+
+TEST_P(EncodingTest, Base64Rfc4648Vectors) {
+  const char* const kVectors[][3] = {
+      {"", "", ""},
+      {"f", "Zg==", "Zg"},
+      {"fo", "Zm8=", "Zm8"},
+      {"foo", "Zm9v", "Zm9v"},
+      {"foob", "Zm9vYg==", "Zm9vYg"},
+      {"fooba", "Zm9vYmE=", "Zm9vYmE"},
+      {"foobar", "Zm9vYmFy", "Zm9vYmFy"},
+  };
+  for (const auto& v : kVectors) {
+    EXPECT_EQ(base64_encode(v[0]), v[1]);
+    EXPECT_EQ(base64_decode(v[1]), v[0]);
+    EXPECT_EQ(base64_encode(v[0], base64::alphabet::kUrl), v[2]);
+    EXPECT_EQ(base64_decode(v[2], base64::alphabet::kUrl), v[0]);
+  }
+  EXPECT_EQ(base64_encode("\xfb\xff"), "+/8=");
+  EXPECT_EQ(base64_encode("\xfb\xff", base64::alphabet::kUrl), "-_8");
+}
+
+TEST_P(EncodingTest, Base64MatchesReference) {
+  std::mt19937 rng(42);
+  for (const base64::alphabet a :
+       {base64::alphabet::kStandard, base64::alphabet::kUrl}) {
+    for (size_t size = 0; size < 300; ++size) {
+      const std::string in = random_bytes(&rng, size);
+      const std::string encoded = base64_encode(in, a);
+      ASSERT_EQ(encoded, reference_base64(in, a));
+      ASSERT_EQ(base64::decoded_size(encoded, a), size);
+      ASSERT_EQ(base64_decode(encoded, a), in);
+    }
+  }
+}
+
+TEST_P(EncodingTest, Base64RejectsCharsOutsideAlphabet) {
+  std::mt19937 rng(7);
+  // Long enough for the vector kernels.
+  const std::string valid = base64_encode(random_bytes(&rng, 96));
+  const std::string valid_url =
+      base64_encode(random_bytes(&rng, 96), base64::alphabet::kUrl);
+  for (int c = 0; c < 256; ++c) {
+    const char ch = static_cast<char>(c);
+    const bool in_standard = std::isalnum(c) || ch == '+' || ch == '/';
+    const bool in_url = std::isalnum(c) || ch == '-' || ch == '_';
+    for (size_t pos = 0; pos < valid.size(); pos += 7) {
+      std::string s = valid;
+      s[pos] = ch;
+      if (!in_standard) {
+        ASSERT_EQ(base64_decode(s), "error") << c << " " << pos;
+      }
+      std::string u = valid_url;
+      u[pos] = ch;
+      if (!in_url) {
+        ASSERT_EQ(base64_decode(u, base64::alphabet::kUrl), "error")
+            << c << " " << pos;
+      }
+    }
+  }
+}
+
+TEST_P(EncodingTest, Base64IsStrict) {
+  // Padding.
+  EXPECT_EQ(base64_decode("Zg"), "error");
+  EXPECT_EQ(base64_decode("Zg="), "error");
+  EXPECT_EQ(base64_decode("Z==="), "error");
+  EXPECT_EQ(base64_decode("Zg==Zg=="), "error");
+  EXPECT_EQ(base64_decode("Zm=v"), "error");
+  EXPECT_EQ(base64_decode("Zg==", base64::alphabet::kUrl), "error");
+  EXPECT_EQ(base64_decode("Zm9vY", base64::alphabet::kUrl), "error");
+  // Bits past the last byte.
+  EXPECT_EQ(base64_decode("Zh=="), "error");
+  EXPECT_EQ(base64_decode("Zm9="), "error");
+  EXPECT_EQ(base64_decode("Zh", base64::alphabet::kUrl), "error");
+  // Whitespace.
+  EXPECT_EQ(base64_decode("Zm9v\nYmFy"), "error");
+}
+
+TEST_P(EncodingTest, Base64Streaming) {
+  std::mt19937 rng(3);
+  for (const base64::alphabet a :
+       {base64::alphabet::kStandard, base64::alphabet::kUrl}) {
+    for (int i = 0; i < 500; ++i) {
+      const std::string in = random_bytes(&rng, rng() % 200);
+      const std::string encoded = base64_encode(in, a);
+
+      base64::encoder encoder(a);
+      base64::decoder decoder(a);
+      std::string streamed;
+      std::string decoded;
+      for (size_t pos = 0; pos < in.size();) {
+        const size_t n = std::min<size_t>(rng() % 40, in.size() - pos);
+        std::string out(base64::encoder::max_update_size(n), '\0');
+        out.resize(encoder.update(string_view(in).substr(pos, n), &out[0]));
+        streamed += out;
+        pos += n;
+      }
+      std::string out(encoder.finish_size(), '\0');
+      EXPECT_EQ(encoder.finish(&out[0]), out.size());
+      streamed += out;
+      ASSERT_EQ(streamed, encoded);
+
+      for (size_t pos = 0; pos < encoded.size();) {
+        const size_t n = std::min<size_t>(rng() % 40, encoded.size() - pos);
+        std::string bytes(base64::decoder::max_update_size(n), '\0');
+        const expected<size_t, std::errc> size =
+            decoder.update(string_view(encoded).substr(pos, n), &bytes[0]);
+        ASSERT_TRUE(size.has_value());
+        decoded.append(bytes, 0, *size);
+        pos += n;
+      }
+      char last[3];
+      const expected<size_t, std::errc> size = decoder.finish(last);
+      ASSERT_TRUE(size.has_value());
+      decoded.append(last, *size);
+      ASSERT_EQ(decoded, in);
+    }
+  }
+}
+
+TEST_P(EncodingTest, Base64StreamingRejectsPaddingBeforeEnd) {
+  base64::decoder decoder;
+  char out[8];
+  EXPECT_TRUE(decoder.update("Zg==", out).has_value());
+  EXPECT_FALSE(decoder.update("Zg==", out).has_value());
+  decoder.reset();
+  EXPECT_TRUE(decoder.update("Zm", out).has_value());
+  EXPECT_FALSE(decoder.finish(out).has_value());
+}
+
+TEST_P(EncodingTest, HexRoundTrip) {
+  EXPECT_EQ(hex_encode(""), "");
+  EXPECT_EQ(hex_encode(std::string("\x00\x01\xab\xff", 4)), "0001abff");
+  EXPECT_EQ(hex_decode("0001abFF"), std::string("\x00\x01\xab\xff", 4));
+  std::mt19937 rng(11);
+  for (size_t size = 0; size < 200; ++size) {
+    const std::string in = random_bytes(&rng, size);
+    const std::string encoded = hex_encode(in);
+    std::string reference;
+    for (const char c : in) {
+      reference += "0123456789abcdef"[static_cast<unsigned char>(c) >> 4];
+      reference += "0123456789abcdef"[c & 15];
+    }
+    ASSERT_EQ(encoded, reference);
+    ASSERT_EQ(hex_decode(encoded), in);
+  }
+}
+
+TEST_P(EncodingTest, HexRejectsNonDigits) {
+  EXPECT_EQ(hex_decode("abc"), "error");
+  const std::string valid(64, 'a');
+  for (int c = 0; c < 256; ++c) {
+    if (std::isxdigit(c)) continue;
+    for (size_t pos = 0; pos < valid.size(); pos += 5) {
+      std::string s = valid;
+      s[pos] = static_cast<char>(c);
+      ASSERT_EQ(hex_decode(s), "error") << c << " " << pos;
+    }
+  }
+}
+
+TEST_P(EncodingTest, HexStreaming) {
+  const std::string encoded = "00112233445566778899aabbccddeeff";
+  for (size_t split = 0; split <= encoded.size(); ++split) {
+    hex::decoder decoder;
+    char out[16];
+    size_t size = 0;
+    for (const string_view chunk : {string_view(encoded).substr(0, split),
+                                    string_view(encoded).substr(split)}) {
+      const expected<size_t, std::errc> n = decoder.update(chunk, out + size);
+      ASSERT_TRUE(n.has_value());
+      size += *n;
+    }
+    EXPECT_TRUE(decoder.finish().has_value());
+    EXPECT_EQ(std::string(out, size), hex_decode(encoded));
+  }
+  hex::decoder decoder;
+  char out[2];
+  EXPECT_TRUE(decoder.update("abc", out).has_value());
+  EXPECT_FALSE(decoder.finish().has_value());
+}
+
+INSTANTIATE_TEST_SUITE_P(Tiers, EncodingTest,
+                         ::testing::ValuesIn(supported_tiers()),
+                         [](const ::testing::TestParamInfo<cpu_tier>& info) {
+                           return std::string(cpu_tier_name(info.param));
+                         });
+
+TEST(Encoding, Sizes) {
+  EXPECT_EQ(base64::encoded_size(0), 0u);
+  EXPECT_EQ(base64::encoded_size(1), 4u);
+  EXPECT_EQ(base64::encoded_size(1, base64::alphabet::kUrl), 2u);
+  EXPECT_EQ(base64::encoded_size(5, base64::alphabet::kUrl), 7u);
+  EXPECT_EQ(base64::decoded_size("Zm9vYg=="), 4u);
+  EXPECT_EQ(base64::decoded_size("Zm9vYmE="), 5u);
+  EXPECT_EQ(base64::decoded_size("Zm9vYmE", base64::alphabet::kUrl), 5u);
+  EXPECT_EQ(hex::encoded_size(3), 6u);
+  EXPECT_EQ(hex::decoded_size("abcd"), 2u);
+}
+
+TEST(Encoding, IntoArena) {
+  string_arena arena;
+  const string_view encoded = base64::encode("foobar", arena);
+  EXPECT_EQ(encoded, "Zm9vYmFy");
+  const expected<string_view, std::errc> decoded =
+      base64::decode(encoded, arena);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(*decoded, "foobar");
+  EXPECT_EQ(base64::decode("Zm9v!mFy", arena).error(),
+            std::errc::invalid_argument);
+  EXPECT_EQ(hex::encode("\x12\x34", arena), "1234");
+  EXPECT_EQ(*hex::decode("1234", arena), "\x12\x34");
+  EXPECT_FALSE(hex::decode("123", arena).has_value());
+}
+
+}  // namespace
+}  // namespace david
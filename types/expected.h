@@ -0,0 +1,525 @@
+#ifndef TYPES_EXPECTED
+#define TYPES_EXPECTED
+
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "types/internal/enable_copy_move.h"
+#include "types/relocate.h"
+
+namespace david {
+
+// Wraps an error, to construct an expected that holds it.
+//
+//   expected<int, std::errc> parse(string_view s) {
+//     if (s.empty()) return unexpected<std::errc>(std::errc::invalid_argument);
+//     ...
+//   }
+template <typename E>
+class unexpected {
+ public:
+  constexpr explicit unexpected(const E& e) : error_(e) {}
+  constexpr explicit unexpected(E&& e) : error_(std::move(e)) {}
+
+  const E& error() const& noexcept { return error_; }
+  E& error() & noexcept { return error_; }
+  E&& error() && noexcept { return std::move(error_); }
+
+  friend bool operator==(const unexpected& a, const unexpected& b) {
+    return a.error_ == b.error_;
+  }
+  friend bool operator!=(const unexpected& a, const unexpected& b) {
+    return !(a == b);
+  }
+
+ private:
+  E error_;
+};
+
+template <typename E>
+unexpected<typename std::decay<E>::type> make_unexpected(E&& e) {
+  return unexpected<typename std::decay<E>::type>(std::forward<E>(e));
+}
+
+// Tag to construct the error of an expected in place.
+struct unexpect_t {
+  explicit constexpr unexpect_t(int) {}
+};
+
+static const unexpect_t unexpect{0};
+
+// Thrown by expected::value() when there is no value. Builds without
+// exceptions abort instead.
+template <typename E>
+class bad_expected_access : public std::exception {
+ public:
+  explicit bad_expected_access(E e) : error_(std::move(e)) {}
+
+  const char* what() const noexcept override { return "bad expected access"; }
+  const E& error() const noexcept { return error_; }
+
+ private:
+  E error_;
+};
+
+template <typename T, typename E>
+class expected;
+
+namespace internal {
+
+template <typename T>
+struct is_unexpected : std::false_type {};
+template <typename E>
+struct is_unexpected<unexpected<E>> : std::true_type {};
+
+template <typename T>
+struct is_expected : std::false_type {};
+template <typename T, typename E>
+struct is_expected<expected<T, E>> : std::true_type {};
+
+struct expected_value_tag {};
+struct expected_uninit_tag {};
+
+template <typename E>
+[[noreturn]] void throw_bad_expected_access(const E& e) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+  throw bad_expected_access<E>(e);
+#else
+  (void)e;
+  std::abort();
+#endif
+}
+
+// Replaces the object at *old with a New built from args. Like
+// std::expected, it keeps the old object if building the new one throws,
+// which needs New or Old to be nothrow move constructible.
+template <typename New, typename Old, typename... Args>
+void reinit_expected(New* new_val, Old* old_val, Args&&... args) {
+  if (std::is_nothrow_constructible<New, Args...>::value) {
+    old_val->~Old();
+    new (new_val) New(std::forward<Args>(args)...);
+  } else if (std::is_nothrow_move_constructible<New>::value) {
+    New tmp(std::forward<Args>(args)...);
+    old_val->~Old();
+    new (new_val) New(std::move(tmp));
+  } else {
+    Old tmp(std::move(*old_val));
+    old_val->~Old();
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+    try {
+      new (new_val) New(std::forward<Args>(args)...);
+    } catch (...) {
+      new (old_val) Old(std::move(tmp));
+      throw;
+    }
+#else
+    new (new_val) New(std::forward<Args>(args)...);
+#endif
+  }
+}
+
+// Holds either a T or an E. Destroying it is trivial when it is for both.
+template <typename T, typename E,
+          bool = std::is_trivially_destructible<T>::value &&
+                 std::is_trivially_destructible<E>::value>
+class expected_storage {
+ public:
+  template <typename... Args>
+  constexpr explicit expected_storage(expected_value_tag, Args&&... args)
+      : value_(std::forward<Args>(args)...), has_value_(true) {}
+  template <typename... Args>
+  constexpr explicit expected_storage(unexpect_t, Args&&... args)
+      : error_(std::forward<Args>(args)...), has_value_(false) {}
+  // Leaves the storage empty, for construct_from() to fill.
+  explicit expected_storage(expected_uninit_tag) {}
+
+ protected:
+  void destroy() noexcept {}
+
+  union {
+    T value_;
+    E error_;
+  };
+  bool has_value_;
+};
+
+template <typename T, typename E>
+class expected_storage<T, E, false> {
+ public:
+  template <typename... Args>
+  constexpr explicit expected_storage(expected_value_tag, Args&&... args)
+      : value_(std::forward<Args>(args)...), has_value_(true) {}
+  template <typename... Args>
+  constexpr explicit expected_storage(unexpect_t, Args&&... args)
+      : error_(std::forward<Args>(args)...), has_value_(false) {}
+  explicit expected_storage(expected_uninit_tag) {}
+  ~expected_storage() { destroy(); }
+
+ protected:
+  void destroy() noexcept {
+    if (has_value_) {
+      value_.~T();
+    } else {
+      error_.~E();
+    }
+  }
+
+  union {
+    T value_;
+    E error_;
+  };
+  bool has_value_;
+};
+
+// Copies and moves of the storage. Other is an expected_storage, as an
+// lvalue to copy or an rvalue to move.
+template <typename T, typename E>
+class expected_ops : public expected_storage<T, E> {
+ public:
+  using expected_storage<T, E>::expected_storage;
+
+ protected:
+  template <typename Other>
+  void construct_from(Other&& other) {
+    if (other.has_value_) {
+      new (&this->value_) T(std::forward<Other>(other).value_);
+    } else {
+      new (&this->error_) E(std::forward<Other>(other).error_);
+    }
+    this->has_value_ = other.has_value_;
+  }
+
+  template <typename Other>
+  void assign_from(Other&& other) {
+    if (this->has_value_ && other.has_value_) {
+      this->value_ = std::forward<Other>(other).value_;
+    } else if (!this->has_value_ && !other.has_value_) {
+      this->error_ = std::forward<Other>(other).error_;
+    } else if (other.has_value_) {
+      reinit_expected(&this->value_, &this->error_,
+                      std::forward<Other>(other).value_);
+      this->has_value_ = true;
+    } else {
+      reinit_expected(&this->error_, &this->value_,
+                      std::forward<Other>(other).error_);
+      this->has_value_ = false;
+    }
+  }
+};
+
+// As with optional_base, the copy and move members are only user-provided
+// when T or E need it, so that an expected of trivially copyable types is
+// trivially copyable itself.
+template <typename T, typename E,
+          bool /* trivial copy */ =
+              std::is_trivially_copy_constructible<T>::value &&
+              std::is_trivially_copy_assignable<T>::value &&
+              std::is_trivially_destructible<T>::value &&
+              std::is_trivially_copy_constructible<E>::value &&
+              std::is_trivially_copy_assignable<E>::value &&
+              std::is_trivially_destructible<E>::value,
+          bool /* trivial move */ =
+              std::is_trivially_move_constructible<T>::value &&
+              std::is_trivially_move_assignable<T>::value &&
+              std::is_trivially_destructible<T>::value &&
+              std::is_trivially_move_constructible<E>::value &&
+              std::is_trivially_move_assignable<E>::value &&
+              std::is_trivially_destructible<E>::value>
+class expected_base : public expected_ops<T, E> {
+ public:
+  using expected_ops<T, E>::expected_ops;
+
+  expected_base(const expected_base& other)
+      : expected_ops<T, E>(expected_uninit_tag()) {
+    this->construct_from(other);
+  }
+  expected_base(expected_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_constructible<E>::value)
+      : expected_ops<T, E>(expected_uninit_tag()) {
+    this->construct_from(std::move(other));
+  }
+  expected_base& operator=(const expected_base& other) {
+    this->assign_from(other);
+    return *this;
+  }
+  expected_base& operator=(expected_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_assignable<T>::value &&
+      std::is_nothrow_move_constructible<E>::value &&
+      std::is_nothrow_move_assignable<E>::value) {
+    this->assign_from(std::move(other));
+    return *this;
+  }
+};
+
+template <typename T, typename E>
+class expected_base<T, E, true, true> : public expected_ops<T, E> {
+ public:
+  using expected_ops<T, E>::expected_ops;
+};
+
+template <typename T, typename E>
+class expected_base<T, E, false, true> : public expected_ops<T, E> {
+ public:
+  using expected_ops<T, E>::expected_ops;
+
+  expected_base(const expected_base& other)
+      : expected_ops<T, E>(expected_uninit_tag()) {
+    this->construct_from(other);
+  }
+  expected_base(expected_base&&) = default;
+  expected_base& operator=(const expected_base& other) {
+    this->assign_from(other);
+    return *this;
+  }
+  expected_base& operator=(expected_base&&) = default;
+};
+
+template <typename T, typename E>
+class expected_base<T, E, true, false> : public expected_ops<T, E> {
+ public:
+  using expected_ops<T, E>::expected_ops;
+
+  expected_base(const expected_base&) = default;
+  expected_base(expected_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_constructible<E>::value)
+      : expected_ops<T, E>(expected_uninit_tag()) {
+    this->construct_from(std::move(other));
+  }
+  expected_base& operator=(const expected_base&) = default;
+  expected_base& operator=(expected_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_assignable<T>::value &&
+      std::is_nothrow_move_constructible<E>::value &&
+      std::is_nothrow_move_assignable<E>::value) {
+    this->assign_from(std::move(other));
+    return *this;
+  }
+};
+
+}  // namespace internal
+
+// Holds either a value or the error that kept it from being computed, for
+// code that reports errors without exceptions. Checking which one it holds
+// is a single branch, and nothing but value() throws.
+//
+//   expected<string_view, std::errc> field = line.try_substr(pos, 8);
+//   if (!field) return field.error();
+//   use(*field);
+//
+// Interface from https://en.cppreference.com/w/cpp/utility/expected, without
+// expected<void, E>. The monadic members take functions that do not return
+// void.
+template <typename T, typename E>
+class expected
+    : private internal::expected_base<T, E>,
+      private internal::enable_copy_move<
+          std::is_copy_constructible<T>::value &&
+              std::is_copy_constructible<E>::value,
+          std::is_copy_constructible<T>::value &&
+              std::is_copy_assignable<T>::value &&
+              std::is_copy_constructible<E>::value &&
+              std::is_copy_assignable<E>::value,
+          std::is_move_constructible<T>::value &&
+              std::is_move_constructible<E>::value,
+          std::is_move_constructible<T>::value &&
+              std::is_move_assignable<T>::value &&
+              std::is_move_constructible<E>::value &&
+              std::is_move_assignable<E>::value> {
+  using base = internal::expected_base<T, E>;
+
+  template <typename U, typename G>
+  friend class expected;
+
+ public:
+  using value_type = T;
+  using error_type = E;
+  using unexpected_type = unexpected<E>;
+  using trivially_relocatable = internal::trivially_relocatable_if<
+      is_trivially_relocatable<T>::value && is_trivially_relocatable<E>::value,
+      expected>;
+  template <typename U>
+  using rebind = expected<U, E>;
+
+  // Constructors. The default one value-initializes the value.
+  constexpr expected() : base(internal::expected_value_tag()) {}
+  template <typename U = T,
+            typename = typename std::enable_if<
+                std::is_constructible<T, U&&>::value &&
+                !std::is_same<typename std::decay<U>::type,
+                              expected>::value &&
+                !std::is_same<typename std::decay<U>::type,
+                              unexpect_t>::value &&
+                !internal::is_unexpected<
+                    typename std::decay<U>::type>::value>::type>
+  constexpr expected(U&& value)
+      : base(internal::expected_value_tag(), std::forward<U>(value)) {}
+  template <typename G>
+  constexpr expected(const unexpected<G>& e) : base(unexpect, e.error()) {}
+  template <typename G>
+  constexpr expected(unexpected<G>&& e)
+      : base(unexpect, std::move(e).error()) {}
+  template <typename... Args>
+  constexpr explicit expected(unexpect_t, Args&&... args)
+      : base(unexpect, std::forward<Args>(args)...) {}
+
+  // Observers.
+  constexpr bool has_value() const noexcept { return this->has_value_; }
+  constexpr explicit operator bool() const noexcept {
+    return this->has_value_;
+  }
+
+  // The value, which must be there.
+  const T& operator*() const& noexcept { return this->value_; }
+  T& operator*() & noexcept { return this->value_; }
+  T&& operator*() && noexcept { return std::move(this->value_); }
+  const T* operator->() const noexcept { return &this->value_; }
+  T* operator->() noexcept { return &this->value_; }
+
+  // The value. Throws bad_expected_access if there is none.
+  const T& value() const& {
+    if (!this->has_value_) internal::throw_bad_expected_access(this->error_);
+    return this->value_;
+  }
+  T& value() & {
+    if (!this->has_value_) internal::throw_bad_expected_access(this->error_);
+    return this->value_;
+  }
+  T&& value() && {
+    if (!this->has_value_) internal::throw_bad_expected_access(this->error_);
+    return std::move(this->value_);
+  }
+
+  // The error, which must be there.
+  const E& error() const& noexcept { return this->error_; }
+  E& error() & noexcept { return this->error_; }
+  E&& error() && noexcept { return std::move(this->error_); }
+
+  template <typename U>
+  T value_or(U&& default_value) const& {
+    return this->has_value_ ? this->value_
+                            : static_cast<T>(std::forward<U>(default_value));
+  }
+  template <typename U>
+  T value_or(U&& default_value) && {
+    return this->has_value_ ? std::move(this->value_)
+                            : static_cast<T>(std::forward<U>(default_value));
+  }
+
+  // Monadic operations.
+  // Returns f(value), which must be an expected with the same error type, or
+  // the error.
+  template <typename F>
+  auto and_then(F&& f) const& -> decltype(std::forward<F>(f)(
+      std::declval<const T&>())) {
+    using result = decltype(std::forward<F>(f)(std::declval<const T&>()));
+    static_assert(internal::is_expected<result>::value,
+                  "and_then needs a function that returns an expected");
+    if (this->has_value_) return std::forward<F>(f)(this->value_);
+    return result(unexpect, this->error_);
+  }
+  template <typename F>
+  auto and_then(F&& f) && -> decltype(std::forward<F>(f)(
+      std::declval<T&&>())) {
+    using result = decltype(std::forward<F>(f)(std::declval<T&&>()));
+    static_assert(internal::is_expected<result>::value,
+                  "and_then needs a function that returns an expected");
+    if (this->has_value_) return std::forward<F>(f)(std::move(this->value_));
+    return result(unexpect, std::move(this->error_));
+  }
+
+  // Returns an expected of f(value), or the error.
+  template <typename F>
+  auto transform(F&& f) const& -> expected<
+      typename std::decay<decltype(std::forward<F>(f)(
+          std::declval<const T&>()))>::type,
+      E> {
+    using result = expected<typename std::decay<decltype(std::forward<F>(f)(
+                                std::declval<const T&>()))>::type,
+                            E>;
+    if (this->has_value_) return result(std::forward<F>(f)(this->value_));
+    return result(unexpect, this->error_);
+  }
+  template <typename F>
+  auto transform(F&& f) && -> expected<
+      typename std::decay<decltype(std::forward<F>(f)(
+          std::declval<T&&>()))>::type,
+      E> {
+    using result = expected<typename std::decay<decltype(std::forward<F>(f)(
+                                std::declval<T&&>()))>::type,
+                            E>;
+    if (this->has_value_) {
+      return result(std::forward<F>(f)(std::move(this->value_)));
+    }
+    return result(unexpect, std::move(this->error_));
+  }
+
+  // Returns the value, or f(error), which must be an expected with the same
+  // value type.
+  template <typename F>
+  auto or_else(F&& f) const& -> decltype(std::forward<F>(f)(
+      std::declval<const E&>())) {
+    using result = decltype(std::forward<F>(f)(std::declval<const E&>()));
+    static_assert(internal::is_expected<result>::value,
+                  "or_else needs a function that returns an expected");
+    if (this->has_value_) return result(this->value_);
+    return std::forward<F>(f)(this->error_);
+  }
+  template <typename F>
+  auto or_else(F&& f) && -> decltype(std::forward<F>(f)(
+      std::declval<E&&>())) {
+    using result = decltype(std::forward<F>(f)(std::declval<E&&>()));
+    static_assert(internal::is_expected<result>::value,
+                  "or_else needs a function that returns an expected");
+    if (this->has_value_) return result(std::move(this->value_));
+    return std::forward<F>(f)(std::move(this->error_));
+  }
+
+  // Returns the value, or an expected with the error f(error).
+  template <typename F>
+  auto transform_error(F&& f) const& -> expected<
+      T, typename std::decay<decltype(std::forward<F>(f)(
+             std::declval<const E&>()))>::type> {
+    using result =
+        expected<T, typename std::decay<decltype(std::forward<F>(f)(
+                        std::declval<const E&>()))>::type>;
+    if (this->has_value_) return result(this->value_);
+    return result(unexpect, std::forward<F>(f)(this->error_));
+  }
+  template <typename F>
+  auto transform_error(F&& f) && -> expected<
+      T, typename std::decay<decltype(std::forward<F>(f)(
+             std::declval<E&&>()))>::type> {
+    using result =
+        expected<T, typename std::decay<decltype(std::forward<F>(f)(
+                        std::declval<E&&>()))>::type>;
+    if (this->has_value_) return result(std::move(this->value_));
+    return result(unexpect, std::forward<F>(f)(std::move(this->error_)));
+  }
+
+  // Comparisons. Values compare with values and errors with errors.
+  friend bool operator==(const expected& a, const expected& b) {
+    if (a.has_value_ != b.has_value_) return false;
+    return a.has_value_ ? a.value_ == b.value_ : a.error_ == b.error_;
+  }
+  friend bool operator!=(const expected& a, const expected& b) {
+    return !(a == b);
+  }
+  template <typename G>
+  friend bool operator==(const expected& a, const unexpected<G>& e) {
+    return !a.has_value_ && a.error_ == e.error();
+  }
+  template <typename G>
+  friend bool operator!=(const expected& a, const unexpected<G>& e) {
+    return !(a == e);
+  }
+};
+
+}  // namespace david
+
+#endif  // TYPES_EXPECTED
@@ -0,0 +1,158 @@
+#include "types/expected.h"
+
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "types/string_view.h"
+
+namespace david {
+namespace {
+
+using int_or_errc = expected<int, std::errc>;
+
+static_assert(std::is_trivially_copyable<int_or_errc>::value, "");
+static_assert(std::is_trivially_destructible<int_or_errc>::value, "");
+static_assert(
+    std::is_trivially_copyable<expected<string_view, std::errc>>::value, "");
+static_assert(!std::is_trivially_copyable<expected<std::string, int>>::value,
+              "");
+static_assert(std::is_copy_constructible<expected<std::string, int>>::value,
+              "");
+static_assert(
+    !std::is_copy_constructible<expected<std::unique_ptr<int>, int>>::value,
+    "");
+static_assert(
+    std::is_move_constructible<expected<std::unique_ptr<int>, int>>::value,
+    "");
+
+TEST(Expected, DefaultConstructorHoldsValue) {
+  const int_or_errc e;
+  ASSERT_TRUE(e.has_value());
+  EXPECT_EQ(*e, 0);
+}
+
+TEST(Expected, HoldsValue) {
+  const int_or_errc e = 42;
+  EXPECT_TRUE(e);
+  EXPECT_EQ(*e, 42);
+  EXPECT_EQ(e.value(), 42);
+  EXPECT_EQ(e.value_or(7), 42);
+}
+
+TEST(Expected, HoldsError) {
+  const int_or_errc e = make_unexpected(std::errc::invalid_argument);
+  EXPECT_FALSE(e);
+  EXPECT_EQ(e.error(), std::errc::invalid_argument);
+  EXPECT_EQ(e.value_or(7), 7);
+  EXPECT_TRUE(e == make_unexpected(std::errc::invalid_argument));
+}
+
+TEST(Expected, ValueThrowsWithoutValue) {
+  const int_or_errc e(unexpect, std::errc::invalid_argument);
+  try {
+    e.value();
+    FAIL() << "Expected bad_expected_access";
+  } catch (const bad_expected_access<std::errc>& ex) {
+    EXPECT_EQ(ex.error(), std::errc::invalid_argument);
+  }
+}
+
+TEST(Expected, CopiesAndAssignsNonTrivialTypes) {
+  expected<std::string, std::string> a = std::string("value");
+  expected<std::string, std::string> b(unexpect, "error");
+  expected<std::string, std::string> c = a;
+  EXPECT_EQ(*c, "value");
+
+  c = b;
+  ASSERT_FALSE(c);
+  EXPECT_EQ(c.error(), "error");
+  c = a;
+  ASSERT_TRUE(c);
+  EXPECT_EQ(*c, "value");
+  c = std::move(b);
+  ASSERT_FALSE(c);
+  EXPECT_EQ(c.error(), "error");
+  EXPECT_TRUE(a != c);
+}
+
+TEST(Expected, MovesMoveOnlyTypes) {
+  expected<std::unique_ptr<int>, int> a(std::unique_ptr<int>(new int(5)));
+  expected<std::unique_ptr<int>, int> b = std::move(a);
+  ASSERT_TRUE(b);
+  EXPECT_EQ(**b, 5);
+  std::unique_ptr<int> p = std::move(b).value();
+  EXPECT_EQ(*p, 5);
+}
+
+int_or_errc parse_digit(char c) {
+  if (c < '0' || c > '9') return make_unexpected(std::errc::invalid_argument);
+  return c - '0';
+}
+
+TEST(Expected, AndThen) {
+  const expected<char, std::errc> digit = '7';
+  EXPECT_EQ(*digit.and_then(parse_digit), 7);
+  const expected<char, std::errc> letter = 'x';
+  EXPECT_EQ(letter.and_then(parse_digit).error(), std::errc::invalid_argument);
+  const expected<char, std::errc> missing =
+      make_unexpected(std::errc::result_out_of_range);
+  EXPECT_EQ(missing.and_then(parse_digit).error(),
+            std::errc::result_out_of_range);
+}
+
+TEST(Expected, Transform) {
+  const int_or_errc e = 20;
+  const expected<std::string, std::errc> s =
+      e.transform([](int v) { return std::to_string(v + 1); });
+  EXPECT_EQ(*s, "21");
+  const int_or_errc error = make_unexpected(std::errc::invalid_argument);
+  EXPECT_FALSE(error.transform([](int v) { return v + 1; }));
+}
+
+TEST(Expected, OrElseAndTransformError) {
+  const int_or_errc error = make_unexpected(std::errc::invalid_argument);
+  EXPECT_EQ(*error.or_else([](std::errc) { return int_or_errc(-1); }), -1);
+  const int_or_errc value = 3;
+  EXPECT_EQ(*value.or_else([](std::errc) { return int_or_errc(-1); }), 3);
+
+  const expected<int, std::string> described = error.transform_error(
+      [](std::errc e) { return std::make_error_code(e).message(); });
+  EXPECT_FALSE(described.error().empty());
+}
+
+TEST(Expected, MovesThroughChains) {
+  expected<std::unique_ptr<int>, int> e(std::unique_ptr<int>(new int(2)));
+  const expected<int, int> doubled =
+      std::move(e).transform([](std::unique_ptr<int> p) { return *p * 2; });
+  EXPECT_EQ(*doubled, 4);
+}
+
+TEST(Expected, StringViewTryMembers) {
+  const string_view s = "hello world";
+  EXPECT_EQ(*s.try_at(4), 'o');
+  EXPECT_EQ(s.try_at(s.size()).error(), std::errc::result_out_of_range);
+  EXPECT_EQ(*s.try_substr(6), "world");
+  EXPECT_EQ(*s.try_substr(6, 2), "wo");
+  EXPECT_TRUE(s.try_substr(s.size())->empty());
+  EXPECT_EQ(s.try_substr(s.size() + 1).error(),
+            std::errc::result_out_of_range);
+
+  char buf[5];
+  EXPECT_EQ(*s.try_copy(buf, sizeof(buf), 6), 5);
+  EXPECT_EQ(string_view(buf, 5), "world");
+  EXPECT_FALSE(s.try_copy(buf, sizeof(buf), 12));
+
+  static_assert(noexcept(s.try_substr(1)), "");
+  const expected<int, std::errc> digit =
+      s.try_substr(6).and_then([](string_view w) { return w.try_at(0); })
+          .transform([](char c) { return static_cast<int>(c); });
+  EXPECT_EQ(*digit, 'w');
+}
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,213 @@
+#ifndef TYPES_FIXED_STRING
+#define TYPES_FIXED_STRING
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "types/internal/config.h"
+#include "types/string_view.h"
+
+namespace david {
+
+// A string of at most N chars stored inside the object, for short keys such
+// as ticker symbols or country codes. It is trivially copyable, converts to
+// string_view for free and, from C++20 on, can be a non-type template
+// parameter:
+//   template <fixed_string Name> struct counter { ... };
+//   counter<"requests"> c;
+//
+// The chars are followed by zeros up to a multiple of 8 bytes, so comparisons
+// and hashing work on whole 64-bit words and never follow a pointer.
+template <size_t N>
+class fixed_string {
+  static_assert(N > 0, "fixed_string needs room for at least one char");
+
+ public:
+  using traits_type = std::char_traits<char>;
+  using value_type = char;
+  using size_type = size_t;
+  using const_pointer = const char*;
+  using const_reference = const char&;
+  using const_iterator = const char*;
+  using iterator = const_iterator;
+
+  // Room for N chars plus a terminator, rounded up to whole words.
+  static constexpr size_type kStorageSize = (N + 1 + 7) / 8 * 8;
+  // The smallest unsigned type that holds N.
+  using length_type = typename std::conditional<
+      (N <= 0xff), uint8_t,
+      typename std::conditional<(N <= 0xffff), uint16_t,
+                                uint32_t>::type>::type;
+
+  // Construction.
+  constexpr fixed_string() noexcept : chars_(), size_(0) {}
+  // From a string literal. The literal must fit, which is checked at compile
+  // time.
+  template <size_t M, typename = typename std::enable_if<(M <= N + 1)>::type>
+  DAVID_CONSTEXPR14 fixed_string(const char (&str)[M]) noexcept
+      : chars_(), size_(M - 1) {
+    for (size_type i = 0; i + 1 < M; ++i) chars_[i] = str[i];
+  }
+  // Throws std::length_error if s has more than N chars.
+  explicit DAVID_CONSTEXPR14 fixed_string(string_view s) : chars_(), size_(0) {
+    if (s.size() > N) {
+      throw std::length_error("string_view does not fit in fixed_string");
+    }
+    size_ = static_cast<length_type>(s.size());
+    for (size_type i = 0; i < s.size(); ++i) chars_[i] = s[i];
+  }
+
+  // Iterator support.
+  constexpr const_iterator begin() const noexcept { return chars_; }
+  constexpr const_iterator cbegin() const noexcept { return begin(); }
+  constexpr const_iterator end() const noexcept { return chars_ + size_; }
+  constexpr const_iterator cend() const noexcept { return end(); }
+
+  // Element access.
+  constexpr const_reference operator[](size_type pos) const {
+    return chars_[pos];
+  }
+  constexpr const_reference front() const { return chars_[0]; }
+  constexpr const_reference back() const { return chars_[size_ - 1]; }
+  constexpr const_pointer data() const noexcept { return chars_; }
+  constexpr const_pointer c_str() const noexcept { return chars_; }
+
+  constexpr operator string_view() const noexcept {
+    return string_view(chars_, size_);
+  }
+  constexpr string_view view() const noexcept {
+    return string_view(chars_, size_);
+  }
+
+  // Capacity.
+  constexpr size_type size() const noexcept { return size_; }
+  constexpr size_type length() const noexcept { return size_; }
+  static constexpr size_type capacity() noexcept { return N; }
+  constexpr bool empty() const noexcept { return size_ == 0; }
+
+  // Three-way comparison of the zero-padded chars as big-endian words, which
+  // orders like comparing the views byte by byte.
+  int compare(const fixed_string& other) const noexcept {
+    for (size_type i = 0; i < kStorageSize; i += 8) {
+      const uint64_t a = load_big_endian(chars_ + i);
+      const uint64_t b = load_big_endian(other.chars_ + i);
+      if (a != b) return a < b ? -1 : 1;
+    }
+    // Equal padded chars: the strings only differ in trailing '\0's.
+    if (size_ == other.size_) return 0;
+    return size_ < other.size_ ? -1 : 1;
+  }
+  int compare(string_view s) const noexcept { return view().compare(s); }
+
+  friend inline bool operator==(const fixed_string& a,
+                                const fixed_string& b) noexcept {
+    if (a.size_ != b.size_) return false;
+    for (size_type i = 0; i < kStorageSize; i += 8) {
+      if (load(a.chars_ + i) != load(b.chars_ + i)) return false;
+    }
+    return true;
+  }
+  friend inline bool operator!=(const fixed_string& a,
+                                const fixed_string& b) noexcept {
+    return !(a == b);
+  }
+  friend inline bool operator<(const fixed_string& a,
+                               const fixed_string& b) noexcept {
+    return a.compare(b) < 0;
+  }
+  friend inline bool operator>(const fixed_string& a,
+                               const fixed_string& b) noexcept {
+    return a.compare(b) > 0;
+  }
+  friend inline bool operator<=(const fixed_string& a,
+                                const fixed_string& b) noexcept {
+    return a.compare(b) <= 0;
+  }
+  friend inline bool operator>=(const fixed_string& a,
+                                const fixed_string& b) noexcept {
+    return a.compare(b) >= 0;
+  }
+
+  // Overloads for views and C strings. The const_pointer ones avoid
+  // ambiguities between converting a literal to a view and to a fixed_string.
+  friend inline bool operator==(const fixed_string& a, string_view b) noexcept {
+    return a.view() == b;
+  }
+  friend inline bool operator==(string_view a, const fixed_string& b) noexcept {
+    return a == b.view();
+  }
+  friend inline bool operator==(const fixed_string& a,
+                                const_pointer b) noexcept {
+    return a.view() == string_view(b);
+  }
+  friend inline bool operator==(const_pointer a,
+                                const fixed_string& b) noexcept {
+    return string_view(a) == b.view();
+  }
+  friend inline bool operator!=(const fixed_string& a, string_view b) noexcept {
+    return a.view() != b;
+  }
+  friend inline bool operator!=(string_view a, const fixed_string& b) noexcept {
+    return a != b.view();
+  }
+  friend inline bool operator!=(const fixed_string& a,
+                                const_pointer b) noexcept {
+    return a.view() != string_view(b);
+  }
+  friend inline bool operator!=(const_pointer a,
+                                const fixed_string& b) noexcept {
+    return string_view(a) != b.view();
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const fixed_string& s) {
+    return os << s.view();
+  }
+
+  // Public only so that fixed_string is a structural type, which C++20
+  // requires for non-type template parameters. Use the accessors instead.
+  char chars_[kStorageSize];
+  length_type size_;
+
+ private:
+  static uint64_t load(const char* p) noexcept {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+  }
+  static uint64_t load_big_endian(const char* p) noexcept {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap64(load(p));
+#else
+    return load(p);
+#endif
+  }
+};
+
+template <size_t N>
+constexpr typename fixed_string<N>::size_type fixed_string<N>::kStorageSize;
+
+#if __cplusplus >= 201703L
+// Lets fixed_string deduce its capacity from a literal, as in
+// fixed_string s = "USD"; or template <fixed_string S>.
+template <size_t M>
+fixed_string(const char (&)[M]) -> fixed_string<M - 1>;
+#endif
+
+}  // namespace david
+
+namespace std {
+template <size_t N>
+struct hash<david::fixed_string<N>> {
+  // Same value as hashing the view, computed over the inline chars.
+  size_t operator()(const david::fixed_string<N>& s) const {
+    return hash<david::string_view>()(s.view());
+  }
+};
+}  // namespace std
+
+#endif  // TYPES_FIXED_STRING
@@ -0,0 +1,133 @@
+#include "types/fixed_string.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+using ::testing::StrEq;
+
+TEST(FixedString, Layout) {
+  EXPECT_TRUE(std::is_trivially_copyable<fixed_string<8>>::value);
+  EXPECT_EQ(sizeof(fixed_string<7>), 9);
+  EXPECT_EQ(sizeof(fixed_string<15>), 17);
+  EXPECT_EQ(fixed_string<8>::capacity(), 8);
+}
+
+TEST(FixedString, DefaultConstructor) {
+  const fixed_string<4> s;
+  EXPECT_THAT(s, IsEmpty());
+  EXPECT_THAT(s.c_str(), StrEq(""));
+}
+
+TEST(FixedString, LiteralConstructor) {
+  const fixed_string<8> s = "USD";
+  EXPECT_THAT(s, SizeIs(3));
+  EXPECT_THAT(s.c_str(), StrEq("USD"));
+  EXPECT_EQ(s.front(), 'U');
+  EXPECT_EQ(s.back(), 'D');
+  EXPECT_EQ(std::string(s.begin(), s.end()), "USD");
+}
+
+TEST(FixedString, ViewConstructor) {
+  const fixed_string<4> s(string_view("ab\0c", 4));
+  EXPECT_THAT(s, SizeIs(4));
+  EXPECT_EQ(s.view(), string_view("ab\0c", 4));
+  EXPECT_THROW(fixed_string<4>(string_view("hello")), std::length_error);
+}
+
+TEST(FixedString, ConvertsToView) {
+  const fixed_string<16> s = "GOOGL";
+  const string_view v = s;
+  EXPECT_EQ(v.data(), s.data());
+  EXPECT_EQ(v, "GOOGL");
+}
+
+TEST(FixedString, Equality) {
+  const fixed_string<8> a = "abc";
+  const fixed_string<8> b = "abc";
+  const fixed_string<8> c = "abd";
+  EXPECT_TRUE(a == b);
+  EXPECT_TRUE(a != c);
+  EXPECT_TRUE(a == "abc");
+  EXPECT_TRUE("abc" == a);
+  EXPECT_TRUE(a == string_view("abc"));
+  EXPECT_TRUE(a != "ab");
+  // Trailing nulls are part of the string.
+  EXPECT_TRUE(a != fixed_string<8>(string_view("abc\0", 4)));
+}
+
+TEST(FixedString, OrderingMatchesViews) {
+  const std::vector<std::string> words = {
+      "",         "a",        "ab",       std::string("ab\0", 3),
+      "ab\x01",   "abc",      "b",        "ba",
+      "\xff",     "abcdefgh", "abcdefg",  "abcdefghijklmno",
+      "abcdefghi", "zzzzzzzzzzzzzz"};
+  for (const std::string& x : words) {
+    for (const std::string& y : words) {
+      const fixed_string<15> a((string_view(x)));
+      const fixed_string<15> b((string_view(y)));
+      const int expected = string_view(x).compare(string_view(y));
+      ASSERT_EQ(a.compare(b) < 0, expected < 0) << x << " vs " << y;
+      ASSERT_EQ(a.compare(b) == 0, expected == 0) << x << " vs " << y;
+      ASSERT_EQ(a < b, expected < 0);
+      ASSERT_EQ(a == b, expected == 0);
+      ASSERT_EQ(a >= b, expected >= 0);
+    }
+  }
+}
+
+TEST(FixedString, Sort) {
+  std::vector<fixed_string<4>> codes = {"USD", "EUR", "JPY", "CHF", "GBP"};
+  std::sort(codes.begin(), codes.end());
+  EXPECT_THAT(codes, ElementsAre("CHF", "EUR", "GBP", "JPY", "USD"));
+}
+
+TEST(FixedString, Hash) {
+  const fixed_string<8> s = "abc";
+  EXPECT_EQ(std::hash<fixed_string<8>>()(s), std::hash<string_view>()("abc"));
+  std::unordered_set<fixed_string<8>> set = {"USD", "EUR"};
+  EXPECT_EQ(set.count("USD"), 1);
+  EXPECT_EQ(set.count("JPY"), 0);
+}
+
+TEST(FixedString, Stream) {
+  std::ostringstream os;
+  os << fixed_string<8>("abc");
+  EXPECT_EQ(os.str(), "abc");
+}
+
+#if __cplusplus >= 201402L
+TEST(FixedString, Constexpr) {
+  constexpr fixed_string<8> s = "abc";
+  static_assert(s.size() == 3, "");
+  static_assert(s[1] == 'b', "");
+}
+#endif
+
+#if DAVID_HAS_CLASS_NTTP
+template <fixed_string Name>
+struct named {
+  static constexpr string_view name() { return Name; }
+};
+
+TEST(FixedString, NonTypeTemplateParameter) {
+  EXPECT_EQ(named<"requests">::name(), "requests");
+  static_assert(std::is_same_v<named<"a">, named<"a">>);
+  static_assert(!std::is_same_v<named<"a">, named<"b">>);
+}
+#endif
+
+}  // namespace
+}  // namespace david
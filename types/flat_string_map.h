@@ -0,0 +1,564 @@
+#ifndef TYPES_FLAT_STRING_MAP
+#define TYPES_FLAT_STRING_MAP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "types/string_arena.h"
+#include "types/string_view.h"
+
+namespace david {
+namespace internal {
+
+// Control bytes of a flat_string_map. Each slot has one: either kEmpty,
+// kDeleted or, for a full slot, 7 bits of the hash of its key.
+using ctrl_t = int8_t;
+static const ctrl_t kCtrlEmpty = -128;
+static const ctrl_t kCtrlDeleted = -2;
+
+// A group of 16 control bytes, matched against a byte all at once. Each
+// match is a bitmask with bit i set when byte i matches.
+class ctrl_group {
+ public:
+  static const size_t kWidth = 16;
+
+#ifdef __SSE2__
+  explicit ctrl_group(const ctrl_t* ctrl)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+  uint32_t match(ctrl_t h2) const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+  }
+  uint32_t match_empty() const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(kCtrlEmpty), ctrl_)));
+  }
+  // Empty and deleted bytes are the negative ones.
+  uint32_t match_empty_or_deleted() const {
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+  }
+
+ private:
+  __m128i ctrl_;
+#else
+  explicit ctrl_group(const ctrl_t* ctrl) { std::memcpy(ctrl_, ctrl, kWidth); }
+
+  uint32_t match(ctrl_t h2) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kWidth; ++i) mask |= uint32_t(ctrl_[i] == h2) << i;
+    return mask;
+  }
+  uint32_t match_empty() const { return match(kCtrlEmpty); }
+  uint32_t match_empty_or_deleted() const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kWidth; ++i) mask |= uint32_t(ctrl_[i] < 0) << i;
+    return mask;
+  }
+
+ private:
+  ctrl_t ctrl_[kWidth];
+#endif
+};
+
+// Control bytes of a map with no slots, so that lookups in it need no special
+// case.
+template <typename T = void>
+struct empty_ctrl_group {
+  static const ctrl_t kCtrl[ctrl_group::kWidth];
+};
+
+template <typename T>
+const ctrl_t empty_ctrl_group<T>::kCtrl[ctrl_group::kWidth] = {
+    kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty,
+    kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty,
+    kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty};
+
+}  // namespace internal
+
+// An open-addressing hash map from strings to V, laid out like a Swiss table.
+//
+// Slots are split into groups of 16 with one control byte each, holding 7
+// bits of the key's hash. A lookup compares a whole group of control bytes
+// with one SIMD compare, and only the few slots that match are looked at.
+// Each slot stores, next to the key's pointer, its length and another 32 bits
+// of its hash, so that nearly every mismatch is rejected without reading the
+// key's chars. A lookup that finds its key usually costs one memcmp.
+//
+// Keys are not copied by default: like a string_view, the chars of every key
+// must outlive the map. A map built with a string_arena copies the chars of
+// each new key into the arena instead. Copies of a map share its arena.
+//
+// Lookups take a string_view, so they accept std::string and C strings
+// without building a key. Inserting and erasing invalidate iterators and
+// references to values.
+template <class V>
+class flat_string_map {
+  struct slot {
+    const char* data;
+    uint32_t size;
+    uint32_t tag;
+    V value;
+  };
+
+  template <bool kConst>
+  class iterator_impl {
+    using slot_type = typename std::conditional<kConst, const slot, slot>::type;
+    using value_ref = typename std::conditional<kConst, const V&, V&>::type;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<string_view, V>;
+    using difference_type = std::ptrdiff_t;
+    // Entries are built on the fly from the slot, so references are
+    // (key, value reference) pairs rather than references to a pair.
+    using reference = std::pair<string_view, value_ref>;
+    struct pointer {
+      reference ref;
+      const reference* operator->() const { return &ref; }
+    };
+
+    iterator_impl() noexcept : ctrl_(nullptr), slot_(nullptr), end_(nullptr) {}
+    // iterator converts to const_iterator.
+    template <bool kOtherConst,
+              typename = typename std::enable_if<kConst && !kOtherConst>::type>
+    iterator_impl(const iterator_impl<kOtherConst>& other) noexcept
+        : ctrl_(other.ctrl_), slot_(other.slot_), end_(other.end_) {}
+
+    string_view key() const { return string_view(slot_->data, slot_->size); }
+    value_ref value() const { return slot_->value; }
+    reference operator*() const { return reference(key(), slot_->value); }
+    pointer operator->() const { return pointer{**this}; }
+
+    iterator_impl& operator++() {
+      ++ctrl_;
+      ++slot_;
+      skip_free_slots();
+      return *this;
+    }
+    iterator_impl operator++(int) {
+      iterator_impl old = *this;
+      ++*this;
+      return old;
+    }
+
+    friend bool operator==(const iterator_impl& a, const iterator_impl& b) {
+      return a.ctrl_ == b.ctrl_;
+    }
+    friend bool operator!=(const iterator_impl& a, const iterator_impl& b) {
+      return a.ctrl_ != b.ctrl_;
+    }
+
+   private:
+    friend class flat_string_map;
+    template <bool>
+    friend class iterator_impl;
+
+    iterator_impl(const internal::ctrl_t* ctrl, slot_type* s,
+                  const internal::ctrl_t* end) noexcept
+        : ctrl_(ctrl), slot_(s), end_(end) {}
+
+    void skip_free_slots() {
+      while (ctrl_ != end_ && *ctrl_ < 0) {
+        ++ctrl_;
+        ++slot_;
+      }
+    }
+
+    const internal::ctrl_t* ctrl_;
+    slot_type* slot_;
+    const internal::ctrl_t* end_;
+  };
+
+ public:
+  using key_type = string_view;
+  using mapped_type = V;
+  using size_type = size_t;
+  using iterator = iterator_impl<false>;
+  using const_iterator = iterator_impl<true>;
+
+  // Construction. A map without an arena does not own its keys.
+  flat_string_map() noexcept : flat_string_map(nullptr) {}
+  explicit flat_string_map(string_arena* arena) noexcept
+      : ctrl_(empty_ctrl()),
+        slots_(nullptr),
+        capacity_(0),
+        size_(0),
+        growth_left_(0),
+        arena_(arena) {}
+
+  flat_string_map(const flat_string_map& other)
+      : flat_string_map(other.arena_) {
+    reserve(other.size_);
+    for (size_t i = 0; i < other.capacity_; ++i) {
+      if (other.ctrl_[i] >= 0) {
+        const slot& s = other.slots_[i];
+        const size_t pos = find_free_slot(s.tag);
+        new (&slots_[pos].value) V(s.value);
+        set_slot(pos, other.ctrl_[i], s.data, s.size, s.tag);
+      }
+    }
+  }
+  flat_string_map(flat_string_map&& other) noexcept
+      : ctrl_(other.ctrl_),
+        slots_(other.slots_),
+        capacity_(other.capacity_),
+        size_(other.size_),
+        growth_left_(other.growth_left_),
+        arena_(other.arena_) {
+    other.release();
+  }
+  flat_string_map& operator=(const flat_string_map& other) {
+    if (this != &other) *this = flat_string_map(other);
+    return *this;
+  }
+  flat_string_map& operator=(flat_string_map&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      ctrl_ = other.ctrl_;
+      slots_ = other.slots_;
+      capacity_ = other.capacity_;
+      size_ = other.size_;
+      growth_left_ = other.growth_left_;
+      arena_ = other.arena_;
+      other.release();
+    }
+    return *this;
+  }
+
+  ~flat_string_map() { destroy(); }
+
+  // Iterator support.
+  iterator begin() noexcept {
+    iterator it(ctrl_, slots_, ctrl_ + capacity_);
+    it.skip_free_slots();
+    return it;
+  }
+  const_iterator begin() const noexcept {
+    const_iterator it(ctrl_, slots_, ctrl_ + capacity_);
+    it.skip_free_slots();
+    return it;
+  }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept {
+    const internal::ctrl_t* end = ctrl_ + capacity_;
+    return iterator(end, slots_ + capacity_, end);
+  }
+  const_iterator end() const noexcept {
+    const internal::ctrl_t* end = ctrl_ + capacity_;
+    return const_iterator(end, slots_ + capacity_, end);
+  }
+  const_iterator cend() const noexcept { return end(); }
+
+  // Capacity.
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  size_type capacity() const noexcept { return capacity_; }
+  string_arena* arena() const noexcept { return arena_; }
+
+  // Makes room for n keys without rehashing.
+  void reserve(size_type n) {
+    size_t capacity = internal::ctrl_group::kWidth;
+    while (max_load(capacity) < n) capacity *= 2;
+    if (capacity > capacity_) resize(capacity);
+  }
+
+  // Lookup.
+  iterator find(string_view key) {
+    const size_t pos = find_slot(key);
+    if (pos == kNotFound) return end();
+    return iterator(ctrl_ + pos, slots_ + pos, ctrl_ + capacity_);
+  }
+  const_iterator find(string_view key) const {
+    const size_t pos = find_slot(key);
+    if (pos == kNotFound) return end();
+    return const_iterator(ctrl_ + pos, slots_ + pos, ctrl_ + capacity_);
+  }
+  bool contains(string_view key) const { return find_slot(key) != kNotFound; }
+  size_type count(string_view key) const { return contains(key) ? 1 : 0; }
+
+  // Throws std::out_of_range if key is not in the map.
+  V& at(string_view key) {
+    const size_t pos = find_slot(key);
+    if (pos == kNotFound) throw std::out_of_range("key not found");
+    return slots_[pos].value;
+  }
+  const V& at(string_view key) const {
+    const size_t pos = find_slot(key);
+    if (pos == kNotFound) throw std::out_of_range("key not found");
+    return slots_[pos].value;
+  }
+
+  // Modifiers. Keys of 4 GiB or more throw std::length_error.
+
+  // Inserts key with a value built from args, unless key is already in the
+  // map. Returns the key's entry and whether it was inserted.
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(string_view key, Args&&... args) {
+    if (key.size() > 0xffffffffu) {
+      throw std::length_error("key does not fit flat_string_map");
+    }
+    const uint64_t hash = hash_of(key);
+    const internal::ctrl_t h2 = h2_of(hash);
+    const uint32_t tag = tag_of(hash);
+    size_t pos = find_slot(key, h2, tag);
+    if (pos != kNotFound) {
+      return std::make_pair(
+          iterator(ctrl_ + pos, slots_ + pos, ctrl_ + capacity_), false);
+    }
+
+    if (growth_left_ == 0) grow();
+    pos = find_free_slot(tag);
+    new (&slots_[pos].value) V(std::forward<Args>(args)...);
+    if (arena_ != nullptr && !key.empty()) {
+      try {
+        key = arena_->copy(key);
+      } catch (...) {
+        slots_[pos].value.~V();
+        throw;
+      }
+    }
+    set_slot(pos, h2, key.data(), static_cast<uint32_t>(key.size()), tag);
+    return std::make_pair(
+        iterator(ctrl_ + pos, slots_ + pos, ctrl_ + capacity_), true);
+  }
+  std::pair<iterator, bool> insert(string_view key, const V& value) {
+    return try_emplace(key, value);
+  }
+  std::pair<iterator, bool> insert(string_view key, V&& value) {
+    return try_emplace(key, std::move(value));
+  }
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(string_view key, M&& value) {
+    std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(value));
+    if (!result.second) result.first.value() = std::forward<M>(value);
+    return result;
+  }
+  V& operator[](string_view key) { return try_emplace(key).first.value(); }
+
+  // Removes key from the map, and returns how many keys were removed. The
+  // chars of the key stay in the arena, if any.
+  size_type erase(string_view key) {
+    const size_t pos = find_slot(key);
+    if (pos == kNotFound) return 0;
+    erase_slot(pos);
+    return 1;
+  }
+  void erase(const_iterator it) { erase_slot(it.ctrl_ - ctrl_); }
+
+  // Removes every key and keeps the capacity.
+  void clear() noexcept {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) slots_[i].value.~V();
+    }
+    if (capacity_ > 0) {
+      std::memset(ctrl_, static_cast<unsigned char>(internal::kCtrlEmpty),
+                  capacity_);
+    }
+    size_ = 0;
+    growth_left_ = max_load(capacity_);
+  }
+
+  void swap(flat_string_map& other) noexcept {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(arena_, other.arena_);
+  }
+
+ private:
+  static const size_t kNotFound = ~size_t(0);
+
+  static internal::ctrl_t* empty_ctrl() noexcept {
+    // Never written to: a map with no slots has no room to insert into.
+    return const_cast<internal::ctrl_t*>(
+        internal::empty_ctrl_group<>::kCtrl);
+  }
+
+  // The table holds at most 7/8 of its capacity.
+  static size_t max_load(size_t capacity) noexcept {
+    return capacity - capacity / 8;
+  }
+
+  // Hashes are split three ways: 7 low bits go to the control byte, the top
+  // 32 bits are the slot's tag and pick the key's first group. Rehashing
+  // needs only the control byte and the tag, not the key's chars.
+  static uint64_t hash_of(string_view key) noexcept {
+    uint64_t x = std::hash<string_view>()(key);
+    // Finalizer from MurmurHash3, which spreads 32-bit hashes over 64 bits.
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+  }
+  static internal::ctrl_t h2_of(uint64_t hash) noexcept {
+    return static_cast<internal::ctrl_t>(hash & 0x7f);
+  }
+  static uint32_t tag_of(uint64_t hash) noexcept {
+    return static_cast<uint32_t>(hash >> 32);
+  }
+
+  // Groups are probed quadratically: first, first + 1, first + 3, ... which
+  // visits every group since their number is a power of two.
+  size_t num_groups() const noexcept {
+    return capacity_ == 0 ? 1 : capacity_ / internal::ctrl_group::kWidth;
+  }
+
+  size_t find_slot(string_view key) const {
+    const uint64_t hash = hash_of(key);
+    return find_slot(key, h2_of(hash), tag_of(hash));
+  }
+  size_t find_slot(string_view key, internal::ctrl_t h2, uint32_t tag) const {
+    const size_t mask = num_groups() - 1;
+    size_t group = tag & mask;
+    for (size_t step = 1;; ++step) {
+      const size_t first = group * internal::ctrl_group::kWidth;
+      const internal::ctrl_group g(ctrl_ + first);
+      for (uint32_t match = g.match(h2); match != 0; match &= match - 1) {
+        const size_t pos = first + __builtin_ctz(match);
+        const slot& s = slots_[pos];
+        if (s.tag == tag && s.size == key.size() &&
+            (key.empty() ||
+             std::memcmp(s.data, key.data(), key.size()) == 0)) {
+          return pos;
+        }
+      }
+      if (g.match_empty() != 0) return kNotFound;
+      group = (group + step) & mask;
+    }
+  }
+
+  // First empty or deleted slot on the probe sequence of tag. The table must
+  // have one.
+  size_t find_free_slot(uint32_t tag) const noexcept {
+    const size_t mask = num_groups() - 1;
+    size_t group = tag & mask;
+    for (size_t step = 1;; ++step) {
+      const size_t first = group * internal::ctrl_group::kWidth;
+      const uint32_t free =
+          internal::ctrl_group(ctrl_ + first).match_empty_or_deleted();
+      if (free != 0) return first + __builtin_ctz(free);
+      group = (group + step) & mask;
+    }
+  }
+
+  // Fills the slot at pos, whose value is already constructed.
+  void set_slot(size_t pos, internal::ctrl_t h2, const char* data,
+                uint32_t size, uint32_t tag) noexcept {
+    if (ctrl_[pos] == internal::kCtrlEmpty) --growth_left_;
+    ctrl_[pos] = h2;
+    slots_[pos].data = data;
+    slots_[pos].size = size;
+    slots_[pos].tag = tag;
+    ++size_;
+  }
+
+  void erase_slot(size_t pos) {
+    slots_[pos].value.~V();
+    --size_;
+    // Probes stop at a group with an empty slot. If this group has one
+    // already, no probe goes past it, and the slot can be empty too.
+    // Otherwise some keys may have been placed beyond the group, and the
+    // slot becomes a tombstone that probes walk over.
+    const size_t first = pos / internal::ctrl_group::kWidth *
+                         internal::ctrl_group::kWidth;
+    if (internal::ctrl_group(ctrl_ + first).match_empty() != 0) {
+      ctrl_[pos] = internal::kCtrlEmpty;
+      ++growth_left_;
+    } else {
+      ctrl_[pos] = internal::kCtrlDeleted;
+    }
+  }
+
+  // Makes room for one more key: drops tombstones when they take up a good
+  // part of the table, and doubles the capacity otherwise.
+  void grow() {
+    if (capacity_ == 0) {
+      resize(internal::ctrl_group::kWidth);
+    } else if (size_ <= max_load(capacity_) / 2) {
+      resize(capacity_);
+    } else {
+      resize(capacity_ * 2);
+    }
+  }
+
+  void resize(size_t new_capacity) {
+    std::unique_ptr<internal::ctrl_t[]> new_ctrl(
+        new internal::ctrl_t[new_capacity]);
+    std::memset(new_ctrl.get(),
+                static_cast<unsigned char>(internal::kCtrlEmpty), new_capacity);
+    slot* new_slots = std::allocator<slot>().allocate(new_capacity);
+
+    internal::ctrl_t* old_ctrl = ctrl_;
+    slot* old_slots = slots_;
+    const size_t old_capacity = capacity_;
+    ctrl_ = new_ctrl.release();
+    slots_ = new_slots;
+    capacity_ = new_capacity;
+    size_ = 0;
+    growth_left_ = max_load(new_capacity);
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] < 0) continue;
+      slot& s = old_slots[i];
+      const size_t pos = find_free_slot(s.tag);
+      new (&slots_[pos].value) V(std::move(s.value));
+      s.value.~V();
+      set_slot(pos, old_ctrl[i], s.data, s.size, s.tag);
+    }
+    if (old_capacity > 0) {
+      delete[] old_ctrl;
+      std::allocator<slot>().deallocate(old_slots, old_capacity);
+    }
+  }
+
+  void destroy() noexcept {
+    if (capacity_ == 0) return;
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) slots_[i].value.~V();
+    }
+    delete[] ctrl_;
+    std::allocator<slot>().deallocate(slots_, capacity_);
+  }
+
+  // Leaves the map empty without freeing anything.
+  void release() noexcept {
+    ctrl_ = empty_ctrl();
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    growth_left_ = 0;
+  }
+
+  internal::ctrl_t* ctrl_;
+  slot* slots_;
+  size_t capacity_;
+  size_t size_;
+  // Empty slots that can be filled before the table exceeds its maximum load.
+  size_t growth_left_;
+  string_arena* arena_;
+};
+
+template <class V>
+void swap(flat_string_map<V>& a, flat_string_map<V>& b) noexcept {
+  a.swap(b);
+}
+
+}  // namespace david
+
+#endif  // TYPES_FLAT_STRING_MAP
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/flat_string_map.h"
+
+namespace david {
+namespace {
+
+// Identifier-like keys of 8 to 40 chars, many sharing a prefix.
+std::vector<std::string> make_keys(size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  const char* prefixes[] = {"user_", "session_", "order_item_", ""};
+  std::vector<std::string> keys(n);
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = prefixes[rng() % 4];
+    const size_t size = 8 + rng() % 32;
+    while (keys[i].size() < size) {
+      keys[i].push_back(static_cast<char>('a' + rng() % 26));
+    }
+  }
+  return keys;
+}
+
+template <class Map>
+void insert(Map& map, const std::string& key, int value) {
+  map.insert({key, value});
+}
+void insert(flat_string_map<int>& map, const std::string& key, int value) {
+  map.insert(key, value);
+}
+
+template <class Map>
+void BM_Insert(benchmark::State& state) {
+  const std::vector<std::string> keys = make_keys(state.range(0), 1);
+  for (auto _ : state) {
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i) insert(map, keys[i], i);
+    benchmark::DoNotOptimize(map);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_TEMPLATE(BM_Insert, std::unordered_map<std::string, int>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Insert, std::unordered_map<string_view, int>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Insert, flat_string_map<int>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+
+// Looks up keys that are in the map, or similar keys that are not.
+template <class Map, bool kHit>
+void BM_Find(benchmark::State& state) {
+  const std::vector<std::string> keys = make_keys(state.range(0), 1);
+  const std::vector<std::string> queries =
+      kHit ? make_keys(state.range(0), 1) : make_keys(state.range(0), 2);
+  Map map;
+  for (size_t i = 0; i < keys.size(); ++i) insert(map, keys[i], i);
+  std::vector<size_t> order(queries.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::shuffle(order.begin(), order.end(), std::mt19937(3));
+  for (auto _ : state) {
+    size_t found = 0;
+    for (size_t i : order) found += map.count(queries[i]);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK_TEMPLATE(BM_Find, std::unordered_map<std::string, int>, true)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, std::unordered_map<string_view, int>, true)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, flat_string_map<int>, true)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, std::unordered_map<std::string, int>, false)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, std::unordered_map<string_view, int>, false)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, flat_string_map<int>, false)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+
+}  // namespace
+}  // namespace david
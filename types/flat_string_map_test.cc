@@ -0,0 +1,209 @@
+#include "types/flat_string_map.h"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+// The entries of m as (key, value) pairs.
+template <class V>
+std::vector<std::pair<std::string, V>> entries(const flat_string_map<V>& m) {
+  std::vector<std::pair<std::string, V>> result;
+  for (const auto& entry : m) {
+    result.emplace_back(std::string(entry.first.data(), entry.first.size()),
+                        entry.second);
+  }
+  return result;
+}
+
+TEST(FlatStringMap, Empty) {
+  const flat_string_map<int> m;
+  EXPECT_THAT(m, IsEmpty());
+  EXPECT_EQ(m.capacity(), 0);
+  EXPECT_FALSE(m.contains("a"));
+  EXPECT_FALSE(m.contains(""));
+  EXPECT_TRUE(m.find("a") == m.end());
+  EXPECT_TRUE(m.begin() == m.end());
+  EXPECT_THROW(m.at("a"), std::out_of_range);
+}
+
+TEST(FlatStringMap, InsertAndFind) {
+  flat_string_map<int> m;
+  EXPECT_TRUE(m.insert("one", 1).second);
+  EXPECT_TRUE(m.insert("two", 2).second);
+  EXPECT_FALSE(m.insert("one", 10).second);
+  EXPECT_THAT(m, SizeIs(2));
+  EXPECT_EQ(m.at("one"), 1);
+  EXPECT_EQ(m.find("two").value(), 2);
+  EXPECT_EQ(m.find("two")->second, 2);
+  EXPECT_EQ(m.find("two").key(), "two");
+  EXPECT_EQ(m.count("three"), 0);
+  EXPECT_THAT(entries(m), UnorderedElementsAre(Pair("one", 1), Pair("two", 2)));
+}
+
+TEST(FlatStringMap, HeterogeneousLookup) {
+  flat_string_map<int> m;
+  m["apple"] = 1;
+  const std::string key = "apple";
+  const char* c_str = key.c_str();
+  EXPECT_TRUE(m.contains(key));
+  EXPECT_TRUE(m.contains(c_str));
+  EXPECT_TRUE(m.contains(string_view("apples", 5)));
+  EXPECT_FALSE(m.contains("apples"));
+}
+
+TEST(FlatStringMap, EmptyAndBinaryKeys) {
+  flat_string_map<int> m;
+  m[""] = 1;
+  m[string_view("\0", 1)] = 2;
+  m[string_view("\0\0", 2)] = 3;
+  EXPECT_THAT(m, SizeIs(3));
+  EXPECT_EQ(m.at(""), 1);
+  EXPECT_EQ(m.at(string_view("\0", 1)), 2);
+  EXPECT_EQ(m.at(string_view("\0\0", 2)), 3);
+}
+
+TEST(FlatStringMap, Subscript) {
+  flat_string_map<std::string> m;
+  m["a"] += "x";
+  m["a"] += "y";
+  EXPECT_EQ(m.at("a"), "xy");
+  EXPECT_EQ(m["b"], "");
+  EXPECT_THAT(m, SizeIs(2));
+}
+
+TEST(FlatStringMap, InsertOrAssign) {
+  flat_string_map<int> m;
+  EXPECT_TRUE(m.insert_or_assign("a", 1).second);
+  EXPECT_FALSE(m.insert_or_assign("a", 2).second);
+  EXPECT_EQ(m.at("a"), 2);
+}
+
+TEST(FlatStringMap, MoveOnlyValues) {
+  string_arena arena;
+  flat_string_map<std::unique_ptr<int>> m(&arena);
+  m.try_emplace("a", new int(1));
+  for (int i = 0; i < 100; ++i) {
+    m.try_emplace(std::to_string(i), new int(i));
+  }
+  EXPECT_EQ(*m.at("a"), 1);
+  EXPECT_EQ(*m.at("42"), 42);
+}
+
+TEST(FlatStringMap, Erase) {
+  flat_string_map<int> m;
+  m["a"] = 1;
+  m["b"] = 2;
+  EXPECT_EQ(m.erase("a"), 1);
+  EXPECT_EQ(m.erase("a"), 0);
+  EXPECT_FALSE(m.contains("a"));
+  m.erase(m.find("b"));
+  EXPECT_THAT(m, IsEmpty());
+  EXPECT_TRUE(m.begin() == m.end());
+}
+
+TEST(FlatStringMap, ArenaOwnsKeys) {
+  string_arena arena;
+  flat_string_map<int> m(&arena);
+  {
+    std::string key = "temporary";
+    m[key] = 1;
+    key = "overwritten";
+  }
+  EXPECT_EQ(m.at("temporary"), 1);
+  EXPECT_EQ(m.begin().key(), "temporary");
+  EXPECT_EQ(arena.bytes_used(), 9);
+  // Keys already in the map are not copied again.
+  m["temporary"] = 2;
+  EXPECT_EQ(arena.bytes_used(), 9);
+}
+
+TEST(FlatStringMap, CopyAndMove) {
+  string_arena arena;
+  flat_string_map<int> m(&arena);
+  for (int i = 0; i < 50; ++i) m[std::to_string(i)];
+  flat_string_map<int> copy = m;
+  copy["x"] = 1;
+  EXPECT_THAT(m, SizeIs(50));
+  EXPECT_THAT(copy, SizeIs(51));
+  EXPECT_EQ(entries(copy).size(), 51);
+
+  flat_string_map<int> moved = std::move(copy);
+  EXPECT_THAT(moved, SizeIs(51));
+  EXPECT_THAT(copy, IsEmpty());
+  EXPECT_FALSE(copy.contains("x"));
+  copy["y"] = 2;
+  EXPECT_EQ(copy.at("y"), 2);
+
+  moved = m;
+  EXPECT_THAT(moved, SizeIs(50));
+  EXPECT_FALSE(moved.contains("x"));
+}
+
+TEST(FlatStringMap, Clear) {
+  string_arena arena;
+  flat_string_map<int> m(&arena);
+  for (int i = 0; i < 100; ++i) m[std::to_string(i)] = i;
+  const size_t capacity = m.capacity();
+  m.clear();
+  EXPECT_THAT(m, IsEmpty());
+  EXPECT_EQ(m.capacity(), capacity);
+  EXPECT_FALSE(m.contains("1"));
+  m["1"] = 1;
+  EXPECT_EQ(m.at("1"), 1);
+}
+
+TEST(FlatStringMap, Reserve) {
+  flat_string_map<int> m;
+  m.reserve(1000);
+  const size_t capacity = m.capacity();
+  EXPECT_GE(capacity, 1000);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; ++i) keys.push_back(std::to_string(i));
+  for (const std::string& key : keys) m[key] = 0;
+  EXPECT_EQ(m.capacity(), capacity);
+}
+
+// Random inserts and erases, checked against std::map. Erases leave
+// tombstones, which rehashing has to clean up.
+TEST(FlatStringMap, MatchesStdMap) {
+  std::mt19937 rng(1);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 2000; ++i) {
+    keys.push_back(std::string(rng() % 20, 'k') + std::to_string(i));
+  }
+  flat_string_map<int> m;
+  std::map<std::string, int> expected;
+  for (int i = 0; i < 100000; ++i) {
+    const std::string& key = keys[rng() % keys.size()];
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(m.erase(key), expected.erase(key));
+    } else {
+      EXPECT_EQ(m.insert(key, i).second, expected.emplace(key, i).second);
+    }
+  }
+  ASSERT_EQ(m.size(), expected.size());
+  for (const auto& entry : expected) EXPECT_EQ(m.at(entry.first), entry.second);
+  std::map<std::string, int> actual;
+  for (const auto& entry : m) {
+    actual[std::string(entry.first.data(), entry.first.size())] = entry.second;
+  }
+  EXPECT_EQ(actual, expected);
+  EXPECT_LE(m.capacity(), 4096);
+}
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,421 @@
+#ifndef TYPES_FORMAT
+#define TYPES_FORMAT
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "types/internal/ryu_tables.h"
+#include "types/string_view.h"
+
+namespace david {
+
+// Maximum number of characters that format_to can write for a value of type T.
+// Callers can use it to size stack buffers:
+//   char buf[max_format_length<int>::value];
+//   string_view s = format_to(buf, 42);
+template <typename T, typename Enable = void>
+struct max_format_length;
+
+template <typename T>
+struct max_format_length<
+    T, typename std::enable_if<std::is_integral<T>::value>::type>
+    : std::integral_constant<size_t,
+                             std::numeric_limits<T>::digits10 + 1 +
+                                 (std::numeric_limits<T>::is_signed ? 1 : 0)> {
+};
+
+// "-1.17549435e-38".
+template <>
+struct max_format_length<float> : std::integral_constant<size_t, 15> {};
+
+// "-2.2250738585072014e-308".
+template <>
+struct max_format_length<double> : std::integral_constant<size_t, 24> {};
+
+namespace internal {
+
+template <typename T = void>
+struct digit_pairs {
+  static const char kTable[200];
+};
+
+template <typename T>
+const char digit_pairs<T>::kTable[200] = {
+    '0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6', '0',
+    '7', '0', '8', '0', '9', '1', '0', '1', '1', '1', '2', '1', '3', '1', '4',
+    '1', '5', '1', '6', '1', '7', '1', '8', '1', '9', '2', '0', '2', '1', '2',
+    '2', '2', '3', '2', '4', '2', '5', '2', '6', '2', '7', '2', '8', '2', '9',
+    '3', '0', '3', '1', '3', '2', '3', '3', '3', '4', '3', '5', '3', '6', '3',
+    '7', '3', '8', '3', '9', '4', '0', '4', '1', '4', '2', '4', '3', '4', '4',
+    '4', '5', '4', '6', '4', '7', '4', '8', '4', '9', '5', '0', '5', '1', '5',
+    '2', '5', '3', '5', '4', '5', '5', '5', '6', '5', '7', '5', '8', '5', '9',
+    '6', '0', '6', '1', '6', '2', '6', '3', '6', '4', '6', '5', '6', '6', '6',
+    '7', '6', '8', '6', '9', '7', '0', '7', '1', '7', '2', '7', '3', '7', '4',
+    '7', '5', '7', '6', '7', '7', '7', '8', '7', '9', '8', '0', '8', '1', '8',
+    '2', '8', '3', '8', '4', '8', '5', '8', '6', '8', '7', '8', '8', '8', '9',
+    '9', '0', '9', '1', '9', '2', '9', '3', '9', '4', '9', '5', '9', '6', '9',
+    '7', '9', '8', '9', '9'};
+
+inline size_t decimal_length(uint64_t v) {
+  size_t len = 1;
+  for (;;) {
+    if (v < 10) return len;
+    if (v < 100) return len + 1;
+    if (v < 1000) return len + 2;
+    if (v < 10000) return len + 3;
+    v /= 10000;
+    len += 4;
+  }
+}
+
+// Writes the decimal digits of v into [buf, buf + len), where len must be
+// decimal_length(v). Two digits are emitted per division.
+inline void write_digits(char* buf, uint64_t v, size_t len) {
+  const char* pairs = digit_pairs<>::kTable;
+  char* p = buf + len;
+  while (v >= 100) {
+    const size_t i = static_cast<size_t>(v % 100) * 2;
+    v /= 100;
+    p -= 2;
+    p[0] = pairs[i];
+    p[1] = pairs[i + 1];
+  }
+  if (v >= 10) {
+    const size_t i = static_cast<size_t>(v) * 2;
+    p -= 2;
+    p[0] = pairs[i];
+    p[1] = pairs[i + 1];
+  } else {
+    *--p = static_cast<char>('0' + v);
+  }
+}
+
+inline size_t format_unsigned(char* buf, uint64_t v) {
+  const size_t len = decimal_length(v);
+  write_digits(buf, v, len);
+  return len;
+}
+
+// Ryu: https://github.com/ulfjack/ryu (Ulf Adams, PLDI 2018).
+// The helpers below follow the reference implementation (d2s.c) closely so
+// they can be checked against it.
+
+// ceil(log2(5^e)) for 0 <= e <= 3528 (1 when e == 0).
+inline int32_t pow5_bits(int32_t e) {
+  return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650.
+inline uint32_t log10_pow2(int32_t e) {
+  return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620.
+inline uint32_t log10_pow5(int32_t e) {
+  return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+inline bool multiple_of_pow5(uint64_t v, uint32_t p) {
+  uint32_t count = 0;
+  while (v > 0 && v % 5 == 0) {
+    v /= 5;
+    ++count;
+  }
+  return count >= p;
+}
+
+inline bool multiple_of_pow2(uint64_t v, uint32_t p) {
+  return (v & ((uint64_t(1) << p) - 1)) == 0;
+}
+
+inline uint64_t mul_shift64(uint64_t m, const uint64_t* mul, int32_t j) {
+  typedef unsigned __int128 uint128_t;
+  const uint128_t b0 = uint128_t(m) * mul[0];
+  const uint128_t b2 = uint128_t(m) * mul[1];
+  return static_cast<uint64_t>(((b0 >> 64) + b2) >> (j - 64));
+}
+
+// Decimal representation computed by Ryu: value = digits * 10^exponent.
+struct decimal_fp {
+  uint64_t digits;
+  int32_t exponent;
+};
+
+// Computes the shortest decimal in the rounding interval of m2 * 2^e2, where
+// m2 includes the implicit bit. mm_shift is 0 when the lower neighbor is
+// closer than the upper one (the value is a power of two). Works for any
+// mantissa of at most 53 bits, so it is shared by float and double.
+inline decimal_fp shortest_decimal(uint64_t m2, int32_t e2, uint32_t mm_shift) {
+  typedef ryu_tables<> tables;
+  e2 -= 2;
+  const bool accept_bounds = (m2 & 1) == 0;
+  const uint64_t mv = 4 * m2;
+
+  uint64_t vr, vp, vm;
+  int32_t e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  if (e2 >= 0) {
+    const uint32_t q = log10_pow2(e2) - (e2 > 3);
+    e10 = static_cast<int32_t>(q);
+    const int32_t k =
+        tables::kPow5InvBitCount + pow5_bits(static_cast<int32_t>(q)) - 1;
+    const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+    const uint64_t* mul = tables::kPow5InvSplit[q];
+    vr = mul_shift64(mv, mul, i);
+    vp = mul_shift64(mv + 2, mul, i);
+    vm = mul_shift64(mv - 1 - mm_shift, mul, i);
+    if (q <= 21) {
+      if (mv % 5 == 0) {
+        vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+      } else if (accept_bounds) {
+        vm_is_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+      } else {
+        vp -= multiple_of_pow5(mv + 2, q);
+      }
+    }
+  } else {
+    const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+    e10 = static_cast<int32_t>(q) + e2;
+    const int32_t i = -e2 - static_cast<int32_t>(q);
+    const int32_t k = pow5_bits(i) - tables::kPow5BitCount;
+    const int32_t j = static_cast<int32_t>(q) - k;
+    const uint64_t* mul = tables::kPow5Split[i];
+    vr = mul_shift64(mv, mul, j);
+    vp = mul_shift64(mv + 2, mul, j);
+    vm = mul_shift64(mv - 1 - mm_shift, mul, j);
+    if (q <= 1) {
+      vr_is_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_is_trailing_zeros = mm_shift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 63) {
+      vr_is_trailing_zeros = multiple_of_pow2(mv, q);
+    }
+  }
+
+  int32_t removed = 0;
+  uint8_t last_removed_digit = 0;
+  uint64_t output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = static_cast<uint8_t>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = static_cast<uint8_t>(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+      // Round half to even.
+      last_removed_digit = 4;
+    }
+    output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                   last_removed_digit >= 5);
+  } else {
+    // Common case: no trailing zeros to track.
+    bool round_up = false;
+    if (vp / 100 > vm / 100) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr + (vr == vm || round_up);
+  }
+
+  decimal_fp fd;
+  fd.digits = output;
+  fd.exponent = e10 + removed;
+  return fd;
+}
+
+// Writes m2 * 2^e2, which must be an integer below 2^128.
+inline size_t format_exact_integer(char* buf, uint64_t m2, int32_t e2) {
+  typedef unsigned __int128 uint128_t;
+  const uint128_t v = e2 >= 0 ? uint128_t(m2) << e2 : uint128_t(m2 >> -e2);
+  const uint64_t kTen19 = 10000000000000000000u;
+  if (v <= ~uint64_t(0)) return format_unsigned(buf, static_cast<uint64_t>(v));
+  const size_t len = format_unsigned(buf, static_cast<uint64_t>(v / kTen19));
+  // The low half is zero padded to 19 digits.
+  const uint64_t low = static_cast<uint64_t>(v % kTen19);
+  const size_t low_len = decimal_length(low);
+  std::memset(buf + len, '0', 19 - low_len);
+  write_digits(buf + len + 19 - low_len, low, low_len);
+  return len + 19;
+}
+
+// Lays out digits * 10^exponent like std::to_chars does in its shortest mode:
+// plain notation unless scientific notation is strictly shorter. Like
+// std::to_chars, integers printed in plain notation show the exact value of
+// m2 * 2^e2 rather than the shortest digits padded with zeros.
+inline size_t format_decimal(char* buf, bool negative, decimal_fp fd,
+                             uint64_t m2, int32_t e2) {
+  char* p = buf;
+  if (negative) *p++ = '-';
+
+  const int32_t olength = static_cast<int32_t>(decimal_length(fd.digits));
+  const int32_t sci_exponent = fd.exponent + olength - 1;
+  const int32_t abs_sci_exponent =
+      sci_exponent < 0 ? -sci_exponent : sci_exponent;
+  const int32_t sci_length = olength + (olength > 1 ? 1 : 0) + 2 +
+                             (abs_sci_exponent >= 100 ? 3 : 2);
+  int32_t fixed_length;
+  if (fd.exponent >= 0) {
+    fixed_length = olength + fd.exponent;
+  } else if (-fd.exponent < olength) {
+    fixed_length = olength + 1;
+  } else {
+    fixed_length = 2 - fd.exponent;
+  }
+
+  if (fixed_length <= sci_length) {
+    if (fd.exponent > 0) {
+      p += format_exact_integer(p, m2, e2);
+    } else if (fd.exponent == 0) {
+      write_digits(p, fd.digits, olength);
+      p += olength;
+    } else if (-fd.exponent < olength) {
+      const int32_t int_length = olength + fd.exponent;
+      write_digits(p + 1, fd.digits, olength);
+      std::memmove(p, p + 1, int_length);
+      p[int_length] = '.';
+      p += olength + 1;
+    } else {
+      const int32_t zeros = -fd.exponent - olength;
+      *p++ = '0';
+      *p++ = '.';
+      std::memset(p, '0', zeros);
+      p += zeros;
+      write_digits(p, fd.digits, olength);
+      p += olength;
+    }
+    return p - buf;
+  }
+
+  // Scientific: d[.ddd]e(+|-)XX[X].
+  write_digits(p + 1, fd.digits, olength);
+  p[0] = p[1];
+  if (olength > 1) {
+    p[1] = '.';
+    p += olength + 1;
+  } else {
+    p += 1;
+  }
+  *p++ = 'e';
+  *p++ = sci_exponent < 0 ? '-' : '+';
+  if (abs_sci_exponent >= 100) {
+    *p++ = static_cast<char>('0' + abs_sci_exponent / 100);
+  }
+  const int32_t two = (abs_sci_exponent % 100) * 2;
+  *p++ = digit_pairs<>::kTable[two];
+  *p++ = digit_pairs<>::kTable[two + 1];
+  return p - buf;
+}
+
+inline size_t format_special(char* buf, bool negative, bool nan) {
+  char* p = buf;
+  if (negative) *p++ = '-';
+  std::memcpy(p, nan ? "nan" : "inf", 3);
+  return p + 3 - buf;
+}
+
+// Shared by float and double: kMantissaBits excludes the implicit bit.
+template <int kMantissaBits, int kExponentBits, typename Bits>
+size_t format_ieee(char* buf, Bits bits) {
+  const int32_t bias = (1 << (kExponentBits - 1)) - 1;
+  const bool negative = (bits >> (kMantissaBits + kExponentBits)) & 1;
+  const uint64_t mantissa = bits & ((Bits(1) << kMantissaBits) - 1);
+  const uint32_t exponent = static_cast<uint32_t>(
+      (bits >> kMantissaBits) & ((Bits(1) << kExponentBits) - 1));
+
+  if (exponent == (uint32_t(1) << kExponentBits) - 1) {
+    return format_special(buf, negative, mantissa != 0);
+  }
+  if (exponent == 0 && mantissa == 0) {
+    char* p = buf;
+    if (negative) *p++ = '-';
+    *p++ = '0';
+    return p - buf;
+  }
+
+  uint64_t m2;
+  int32_t e2;
+  if (exponent == 0) {
+    m2 = mantissa;
+    e2 = 1 - bias - kMantissaBits;
+  } else {
+    m2 = (uint64_t(1) << kMantissaBits) | mantissa;
+    e2 = static_cast<int32_t>(exponent) - bias - kMantissaBits;
+  }
+  const uint32_t mm_shift = mantissa != 0 || exponent <= 1;
+  return format_decimal(buf, negative, shortest_decimal(m2, e2, mm_shift), m2,
+                        e2);
+}
+
+}  // namespace internal
+
+// Formats value in base 10 into buf, which must have room for at least
+// max_format_length<T>::value characters, and returns a view over the written
+// characters. No terminating null character is written and nothing is
+// allocated.
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_same<T, bool>::value,
+                        string_view>::type
+format_to(char* buf, T value) {
+  typedef typename std::make_unsigned<T>::type unsigned_type;
+  unsigned_type magnitude = static_cast<unsigned_type>(value);
+  char* p = buf;
+  if (value < 0) {
+    *p++ = '-';
+    // Negate in the unsigned domain so the minimum value doesn't overflow.
+    magnitude = unsigned_type(0) - magnitude;
+  }
+  const size_t len = internal::format_unsigned(p, magnitude);
+  return string_view(buf, p - buf + len);
+}
+
+// Formats value with the fewest digits that parse back to the same value
+// (the same output as std::to_chars without a format or precision): plain
+// notation unless scientific notation is shorter, "inf" and "nan" for
+// non-finite values. The digits are computed with Ryu.
+inline string_view format_to(char* buf, double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return string_view(buf, internal::format_ieee<52, 11>(buf, bits));
+}
+
+inline string_view format_to(char* buf, float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return string_view(buf, internal::format_ieee<23, 8>(buf, bits));
+}
+
+}  // namespace david
+
+#endif  // TYPES_FORMAT
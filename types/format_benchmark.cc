@@ -0,0 +1,103 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/format.h"
+
+namespace david {
+namespace {
+
+template <typename T>
+std::vector<T> random_values(size_t n) {
+  std::mt19937_64 rng(42);
+  std::vector<T> values;
+  values.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    // Mix magnitudes so every digit count shows up.
+    values.push_back(static_cast<T>(rng() >> (rng() % 64)));
+  }
+  return values;
+}
+
+std::vector<double> random_doubles(size_t n) {
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> mantissa(0, 1);
+  std::uniform_int_distribution<int> exponent(-30, 30);
+  std::vector<double> values;
+  values.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    values.push_back(mantissa(rng) * std::pow(10.0, exponent(rng)));
+  }
+  return values;
+}
+
+constexpr size_t kNumValues = 1 << 12;
+
+void BM_FormatToInt64(benchmark::State& state) {
+  const std::vector<int64_t> values = random_values<int64_t>(kNumValues);
+  char buf[max_format_length<int64_t>::value];
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(format_to(buf, values[i++ % kNumValues]));
+  }
+}
+BENCHMARK(BM_FormatToInt64);
+
+void BM_ToStringInt64(benchmark::State& state) {
+  const std::vector<int64_t> values = random_values<int64_t>(kNumValues);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::to_string(values[i++ % kNumValues]));
+  }
+}
+BENCHMARK(BM_ToStringInt64);
+
+void BM_SnprintfInt64(benchmark::State& state) {
+  const std::vector<int64_t> values = random_values<int64_t>(kNumValues);
+  char buf[32];
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::snprintf(
+        buf, sizeof(buf), "%lld",
+        static_cast<long long>(values[i++ % kNumValues])));
+  }
+}
+BENCHMARK(BM_SnprintfInt64);
+
+void BM_FormatToDouble(benchmark::State& state) {
+  const std::vector<double> values = random_doubles(kNumValues);
+  char buf[max_format_length<double>::value];
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(format_to(buf, values[i++ % kNumValues]));
+  }
+}
+BENCHMARK(BM_FormatToDouble);
+
+void BM_ToStringDouble(benchmark::State& state) {
+  const std::vector<double> values = random_doubles(kNumValues);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::to_string(values[i++ % kNumValues]));
+  }
+}
+BENCHMARK(BM_ToStringDouble);
+
+// %.17g is what it takes for snprintf to round-trip.
+void BM_SnprintfDouble(benchmark::State& state) {
+  const std::vector<double> values = random_doubles(kNumValues);
+  char buf[32];
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        std::snprintf(buf, sizeof(buf), "%.17g", values[i++ % kNumValues]));
+  }
+}
+BENCHMARK(BM_SnprintfDouble);
+
+}  // namespace
+}  // namespace david
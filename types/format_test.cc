@@ -0,0 +1,167 @@
+#include "types/format.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::Eq;
+
+template <typename T>
+std::string format(T value) {
+  char buf[max_format_length<T>::value];
+  const string_view s = format_to(buf, value);
+  return std::string(s.data(), s.size());
+}
+
+TEST(Format, MaxLengths) {
+  EXPECT_EQ(max_format_length<int8_t>::value, 4);
+  EXPECT_EQ(max_format_length<uint8_t>::value, 3);
+  EXPECT_EQ(max_format_length<int32_t>::value, 11);
+  EXPECT_EQ(max_format_length<uint32_t>::value, 10);
+  EXPECT_EQ(max_format_length<int64_t>::value, 20);
+  EXPECT_EQ(max_format_length<uint64_t>::value, 20);
+}
+
+TEST(Format, ReturnsViewIntoBuffer) {
+  char buf[max_format_length<int>::value];
+  const string_view s = format_to(buf, 1234);
+  EXPECT_EQ(s.data(), buf);
+  EXPECT_EQ(s, "1234");
+}
+
+TEST(Format, Integers) {
+  EXPECT_THAT(format(0), Eq("0"));
+  EXPECT_THAT(format(7), Eq("7"));
+  EXPECT_THAT(format(10), Eq("10"));
+  EXPECT_THAT(format(99), Eq("99"));
+  EXPECT_THAT(format(100), Eq("100"));
+  EXPECT_THAT(format(-1), Eq("-1"));
+  EXPECT_THAT(format(-100), Eq("-100"));
+  EXPECT_THAT(format(12345u), Eq("12345"));
+}
+
+TEST(Format, IntegerLimits) {
+  EXPECT_THAT(format(std::numeric_limits<int8_t>::min()), Eq("-128"));
+  EXPECT_THAT(format(std::numeric_limits<uint8_t>::max()), Eq("255"));
+  EXPECT_THAT(format(std::numeric_limits<int32_t>::min()), Eq("-2147483648"));
+  EXPECT_THAT(format(std::numeric_limits<int64_t>::min()),
+              Eq("-9223372036854775808"));
+  EXPECT_THAT(format(std::numeric_limits<uint64_t>::max()),
+              Eq("18446744073709551615"));
+}
+
+TEST(Format, IntegersMatchToString) {
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < 100000; ++i) {
+    const int64_t v = static_cast<int64_t>(rng()) >> (rng() % 64);
+    ASSERT_THAT(format(v), Eq(std::to_string(v)));
+    ASSERT_THAT(format(static_cast<int32_t>(v)),
+                Eq(std::to_string(static_cast<int32_t>(v))));
+  }
+}
+
+TEST(Format, DoubleSpecialValues) {
+  EXPECT_THAT(format(0.0), Eq("0"));
+  EXPECT_THAT(format(-0.0), Eq("-0"));
+  EXPECT_THAT(format(std::numeric_limits<double>::infinity()), Eq("inf"));
+  EXPECT_THAT(format(-std::numeric_limits<double>::infinity()), Eq("-inf"));
+  EXPECT_THAT(format(std::numeric_limits<double>::quiet_NaN()), Eq("nan"));
+}
+
+TEST(Format, DoubleShortest) {
+  EXPECT_THAT(format(1.0), Eq("1"));
+  EXPECT_THAT(format(0.1), Eq("0.1"));
+  EXPECT_THAT(format(0.3), Eq("0.3"));
+  EXPECT_THAT(format(0.1 + 0.2), Eq("0.30000000000000004"));
+  EXPECT_THAT(format(-1.5), Eq("-1.5"));
+  EXPECT_THAT(format(123456.789), Eq("123456.789"));
+  EXPECT_THAT(format(1e21), Eq("1e+21"));
+  EXPECT_THAT(format(1e-7), Eq("1e-07"));
+  EXPECT_THAT(format(0.001), Eq("0.001"));
+  EXPECT_THAT(format(100.0), Eq("100"));
+  EXPECT_THAT(format(1.5e300), Eq("1.5e+300"));
+  EXPECT_THAT(format(std::numeric_limits<double>::max()),
+              Eq("1.7976931348623157e+308"));
+  EXPECT_THAT(format(std::numeric_limits<double>::min()),
+              Eq("2.2250738585072014e-308"));
+  EXPECT_THAT(format(std::numeric_limits<double>::denorm_min()),
+              Eq("5e-324"));
+  EXPECT_THAT(format(-std::numeric_limits<double>::min()),
+              Eq("-2.2250738585072014e-308"));
+}
+
+TEST(Format, FloatShortest) {
+  EXPECT_THAT(format(0.1f), Eq("0.1"));
+  EXPECT_THAT(format(1.0f / 3), Eq("0.33333334"));
+  EXPECT_THAT(format(16777216.0f), Eq("16777216"));
+  EXPECT_THAT(format(std::numeric_limits<float>::max()),
+              Eq("3.4028235e+38"));
+  EXPECT_THAT(format(-std::numeric_limits<float>::min()),
+              Eq("-1.1754944e-38"));
+  EXPECT_THAT(format(std::numeric_limits<float>::denorm_min()),
+              Eq("1e-45"));
+}
+
+TEST(Format, DoublesRoundTrip) {
+  std::mt19937_64 rng(7);
+  for (int i = 0; i < 200000; ++i) {
+    const uint64_t bits = rng();
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    if (v != v) continue;
+    const std::string s = format(v);
+    ASSERT_LE(s.size(), max_format_length<double>::value);
+    ASSERT_EQ(std::strtod(s.c_str(), nullptr), v) << s;
+  }
+}
+
+TEST(Format, FloatsRoundTrip) {
+  std::mt19937 rng(7);
+  for (int i = 0; i < 200000; ++i) {
+    const uint32_t bits = rng();
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    if (v != v) continue;
+    const std::string s = format(v);
+    ASSERT_LE(s.size(), max_format_length<float>::value);
+    ASSERT_EQ(std::strtof(s.c_str(), nullptr), v) << s;
+  }
+}
+
+#if __cplusplus >= 201703L
+TEST(Format, MatchesToChars) {
+  std::mt19937_64 rng(11);
+  char expected[64];
+  for (int i = 0; i < 200000; ++i) {
+    const uint64_t bits = rng();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    const std::to_chars_result dr =
+        std::to_chars(expected, expected + sizeof(expected), d);
+    ASSERT_THAT(format(d), Eq(std::string(expected, dr.ptr)));
+
+    const uint32_t fbits = static_cast<uint32_t>(bits);
+    float f;
+    std::memcpy(&f, &fbits, sizeof(f));
+    const std::to_chars_result fr =
+        std::to_chars(expected, expected + sizeof(expected), f);
+    ASSERT_THAT(format(f), Eq(std::string(expected, fr.ptr)));
+  }
+}
+#endif
+
+}  // namespace
+}  // namespace david
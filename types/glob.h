@@ -0,0 +1,379 @@
+#ifndef TYPES_GLOB
+#define TYPES_GLOB
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types/string_view.h"
+
+namespace david {
+namespace internal {
+
+// A set of bytes, as matched by one char of a glob.
+struct glob_char_set {
+  uint64_t bits[4] = {0, 0, 0, 0};
+
+  void add(unsigned char c) { bits[c / 64] |= uint64_t(1) << (c % 64); }
+  void add_range(unsigned char lo, unsigned char hi) {
+    for (unsigned c = lo; c <= hi; ++c) add(static_cast<unsigned char>(c));
+  }
+  bool contains(unsigned char c) const {
+    return (bits[c / 64] >> (c % 64)) & 1;
+  }
+  void invert() {
+    for (uint64_t& word : bits) word = ~word;
+  }
+};
+
+enum class glob_loop : uint8_t {
+  kNone,
+  // *: any run of chars other than '/'.
+  kStar,
+  // **: any run of chars.
+  kDoubleStar,
+};
+
+// A glob as an NFA in a line: state i moves to state i + 1 on a char in
+// atoms[i], and loops on itself on any char allowed by loops[i]. Runs of
+// stars become a loop, so no state needs an epsilon move. The glob matches
+// a string that leads from state 0 to state atoms.size().
+struct parsed_glob {
+  std::vector<glob_char_set> atoms;
+  std::vector<glob_loop> loops;
+  // literal[i] is the char atom i matches, or -1 if it matches several.
+  std::vector<int> literal;
+};
+
+// Parses a glob, throwing std::invalid_argument if it is malformed. Supported
+// syntax:
+//   ?        any char but '/'
+//   *        any run of chars without '/'
+//   **       any run of chars, '/' included
+//   [a-z_]   a char from the set; [!...] or [^...] for the complement. Sets
+//            never match '/'. A ']' right after the '[' belongs to the set.
+//   \c       the char c
+inline parsed_glob parse_glob(string_view pattern) {
+  parsed_glob g;
+  g.loops.push_back(glob_loop::kNone);
+  size_t i = 0;
+  const size_t n = pattern.size();
+  while (i < n) {
+    const char c = pattern[i];
+    if (c == '*') {
+      size_t stars = 0;
+      while (i < n && pattern[i] == '*') ++stars, ++i;
+      glob_loop& loop = g.loops.back();
+      if (stars >= 2) {
+        loop = glob_loop::kDoubleStar;
+      } else if (loop == glob_loop::kNone) {
+        loop = glob_loop::kStar;
+      }
+      continue;
+    }
+
+    glob_char_set set;
+    int literal = -1;
+    if (c == '?') {
+      set.invert();
+      ++i;
+    } else if (c == '[') {
+      ++i;
+      bool negate = false;
+      if (i < n && (pattern[i] == '!' || pattern[i] == '^')) {
+        negate = true;
+        ++i;
+      }
+      bool first = true;
+      for (;; first = false) {
+        if (i >= n) throw std::invalid_argument("unterminated [ in glob");
+        if (pattern[i] == ']' && !first) break;
+        if (pattern[i] == '\\') {
+          if (++i >= n) throw std::invalid_argument("trailing \\ in glob");
+        }
+        const unsigned char lo = static_cast<unsigned char>(pattern[i++]);
+        unsigned char hi = lo;
+        if (i + 1 < n && pattern[i] == '-' && pattern[i + 1] != ']') {
+          ++i;
+          if (pattern[i] == '\\' && ++i >= n) {
+            throw std::invalid_argument("trailing \\ in glob");
+          }
+          hi = static_cast<unsigned char>(pattern[i++]);
+          if (hi < lo) throw std::invalid_argument("reversed range in glob");
+        }
+        set.add_range(lo, hi);
+      }
+      ++i;
+      if (negate) set.invert();
+    } else {
+      if (c == '\\' && ++i >= n) {
+        throw std::invalid_argument("trailing \\ in glob");
+      }
+      literal = static_cast<unsigned char>(pattern[i++]);
+      set.add(static_cast<unsigned char>(literal));
+    }
+    if (literal < 0) {
+      // Only stars cross directories.
+      set.bits['/' / 64] &= ~(uint64_t(1) << ('/' % 64));
+    }
+    g.atoms.push_back(set);
+    g.literal.push_back(literal);
+    g.loops.push_back(glob_loop::kNone);
+  }
+  return g;
+}
+
+// Bit-parallel simulation of the NFAs of one or more globs (Shift-And with
+// self-loops). Each glob owns a run of bits, one per state, and a string is
+// read one char at a time with a few word operations per 64 states:
+//   next = ((states << 1) & advance[c]) | (states & loop[c])
+// The bit that starts each run is never in advance[], so nothing carries from
+// one glob into the next. Time is linear in the size of the string.
+class glob_nfa {
+ public:
+  explicit glob_nfa(const std::vector<parsed_glob>& globs) {
+    size_t num_states = 0;
+    for (const parsed_glob& g : globs) num_states += g.atoms.size() + 1;
+    words_ = (num_states + 63) / 64;
+    advance_.assign(256 * words_, 0);
+    loop_.assign(256 * words_, 0);
+    initial_.assign(words_, 0);
+    accept_.assign(words_, 0);
+    glob_of_accept_.resize(num_states);
+
+    size_t first = 0;
+    for (size_t k = 0; k < globs.size(); ++k) {
+      const parsed_glob& g = globs[k];
+      const size_t m = g.atoms.size();
+      set_bit(&initial_[0], first);
+      set_bit(&accept_[0], first + m);
+      glob_of_accept_[first + m] = k;
+      for (unsigned c = 0; c < 256; ++c) {
+        uint64_t* advance = &advance_[c * words_];
+        uint64_t* loop = &loop_[c * words_];
+        for (size_t i = 0; i < m; ++i) {
+          if (g.atoms[i].contains(static_cast<unsigned char>(c))) {
+            set_bit(advance, first + i + 1);
+          }
+        }
+        for (size_t i = 0; i <= m; ++i) {
+          if (g.loops[i] == glob_loop::kDoubleStar ||
+              (g.loops[i] == glob_loop::kStar && c != '/')) {
+            set_bit(loop, first + i);
+          }
+        }
+      }
+      first += m + 1;
+    }
+  }
+
+  size_t words() const noexcept { return words_; }
+
+  // Runs s through the NFA starting from the initial states, leaving the
+  // final states in states[0, words()). Returns false, possibly early, if
+  // no state is left.
+  bool run(string_view s, uint64_t* states) const {
+    if (words_ == 1) {
+      uint64_t d = initial_[0];
+      for (size_t i = 0; i < s.size() && d != 0; ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        d = ((d << 1) & advance_[c]) | (d & loop_[c]);
+      }
+      states[0] = d;
+      return d != 0;
+    }
+
+    for (size_t w = 0; w < words_; ++w) states[w] = initial_[w];
+    for (size_t i = 0; i < s.size(); ++i) {
+      const unsigned char c = static_cast<unsigned char>(s[i]);
+      const uint64_t* advance = &advance_[c * words_];
+      const uint64_t* loop = &loop_[c * words_];
+      uint64_t carry = 0;
+      uint64_t any = 0;
+      for (size_t w = 0; w < words_; ++w) {
+        const uint64_t d = states[w];
+        states[w] = (((d << 1) | carry) & advance[w]) | (d & loop[w]);
+        carry = d >> 63;
+        any |= states[w];
+      }
+      if (any == 0) return false;
+    }
+    return true;
+  }
+
+  // Calls f(k) for every glob k whose accepting state is in states, in
+  // increasing order of k.
+  template <class F>
+  void for_each_accepted(const uint64_t* states, const F& f) const {
+    for (size_t w = 0; w < words_; ++w) {
+      for (uint64_t hits = states[w] & accept_[w]; hits != 0;
+           hits &= hits - 1) {
+        f(glob_of_accept_[w * 64 + __builtin_ctzll(hits)]);
+      }
+    }
+  }
+
+ private:
+  static void set_bit(uint64_t* words, size_t bit) {
+    words[bit / 64] |= uint64_t(1) << (bit % 64);
+  }
+
+  size_t words_;
+  // advance_[c * words_ + w] and loop_[c * words_ + w] hold the masks of
+  // char c.
+  std::vector<uint64_t> advance_;
+  std::vector<uint64_t> loop_;
+  std::vector<uint64_t> initial_;
+  std::vector<uint64_t> accept_;
+  std::vector<size_t> glob_of_accept_;
+};
+
+}  // namespace internal
+
+// A glob compiled for matching whole strings, such as paths, in linear time.
+// See internal::parse_glob for the syntax.
+//
+// Globs made of literal chars and ** only are matched by searching for their
+// literal segments in order with string_view::find, which is exact for them:
+// the leftmost place for each segment leaves the most room for the rest.
+// Other globs run through a bit-parallel NFA, after checking that the string
+// contains their longest literal segment.
+class glob_pattern {
+ public:
+  // Throws std::invalid_argument if pattern is malformed.
+  explicit glob_pattern(string_view pattern)
+      : pattern_(pattern.data(), pattern.size()),
+        nfa_(std::vector<internal::parsed_glob>(1, parse(pattern))) {}
+
+  const std::string& pattern() const noexcept { return pattern_; }
+
+  bool matches(string_view s) const {
+    if (literal_only_) return matches_segments(s);
+    if (!required_.empty() && s.find(required_) == string_view::npos) {
+      return false;
+    }
+    uint64_t inline_states[4];
+    std::vector<uint64_t> heap_states;
+    uint64_t* states = inline_states;
+    if (nfa_.words() > 4) {
+      heap_states.resize(nfa_.words());
+      states = heap_states.data();
+    }
+    if (!nfa_.run(s, states)) return false;
+    bool accepted = false;
+    nfa_.for_each_accepted(states, [&](size_t) { accepted = true; });
+    return accepted;
+  }
+
+ private:
+  internal::parsed_glob parse(string_view pattern) {
+    internal::parsed_glob g = internal::parse_glob(pattern);
+
+    // Split into literal segments at the loops, and note the longest.
+    literal_only_ = true;
+    segments_.assign(1, std::string());
+    for (size_t i = 0; i < g.atoms.size(); ++i) {
+      if (g.loops[i] == internal::glob_loop::kStar) literal_only_ = false;
+      if (g.loops[i] != internal::glob_loop::kNone) {
+        segments_.push_back(std::string());
+      }
+      if (g.literal[i] < 0) {
+        literal_only_ = false;
+        segments_.push_back(std::string());
+        continue;
+      }
+      segments_.back().push_back(static_cast<char>(g.literal[i]));
+      if (segments_.back().size() > required_.size()) {
+        required_ = segments_.back();
+      }
+    }
+    const internal::glob_loop last = g.loops.back();
+    if (last == internal::glob_loop::kStar) literal_only_ = false;
+    if (last != internal::glob_loop::kNone) segments_.push_back(std::string());
+    return g;
+  }
+
+  // For literal_only_ globs: segments_[0] must be a prefix and, if there are
+  // several, the last one a suffix, with the others in order in between.
+  bool matches_segments(string_view s) const {
+    const string_view first = segments_.front();
+    if (segments_.size() == 1) return s == first;
+    const string_view last = segments_.back();
+    if (s.size() < first.size() + last.size() || !s.starts_with(first) ||
+        !s.ends_with(last)) {
+      return false;
+    }
+    const string_view middle =
+        s.substr(first.size(), s.size() - first.size() - last.size());
+    size_t pos = 0;
+    for (size_t i = 1; i + 1 < segments_.size(); ++i) {
+      if (segments_[i].empty()) continue;
+      pos = middle.find(segments_[i], pos);
+      if (pos == string_view::npos) return false;
+      pos += segments_[i].size();
+    }
+    return true;
+  }
+
+  std::string pattern_;
+  // Set by parse(), like the two members below, while nfa_ is initialized.
+  bool literal_only_;
+  std::vector<std::string> segments_;
+  // The longest run of literal chars, which every match contains.
+  std::string required_;
+  internal::glob_nfa nfa_;
+};
+
+// Many globs matched together: a string is read once, however many globs
+// there are, with all their NFAs run side by side.
+class glob_set {
+ public:
+  // Throws std::invalid_argument if a pattern is malformed.
+  explicit glob_set(const std::vector<string_view>& patterns)
+      : glob_set(patterns.data(), patterns.size()) {}
+  glob_set(const string_view* patterns, size_t n)
+      : size_(n), nfa_(parse_all(patterns, n)) {}
+
+  size_t size() const noexcept { return size_; }
+
+  // Whether any glob matches s.
+  bool matches_any(string_view s) const {
+    std::vector<uint64_t> states(nfa_.words());
+    if (states.empty() || !nfa_.run(s, states.data())) return false;
+    bool accepted = false;
+    nfa_.for_each_accepted(states.data(), [&](size_t) { accepted = true; });
+    return accepted;
+  }
+
+  // Indices of the globs that match s, in increasing order.
+  std::vector<size_t> match(string_view s) const {
+    std::vector<size_t> matched;
+    std::vector<uint64_t> states(nfa_.words());
+    if (!states.empty() && nfa_.run(s, states.data())) {
+      nfa_.for_each_accepted(states.data(),
+                             [&](size_t k) { matched.push_back(k); });
+    }
+    return matched;
+  }
+
+ private:
+  static std::vector<internal::parsed_glob> parse_all(
+      const string_view* patterns, size_t n) {
+    std::vector<internal::parsed_glob> globs;
+    globs.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      globs.push_back(internal::parse_glob(patterns[i]));
+    }
+    return globs;
+  }
+
+  size_t size_;
+  internal::glob_nfa nfa_;
+};
+
+}  // namespace david
+
+#endif  // TYPES_GLOB
@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/glob.h"
+
+namespace david {
+namespace {
+
+// The usual backtracking matcher for * and ?, as a baseline. Exponential in
+// the number of stars on some inputs.
+bool backtracking_match(string_view p, string_view s) {
+  if (p.empty()) return s.empty();
+  if (p[0] == '*') {
+    for (size_t i = 0; i <= s.size(); ++i) {
+      if (backtracking_match(p.substr(1), s.substr(i))) return true;
+      if (i < s.size() && s[i] == '/') break;
+    }
+    return false;
+  }
+  return !s.empty() && (p[0] == '?' ? s[0] != '/' : p[0] == s[0]) &&
+         backtracking_match(p.substr(1), s.substr(1));
+}
+
+void BM_BacktrackingPathological(benchmark::State& state) {
+  const std::string s(state.range(0), 'a');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(backtracking_match("*a*a*a*b", s));
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_BacktrackingPathological)->Arg(64)->Arg(256);
+
+void BM_GlobPathological(benchmark::State& state) {
+  const std::string s(state.range(0), 'a');
+  const glob_pattern pattern("*a*a*a*b");
+  for (auto _ : state) benchmark::DoNotOptimize(pattern.matches(s));
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK(BM_GlobPathological)->Arg(64)->Arg(256)->Arg(1 << 16);
+
+std::vector<std::string> make_paths(size_t n) {
+  std::mt19937 rng(1);
+  const char* roots[] = {"/api/v1/", "/api/v2/", "/static/", "/users/"};
+  const char* leaves[] = {"index.html", "site.css", "app.js", "profile"};
+  std::vector<std::string> paths(n);
+  for (std::string& path : paths) {
+    path = roots[rng() % 4];
+    for (size_t depth = rng() % 3; depth > 0; --depth) {
+      path += "dir" + std::to_string(rng() % 100) + "/";
+    }
+    path += leaves[rng() % 4];
+  }
+  return paths;
+}
+
+// Route-like patterns, each unique through its numbered directory.
+std::vector<std::string> make_patterns(size_t n) {
+  std::vector<std::string> patterns(n);
+  const char* forms[] = {"/api/v?/dir%zu/*", "/static/**/dir%zu/*.css",
+                         "/users/dir%zu/**", "/api/*/dir%zu/[a-p]*"};
+  for (size_t i = 0; i < n; ++i) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), forms[i % 4], i % 100);
+    patterns[i] = buf;
+  }
+  return patterns;
+}
+
+void BM_PatternLoop(benchmark::State& state) {
+  const std::vector<std::string> paths = make_paths(1024);
+  std::vector<glob_pattern> patterns;
+  for (const std::string& p : make_patterns(state.range(0))) {
+    patterns.emplace_back(p);
+  }
+  for (auto _ : state) {
+    size_t matched = 0;
+    for (const std::string& path : paths) {
+      for (const glob_pattern& pattern : patterns) {
+        matched += pattern.matches(path);
+      }
+    }
+    benchmark::DoNotOptimize(matched);
+  }
+  state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_PatternLoop)->Arg(16)->Arg(256);
+
+void BM_GlobSet(benchmark::State& state) {
+  const std::vector<std::string> paths = make_paths(1024);
+  const std::vector<std::string> patterns = make_patterns(state.range(0));
+  const glob_set set(
+      std::vector<string_view>(patterns.begin(), patterns.end()));
+  for (auto _ : state) {
+    size_t matched = 0;
+    for (const std::string& path : paths) matched += set.match(path).size();
+    benchmark::DoNotOptimize(matched);
+  }
+  state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_GlobSet)->Arg(16)->Arg(256);
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,192 @@
+#include "types/glob.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Reference matcher by recursion on (pattern, string) positions, memoized so
+// that it stays polynomial. Supports the same syntax except classes.
+class reference_matcher {
+ public:
+  reference_matcher(const std::string& p, const std::string& s)
+      : p_(p), s_(s), memo_((p.size() + 1) * (s.size() + 1), -1) {}
+
+  bool matches() { return match(0, 0); }
+
+ private:
+  bool match(size_t i, size_t j) {
+    int& memo = memo_[i * (s_.size() + 1) + j];
+    if (memo < 0) memo = compute(i, j);
+    return memo;
+  }
+
+  bool compute(size_t i, size_t j) {
+    if (i == p_.size()) return j == s_.size();
+    if (p_[i] == '*') {
+      size_t k = i;
+      while (k < p_.size() && p_[k] == '*') ++k;
+      const bool any = k - i >= 2;
+      if (match(k, j)) return true;
+      return j < s_.size() && (any || s_[j] != '/') && match(i, j + 1);
+    }
+    if (j == s_.size()) return false;
+    if (p_[i] == '?') return s_[j] != '/' && match(i + 1, j + 1);
+    return p_[i] == s_[j] && match(i + 1, j + 1);
+  }
+
+  const std::string& p_;
+  const std::string& s_;
+  std::vector<int> memo_;
+};
+
+bool matches(string_view pattern, string_view s) {
+  return glob_pattern(pattern).matches(s);
+}
+
+TEST(GlobPattern, Literals) {
+  EXPECT_TRUE(matches("", ""));
+  EXPECT_FALSE(matches("", "a"));
+  EXPECT_TRUE(matches("/usr/bin", "/usr/bin"));
+  EXPECT_FALSE(matches("/usr/bin", "/usr/bin/"));
+  EXPECT_FALSE(matches("/usr/bin", "/usr/bi"));
+  EXPECT_TRUE(matches("a\\*b", "a*b"));
+  EXPECT_FALSE(matches("a\\*b", "axb"));
+}
+
+TEST(GlobPattern, QuestionMark) {
+  EXPECT_TRUE(matches("a?c", "abc"));
+  EXPECT_FALSE(matches("a?c", "ac"));
+  EXPECT_FALSE(matches("a?c", "a/c"));
+}
+
+TEST(GlobPattern, Star) {
+  EXPECT_TRUE(matches("*", ""));
+  EXPECT_TRUE(matches("*", "file.txt"));
+  EXPECT_FALSE(matches("*", "dir/file.txt"));
+  EXPECT_TRUE(matches("*.txt", "file.txt"));
+  EXPECT_TRUE(matches("*.txt", ".txt"));
+  EXPECT_FALSE(matches("*.txt", "file.txt.gz"));
+  EXPECT_TRUE(matches("/api/*/users", "/api/v1/users"));
+  EXPECT_FALSE(matches("/api/*/users", "/api/v1/beta/users"));
+  EXPECT_TRUE(matches("a*b*c", "aXbYbZc"));
+}
+
+TEST(GlobPattern, DoubleStar) {
+  EXPECT_TRUE(matches("**", ""));
+  EXPECT_TRUE(matches("**", "a/b/c"));
+  EXPECT_TRUE(matches("/static/**", "/static/css/site.css"));
+  EXPECT_FALSE(matches("/static/**", "/public/site.css"));
+  EXPECT_TRUE(matches("**/*.go", "src/pkg/main.go"));
+  EXPECT_FALSE(matches("**/*.go", "main.go"));
+  EXPECT_TRUE(matches("/a/**/b/*.txt", "/a/x/y/b/c.txt"));
+  EXPECT_FALSE(matches("/a/**/b/*.txt", "/a/x/y/b/c/d.txt"));
+  EXPECT_TRUE(matches("**a**b", "xaybb"));
+  EXPECT_FALSE(matches("**ab**ab", "xaby"));
+}
+
+TEST(GlobPattern, Classes) {
+  EXPECT_TRUE(matches("[a-c]x", "bx"));
+  EXPECT_FALSE(matches("[a-c]x", "dx"));
+  EXPECT_TRUE(matches("[!a-c]x", "dx"));
+  EXPECT_TRUE(matches("[^a-c]x", "dx"));
+  EXPECT_FALSE(matches("[!a-c]x", "/x"));
+  EXPECT_TRUE(matches("[]]", "]"));
+  EXPECT_TRUE(matches("[a-]", "-"));
+  EXPECT_TRUE(matches("[\\]]", "]"));
+  EXPECT_TRUE(matches("v[0-9].[0-9]*", "v1.2"));
+  EXPECT_TRUE(matches("v[0-9].[0-9]*", "v1.2.3"));
+  EXPECT_FALSE(matches("v[0-9].[0-9]*", "v1.x"));
+}
+
+TEST(GlobPattern, RejectsMalformedPatterns) {
+  EXPECT_THROW(glob_pattern("[abc"), std::invalid_argument);
+  EXPECT_THROW(glob_pattern("[]"), std::invalid_argument);
+  EXPECT_THROW(glob_pattern("abc\\"), std::invalid_argument);
+  EXPECT_THROW(glob_pattern("[z-a]"), std::invalid_argument);
+}
+
+TEST(GlobPattern, LongPatterns) {
+  std::string pattern;
+  std::string s;
+  for (int i = 0; i < 100; ++i) {
+    pattern += "?*";
+    s += "ab";
+  }
+  EXPECT_TRUE(matches(pattern, s));
+  EXPECT_FALSE(matches(pattern + "c", s));
+}
+
+TEST(GlobPattern, MatchesReference) {
+  std::mt19937 rng(3);
+  const char pattern_chars[] = {'a', 'b', '/', '?', '*'};
+  const char chars[] = {'a', 'b', '/'};
+  for (int iter = 0; iter < 20000; ++iter) {
+    std::string pattern;
+    for (size_t i = rng() % 8; i > 0; --i) pattern += pattern_chars[rng() % 5];
+    std::string s;
+    for (size_t i = rng() % 10; i > 0; --i) s += chars[rng() % 3];
+    EXPECT_EQ(matches(pattern, s), reference_matcher(pattern, s).matches())
+        << pattern << " vs " << s;
+  }
+}
+
+// Patterns that make backtracking matchers exponential.
+TEST(GlobPattern, PathologicalPatterns) {
+  const std::string s(10000, 'a');
+  EXPECT_FALSE(matches("*a*a*a*a*a*a*a*a*a*a*b", s));
+  EXPECT_FALSE(matches("**a**a**a**a**a**a**a**a**b", s));
+  EXPECT_TRUE(matches("*a*a*a*a*a*a*a*a*a*a", s));
+}
+
+TEST(GlobSet, MatchesEveryPattern) {
+  const glob_set set(std::vector<string_view>{
+      "/api/**", "/api/*/users", "*.txt", "/static/*.css", "/api/v[0-9]/*"});
+  EXPECT_EQ(set.size(), 5);
+  EXPECT_THAT(set.match("/api/v1/users"), ElementsAre(0, 1, 4));
+  EXPECT_THAT(set.match("/api/beta/users"), ElementsAre(0, 1));
+  EXPECT_THAT(set.match("notes.txt"), ElementsAre(2));
+  EXPECT_THAT(set.match("/static/a/b.css"), IsEmpty());
+  EXPECT_TRUE(set.matches_any("/static/b.css"));
+  EXPECT_FALSE(set.matches_any("/other"));
+}
+
+TEST(GlobSet, Empty) {
+  const glob_set set(std::vector<string_view>{});
+  EXPECT_FALSE(set.matches_any(""));
+  EXPECT_THAT(set.match("a"), IsEmpty());
+}
+
+TEST(GlobSet, AgreesWithPatterns) {
+  std::mt19937 rng(4);
+  const char pattern_chars[] = {'a', 'b', '/', '?', '*'};
+  std::vector<std::string> patterns(300);
+  for (std::string& pattern : patterns) {
+    for (size_t i = 1 + rng() % 10; i > 0; --i) {
+      pattern += pattern_chars[rng() % 5];
+    }
+  }
+  const glob_set set(
+      std::vector<string_view>(patterns.begin(), patterns.end()));
+  for (int iter = 0; iter < 500; ++iter) {
+    std::string s;
+    for (size_t i = rng() % 12; i > 0; --i) s += "ab/"[rng() % 3];
+    std::vector<size_t> expected;
+    for (size_t k = 0; k < patterns.size(); ++k) {
+      if (matches(patterns[k], s)) expected.push_back(k);
+    }
+    EXPECT_EQ(set.match(s), expected) << s;
+    EXPECT_EQ(set.matches_any(s), !expected.empty());
+  }
+}
+
+}  // namespace
+}  // namespace david
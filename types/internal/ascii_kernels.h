@@ -0,0 +1,187 @@
+#ifndef TYPES_INTERNAL_ASCII_KERNELS
+#define TYPES_INTERNAL_ASCII_KERNELS
+
+#include <cstddef>
+#include <cstdint>
+
+#include "types/internal/string_kernels.h"
+
+// Char class and case kernels behind types/ascii.h, one namespace per
+// instruction set tier as in string_kernels.h. The AVX-512 tier runs the
+// AVX2 kernels, and the SSE2 tier the scalar ones.
+//
+// A class of chars is a table of 16 bytes indexed by the low nibble of a
+// char, where bit h of an entry is set if the char with high nibble h is in
+// the class. Chars from 0x80 up are in no class. A single lookup thus tells
+// whether a char is in any set of ASCII chars, and a byte shuffle does it for
+// a whole block. The table of a union of classes is the bitwise or of their
+// tables.
+namespace david {
+namespace internal {
+
+// Tables of the classes of ascii::char_class, by bit.
+const uint8_t kCharClassTables[8][16] = {
+    // Digits.
+    {0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00},
+    // Lower case letters.
+    {0x80, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0x40,
+     0x40, 0x40, 0x40, 0x40},
+    // Upper case letters.
+    {0x20, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x10,
+     0x10, 0x10, 0x10, 0x10},
+    // Hex digits.
+    {0x08, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x08, 0x08, 0x08, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00},
+    // Whitespace.
+    {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01,
+     0x01, 0x01, 0x00, 0x00},
+    // Punctuation.
+    {0x50, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0c, 0xac,
+     0xac, 0xac, 0xac, 0x2c},
+    // Printable chars.
+    {0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc,
+     0xfc, 0xfc, 0xfc, 0x7c},
+    // Control chars.
+    {0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+     0x03, 0x03, 0x03, 0x83},
+};
+
+namespace scalar {
+
+inline bool in_class(const uint8_t* table, char c) {
+  const unsigned char u = static_cast<unsigned char>(c);
+  return u < 0x80 && ((table[u & 15] >> (u >> 4)) & 1) != 0;
+}
+
+// Offset of the first char of p[0, n) that is not in the class, or n.
+inline size_t find_not_in_class(const uint8_t* table, const char* p,
+                                size_t n) {
+  size_t i = 0;
+  while (i < n && in_class(table, p[i])) ++i;
+  return i;
+}
+
+// One past the offset of the last char of p[0, n) that is not in the class,
+// or 0.
+inline size_t rfind_not_in_class(const uint8_t* table, const char* p,
+                                 size_t n) {
+  while (n > 0 && in_class(table, p[n - 1])) --n;
+  return n;
+}
+
+// Out may be in.
+inline void to_lower(const char* in, size_t n, char* out) {
+  for (size_t i = 0; i < n; ++i) {
+    const unsigned char c = static_cast<unsigned char>(in[i]);
+    out[i] = static_cast<char>(c ^ (static_cast<unsigned char>(c - 'A') < 26
+                                        ? 0x20
+                                        : 0));
+  }
+}
+
+inline void to_upper(const char* in, size_t n, char* out) {
+  for (size_t i = 0; i < n; ++i) {
+    const unsigned char c = static_cast<unsigned char>(in[i]);
+    out[i] = static_cast<char>(c ^ (static_cast<unsigned char>(c - 'a') < 26
+                                        ? 0x20
+                                        : 0));
+  }
+}
+
+}  // namespace scalar
+
+#if DAVID_HAS_X86_KERNELS
+
+namespace avx2 {
+
+#define DAVID_KERNEL_TARGET __attribute__((target("avx2")))
+
+// Bit i set for each char of the block that is not in the class.
+DAVID_KERNEL_TARGET inline uint32_t not_in_class_mask(__m256i table,
+                                                      __m256i block) {
+  // The bit of each high nibble; none for chars from 0x80 up. The shuffle
+  // of the table also gives 0 for them, as their top bit is set.
+  const __m256i rows = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,  //
+      1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i hi =
+      _mm256_and_si256(_mm256_srli_epi16(block, 4), _mm256_set1_epi8(0x0f));
+  const __m256i in_class = _mm256_and_si256(
+      _mm256_shuffle_epi8(table, block), _mm256_shuffle_epi8(rows, hi));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(in_class, _mm256_setzero_si256())));
+}
+
+DAVID_KERNEL_TARGET inline __m256i load_table(const uint8_t* table) {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+DAVID_KERNEL_TARGET inline size_t find_not_in_class(const uint8_t* table,
+                                                    const char* p, size_t n) {
+  const __m256i t = load_table(table);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const uint32_t mask = not_in_class_mask(
+        t, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  return i + scalar::find_not_in_class(table, p + i, n - i);
+}
+
+DAVID_KERNEL_TARGET inline size_t rfind_not_in_class(const uint8_t* table,
+                                                     const char* p,
+                                                     size_t n) {
+  const __m256i t = load_table(table);
+  for (; n >= 32; n -= 32) {
+    const uint32_t mask = not_in_class_mask(
+        t, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n - 32)));
+    if (mask != 0) return n - __builtin_clz(mask);
+  }
+  return scalar::rfind_not_in_class(table, p, n);
+}
+
+// Flips bit 5 of the chars in [first, first + 25].
+template <char first>
+DAVID_KERNEL_TARGET inline void flip_case(const char* in, size_t n,
+                                          char* out) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    const __m256i offset = _mm256_sub_epi8(block, _mm256_set1_epi8(first));
+    const __m256i in_range = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(offset, _mm256_set1_epi8(25)), offset);
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(out + i),
+        _mm256_xor_si256(block,
+                         _mm256_and_si256(in_range, _mm256_set1_epi8(0x20))));
+  }
+  if (first == 'A') {
+    scalar::to_lower(in + i, n - i, out + i);
+  } else {
+    scalar::to_upper(in + i, n - i, out + i);
+  }
+}
+
+DAVID_KERNEL_TARGET inline void to_lower(const char* in, size_t n,
+                                         char* out) {
+  flip_case<'A'>(in, n, out);
+}
+
+DAVID_KERNEL_TARGET inline void to_upper(const char* in, size_t n,
+                                         char* out) {
+  flip_case<'a'>(in, n, out);
+}
+
+#undef DAVID_KERNEL_TARGET
+
+}  // namespace avx2
+
+#endif  // DAVID_HAS_X86_KERNELS
+
+}  // namespace internal
+}  // namespace david
+
+#endif  // TYPES_INTERNAL_ASCII_KERNELS
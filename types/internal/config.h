@@ -0,0 +1,22 @@
+#ifndef TYPES_INTERNAL_CONFIG
+#define TYPES_INTERNAL_CONFIG
+
+// The library builds as C++11. These macros turn on features of later
+// standards when the compiler supports them.
+
+// constexpr functions with loops and local variables need C++14.
+#if __cplusplus >= 201402L
+#define DAVID_CONSTEXPR14 constexpr
+#else
+#define DAVID_CONSTEXPR14
+#endif
+
+// Class types as non-type template parameters need C++20.
+#if defined(__cpp_nontype_template_args) && \
+    __cpp_nontype_template_args >= 201911L
+#define DAVID_HAS_CLASS_NTTP 1
+#else
+#define DAVID_HAS_CLASS_NTTP 0
+#endif
+
+#endif  // TYPES_INTERNAL_CONFIG
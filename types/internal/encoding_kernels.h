@@ -0,0 +1,320 @@
+#ifndef TYPES_INTERNAL_ENCODING_KERNELS
+#define TYPES_INTERNAL_ENCODING_KERNELS
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "types/internal/string_kernels.h"
+
+// Base64 and hex kernels behind types/encoding.h. They work on whole blocks
+// only: groups of 3 bytes and 4 chars for base64, and pairs of chars for hex.
+// Padding, partial groups and streaming are left to encoding.h.
+//
+// As in string_kernels.h there is one namespace per instruction set tier.
+// The vector kernels need the byte shuffles of SSSE3, so the SSE2 tier runs
+// the scalar ones, and the AVX-512 tier the AVX2 ones.
+namespace david {
+namespace internal {
+
+const char kBase64Standard[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char kBase64Url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const char kHexDigits[] = "0123456789abcdef";
+
+// Value of each char in an alphabet, or kInvalid. With ignore_case, the
+// letters of the alphabet also decode in the other case.
+class decode_table {
+ public:
+  static const uint8_t kInvalid = 0xff;
+
+  decode_table(const char* alphabet, size_t size, bool ignore_case) {
+    std::memset(values_, kInvalid, sizeof(values_));
+    for (size_t i = 0; i < size; ++i) {
+      const unsigned char c = static_cast<unsigned char>(alphabet[i]);
+      values_[c] = static_cast<uint8_t>(i);
+      if (ignore_case && ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) {
+        values_[c ^ 0x20] = static_cast<uint8_t>(i);
+      }
+    }
+  }
+
+  uint8_t operator[](char c) const {
+    return values_[static_cast<unsigned char>(c)];
+  }
+
+ private:
+  uint8_t values_[256];
+};
+
+inline const decode_table& base64_decode_table(bool url) {
+  static const decode_table kStandard(kBase64Standard, 64, false);
+  static const decode_table kUrl(kBase64Url, 64, false);
+  return url ? kUrl : kStandard;
+}
+
+inline const decode_table& hex_decode_table() {
+  static const decode_table kTable(kHexDigits, 16, true);
+  return kTable;
+}
+
+namespace scalar {
+
+// Encodes in[0, n), n a multiple of 3, into n / 3 * 4 chars.
+inline void base64_encode(const char* in, size_t n, char* out, bool url) {
+  const char* const alphabet = url ? kBase64Url : kBase64Standard;
+  for (size_t i = 0; i < n; i += 3) {
+    const uint32_t v = uint32_t(static_cast<unsigned char>(in[i])) << 16 |
+                       uint32_t(static_cast<unsigned char>(in[i + 1])) << 8 |
+                       uint32_t(static_cast<unsigned char>(in[i + 2]));
+    out[0] = alphabet[v >> 18];
+    out[1] = alphabet[(v >> 12) & 63];
+    out[2] = alphabet[(v >> 6) & 63];
+    out[3] = alphabet[v & 63];
+    out += 4;
+  }
+}
+
+// Decodes in[0, n), n a multiple of 4 and without padding, into n / 4 * 3
+// bytes. Returns false if a char is not in the alphabet, in which case out
+// holds garbage.
+inline bool base64_decode(const char* in, size_t n, char* out, bool url) {
+  const decode_table& table = base64_decode_table(url);
+  uint8_t invalid = 0;
+  for (size_t i = 0; i < n; i += 4) {
+    const uint8_t a = table[in[i]];
+    const uint8_t b = table[in[i + 1]];
+    const uint8_t c = table[in[i + 2]];
+    const uint8_t d = table[in[i + 3]];
+    // Values are 6 bits, so only kInvalid sets the top bit.
+    invalid |= a | b | c | d;
+    const uint32_t v = uint32_t(a) << 18 | uint32_t(b) << 12 |
+                       uint32_t(c) << 6 | uint32_t(d);
+    out[0] = static_cast<char>(v >> 16);
+    out[1] = static_cast<char>(v >> 8);
+    out[2] = static_cast<char>(v);
+    out += 3;
+  }
+  return (invalid & 0x80) == 0;
+}
+
+inline void hex_encode(const char* in, size_t n, char* out) {
+  for (size_t i = 0; i < n; ++i) {
+    const unsigned char c = static_cast<unsigned char>(in[i]);
+    out[2 * i] = kHexDigits[c >> 4];
+    out[2 * i + 1] = kHexDigits[c & 15];
+  }
+}
+
+// Decodes in[0, n), n even, into n / 2 bytes. Returns false if a char is
+// not a hex digit of either case.
+inline bool hex_decode(const char* in, size_t n, char* out) {
+  const decode_table& table = hex_decode_table();
+  uint8_t invalid = 0;
+  for (size_t i = 0; i < n; i += 2) {
+    const uint8_t hi = table[in[i]];
+    const uint8_t lo = table[in[i + 1]];
+    invalid |= hi | lo;
+    out[i / 2] = static_cast<char>(hi << 4 | lo);
+  }
+  return (invalid & 0x80) == 0;
+}
+
+}  // namespace scalar
+
+#if DAVID_HAS_X86_KERNELS
+
+namespace avx2 {
+
+#define DAVID_KERNEL_TARGET __attribute__((target("avx2")))
+
+DAVID_KERNEL_TARGET inline __m256i broadcast_lut(const int8_t* lut) {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(lut)));
+}
+
+// Reads 24 bytes as 4 groups of 3 per lane, and writes 32 chars. After the
+// shuffle, each 32-bit word holds a group as bytes [b1, b0, b2, b1], from
+// which two multiplies move the four 6-bit values to the low bits of each
+// byte. The values are then mapped to chars by adding an offset that
+// depends on their range: A-Z, a-z, 0-9 or one of the last two chars.
+//
+// Loads read 28 bytes from in, so the last group or two are left to the
+// scalar kernel.
+DAVID_KERNEL_TARGET inline void base64_encode(const char* in, size_t n,
+                                              char* out, bool url) {
+  static const int8_t kOffsets[2][16] = {
+      {'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+       '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0},
+      {'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+       '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0},
+  };
+  const __m256i shuffle = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,  //
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i offsets = broadcast_lut(kOffsets[url]);
+  size_t i = 0;
+  for (; i + 28 <= n; i += 24) {
+    const __m128i lo =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    const __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12));
+    const __m256i groups = _mm256_shuffle_epi8(
+        _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuffle);
+    const __m256i ac = _mm256_mulhi_epu16(
+        _mm256_and_si256(groups, _mm256_set1_epi32(0x0fc0fc00)),
+        _mm256_set1_epi32(0x04000040));
+    const __m256i bd = _mm256_mullo_epi16(
+        _mm256_and_si256(groups, _mm256_set1_epi32(0x003f03f0)),
+        _mm256_set1_epi32(0x01000010));
+    const __m256i values = _mm256_or_si256(ac, bd);
+    // 0 for a-z, 1 to 12 for 0-9 and the last two, 13 for A-Z.
+    __m256i range = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+    range = _mm256_or_si256(
+        range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), values),
+                                _mm256_set1_epi8(13)));
+    const __m256i chars =
+        _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, range));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 3 * 4), chars);
+  }
+  scalar::base64_encode(in + i, n - i, out + i / 3 * 4, url);
+}
+
+// Reads 32 chars and writes 24 bytes. A char is in the alphabet unless the
+// class of its high nibble is in the set of classes that are invalid for
+// its low nibble, which two table lookups and a test find for every char at
+// once. Adding an offset that depends on the high nibble then gives the
+// value of a char, except for the last char of the alphabet, which shares
+// its high nibble with others. Multiplies pack the 6-bit values.
+DAVID_KERNEL_TARGET inline bool base64_decode(const char* in, size_t n,
+                                              char* out, bool url) {
+  // Classes of high nibbles, one bit each, with the low nibbles for which
+  // they are invalid. The tables for the standard alphabet need 5 classes,
+  // and the URL-safe one 6.
+  static const int8_t kHighClasses[2][16] = {
+      {0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x10, 0x01, 0x01, 0x01, 0x01,
+       0x01, 0x01, 0x01, 0x01},
+      {0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x20, 0x01, 0x01, 0x01, 0x01,
+       0x01, 0x01, 0x01, 0x01},
+  };
+  static const int8_t kInvalidClasses[2][16] = {
+      {0x0b, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x15,
+       0x17, 0x17, 0x17, 0x15},
+      {0x0b, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x37,
+       0x37, 0x35, 0x37, 0x27},
+  };
+  static const int8_t kOffsets[2][16] = {
+      {0, 0, 62 - '+', 52 - '0', -'A', -'A', 26 - 'a', 26 - 'a', 0, 0, 0, 0,
+       0, 0, 0, 0},
+      {0, 0, 62 - '-', 52 - '0', -'A', -'A', 26 - 'a', 26 - 'a', 0, 0, 0, 0,
+       0, 0, 0, 0},
+  };
+  const char last = url ? '_' : '/';
+  const __m256i high_classes = broadcast_lut(kHighClasses[url]);
+  const __m256i invalid_classes = broadcast_lut(kInvalidClasses[url]);
+  const __m256i offsets = broadcast_lut(kOffsets[url]);
+  const __m256i last_offset = _mm256_set1_epi8(static_cast<char>(63 - last));
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i chars =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(chars, 4), nibble);
+    const __m256i lo = _mm256_and_si256(chars, nibble);
+    if (!_mm256_testz_si256(_mm256_shuffle_epi8(high_classes, hi),
+                            _mm256_shuffle_epi8(invalid_classes, lo))) {
+      return false;
+    }
+    const __m256i offset = _mm256_blendv_epi8(
+        _mm256_shuffle_epi8(offsets, hi), last_offset,
+        _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(last)));
+    const __m256i values = _mm256_add_epi8(chars, offset);
+    // [a, b, c, d] to a << 18 | b << 12 | c << 6 | d in each 32-bit word,
+    // whose 3 low bytes are then gathered in big-endian order.
+    const __m256i pairs =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    words = _mm256_shuffle_epi8(
+        words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                -1, -1, -1, -1));
+    words = _mm256_permutevar8x32_epi32(
+        words, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+    char* const dest = out + i / 4 * 3;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+                     _mm256_castsi256_si128(words));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 16),
+                     _mm256_extracti128_si256(words, 1));
+  }
+  return scalar::base64_decode(in + i, n - i, out + i / 4 * 3, url);
+}
+
+// Reads 32 bytes and writes 64 chars, looking up the digit of each nibble.
+DAVID_KERNEL_TARGET inline void hex_encode(const char* in, size_t n,
+                                           char* out) {
+  const __m256i digits = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(kHexDigits)));
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    const __m256i hi = _mm256_shuffle_epi8(
+        digits, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+    const __m256i lo =
+        _mm256_shuffle_epi8(digits, _mm256_and_si256(bytes, nibble));
+    // Bytes 0-7 and 16-23, then 8-15 and 24-31.
+    const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i),
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  scalar::hex_encode(in + i, n - i, out + 2 * i);
+}
+
+// Reads 32 chars and writes 16 bytes.
+DAVID_KERNEL_TARGET inline bool hex_decode(const char* in, size_t n,
+                                           char* out) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i chars =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    // Values of digits, and of letters of either case, as unsigned bytes
+    // that are in range only for chars of their kind.
+    const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i letter = _mm256_sub_epi8(
+        _mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i is_letter = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    if (static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(is_digit, is_letter))) != 0xffffffff) {
+      return false;
+    }
+    const __m256i values = _mm256_blendv_epi8(
+        _mm256_add_epi8(letter, _mm256_set1_epi8(10)), digit, is_digit);
+    // hi << 4 | lo in each 16-bit word, then packed to bytes.
+    const __m256i words =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+    const __m256i bytes = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(words, words), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2),
+                     _mm256_castsi256_si128(bytes));
+  }
+  return scalar::hex_decode(in + i, n - i, out + i / 2);
+}
+
+#undef DAVID_KERNEL_TARGET
+
+}  // namespace avx2
+
+#endif  // DAVID_HAS_X86_KERNELS
+
+}  // namespace internal
+}  // namespace david
+
+#endif  // TYPES_INTERNAL_ENCODING_KERNELS
@@ -0,0 +1,42 @@
+#ifndef TYPES_INTERNAL_LITTLE_ENDIAN
+#define TYPES_INTERNAL_LITTLE_ENDIAN
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Little-endian fixed-width integers, as stored in the serialized forms of
+// sorted_dictionary, line_index and string_table.
+namespace david {
+namespace internal {
+
+inline uint64_t load_le64(const char* p) {
+  uint64_t x;
+  std::memcpy(&x, p, sizeof(x));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  x = __builtin_bswap64(x);
+#endif
+  return x;
+}
+
+inline uint32_t load_le32(const char* p) {
+  uint32_t x;
+  std::memcpy(&x, p, sizeof(x));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  x = __builtin_bswap32(x);
+#endif
+  return x;
+}
+
+inline void append_le64(std::vector<char>* out, uint64_t x) {
+  for (int i = 0; i < 8; ++i) out->push_back(static_cast<char>(x >> (8 * i)));
+}
+
+inline void append_le32(std::vector<char>* out, uint32_t x) {
+  for (int i = 0; i < 4; ++i) out->push_back(static_cast<char>(x >> (8 * i)));
+}
+
+}  // namespace internal
+}  // namespace david
+
+#endif  // TYPES_INTERNAL_LITTLE_ENDIAN
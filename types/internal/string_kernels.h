@@ -0,0 +1,374 @@
+#ifndef TYPES_INTERNAL_STRING_KERNELS
+#define TYPES_INTERNAL_STRING_KERNELS
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Search, compare, count and hash kernels over plain chars, behind the char
+// specialization of basic_string_view. There is one set of kernels per
+// instruction set tier, see types/cpu_dispatch.h for how one is picked.
+//
+// The vector tiers are compiled with target attributes, so that a binary
+// built for baseline x86-64 still carries them. They share a single
+// implementation, string_kernels_simd.h, which each tier includes after
+// defining its vector primitives.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define DAVID_HAS_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define DAVID_HAS_X86_KERNELS 0
+#endif
+
+namespace david {
+namespace internal {
+
+static const size_t kNotFound = static_cast<size_t>(-1);
+
+// Sets larger than this are looked up in a table rather than compared
+// against each input block char by char.
+static const size_t kMaxVectorSetSize = 8;
+
+inline uint64_t load_u64(const char* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t load_u32(const char* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t hash_fmix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// The hash reads inputs longer than 32 bytes in stripes of 32 bytes, as
+// four 64-bit lanes. Each lane adds the product of the halves of its word
+// mixed with a key, and the plain word of its neighbour. The vector tiers
+// compute the same lanes, so every tier returns the same hash.
+const uint64_t kHashKeys[4] = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+                               0x165667b19e3779f9ULL, 0xd6e8feb86659fd93ULL};
+
+inline uint64_t hash_short(const char* p, size_t n) {
+  if (n > 16) {
+    const uint64_t a = hash_short(p, 16);
+    const uint64_t b = hash_short(p + n - 16, 16);
+    return hash_fmix(a ^ (b * kHashKeys[3]) ^ n);
+  }
+  if (n >= 8) {
+    const uint64_t a = load_u64(p) ^ kHashKeys[0];
+    const uint64_t b = load_u64(p + n - 8) ^ kHashKeys[1];
+    return hash_fmix(a ^ hash_fmix(b ^ n));
+  }
+  if (n >= 4) {
+    const uint64_t v =
+        (uint64_t(load_u32(p)) << 32) | load_u32(p + n - 4);
+    return hash_fmix(v ^ kHashKeys[0] ^ (n * kHashKeys[1]));
+  }
+  if (n > 0) {
+    const uint64_t v = uint64_t(static_cast<unsigned char>(p[0])) |
+                       uint64_t(static_cast<unsigned char>(p[n / 2])) << 8 |
+                       uint64_t(static_cast<unsigned char>(p[n - 1])) << 16 |
+                       uint64_t(n) << 24;
+    return hash_fmix(v ^ kHashKeys[2]);
+  }
+  return hash_fmix(kHashKeys[3]);
+}
+
+inline uint64_t hash_finish(const uint64_t* acc, size_t n) {
+  uint64_t h = n * kHashKeys[0];
+  for (size_t j = 0; j < 4; ++j) h = hash_fmix(h ^ acc[j]);
+  return h;
+}
+
+namespace scalar {
+
+// The kernels below take a haystack h[0, n) and a needle or set s[0, m), and
+// return an offset into h or kNotFound. find and rfind need 1 <= m <= n.
+
+inline size_t find(const char* h, size_t n, const char* s, size_t m) {
+  const char* p = h;
+  const char* const end = h + (n - m + 1);
+  while (p < end) {
+    p = static_cast<const char*>(std::memchr(p, s[0], end - p));
+    if (p == nullptr) return kNotFound;
+    if (std::memcmp(p + 1, s + 1, m - 1) == 0) return p - h;
+    ++p;
+  }
+  return kNotFound;
+}
+
+inline size_t rfind(const char* h, size_t n, const char* s, size_t m) {
+  for (size_t i = n - m + 1; i-- > 0;) {
+    if (h[i] == s[0] && std::memcmp(h + i + 1, s + 1, m - 1) == 0) return i;
+  }
+  return kNotFound;
+}
+
+// Set of chars as a 256-bit table.
+class char_set {
+ public:
+  char_set(const char* s, size_t m) : bits_() {
+    for (size_t i = 0; i < m; ++i) {
+      const unsigned char c = static_cast<unsigned char>(s[i]);
+      bits_[c >> 6] |= uint64_t(1) << (c & 63);
+    }
+  }
+
+  bool contains(char c) const {
+    const unsigned char u = static_cast<unsigned char>(c);
+    return (bits_[u >> 6] >> (u & 63)) & 1;
+  }
+
+ private:
+  uint64_t bits_[4];
+};
+
+// First char of h that is in s or, with negate, that is not.
+inline size_t find_of(const char* h, size_t n, const char* s, size_t m,
+                      bool negate) {
+  if (m == 1 && !negate) {
+    const void* p = std::memchr(h, s[0], n);
+    return p == nullptr ? kNotFound : static_cast<const char*>(p) - h;
+  }
+  const char_set set(s, m);
+  for (size_t i = 0; i < n; ++i) {
+    if (set.contains(h[i]) != negate) return i;
+  }
+  return kNotFound;
+}
+
+// Last char of h that is in s or, with negate, that is not.
+inline size_t rfind_of(const char* h, size_t n, const char* s, size_t m,
+                       bool negate) {
+  const char_set set(s, m);
+  for (size_t i = n; i-- > 0;) {
+    if (set.contains(h[i]) != negate) return i;
+  }
+  return kNotFound;
+}
+
+// Offset of the first char where a and b differ, or n if they do not.
+inline size_t mismatch(const char* a, const char* b, size_t n) {
+  size_t i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (n >= 8) {
+    for (; i + 8 <= n; i += 8) {
+      const uint64_t diff = load_u64(a + i) ^ load_u64(b + i);
+      if (diff != 0) return i + __builtin_ctzll(diff) / 8;
+    }
+    if (i == n) return n;
+    // The last word overlaps words that matched, so its first mismatch is
+    // the first one.
+    const uint64_t diff = load_u64(a + n - 8) ^ load_u64(b + n - 8);
+    return diff == 0 ? n : n - 8 + __builtin_ctzll(diff) / 8;
+  }
+  if (n >= 4) {
+    uint32_t diff = load_u32(a) ^ load_u32(b);
+    if (diff != 0) return __builtin_ctz(diff) / 8;
+    diff = load_u32(a + n - 4) ^ load_u32(b + n - 4);
+    return diff == 0 ? n : n - 4 + __builtin_ctz(diff) / 8;
+  }
+#endif
+  while (i < n && a[i] == b[i]) ++i;
+  return i;
+}
+
+// memcmp's pointers must be valid even when n is 0, and those of empty
+// views may be null.
+inline int compare(const char* a, const char* b, size_t n) {
+  if (n == 0) return 0;
+  return std::memcmp(a, b, n);
+}
+
+// Number of chars of h[0, n) equal to c. Eight chars at a time: the bytes of
+// a word equal to c are the zero bytes of its xor with c in every byte.
+inline size_t count(const char* h, size_t n, char c) {
+  const uint64_t kOnes = 0x0101010101010101;
+  const uint64_t kLow7 = 0x7f7f7f7f7f7f7f7f;
+  const uint64_t pattern = kOnes * static_cast<unsigned char>(c);
+  size_t total = 0;
+  size_t i = 0;
+  while (n - i >= 8) {
+    // Up to 31 words keep each byte of acc, and the sum of its bytes, below
+    // 256.
+    const size_t end = i + 8 * std::min<size_t>((n - i) / 8, 31);
+    uint64_t acc = 0;
+    for (; i < end; i += 8) {
+      const uint64_t x = load_u64(h + i) ^ pattern;
+      // Low bit of each byte set when the byte of x is 0.
+      acc += (~(((x & kLow7) + kLow7) | x) & ~kLow7) >> 7;
+    }
+    total += (acc * kOnes) >> 56;
+  }
+  for (; i < n; ++i) total += h[i] == c;
+  return total;
+}
+
+inline void hash_stripe(uint64_t* acc, const char* p) {
+  for (size_t j = 0; j < 4; ++j) {
+    const uint64_t d = load_u64(p + 8 * j);
+    const uint64_t dk = d ^ kHashKeys[j];
+    acc[j] += (dk & 0xffffffff) * (dk >> 32);
+    acc[j ^ 1] += d;
+  }
+}
+
+inline uint64_t hash(const char* p, size_t n) {
+  if (n <= 32) return hash_short(p, n);
+  uint64_t acc[4] = {kHashKeys[0], kHashKeys[1], kHashKeys[2], kHashKeys[3]};
+  for (size_t i = 0; i + 32 < n; i += 32) hash_stripe(acc, p + i);
+  hash_stripe(acc, p + n - 32);
+  return hash_finish(acc, n);
+}
+
+}  // namespace scalar
+
+#if DAVID_HAS_X86_KERNELS
+
+namespace sse2 {
+
+#define DAVID_KERNEL_TARGET __attribute__((target("sse2")))
+
+typedef __m128i block;
+const size_t kBlock = 16;
+
+DAVID_KERNEL_TARGET inline block load_block(const char* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+DAVID_KERNEL_TARGET inline uint64_t eq_mask(block b, char c) {
+  return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(b, _mm_set1_epi8(c))));
+}
+
+DAVID_KERNEL_TARGET inline uint64_t eq_mask(block a, block b) {
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+}
+
+#include "types/internal/string_kernels_simd.h"
+
+DAVID_KERNEL_TARGET inline uint64_t hash(const char* p, size_t n) {
+  if (n <= 32) return hash_short(p, n);
+  const __m128i key_lo = load_block(reinterpret_cast<const char*>(kHashKeys));
+  const __m128i key_hi =
+      load_block(reinterpret_cast<const char*>(kHashKeys + 2));
+  __m128i acc_lo = key_lo;
+  __m128i acc_hi = key_hi;
+  size_t i = 0;
+  for (;; i += 32) {
+    if (i + 32 >= n) i = n - 32;
+    const __m128i d_lo = load_block(p + i);
+    const __m128i d_hi = load_block(p + i + 16);
+    const __m128i dk_lo = _mm_xor_si128(d_lo, key_lo);
+    const __m128i dk_hi = _mm_xor_si128(d_hi, key_hi);
+    acc_lo = _mm_add_epi64(
+        acc_lo, _mm_mul_epu32(dk_lo, _mm_srli_epi64(dk_lo, 32)));
+    acc_hi = _mm_add_epi64(
+        acc_hi, _mm_mul_epu32(dk_hi, _mm_srli_epi64(dk_hi, 32)));
+    acc_lo = _mm_add_epi64(acc_lo, _mm_shuffle_epi32(d_lo, 0x4e));
+    acc_hi = _mm_add_epi64(acc_hi, _mm_shuffle_epi32(d_hi, 0x4e));
+    if (i == n - 32) break;
+  }
+  uint64_t acc[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(acc), acc_lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2), acc_hi);
+  return hash_finish(acc, n);
+}
+
+#undef DAVID_KERNEL_TARGET
+
+}  // namespace sse2
+
+namespace avx2 {
+
+// Every CPU with AVX2 has POPCNT.
+#define DAVID_KERNEL_TARGET __attribute__((target("avx2,popcnt")))
+
+typedef __m256i block;
+const size_t kBlock = 32;
+
+DAVID_KERNEL_TARGET inline block load_block(const char* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+DAVID_KERNEL_TARGET inline uint64_t eq_mask(block b, char c) {
+  return static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(c))));
+}
+
+DAVID_KERNEL_TARGET inline uint64_t eq_mask(block a, block b) {
+  return static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+}
+
+#include "types/internal/string_kernels_simd.h"
+
+DAVID_KERNEL_TARGET inline uint64_t hash(const char* p, size_t n) {
+  if (n <= 32) return hash_short(p, n);
+  const __m256i key = load_block(reinterpret_cast<const char*>(kHashKeys));
+  __m256i acc = key;
+  size_t i = 0;
+  for (;; i += 32) {
+    if (i + 32 >= n) i = n - 32;
+    const __m256i d = load_block(p + i);
+    const __m256i dk = _mm256_xor_si256(d, key);
+    acc = _mm256_add_epi64(acc,
+                           _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32)));
+    acc = _mm256_add_epi64(acc, _mm256_shuffle_epi32(d, 0x4e));
+    if (i == n - 32) break;
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+  return hash_finish(lanes, n);
+}
+
+#undef DAVID_KERNEL_TARGET
+
+}  // namespace avx2
+
+namespace avx512 {
+
+#define DAVID_KERNEL_TARGET \
+  __attribute__((target("avx512f,avx512bw,popcnt")))
+
+typedef __m512i block;
+const size_t kBlock = 64;
+
+DAVID_KERNEL_TARGET inline block load_block(const char* p) {
+  return _mm512_loadu_si512(p);
+}
+
+DAVID_KERNEL_TARGET inline uint64_t eq_mask(block b, char c) {
+  return _mm512_cmpeq_epi8_mask(b, _mm512_set1_epi8(c));
+}
+
+DAVID_KERNEL_TARGET inline uint64_t eq_mask(block a, block b) {
+  return _mm512_cmpeq_epi8_mask(a, b);
+}
+
+#include "types/internal/string_kernels_simd.h"
+
+// Wider stripes would change the hash, so this tier hashes with AVX2.
+using avx2::hash;
+
+#undef DAVID_KERNEL_TARGET
+
+}  // namespace avx512
+
+#endif  // DAVID_HAS_X86_KERNELS
+
+}  // namespace internal
+}  // namespace david
+
+#endif  // TYPES_INTERNAL_STRING_KERNELS
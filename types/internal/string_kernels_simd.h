@@ -0,0 +1,125 @@
+// Vector kernels shared by the x86 tiers of string_kernels.h. Not a regular
+// header: string_kernels.h includes it once per tier, in the namespace of the
+// tier, after defining
+//
+//   DAVID_KERNEL_TARGET          the target attribute of the tier
+//   block, kBlock                the vector type and its width in chars
+//   block load_block(const char*)
+//   uint64_t eq_mask(block, char)
+//   uint64_t eq_mask(block, block)
+//
+// where the masks have bit i set when char i of the block matches. The
+// kernels take the same arguments as those of internal::scalar, and leave
+// the ends that do not fill a block to them.
+
+const uint64_t kBlockMask = ~uint64_t(0) >> (64 - kBlock);
+
+// Candidates are the offsets whose first and last chars match those of the
+// needle, which rules out most offsets without comparing the whole needle.
+DAVID_KERNEL_TARGET inline size_t find(const char* h, size_t n, const char* s,
+                                       size_t m) {
+  if (m == 1) return scalar::find(h, n, s, m);
+  const char first = s[0];
+  const char last = s[m - 1];
+  size_t i = 0;
+  for (; i + m - 1 + kBlock <= n; i += kBlock) {
+    uint64_t mask = eq_mask(load_block(h + i), first) &
+                    eq_mask(load_block(h + i + m - 1), last);
+    while (mask != 0) {
+      const size_t at = i + __builtin_ctzll(mask);
+      if (std::memcmp(h + at + 1, s + 1, m - 2) == 0) return at;
+      mask &= mask - 1;
+    }
+  }
+  if (n - i < m) return kNotFound;
+  const size_t found = scalar::find(h + i, n - i, s, m);
+  return found == kNotFound ? kNotFound : i + found;
+}
+
+DAVID_KERNEL_TARGET inline size_t rfind(const char* h, size_t n,
+                                        const char* s, size_t m) {
+  const char first = s[0];
+  const char last = s[m - 1];
+  // Candidates left to check are [0, end).
+  size_t end = n - m + 1;
+  while (end >= kBlock) {
+    const size_t i = end - kBlock;
+    uint64_t mask = eq_mask(load_block(h + i), first) &
+                    eq_mask(load_block(h + i + m - 1), last);
+    while (mask != 0) {
+      const size_t bit = 63 - __builtin_clzll(mask);
+      if (std::memcmp(h + i + bit + 1, s + 1, m - 1) == 0) return i + bit;
+      mask ^= uint64_t(1) << bit;
+    }
+    end = i;
+  }
+  return end == 0 ? kNotFound : scalar::rfind(h, end + m - 1, s, m);
+}
+
+DAVID_KERNEL_TARGET inline uint64_t set_mask(block b, const char* s,
+                                             size_t m, bool negate) {
+  uint64_t mask = 0;
+  for (size_t j = 0; j < m; ++j) mask |= eq_mask(b, s[j]);
+  return negate ? ~mask & kBlockMask : mask;
+}
+
+DAVID_KERNEL_TARGET inline size_t find_of(const char* h, size_t n,
+                                          const char* s, size_t m,
+                                          bool negate) {
+  if (m > kMaxVectorSetSize) return scalar::find_of(h, n, s, m, negate);
+  size_t i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    const uint64_t mask = set_mask(load_block(h + i), s, m, negate);
+    if (mask != 0) return i + __builtin_ctzll(mask);
+  }
+  const size_t found = scalar::find_of(h + i, n - i, s, m, negate);
+  return found == kNotFound ? kNotFound : i + found;
+}
+
+DAVID_KERNEL_TARGET inline size_t rfind_of(const char* h, size_t n,
+                                           const char* s, size_t m,
+                                           bool negate) {
+  if (m > kMaxVectorSetSize) return scalar::rfind_of(h, n, s, m, negate);
+  size_t end = n;
+  for (; end >= kBlock; end -= kBlock) {
+    const uint64_t mask =
+        set_mask(load_block(h + end - kBlock), s, m, negate);
+    if (mask != 0) return end - kBlock + 63 - __builtin_clzll(mask);
+  }
+  return scalar::rfind_of(h, end, s, m, negate);
+}
+
+DAVID_KERNEL_TARGET inline size_t mismatch(const char* a, const char* b,
+                                           size_t n) {
+  if (n < kBlock) return scalar::mismatch(a, b, n);
+  size_t i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    const uint64_t diff =
+        ~eq_mask(load_block(a + i), load_block(b + i)) & kBlockMask;
+    if (diff != 0) return i + __builtin_ctzll(diff);
+  }
+  if (i == n) return n;
+  // As in scalar::mismatch, the last block overlaps blocks that matched.
+  const uint64_t diff =
+      ~eq_mask(load_block(a + n - kBlock), load_block(b + n - kBlock)) &
+      kBlockMask;
+  return diff == 0 ? n : n - kBlock + __builtin_ctzll(diff);
+}
+
+// The masks of 64 / kBlock blocks fill a word, which takes one popcount.
+DAVID_KERNEL_TARGET inline size_t count(const char* h, size_t n, char c) {
+  size_t total = 0;
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    uint64_t mask = 0;
+    for (size_t j = 0; j < 64; j += kBlock) {
+      mask |= eq_mask(load_block(h + i + j), c) << j;
+    }
+    total += __builtin_popcountll(mask);
+  }
+  return total + scalar::count(h + i, n - i, c);
+}
+
+// memcmp is faster than a compare built on mismatch, at every size: the C
+// library already picks a vector implementation for the CPU.
+using scalar::compare;
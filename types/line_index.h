@@ -0,0 +1,248 @@
+#ifndef TYPES_LINE_INDEX
+#define TYPES_LINE_INDEX
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "types/internal/little_endian.h"
+#include "types/string_view.h"
+#include "types/thread_pool.h"
+
+namespace david {
+
+struct line_index_options {
+  // Lines per entry of the offset table. line(n) scans forward over up to
+  // sample_interval - 1 lines from the entry before it. Must be at least 1.
+  size_t sample_interval = 64;
+  // Pool that builds the index. nullptr builds it on the calling thread.
+  thread_pool* pool = nullptr;
+  // Bytes of text per task when a pool is used.
+  size_t chunk_size = 4 << 20;
+};
+
+namespace internal {
+
+// Offset of the char after the first k + 1 chars equal to c in s, that is
+// the start of line k + 1 for '\n', or npos if s has k or fewer of them.
+inline size_t skip_chars(string_view s, char c, size_t k) {
+  static const size_t kBlock = 256;
+  size_t pos = 0;
+  // Blocks that hold at most k of them are skipped whole, by count.
+  while (s.size() - pos > kBlock) {
+    const size_t in_block = count(s.substr_unchecked(pos, kBlock), c);
+    if (in_block > k) break;
+    k -= in_block;
+    pos += kBlock;
+  }
+  for (;; --k) {
+    pos = s.find(c, pos);
+    if (pos == string_view::npos) return pos;
+    ++pos;
+    if (k == 0) return pos;
+  }
+}
+
+}  // namespace internal
+
+// Random access to the lines of a text, such as a mapped file of several
+// GB, without a table of every line: the index keeps the offset of one line
+// in sample_interval, and line(n) finds the others by scanning forward from
+// the sample before them, a block of chars at a time.
+//
+// Lines end with '\n', which is not part of them. The last line needs no
+// '\n': a text of "a\nb" has two lines, as does one of "a\nb\n".
+//
+//   const line_index index(text);
+//   for (size_t n = 0; n < index.size(); ++n) use(index.line(n));
+//
+// The index is one flat buffer, returned by bytes(). Write it next to the
+// file and attach an index to both with from_bytes(), which reads nothing
+// but the header. The layout, with integers little-endian:
+//
+//   char magic[4] = "LIDX"  uint32 version  uint64 text_size
+//   uint64 num_lines  uint32 sample_interval  uint32 reserved
+//   uint64 samples[(num_lines + sample_interval - 1) / sample_interval]
+//
+// where samples[j] is the offset of line j * sample_interval.
+class line_index {
+ public:
+  static const uint32_t kVersion = 1;
+
+  // Indexes text, which is not copied and must outlive the index. Throws
+  // std::invalid_argument if opts.sample_interval is 0 or does not fit 32
+  // bits.
+  explicit line_index(string_view text,
+                      const line_index_options& opts = line_index_options())
+      : line_index(build(text, opts)) {}
+
+  // Copies of an index built in memory own a copy of its bytes; copies of
+  // one made with from_bytes() share the caller's buffer.
+  line_index(const line_index& other)
+      : line_index(other.storage_.empty()
+                       ? from_bytes(other.text_, other.bytes_)
+                       : from_storage(other.text_, other.storage_)) {}
+  line_index& operator=(const line_index& other) {
+    if (this != &other) *this = line_index(other);
+    return *this;
+  }
+  // Moving a vector keeps its buffer, so views into it survive moves.
+  line_index(line_index&&) = default;
+  line_index& operator=(line_index&&) = default;
+
+  // An index of text over bytes produced by bytes() for the same text, such
+  // as a mapped file. The bytes are not copied and must outlive the index.
+  // Checks the header, the size of the buffer and the size of the text, and
+  // throws std::invalid_argument when they do not match; the samples
+  // themselves are trusted.
+  static line_index from_bytes(string_view text, string_view bytes) {
+    if (bytes.size() < kHeaderSize ||
+        std::memcmp(bytes.data(), magic(), 4) != 0) {
+      throw std::invalid_argument("not a line_index");
+    }
+    const char* p = bytes.data();
+    if (internal::load_le32(p + 4) != kVersion) {
+      throw std::invalid_argument("unsupported line_index version");
+    }
+    const uint64_t text_size = internal::load_le64(p + 8);
+    const uint64_t num_lines = internal::load_le64(p + 16);
+    const uint32_t interval = internal::load_le32(p + 24);
+    if (interval == 0 || num_lines > text_size) {
+      throw std::invalid_argument("corrupt line_index header");
+    }
+    if (text_size != text.size()) {
+      throw std::invalid_argument("line_index of another text");
+    }
+    const uint64_t num_samples = (num_lines + interval - 1) / interval;
+    if ((bytes.size() - kHeaderSize) / 8 != num_samples ||
+        (bytes.size() - kHeaderSize) % 8 != 0) {
+      throw std::invalid_argument("line_index size mismatch");
+    }
+
+    line_index index(nullptr);
+    index.text_ = text;
+    index.bytes_ = bytes;
+    index.size_ = num_lines;
+    index.interval_ = interval;
+    index.samples_ = p + kHeaderSize;
+    return index;
+  }
+
+  // The serialized index.
+  string_view bytes() const noexcept { return bytes_; }
+  string_view text() const noexcept { return text_; }
+  size_t sample_interval() const noexcept { return interval_; }
+
+  // Number of lines.
+  size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+  // Line n, without its '\n'. Throws std::out_of_range if n >= size().
+  string_view line(size_t n) const {
+    if (n >= size_) throw std::out_of_range("no such line");
+    size_t begin = internal::load_le64(samples_ + 8 * (n / interval_));
+    if (n % interval_ != 0) {
+      begin += internal::skip_chars(text_.substr_unchecked(begin), '\n',
+                                    n % interval_ - 1);
+    }
+    const size_t end = text_.find('\n', begin);
+    return text_.substr_unchecked(begin, end - begin);
+  }
+
+ private:
+  static const size_t kHeaderSize = 32;
+  static const char* magic() { return "LIDX"; }
+
+  explicit line_index(std::nullptr_t)
+      : size_(0), interval_(1), samples_(nullptr) {}
+
+  static line_index from_storage(string_view text, std::vector<char> bytes) {
+    line_index index =
+        from_bytes(text, string_view(bytes.data(), bytes.size()));
+    index.storage_ = std::move(bytes);
+    return index;
+  }
+
+  // Counts the '\n' of each chunk, then, knowing the number of the first
+  // line of each chunk, finds the samples in it. Both passes run a chunk per
+  // task.
+  static line_index build(string_view text, const line_index_options& opts) {
+    const size_t interval = opts.sample_interval;
+    if (interval == 0 || interval > UINT32_MAX) {
+      throw std::invalid_argument("sample_interval must be in [1, 2^32)");
+    }
+    const bool parallel =
+        opts.pool != nullptr && text.size() > opts.chunk_size;
+    const size_t chunk_size =
+        parallel ? std::max<size_t>(opts.chunk_size, 1) : text.size();
+    const size_t num_chunks =
+        text.empty() ? 0 : (text.size() + chunk_size - 1) / chunk_size;
+    const auto chunk = [&](size_t c) {
+      return text.substr_unchecked(c * chunk_size, chunk_size);
+    };
+    const auto run = [&](const std::function<void(size_t)>& task) {
+      if (parallel) {
+        opts.pool->parallel_for(num_chunks, task);
+      } else {
+        for (size_t c = 0; c < num_chunks; ++c) task(c);
+      }
+    };
+
+    // first_newline[c]: number of '\n' before chunk c.
+    std::vector<size_t> first_newline(num_chunks + 1, 0);
+    run([&](size_t c) { first_newline[c + 1] = count(chunk(c), '\n'); });
+    for (size_t c = 0; c < num_chunks; ++c) {
+      first_newline[c + 1] += first_newline[c];
+    }
+    const size_t newlines = first_newline[num_chunks];
+    const size_t num_lines =
+        newlines + (!text.empty() && text.back() != '\n' ? 1 : 0);
+
+    // Line j * interval, for j >= 1, starts after '\n' number
+    // j * interval - 1, counting from 0.
+    std::vector<uint64_t> samples((num_lines + interval - 1) / interval, 0);
+    run([&](size_t c) {
+      const string_view s = chunk(c);
+      size_t j = (first_newline[c] + interval) / interval;
+      size_t pos = 0;
+      size_t skip = j * interval - 1 - first_newline[c];
+      for (; j < samples.size(); ++j, skip = interval - 1) {
+        const size_t next = internal::skip_chars(s.substr_unchecked(pos),
+                                                 '\n', skip);
+        if (next == string_view::npos) break;
+        pos += next;
+        samples[j] = c * chunk_size + pos;
+      }
+    });
+
+    std::vector<char> bytes;
+    bytes.reserve(kHeaderSize + 8 * samples.size());
+    bytes.insert(bytes.end(), magic(), magic() + 4);
+    internal::append_le32(&bytes, kVersion);
+    internal::append_le64(&bytes, text.size());
+    internal::append_le64(&bytes, num_lines);
+    internal::append_le32(&bytes, static_cast<uint32_t>(interval));
+    internal::append_le32(&bytes, 0);
+    for (const uint64_t sample : samples) {
+      internal::append_le64(&bytes, sample);
+    }
+    return from_storage(text, std::move(bytes));
+  }
+
+  // Owns the bytes of a built index; empty for one from from_bytes().
+  std::vector<char> storage_;
+  string_view bytes_;
+  string_view text_;
+  size_t size_;
+  size_t interval_;
+  const char* samples_;
+};
+
+}  // namespace david
+
+#endif  // TYPES_LINE_INDEX
@@ -0,0 +1,110 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/cpu_dispatch.h"
+#include "types/line_index.h"
+
+namespace david {
+namespace {
+
+// 64 MiB of lines of 0 to 120 chars, as a log file.
+const std::string& log_text() {
+  static const std::string* const text = [] {
+    std::mt19937 rng(42);
+    std::string* s = new std::string;
+    while (s->size() < (64u << 20)) {
+      s->append(rng() % 121, static_cast<char>('a' + rng() % 26));
+      s->push_back('\n');
+    }
+    return s;
+  }();
+  return *text;
+}
+
+bool use_tier(benchmark::State& state) {
+  const cpu_tier tier = static_cast<cpu_tier>(state.range(0));
+  if (!set_cpu_tier(tier)) {
+    state.SkipWithError("tier not supported");
+    return false;
+  }
+  state.SetLabel(cpu_tier_name(tier));
+  return true;
+}
+
+void tiers(benchmark::internal::Benchmark* b) {
+  b->DenseRange(0, static_cast<int>(cpu_tier::kAvx512));
+}
+
+// Counting lines with the find loop that count replaces.
+void BM_FindLoopCount(benchmark::State& state) {
+  const string_view text = log_text();
+  for (auto _ : state) {
+    size_t lines = 0;
+    for (size_t pos = text.find('\n'); pos != string_view::npos;
+         pos = text.find('\n', pos + 1)) {
+      ++lines;
+    }
+    benchmark::DoNotOptimize(lines);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_FindLoopCount);
+
+void BM_Count(benchmark::State& state) {
+  if (!use_tier(state)) return;
+  const string_view text = log_text();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(count(text, '\n'));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Count)->Apply(tiers);
+
+// The table of every line offset that line_index replaces.
+void BM_BuildFullTable(benchmark::State& state) {
+  const string_view text = log_text();
+  for (auto _ : state) {
+    std::vector<size_t> offsets(1, 0);
+    for (size_t pos = text.find('\n'); pos != string_view::npos;
+         pos = text.find('\n', pos + 1)) {
+      offsets.push_back(pos + 1);
+    }
+    benchmark::DoNotOptimize(offsets.data());
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_BuildFullTable)->Unit(benchmark::kMillisecond);
+
+// Build on the calling thread (0) or on the default pool (1).
+void BM_Build(benchmark::State& state) {
+  const string_view text = log_text();
+  line_index_options opts;
+  if (state.range(0) != 0) opts.pool = &thread_pool::default_pool();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(line_index(text, opts).size());
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Build)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// Random lines, for sample intervals of 1, 16, 64 and 256.
+void BM_RandomLine(benchmark::State& state) {
+  const string_view text = log_text();
+  line_index_options opts;
+  opts.sample_interval = state.range(0);
+  const line_index index(text, opts);
+  std::mt19937 rng(7);
+  size_t chars = 0;
+  for (auto _ : state) {
+    chars += index.line(rng() % index.size()).size();
+  }
+  benchmark::DoNotOptimize(chars);
+  state.SetItemsProcessed(state.iterations());
+  state.counters["index_bytes"] = index.bytes().size();
+}
+BENCHMARK(BM_RandomLine)->Arg(1)->Arg(16)->Arg(64)->Arg(256);
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,195 @@
+#include "types/line_index.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+// The lines of text, split on '\n', without an empty line after a final
+// '\n'.
+std::vector<std::string> split_lines(const std::string& text) {
+  std::vector<std::string> lines;
+  size_t begin = 0;
+  while (begin < text.size()) {
+    const size_t end = text.find('\n', begin);
+    if (end == std::string::npos) {
+      lines.push_back(text.substr(begin));
+      break;
+    }
+    lines.push_back(text.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  return lines;
+}
+
+// Lines of 0 to max_size chars, runs of empty lines included, with or
+// without a final '\n'.
+std::string random_text(std::mt19937* rng, size_t num_lines,
+                        size_t max_size) {
+  std::string text;
+  for (size_t i = 0; i < num_lines; ++i) {
+    const size_t size = (*rng)() % 4 == 0 ? 0 : (*rng)() % (max_size + 1);
+    for (size_t j = 0; j < size; ++j) {
+      text.push_back(static_cast<char>('a' + (*rng)() % 26));
+    }
+    if (i + 1 < num_lines || (*rng)() % 2 == 0) text.push_back('\n');
+  }
+  return text;
+}
+
+void expect_lines(const line_index& index, const std::string& text) {
+  const std::vector<std::string> want = split_lines(text);
+  ASSERT_EQ(index.size(), want.size());
+  for (size_t n = 0; n < want.size(); ++n) {
+    ASSERT_EQ(index.line(n), want[n]) << "line " << n;
+  }
+  EXPECT_THROW(index.line(want.size()), std::out_of_range);
+}
+
+TEST(LineIndex, Empty) {
+  const line_index index("");
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(index.size(), 0u);
+  EXPECT_THROW(index.line(0), std::out_of_range);
+}
+
+TEST(LineIndex, Edges) {
+  const line_index no_newline("abc");
+  ASSERT_EQ(no_newline.size(), 1u);
+  EXPECT_EQ(no_newline.line(0), "abc");
+
+  const line_index newline("\n");
+  ASSERT_EQ(newline.size(), 1u);
+  EXPECT_EQ(newline.line(0), "");
+
+  const line_index final_newline("a\nb\n");
+  ASSERT_EQ(final_newline.size(), 2u);
+  EXPECT_EQ(final_newline.line(1), "b");
+
+  const line_index blank("\n\n\nx");
+  ASSERT_EQ(blank.size(), 4u);
+  EXPECT_EQ(blank.line(2), "");
+  EXPECT_EQ(blank.line(3), "x");
+}
+
+TEST(LineIndex, MatchesSplit) {
+  std::mt19937 rng(42);
+  for (size_t interval : {1, 2, 3, 7, 64}) {
+    line_index_options opts;
+    opts.sample_interval = interval;
+    for (int iter = 0; iter < 20; ++iter) {
+      // Long lines, so that line(n) skips whole blocks.
+      const std::string text =
+          random_text(&rng, rng() % 300, iter % 2 == 0 ? 10 : 400);
+      SCOPED_TRACE("interval " + std::to_string(interval));
+      const line_index index(text, opts);
+      EXPECT_EQ(index.sample_interval(), interval);
+      expect_lines(index, text);
+    }
+  }
+}
+
+TEST(LineIndex, ParallelBuild) {
+  std::mt19937 rng(7);
+  thread_pool pool(4);
+  for (size_t chunk_size : {1, 5, 64, 1000}) {
+    for (size_t interval : {1, 3, 64}) {
+      const std::string text = random_text(&rng, 500, 20);
+      line_index_options opts;
+      opts.sample_interval = interval;
+      opts.pool = &pool;
+      opts.chunk_size = chunk_size;
+      const line_index index(text, opts);
+      opts.pool = nullptr;
+      EXPECT_EQ(index.bytes(), line_index(text, opts).bytes())
+          << chunk_size << " " << interval;
+      expect_lines(index, text);
+    }
+  }
+}
+
+TEST(LineIndex, InvalidOptions) {
+  line_index_options opts;
+  opts.sample_interval = 0;
+  EXPECT_THROW(line_index("a\nb", opts), std::invalid_argument);
+}
+
+TEST(LineIndex, Copy) {
+  const std::string text = "one\ntwo\nthree";
+  line_index_options opts;
+  opts.sample_interval = 2;
+  line_index index(text, opts);
+  const line_index copy = index;
+  index = line_index("other", opts);
+  EXPECT_EQ(copy.line(2), "three");
+  EXPECT_EQ(index.line(0), "other");
+}
+
+TEST(LineIndex, FromBytes) {
+  std::mt19937 rng(11);
+  const std::string text = random_text(&rng, 1000, 50);
+  line_index_options opts;
+  opts.sample_interval = 16;
+  const line_index index(text, opts);
+  const std::string bytes(index.bytes().data(), index.bytes().size());
+  EXPECT_EQ(bytes.size(), 32 + 8 * ((index.size() + 15) / 16));
+
+  const line_index loaded = line_index::from_bytes(text, bytes);
+  EXPECT_EQ(loaded.sample_interval(), 16u);
+  expect_lines(loaded, text);
+  const line_index copy = loaded;
+  EXPECT_EQ(copy.bytes().data(), bytes.data());
+
+  EXPECT_THROW(line_index::from_bytes(text, "LIDX"), std::invalid_argument);
+  EXPECT_THROW(line_index::from_bytes(text, string_view(bytes).substr(1)),
+               std::invalid_argument);
+  EXPECT_THROW(line_index::from_bytes(
+                   text, string_view(bytes.data(), bytes.size() - 1)),
+               std::invalid_argument);
+  EXPECT_THROW(line_index::from_bytes(text + "x", bytes),
+               std::invalid_argument);
+  std::string bad_version = bytes;
+  bad_version[4] = 2;
+  EXPECT_THROW(line_index::from_bytes(text, bad_version),
+               std::invalid_argument);
+  std::string bad_interval = bytes;
+  bad_interval[24] = 0;
+  EXPECT_THROW(line_index::from_bytes(text, bad_interval),
+               std::invalid_argument);
+}
+
+TEST(LineIndex, IndexFileNextToText) {
+  std::mt19937 rng(3);
+  const std::string text = random_text(&rng, 2000, 30);
+  const line_index index(text);
+  char path[] = "/tmp/line_index_test.XXXXXX";
+  const int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(write(fd, index.bytes().data(), index.bytes().size()),
+            static_cast<ssize_t>(index.bytes().size()));
+  void* mapping =
+      mmap(nullptr, index.bytes().size(), PROT_READ, MAP_PRIVATE, fd, 0);
+  ASSERT_NE(mapping, MAP_FAILED);
+
+  const line_index mapped = line_index::from_bytes(
+      text,
+      string_view(static_cast<const char*>(mapping), index.bytes().size()));
+  expect_lines(mapped, text);
+
+  munmap(mapping, index.bytes().size());
+  close(fd);
+  unlink(path);
+}
+
+}  // namespace
+}  // namespace david
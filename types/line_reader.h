@@ -0,0 +1,271 @@
+#ifndef TYPES_LINE_READER
+#define TYPES_LINE_READER
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "types/string_view.h"
+
+namespace david {
+
+struct line_reader_options {
+  // Char that ends each record. It is not part of the records.
+  char delimiter = '\n';
+  // Size of each of the two read buffers.
+  size_t buffer_size = 1 << 20;
+  // Whether a background thread reads the next buffer while the current one
+  // is being scanned. Without it, reads happen inside next().
+  bool prefetch = true;
+};
+
+// Splits the bytes read from a file descriptor into records, for inputs that
+// cannot be mapped, such as pipes, sockets or stdin.
+//
+//   line_reader reader(STDIN_FILENO);
+//   string_view line;
+//   while (reader.next(&line)) ...
+//
+// The input is read in large chunks into two buffers: while one is scanned,
+// a background thread reads into the other. Records are found with memchr,
+// which is vectorized, and handed out as views into the buffer, so most
+// records are neither copied nor allocated. A record that straddles two
+// chunks is put together in a side buffer.
+//
+// A record stays valid until the reader moves on to the next chunk, which
+// may happen on any call to next(): copy records that must live longer. The
+// last record needs no delimiter. The reader does not own or close fd.
+//
+// The background thread waits for input with poll() on fd and on a pipe of
+// its own, so a reader can be destroyed while the thread waits on an idle
+// pipe or socket whose writer is still open.
+class line_reader {
+ public:
+  // Throws std::invalid_argument if opts.buffer_size is 0, and
+  // std::system_error if the background thread cannot be set up.
+  explicit line_reader(int fd,
+                       const line_reader_options& opts = line_reader_options())
+      : fd_(fd),
+        opts_(opts),
+        current_(0),
+        pos_(0),
+        has_chunk_(false),
+        carrying_(false),
+        done_(false),
+        stop_(false) {
+    if (opts_.buffer_size == 0) {
+      throw std::invalid_argument("line_reader needs a buffer");
+    }
+    chunks_[0].data.reset(new char[opts_.buffer_size]);
+    wake_[0] = wake_[1] = -1;
+    if (opts_.prefetch) {
+      chunks_[1].data.reset(new char[opts_.buffer_size]);
+      if (::pipe2(wake_, O_CLOEXEC) != 0) {
+        throw std::system_error(errno, std::generic_category(),
+                                "line_reader: pipe failed");
+      }
+      try {
+        producer_ = std::thread(&line_reader::produce, this);
+      } catch (...) {
+        // The destructor does not run for a constructor that throws.
+        ::close(wake_[0]);
+        ::close(wake_[1]);
+        throw;
+      }
+    }
+  }
+
+  line_reader(const line_reader&) = delete;
+  line_reader& operator=(const line_reader&) = delete;
+
+  // Stops the background thread, waking it if it waits for input, and
+  // joins it.
+  ~line_reader() {
+    if (producer_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+      }
+      changed_.notify_all();
+      const char byte = 0;
+      while (::write(wake_[1], &byte, 1) < 0 && errno == EINTR) {
+      }
+      producer_.join();
+    }
+    if (wake_[0] != -1) {
+      ::close(wake_[0]);
+      ::close(wake_[1]);
+    }
+  }
+
+  // Sets *line to the next record and returns true, or returns false at the
+  // end of the input. Throws std::system_error if reading fails.
+  bool next(string_view* line) {
+    for (;;) {
+      if (!has_chunk_ && !acquire_chunk()) {
+        if (!carrying_) return false;
+        carrying_ = false;
+        *line = carry_;
+        return true;
+      }
+
+      const chunk& c = chunks_[current_];
+      const char* begin = c.data.get() + pos_;
+      const size_t left = c.size - pos_;
+      const char* end = static_cast<const char*>(
+          std::memchr(begin, opts_.delimiter, left));
+      if (end != nullptr) {
+        pos_ += end - begin + 1;
+        if (carrying_) {
+          carrying_ = false;
+          carry_.append(begin, end - begin);
+          *line = carry_;
+        } else {
+          *line = string_view(begin, end - begin);
+        }
+        return true;
+      }
+
+      // The record goes on in the next chunk.
+      if (left > 0) {
+        if (!carrying_) carry_.clear();
+        carrying_ = true;
+        carry_.append(begin, left);
+      }
+      release_chunk();
+    }
+  }
+
+ private:
+  enum class chunk_state { kFree, kFilling, kReady };
+
+  struct chunk {
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    // The chunk is empty because the input ended or reading failed.
+    bool eof = false;
+    int error = 0;
+    chunk_state state = chunk_state::kFree;
+  };
+
+  // Reads the next chunk into c. Returns false, leaving c as it was, if
+  // the reader is being destroyed.
+  bool fill(chunk* c) {
+    if (opts_.prefetch && !wait_readable()) return false;
+    ssize_t n;
+    do {
+      n = ::read(fd_, c->data.get(), opts_.buffer_size);
+    } while (n < 0 && errno == EINTR);
+    c->size = n > 0 ? static_cast<size_t>(n) : 0;
+    c->eof = n <= 0;
+    c->error = n < 0 ? errno : 0;
+    return true;
+  }
+
+  // Waits until a read of fd_ would not block, or returns false when the
+  // destructor writes to the wake pipe. Errors are left for read() to
+  // report.
+  bool wait_readable() {
+    if (fd_ < 0) return true;
+    pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+    while (::poll(fds, 2, -1) < 0) {
+      if (errno != EINTR) return true;
+    }
+    return fds[1].revents == 0;
+  }
+
+  // Makes the next chunk current, or returns false at the end of the input.
+  bool acquire_chunk() {
+    if (done_) return false;
+    if (opts_.prefetch) {
+      std::unique_lock<std::mutex> lock(mu_);
+      changed_.wait(lock, [this] {
+        return chunks_[current_].state == chunk_state::kReady;
+      });
+    } else {
+      fill(&chunks_[current_]);
+    }
+
+    const chunk& c = chunks_[current_];
+    if (c.error != 0) {
+      done_ = true;
+      throw std::system_error(c.error, std::generic_category(),
+                              "line_reader: read failed");
+    }
+    if (c.eof) {
+      done_ = true;
+      return false;
+    }
+    has_chunk_ = true;
+    pos_ = 0;
+    return true;
+  }
+
+  // Hands the current chunk back to the background thread.
+  void release_chunk() {
+    has_chunk_ = false;
+    if (!opts_.prefetch) return;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      chunks_[current_].state = chunk_state::kFree;
+    }
+    changed_.notify_all();
+    current_ ^= 1;
+  }
+
+  // Background thread: fills chunks in turn until the input ends.
+  void produce() {
+    for (size_t i = 0;; i ^= 1) {
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        changed_.wait(lock, [this, i] {
+          return stop_ || chunks_[i].state == chunk_state::kFree;
+        });
+        if (stop_) return;
+        chunks_[i].state = chunk_state::kFilling;
+      }
+      if (!fill(&chunks_[i])) return;
+      const bool last = chunks_[i].eof;
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        chunks_[i].state = chunk_state::kReady;
+      }
+      changed_.notify_all();
+      if (last) return;
+    }
+  }
+
+  const int fd_;
+  const line_reader_options opts_;
+  chunk chunks_[2];
+  // Consumer state: the chunk being scanned and the position in it.
+  size_t current_;
+  size_t pos_;
+  bool has_chunk_;
+  // Whether carry_ holds the start of a record from earlier chunks.
+  bool carrying_;
+  bool done_;
+  std::string carry_;
+
+  std::mutex mu_;
+  std::condition_variable changed_;
+  bool stop_;
+  // Written to by the destructor to wake the background thread from poll().
+  int wake_[2];
+  std::thread producer_;
+};
+
+}  // namespace david
+
+#endif  // TYPES_LINE_READER
@@ -0,0 +1,93 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "types/line_reader.h"
+
+namespace david {
+namespace {
+
+const size_t kFileSize = 64 << 20;
+
+// A temporary file of log-like lines, created once.
+const std::string& data_file() {
+  static const std::string path = [] {
+    char path[] = "/tmp/line_reader_benchmark.XXXXXX";
+    const int fd = mkstemp(path);
+    std::mt19937 rng(1);
+    std::string data;
+    while (data.size() < kFileSize) {
+      data.append(20 + rng() % 100, 'a' + rng() % 26);
+      data.push_back('\n');
+    }
+    if (write(fd, data.data(), data.size()) !=
+        static_cast<ssize_t>(data.size())) {
+      std::abort();
+    }
+    close(fd);
+    return std::string(path);
+  }();
+  return path;
+}
+
+void BM_Getline(benchmark::State& state) {
+  const std::string& path = data_file();
+  for (auto _ : state) {
+    std::ifstream in(path);
+    std::string line;
+    size_t total = 0;
+    while (std::getline(in, line)) total += line.size();
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetBytesProcessed(state.iterations() * kFileSize);
+}
+BENCHMARK(BM_Getline)->Unit(benchmark::kMillisecond);
+
+void BM_LineReaderFile(benchmark::State& state) {
+  const std::string& path = data_file();
+  line_reader_options opts;
+  opts.prefetch = state.range(0);
+  for (auto _ : state) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    size_t total = 0;
+    {
+      line_reader reader(fd, opts);
+      string_view line;
+      while (reader.next(&line)) total += line.size();
+    }
+    close(fd);
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetBytesProcessed(state.iterations() * kFileSize);
+}
+BENCHMARK(BM_LineReaderFile)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// The file piped through cat, as stdin would be.
+void BM_LineReaderPipe(benchmark::State& state) {
+  const std::string command = "cat " + data_file();
+  line_reader_options opts;
+  opts.prefetch = state.range(0);
+  for (auto _ : state) {
+    FILE* pipe = popen(command.c_str(), "r");
+    size_t total = 0;
+    {
+      line_reader reader(fileno(pipe), opts);
+      string_view line;
+      while (reader.next(&line)) total += line.size();
+    }
+    pclose(pipe);
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetBytesProcessed(state.iterations() * kFileSize);
+}
+BENCHMARK(BM_LineReaderPipe)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace david
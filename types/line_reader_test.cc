@@ -0,0 +1,190 @@
+#include "types/line_reader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Writes data to a pipe from another thread, in pieces of random sizes, and
+// reads it back with a line_reader.
+std::vector<std::string> read_through_pipe(const std::string& data,
+                                           const line_reader_options& opts) {
+  int fds[2];
+  EXPECT_EQ(pipe(fds), 0);
+  std::thread writer([&data, fds] {
+    std::mt19937 rng(data.size());
+    size_t pos = 0;
+    while (pos < data.size()) {
+      const size_t n = std::min<size_t>(1 + rng() % 100, data.size() - pos);
+      const ssize_t written = write(fds[1], data.data() + pos, n);
+      if (written <= 0) break;
+      pos += written;
+    }
+    close(fds[1]);
+  });
+
+  std::vector<std::string> lines;
+  {
+    line_reader reader(fds[0], opts);
+    string_view line;
+    while (reader.next(&line)) {
+      lines.push_back(std::string(line.data(), line.size()));
+    }
+  }
+  writer.join();
+  close(fds[0]);
+  return lines;
+}
+
+std::vector<std::string> read_lines(const std::string& data,
+                                    size_t buffer_size, bool prefetch,
+                                    char delimiter = '\n') {
+  line_reader_options opts;
+  opts.buffer_size = buffer_size;
+  opts.prefetch = prefetch;
+  opts.delimiter = delimiter;
+  return read_through_pipe(data, opts);
+}
+
+// Splits data the way line_reader should.
+std::vector<std::string> split(const std::string& data, char delimiter) {
+  std::vector<std::string> lines;
+  size_t begin = 0;
+  while (begin < data.size()) {
+    size_t end = data.find(delimiter, begin);
+    if (end == std::string::npos) end = data.size();
+    lines.push_back(data.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  return lines;
+}
+
+TEST(LineReader, EmptyInput) {
+  EXPECT_THAT(read_lines("", 16, true), IsEmpty());
+  EXPECT_THAT(read_lines("", 16, false), IsEmpty());
+}
+
+TEST(LineReader, SplitsLines) {
+  for (bool prefetch : {false, true}) {
+    EXPECT_THAT(read_lines("a\nbc\n\nd\n", 1024, prefetch),
+                ElementsAre("a", "bc", "", "d"));
+    EXPECT_THAT(read_lines("no newline", 1024, prefetch),
+                ElementsAre("no newline"));
+    EXPECT_THAT(read_lines("\n", 1024, prefetch), ElementsAre(""));
+  }
+}
+
+TEST(LineReader, RecordsStraddlingChunks) {
+  const std::string data = "0123456789\nab\n\n0123456789012345678901234\nx";
+  for (size_t buffer_size : {1, 2, 3, 7, 11, 64}) {
+    for (bool prefetch : {false, true}) {
+      EXPECT_EQ(read_lines(data, buffer_size, prefetch), split(data, '\n'))
+          << buffer_size << " " << prefetch;
+    }
+  }
+}
+
+TEST(LineReader, CustomDelimiter) {
+  const std::string data("a\0b\nc\0\0d", 8);
+  EXPECT_THAT(read_lines(data, 4, true, '\0'),
+              ElementsAre("a", "b\nc", "", "d"));
+}
+
+TEST(LineReader, LargeRandomInput) {
+  std::mt19937 rng(9);
+  std::string data;
+  while (data.size() < (1 << 20)) {
+    data.append(rng() % 200, 'x');
+    data.push_back('\n');
+  }
+  EXPECT_EQ(read_lines(data, 4096, true), split(data, '\n'));
+  EXPECT_EQ(read_lines(data, 4096, false), split(data, '\n'));
+}
+
+TEST(LineReader, ReadsFiles) {
+  char path[] = "/tmp/line_reader_test.XXXXXX";
+  const int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  const std::string data = "first\nsecond\nthird";
+  ASSERT_EQ(write(fd, data.data(), data.size()),
+            static_cast<ssize_t>(data.size()));
+  ASSERT_EQ(lseek(fd, 0, SEEK_SET), 0);
+
+  std::vector<std::string> lines;
+  line_reader reader(fd);
+  string_view line;
+  while (reader.next(&line)) {
+    lines.push_back(std::string(line.data(), line.size()));
+  }
+  EXPECT_THAT(lines, ElementsAre("first", "second", "third"));
+  EXPECT_FALSE(reader.next(&line));
+  close(fd);
+  unlink(path);
+}
+
+TEST(LineReader, ReportsReadErrors) {
+  for (bool prefetch : {false, true}) {
+    line_reader_options opts;
+    opts.prefetch = prefetch;
+    line_reader reader(-1, opts);
+    string_view line;
+    EXPECT_THROW(reader.next(&line), std::system_error);
+    EXPECT_FALSE(reader.next(&line));
+  }
+}
+
+TEST(LineReader, StopsEarly) {
+  // Destroying a reader before the end of its input joins the prefetch
+  // thread.
+  const int fd = open("/dev/zero", O_RDONLY);
+  ASSERT_NE(fd, -1);
+  {
+    line_reader_options opts;
+    opts.buffer_size = 1024;
+    line_reader reader(fd, opts);
+  }
+  close(fd);
+}
+
+TEST(LineReader, StopsWhileWaitingForInput) {
+  // The writer stays open and idle, so the prefetch thread waits for input
+  // that never comes; destroying the reader must not wait with it.
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_EQ(write(fds[1], "one\ntwo\n", 8), 8);
+  {
+    line_reader reader(fds[0]);
+    string_view line;
+    ASSERT_TRUE(reader.next(&line));
+    EXPECT_EQ(line, "one");
+  }
+  {
+    // Nothing was ever written.
+    line_reader reader(fds[0]);
+  }
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(LineReader, RejectsEmptyBuffer) {
+  line_reader_options opts;
+  opts.buffer_size = 0;
+  EXPECT_THROW(line_reader(0, opts), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace david
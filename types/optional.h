@@ -4,94 +4,167 @@
 #include <exception>
 #include <iostream>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include "types/internal/enable_copy_move.h"
+#include "types/relocate.h"
 
 namespace david {
 namespace internal {
 
-template <typename T>
+struct in_place_tag {};
+
+// The object lives in a union, so that T needs no default constructor and
+// is only constructed when the optional is engaged. Destroying the storage
+// is trivial when it is for T.
+template <typename T, bool = std::is_trivially_destructible<T>::value>
 class optional_storage {
  public:
-  optional_storage() = default;
+  constexpr optional_storage() noexcept : dummy_(), engaged_(false) {}
+  template <typename... Args>
+  constexpr explicit optional_storage(in_place_tag, Args&&... args)
+      : obj_(std::forward<Args>(args)...), engaged_(true) {}
 
  protected:
-  bool engaged_ = false;
-  // TODO: this doesn't work for non-trivially default constructable objects.
-  // Let's use an union here and some traits magic here.
-  T obj_;
+  void destroy_if_engaged() noexcept { engaged_ = false; }
+
+  union {
+    char dummy_;
+    T obj_;
+  };
+  bool engaged_;
+};
 
+template <typename T>
+class optional_storage<T, false> {
+ public:
+  constexpr optional_storage() noexcept : dummy_(), engaged_(false) {}
+  template <typename... Args>
+  constexpr explicit optional_storage(in_place_tag, Args&&... args)
+      : obj_(std::forward<Args>(args)...), engaged_(true) {}
+  ~optional_storage() { destroy_if_engaged(); }
+
+ protected:
   // Destroys the underlying associated object.
-  // This method is only used for non-trivially destructible objects.
   void destroy_if_engaged() noexcept {
     if (engaged_) {
       engaged_ = false;
       obj_.~T();
     }
   }
+
+  union {
+    char dummy_;
+    T obj_;
+  };
+  bool engaged_;
 };
 
+// Construction and assignment of the object. Other is an optional_storage,
+// as an lvalue to copy or an rvalue to move.
+template <typename T>
+class optional_ops : public optional_storage<T> {
+ public:
+  using optional_storage<T>::optional_storage;
+
+ protected:
+  template <typename... Args>
+  void construct(Args&&... args) {
+    ::new (static_cast<void*>(&this->obj_)) T(std::forward<Args>(args)...);
+    this->engaged_ = true;
+  }
+
+  template <typename Other>
+  void construct_from(Other&& other) {
+    if (other.engaged_) construct(std::forward<Other>(other).obj_);
+  }
+
+  template <typename Other>
+  void assign_from(Other&& other) {
+    if (this->engaged_ && other.engaged_) {
+      this->obj_ = std::forward<Other>(other).obj_;
+    } else if (other.engaged_) {
+      construct(std::forward<Other>(other).obj_);
+    } else {
+      this->destroy_if_engaged();
+    }
+  }
+};
+
+// Trivially copyable types shouldn't have a user-provided copy constructor,
+// otherwise it's no longer a trivial constructor. The same goes for moves.
 template <typename T,
-          bool /* trivial copy */ = std::is_trivially_copy_constructible<
-              T>::value&& std::is_trivially_copy_assignable<T>::value,
-          bool /* trivial move */ = std::is_trivially_move_constructible<
-              T>::value&& std::is_trivially_move_assignable<T>::value>
-class optional_base : public optional_storage<T> {};
-
-// Trivially copy constructible types shouldn't have a copy constructor,
-// otherwise it's no longer a trivial constructor.
+          bool /* trivial copy */ =
+              std::is_trivially_copy_constructible<T>::value &&
+              std::is_trivially_copy_assignable<T>::value &&
+              std::is_trivially_destructible<T>::value,
+          bool /* trivial move */ =
+              std::is_trivially_move_constructible<T>::value &&
+              std::is_trivially_move_assignable<T>::value &&
+              std::is_trivially_destructible<T>::value>
+class optional_base : public optional_ops<T> {
+ public:
+  using optional_ops<T>::optional_ops;
+
+  optional_base() noexcept = default;
+  optional_base(const optional_base& other) { this->construct_from(other); }
+  optional_base(optional_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value) {
+    this->construct_from(std::move(other));
+  }
+  optional_base& operator=(const optional_base& other) {
+    this->assign_from(other);
+    return *this;
+  }
+  optional_base& operator=(optional_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_assignable<T>::value) {
+    this->assign_from(std::move(other));
+    return *this;
+  }
+};
+
 template <typename T>
-class optional_base<T, true, true> : public optional_storage<T> {
+class optional_base<T, true, true> : public optional_ops<T> {
  public:
+  using optional_ops<T>::optional_ops;
+
   optional_base() noexcept = default;
 };
 
 template <typename T>
-class optional_base<T, false, true> : public optional_storage<T> {
+class optional_base<T, false, true> : public optional_ops<T> {
  public:
+  using optional_ops<T>::optional_ops;
+
   optional_base() noexcept = default;
-  optional_base(const optional_base& other) {
-    this->engaged_ = other.engaged_;
-    if (other.engaged_) {
-      this->obj_ = other.obj_;
-    }
-  }
+  optional_base(const optional_base& other) { this->construct_from(other); }
+  optional_base(optional_base&&) = default;
   optional_base& operator=(const optional_base& other) {
-    // TODO: not sure if this is compliant with
-    // https://en.cppreference.com/w/cpp/utility/optional/operator%3D
-    // Specially when other is engaged.
-    if (other.engaged_) {
-      // TODO add a construct function.
-      this->engaged = true;
-      this->obj_ = other.obj_;
-    } else {
-      this->destroy_if_engaged();
-    }
+    this->assign_from(other);
     return *this;
   }
+  optional_base& operator=(optional_base&&) = default;
 };
 
 template <typename T>
-class optional_base<T, true, false> : public optional_storage<T> {
+class optional_base<T, true, false> : public optional_ops<T> {
  public:
+  using optional_ops<T>::optional_ops;
+
   optional_base() noexcept = default;
-  optional_base(optional_base&& other) {
-    this->engaged_ = other.engaged_;
-    if (other.engaged_) {
-      this->obj_ = std::move(other.obj_);
-    }
+  optional_base(const optional_base&) = default;
+  optional_base(optional_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value) {
+    this->construct_from(std::move(other));
   }
-  optional_base& operator=(optional_base&& other) noexcept {
-    // TODO: not sure if this is compliant with
-    // https://en.cppreference.com/w/cpp/utility/optional/operator%3D
-    // Specially when other is engaged.
-    if (other.engaged_) {
-      // TODO add a construct function.
-      this->engaged_ = true;
-      this->obj_ = std::move(other.obj_);
-    } else {
-      this->destroy_if_engaged();
-    }
+  optional_base& operator=(const optional_base&) = default;
+  optional_base& operator=(optional_base&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_assignable<T>::value) {
+    this->assign_from(std::move(other));
     return *this;
   }
 };
@@ -107,6 +180,9 @@ struct nullopt_t {
 static const nullopt_t nullopt{0};
 
 // Interface from https://en.cppreference.com/w/cpp/utility/optional
+//
+// An optional is trivially relocatable when T is, so that containers of
+// optionals move with memcpy, see types/relocate.h.
 template <typename T>
 class optional
     : private internal::optional_base<T>,
@@ -114,17 +190,161 @@ class optional
                                          std::is_copy_assignable<T>::value,
                                          std::is_move_constructible<T>::value,
                                          std::is_move_assignable<T>::value> {
+  using base = internal::optional_base<T>;
+
  public:
+  using value_type = T;
+  using trivially_relocatable = internal::trivially_relocatable_if<
+      is_trivially_relocatable<T>::value, optional>;
+
   // Constructors.
-  optional() noexcept = default;
-  optional(nullopt_t) noexcept {};
+  constexpr optional() noexcept = default;
+  constexpr optional(nullopt_t) noexcept {}
+  template <typename U = T,
+            typename = typename std::enable_if<
+                std::is_constructible<T, U&&>::value &&
+                !std::is_same<typename std::decay<U>::type,
+                              optional>::value &&
+                !std::is_same<typename std::decay<U>::type,
+                              nullopt_t>::value>::type>
+  constexpr optional(U&& value)
+      : base(internal::in_place_tag(), std::forward<U>(value)) {}
 
   // Copy assignment.
-  optional& operator=(nullopt_t) noexcept { this->destroy_if_engaged(); }
+  optional& operator=(nullopt_t) noexcept {
+    this->destroy_if_engaged();
+    return *this;
+  }
+
+  // Modifiers.
+  template <typename... Args>
+  T& emplace(Args&&... args) {
+    this->destroy_if_engaged();
+    this->construct(std::forward<Args>(args)...);
+    return this->obj_;
+  }
+  void reset() noexcept { this->destroy_if_engaged(); }
 
   // Observers.
   explicit operator bool() const noexcept { return this->engaged_; }
   bool has_value() const noexcept { return this->engaged_; }
+
+  // The object, which must be there.
+  const T& operator*() const& noexcept { return this->obj_; }
+  T& operator*() & noexcept { return this->obj_; }
+  T&& operator*() && noexcept { return std::move(this->obj_); }
+  const T* operator->() const noexcept { return &this->obj_; }
+  T* operator->() noexcept { return &this->obj_; }
+};
+
+namespace internal {
+
+// The optional that transform() returns for a function result R: of a
+// reference when R is an lvalue reference, so that no value is copied.
+template <typename R>
+using optional_result = optional<typename std::conditional<
+    std::is_lvalue_reference<R>::value, R,
+    typename std::remove_cv<
+        typename std::remove_reference<R>::type>::type>::type>;
+
+}  // namespace internal
+
+// An optional reference to a T, as a pointer that may be null. It is the
+// size of a pointer and trivially copyable, so that lookups return it in a
+// register instead of a copy of the value.
+//
+// Like a pointer, and unlike a T&, assigning another optional rebinds it
+// instead of assigning the object it refers to. It does not bind to
+// temporaries.
+template <typename T>
+class optional<T&> {
+ public:
+  using value_type = T&;
+
+  // Constructors.
+  constexpr optional() noexcept = default;
+  constexpr optional(nullopt_t) noexcept {}
+  template <typename U,
+            typename = typename std::enable_if<
+                std::is_convertible<U*, T*>::value>::type>
+  constexpr optional(U& value) noexcept : ptr_(std::addressof(value)) {}
+  template <typename U,
+            typename = typename std::enable_if<
+                std::is_convertible<U*, T*>::value>::type>
+  constexpr optional(const optional<U&>& other) noexcept
+      : ptr_(other.operator->()) {}
+  optional(typename std::remove_const<T>::type&&) = delete;
+
+  // Refers to *ptr, or to nothing if ptr is null.
+  constexpr explicit optional(T* ptr) noexcept : ptr_(ptr) {}
+
+  // Assignment rebinds.
+  optional& operator=(nullopt_t) noexcept {
+    ptr_ = nullptr;
+    return *this;
+  }
+
+  // Modifiers.
+  template <typename U,
+            typename = typename std::enable_if<
+                std::is_convertible<U*, T*>::value>::type>
+  T& emplace(U& value) noexcept {
+    ptr_ = std::addressof(value);
+    return *ptr_;
+  }
+  void reset() noexcept { ptr_ = nullptr; }
+
+  // Observers.
+  constexpr explicit operator bool() const noexcept { return ptr_ != nullptr; }
+  constexpr bool has_value() const noexcept { return ptr_ != nullptr; }
+
+  // The object, which must be there. Constness is the object's, not the
+  // optional's, as for a pointer.
+  constexpr T& operator*() const noexcept { return *ptr_; }
+  constexpr T* operator->() const noexcept { return ptr_; }
+
+  // A copy of the object, or of the default value.
+  template <typename U>
+  typename std::remove_cv<T>::type value_or(U&& default_value) const {
+    using result = typename std::remove_cv<T>::type;
+    return ptr_ != nullptr ? result(*ptr_)
+                           : static_cast<result>(
+                                 std::forward<U>(default_value));
+  }
+
+  // Monadic operations.
+  // Returns f(object), which must be an optional, or an empty one.
+  template <typename F>
+  auto and_then(F&& f) const -> typename std::remove_cv<
+      typename std::remove_reference<decltype(std::forward<F>(f)(
+          std::declval<T&>()))>::type>::type {
+    using result = typename std::remove_cv<typename std::remove_reference<
+        decltype(std::forward<F>(f)(std::declval<T&>()))>::type>::type;
+    if (ptr_ != nullptr) return std::forward<F>(f)(*ptr_);
+    return result();
+  }
+
+  // Returns an optional of f(object), or an empty one. It is an optional
+  // reference when f returns a reference, such as to a member.
+  template <typename F>
+  auto transform(F&& f) const -> internal::optional_result<decltype(
+      std::forward<F>(f)(std::declval<T&>()))> {
+    using result = internal::optional_result<decltype(
+        std::forward<F>(f)(std::declval<T&>()))>;
+    if (ptr_ != nullptr) return result(std::forward<F>(f)(*ptr_));
+    return result();
+  }
+
+  // Returns this optional if it refers to an object, or f(), which must
+  // return an optional<T&>.
+  template <typename F>
+  optional or_else(F&& f) const {
+    if (ptr_ != nullptr) return *this;
+    return std::forward<F>(f)();
+  }
+
+ private:
+  T* ptr_ = nullptr;
 };
 }  // namespace david
 
@@ -0,0 +1,65 @@
+#include <string>
+#include <unordered_map>
+
+#include "benchmark/benchmark.h"
+#include "types/optional.h"
+
+namespace david {
+namespace {
+
+// A cache of strings, too long to be inline, and lookups that return a
+// copy of the value or a reference to it.
+class cache {
+ public:
+  explicit cache(int size) {
+    for (int i = 0; i < size; ++i) {
+      entries_[i] = "a cached value that is too long to be inline #" +
+                    std::to_string(i);
+    }
+  }
+
+  optional<std::string> find_copy(int key) const {
+    const auto it = entries_.find(key);
+    if (it == entries_.end()) return nullopt;
+    return it->second;
+  }
+
+  optional<const std::string&> find(int key) const {
+    const auto it = entries_.find(key);
+    if (it == entries_.end()) return nullopt;
+    return it->second;
+  }
+
+ private:
+  std::unordered_map<int, std::string> entries_;
+};
+
+constexpr int kCacheSize = 1024;
+
+// Looks up keys of which one in 4 is missing.
+void BM_FindCopy(benchmark::State& state) {
+  const cache c(kCacheSize);
+  int key = 0;
+  for (auto _ : state) {
+    key = (key + 7) % (kCacheSize + kCacheSize / 3);
+    const optional<std::string> value = c.find_copy(key);
+    benchmark::DoNotOptimize(value ? value->size() : 0);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindCopy);
+
+void BM_FindReference(benchmark::State& state) {
+  const cache c(kCacheSize);
+  int key = 0;
+  for (auto _ : state) {
+    key = (key + 7) % (kCacheSize + kCacheSize / 3);
+    const optional<const std::string&> value = c.find(key);
+    benchmark::DoNotOptimize(value ? value->size() : 0);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindReference);
+
+}  // namespace
+}  // namespace david
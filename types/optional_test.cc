@@ -90,5 +90,121 @@ TEST(Optional, AssignedWithNullopt) {
   EXPECT_FALSE(a);
 }
 
+TEST(Optional, HoldsValue) {
+  optional<std::string> a = std::string("value");
+  ASSERT_TRUE(a);
+  EXPECT_EQ(*a, "value");
+  EXPECT_EQ(a->size(), 5u);
+
+  optional<std::string> b = a;
+  EXPECT_EQ(*b, "value");
+  b = nullopt;
+  EXPECT_FALSE(b);
+  b = a;
+  EXPECT_EQ(*b, "value");
+  a.reset();
+  EXPECT_FALSE(a);
+  EXPECT_EQ(a.emplace(3, 'x'), "xxx");
+}
+
+TEST(Optional, HoldsNonDefaultConstructible) {
+  struct NoDefault {
+    explicit NoDefault(int v) : value(v) {}
+    int value;
+  };
+  optional<NoDefault> a;
+  EXPECT_FALSE(a);
+  a.emplace(4);
+  EXPECT_EQ(a->value, 4);
+}
+
+TEST(Optional, IsTriviallyRelocatable) {
+  EXPECT_TRUE(is_trivially_relocatable<optional<int>>::value);
+  EXPECT_TRUE(std::is_trivially_copyable<optional<int>>::value);
+  EXPECT_TRUE(
+      is_trivially_relocatable<optional<std::unique_ptr<int>>>::value);
+  EXPECT_TRUE(is_trivially_relocatable<
+              optional<optional<std::unique_ptr<int>>>>::value);
+  EXPECT_FALSE(is_trivially_relocatable<optional<std::string>>::value);
+}
+
+TEST(OptionalReference, IsATrivialPointer) {
+  EXPECT_EQ(sizeof(optional<std::string&>), sizeof(std::string*));
+  EXPECT_TRUE(std::is_trivially_copyable<optional<std::string&>>::value);
+  EXPECT_TRUE(is_trivially_relocatable<optional<const int&>>::value);
+  // Temporaries don't bind.
+  EXPECT_FALSE((std::is_constructible<optional<const std::string&>,
+                                      std::string>::value));
+  EXPECT_FALSE((std::is_constructible<optional<int&>, const int&>::value));
+}
+
+TEST(OptionalReference, RefersToObject) {
+  std::string s = "value";
+  optional<std::string&> a = s;
+  ASSERT_TRUE(a);
+  EXPECT_EQ(&*a, &s);
+  a->append("s");
+  EXPECT_EQ(s, "values");
+
+  const optional<const std::string&> b = a;
+  EXPECT_EQ(b->size(), 6u);
+  a = nullopt;
+  EXPECT_FALSE(a.has_value());
+  EXPECT_TRUE(b);
+}
+
+TEST(OptionalReference, AssignmentRebinds) {
+  int x = 1;
+  int y = 2;
+  optional<int&> a = x;
+  a = y;
+  EXPECT_EQ(&*a, &y);
+  EXPECT_EQ(x, 1);
+  a.emplace(x);
+  EXPECT_EQ(&*a, &x);
+  a.reset();
+  EXPECT_FALSE(a);
+}
+
+TEST(OptionalReference, FromPointer) {
+  int x = 1;
+  EXPECT_EQ(&*optional<int&>(&x), &x);
+  EXPECT_FALSE(optional<int&>(static_cast<int*>(nullptr)));
+}
+
+TEST(OptionalReference, ValueOr) {
+  const std::string s = "value";
+  EXPECT_EQ(optional<const std::string&>(s).value_or("other"), "value");
+  EXPECT_EQ(optional<const std::string&>().value_or("other"), "other");
+}
+
+TEST(OptionalReference, MonadicOperations) {
+  struct Entry {
+    std::string name;
+  };
+  Entry entry = {"name"};
+  const optional<Entry&> a = entry;
+  const optional<Entry&> none;
+
+  // A reference to a member stays a reference.
+  const optional<std::string&> name =
+      a.transform([](Entry& e) -> std::string& { return e.name; });
+  EXPECT_EQ(&*name, &entry.name);
+  const optional<size_t> size =
+      a.transform([](const Entry& e) { return e.name.size(); });
+  EXPECT_EQ(*size, 4u);
+  EXPECT_FALSE(none.transform([](const Entry& e) { return e.name; }));
+
+  auto first_char = [](const Entry& e) {
+    return e.name.empty() ? optional<char>() : optional<char>(e.name[0]);
+  };
+  EXPECT_EQ(*a.and_then(first_char), 'n');
+  EXPECT_FALSE(none.and_then(first_char));
+
+  Entry other = {"other"};
+  EXPECT_EQ(&*none.or_else([&] { return optional<Entry&>(other); }), &other);
+  EXPECT_EQ(&*a.or_else([&] { return optional<Entry&>(other); }), &entry);
+}
+
 }  // namespace
 }  // namespace david
@@ -0,0 +1,177 @@
+#ifndef TYPES_PARALLEL_FIND
+#define TYPES_PARALLEL_FIND
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "types/string_view.h"
+#include "types/thread_pool.h"
+
+namespace david {
+namespace parallel {
+
+struct options {
+  // Pool that runs the search. nullptr means thread_pool::default_pool().
+  thread_pool* pool = nullptr;
+  // Number of candidate match positions per task. The default keeps a chunk
+  // in L2 cache.
+  size_t chunk_size = 256 * 1024;
+};
+
+namespace internal {
+
+// Prevents the needle from taking part in template argument deduction, so a
+// string literal can be passed for it.
+template <class T>
+struct identity {
+  typedef T type;
+};
+
+inline thread_pool& pool_for(const options& opts) {
+  return opts.pool ? *opts.pool : thread_pool::default_pool();
+}
+
+// Splits the match positions [pos, last] of needle in haystack into chunks.
+// Chunk i covers the positions [begin(i), end(i)) and is searched through
+// view(i), which extends into the next chunk by needle.size() - 1 characters
+// so matches that straddle the boundary are found exactly once. The needle
+// must not be empty.
+template <class CharT, class Traits>
+class chunks {
+ public:
+  typedef basic_string_view<CharT, Traits> view_type;
+
+  chunks(view_type haystack, view_type needle, size_t pos, size_t chunk_size)
+      : haystack_(haystack),
+        needle_(needle),
+        first_(pos),
+        // One past the last position where needle fits.
+        limit_(haystack.size() - needle.size() + 1),
+        chunk_size_(std::max<size_t>(chunk_size, 1)) {}
+
+  size_t size() const {
+    return (limit_ - first_ + chunk_size_ - 1) / chunk_size_;
+  }
+  size_t begin(size_t i) const { return first_ + i * chunk_size_; }
+  size_t end(size_t i) const {
+    return std::min(begin(i) + chunk_size_, limit_);
+  }
+  view_type view(size_t i) const {
+    return view_type(haystack_.data() + begin(i),
+                     end(i) - begin(i) + needle_.size() - 1);
+  }
+
+ private:
+  view_type haystack_;
+  view_type needle_;
+  size_t first_;
+  size_t limit_;
+  size_t chunk_size_;
+};
+
+}  // namespace internal
+
+// Same result as haystack.find(needle, pos), computed by splitting the
+// haystack into chunks searched on opts.pool. Once a match is found, chunks
+// after it are skipped, so the work done past the first match is bounded by
+// the chunks already in flight.
+template <class CharT, class Traits>
+size_t find(
+    basic_string_view<CharT, Traits> haystack,
+    typename internal::identity<basic_string_view<CharT, Traits>>::type needle,
+    size_t pos = 0, const options& opts = options()) {
+  typedef basic_string_view<CharT, Traits> view_type;
+  if (needle.empty() || pos > haystack.size() ||
+      needle.size() > haystack.size() - pos ||
+      haystack.size() - pos <= opts.chunk_size) {
+    return haystack.find(needle, pos);
+  }
+
+  const internal::chunks<CharT, Traits> chunks(haystack, needle, pos,
+                                               opts.chunk_size);
+  std::atomic<size_t> first_match(view_type::npos);
+  internal::pool_for(opts).parallel_for(chunks.size(), [&](size_t i) {
+    // A match in an earlier chunk makes this one irrelevant.
+    if (first_match.load(std::memory_order_relaxed) < chunks.begin(i)) return;
+    const size_t found = chunks.view(i).find(needle);
+    if (found == view_type::npos) return;
+    const size_t match = chunks.begin(i) + found;
+    size_t current = first_match.load(std::memory_order_relaxed);
+    while (match < current && !first_match.compare_exchange_weak(
+                                  current, match, std::memory_order_relaxed)) {
+    }
+  });
+  return first_match.load(std::memory_order_relaxed);
+}
+
+// Returns the positions of every occurrence of needle in haystack, including
+// overlapping ones, in increasing order. An empty needle matches at every
+// position in [0, haystack.size()].
+template <class CharT, class Traits>
+std::vector<size_t> find_all(
+    basic_string_view<CharT, Traits> haystack,
+    typename internal::identity<basic_string_view<CharT, Traits>>::type needle,
+    const options& opts = options()) {
+  typedef basic_string_view<CharT, Traits> view_type;
+  std::vector<size_t> matches;
+  if (needle.size() > haystack.size()) return matches;
+  if (needle.empty()) {
+    for (size_t i = 0; i <= haystack.size(); ++i) matches.push_back(i);
+    return matches;
+  }
+
+  const internal::chunks<CharT, Traits> chunks(haystack, needle, 0,
+                                               opts.chunk_size);
+  std::vector<std::vector<size_t>> per_chunk(chunks.size());
+  internal::pool_for(opts).parallel_for(chunks.size(), [&](size_t i) {
+    const view_type view = chunks.view(i);
+    const size_t end = chunks.end(i) - chunks.begin(i);
+    for (size_t p = view.find(needle); p < end; p = view.find(needle, p + 1)) {
+      per_chunk[i].push_back(chunks.begin(i) + p);
+    }
+  });
+
+  size_t total = 0;
+  for (size_t i = 0; i < per_chunk.size(); ++i) total += per_chunk[i].size();
+  matches.reserve(total);
+  for (size_t i = 0; i < per_chunk.size(); ++i) {
+    matches.insert(matches.end(), per_chunk[i].begin(), per_chunk[i].end());
+  }
+  return matches;
+}
+
+// Returns find_all(haystack, needle, opts).size() without storing the
+// positions.
+template <class CharT, class Traits>
+size_t count(
+    basic_string_view<CharT, Traits> haystack,
+    typename internal::identity<basic_string_view<CharT, Traits>>::type needle,
+    const options& opts = options()) {
+  typedef basic_string_view<CharT, Traits> view_type;
+  if (needle.size() > haystack.size()) return 0;
+  if (needle.empty()) return haystack.size() + 1;
+
+  const internal::chunks<CharT, Traits> chunks(haystack, needle, 0,
+                                               opts.chunk_size);
+  std::vector<size_t> per_chunk(chunks.size());
+  internal::pool_for(opts).parallel_for(chunks.size(), [&](size_t i) {
+    const view_type view = chunks.view(i);
+    const size_t end = chunks.end(i) - chunks.begin(i);
+    size_t n = 0;
+    for (size_t p = view.find(needle); p < end; p = view.find(needle, p + 1)) {
+      ++n;
+    }
+    per_chunk[i] = n;
+  });
+
+  size_t total = 0;
+  for (size_t i = 0; i < per_chunk.size(); ++i) total += per_chunk[i];
+  return total;
+}
+
+}  // namespace parallel
+}  // namespace david
+
+#endif  // TYPES_PARALLEL_FIND
@@ -0,0 +1,68 @@
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "types/parallel_find.h"
+
+namespace david {
+namespace {
+
+// A haystack of state.range(0) MiB with a single match at the very end.
+std::string make_haystack(size_t mib) {
+  std::string text(mib << 20, 'x');
+  text.replace(text.size() - 6, 6, "needle");
+  return text;
+}
+
+// Keeps the compiler from specializing the search for a constant needle.
+string_view opaque_needle() {
+  string_view needle = "needle";
+  benchmark::DoNotOptimize(needle);
+  return needle;
+}
+
+void BM_SerialFind(benchmark::State& state) {
+  const std::string text = make_haystack(state.range(0));
+  const string_view haystack(text);
+  const string_view needle = opaque_needle();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(haystack.find(needle));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_SerialFind)->Arg(64);
+
+void BM_ParallelFind(benchmark::State& state) {
+  const std::string text = make_haystack(state.range(0));
+  const string_view haystack(text);
+  const string_view needle = opaque_needle();
+  thread_pool pool(state.range(1));
+  parallel::options opts;
+  opts.pool = &pool;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parallel::find(haystack, needle, 0, opts));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParallelFind)
+    ->Args({64, 1})
+    ->Args({64, 2})
+    ->Args({64, 4})
+    ->Args({64, 8})
+    ->UseRealTime();
+
+void BM_ParallelCount(benchmark::State& state) {
+  const std::string text = make_haystack(state.range(0));
+  const string_view haystack(text);
+  const string_view needle = opaque_needle();
+  thread_pool pool(state.range(1));
+  parallel::options opts;
+  opts.pool = &pool;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parallel::count(haystack, needle, opts));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParallelCount)->Args({64, 1})->Args({64, 4})->UseRealTime();
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,93 @@
+#include "types/parallel_find.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+std::vector<size_t> naive_find_all(string_view haystack, string_view needle) {
+  std::vector<size_t> matches;
+  for (size_t p = haystack.find(needle); p != string_view::npos;
+       p = haystack.find(needle, p + 1)) {
+    matches.push_back(p);
+  }
+  return matches;
+}
+
+std::string random_text(size_t n, int alphabet, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::string s(n, 'a');
+  for (size_t i = 0; i < n; ++i) {
+    s[i] = static_cast<char>('a' + rng() % alphabet);
+  }
+  return s;
+}
+
+TEST(ParallelFind, SmallInputs) {
+  const string_view s = "hello world, hello";
+  EXPECT_EQ(parallel::find(s, "hello"), 0);
+  EXPECT_EQ(parallel::find(s, "hello", 1), 13);
+  EXPECT_EQ(parallel::find(s, "bye"), string_view::npos);
+  EXPECT_EQ(parallel::find(s, ""), 0);
+  EXPECT_THAT(parallel::find_all(s, "hello"), ElementsAre(0, 13));
+  EXPECT_EQ(parallel::count(s, "l"), 5);
+  EXPECT_THAT(parallel::find_all(s, "too long for the haystack"), IsEmpty());
+  EXPECT_THAT(parallel::find_all(string_view("ab"), ""), ElementsAre(0, 1, 2));
+  EXPECT_EQ(parallel::count(string_view("ab"), ""), 3);
+}
+
+TEST(ParallelFind, OverlappingMatches) {
+  parallel::options opts;
+  opts.chunk_size = 2;
+  EXPECT_THAT(parallel::find_all(string_view("aaaaa"), "aa", opts),
+              ElementsAre(0, 1, 2, 3));
+  EXPECT_EQ(parallel::count(string_view("aaaaa"), "aa", opts), 4);
+}
+
+TEST(ParallelFind, MatchesSerialFind) {
+  thread_pool pool(4);
+  const std::string text = random_text(20000, 3, 1);
+  const string_view haystack(text);
+  for (size_t chunk_size : {1, 3, 64, 1000}) {
+    parallel::options opts;
+    opts.pool = &pool;
+    opts.chunk_size = chunk_size;
+    for (const char* needle : {"a", "abc", "cabbac", "abcabcabca"}) {
+      SCOPED_TRACE(needle);
+      EXPECT_EQ(parallel::find(haystack, needle, 0, opts),
+                haystack.find(needle));
+      EXPECT_EQ(parallel::find(haystack, needle, 777, opts),
+                haystack.find(needle, 777));
+      EXPECT_THAT(parallel::find_all(haystack, needle, opts),
+                  Eq(naive_find_all(haystack, needle)));
+      EXPECT_EQ(parallel::count(haystack, needle, opts),
+                naive_find_all(haystack, needle).size());
+    }
+  }
+}
+
+TEST(ParallelFind, ReturnsFirstMatch) {
+  thread_pool pool(4);
+  std::string text(100000, 'x');
+  text.replace(90000, 3, "abc");
+  text.replace(50000, 3, "abc");
+  text.replace(50001, 3, "abc");
+  parallel::options opts;
+  opts.pool = &pool;
+  opts.chunk_size = 100;
+  for (int round = 0; round < 20; ++round) {
+    EXPECT_EQ(parallel::find(string_view(text), "abc", 0, opts), 50001);
+  }
+}
+
+}  // namespace
+}  // namespace david
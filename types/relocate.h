@@ -0,0 +1,142 @@
+#ifndef TYPES_RELOCATE
+#define TYPES_RELOCATE
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace david {
+
+// Relocating an object moves it to new storage and ends its lifetime at the
+// old one. A type is trivially relocatable when copying its bytes does both,
+// which holds for most types that do not point into themselves. Containers
+// then move whole arrays of it with memcpy, rather than with a move
+// construction and a destruction per element.
+//
+// Trivially copyable types are trivially relocatable. Other classes opt in
+// with a public member typedef that names the class itself, under a
+// condition on their members:
+//
+//   template <typename T>
+//   class optional {
+//    public:
+//     using trivially_relocatable = internal::trivially_relocatable_if<
+//         is_trivially_relocatable<T>::value, optional>;
+//     ...
+//   };
+//
+// A class derived from a marked class is not marked, since it may add
+// members that point into itself: it needs a typedef of its own. The types
+// of the standard library below are listed by hand. std::string is not:
+// libstdc++ points it into itself when short.
+namespace internal {
+
+template <bool B, typename Class>
+using trivially_relocatable_if =
+    typename std::conditional<B, Class, void>::type;
+
+template <typename T, typename = void>
+struct marked_trivially_relocatable : std::false_type {};
+
+template <typename T>
+struct marked_trivially_relocatable<
+    T, typename std::conditional<
+           true, void, typename T::trivially_relocatable>::type>
+    : std::is_same<typename T::trivially_relocatable,
+                   typename std::remove_cv<T>::type> {};
+
+}  // namespace internal
+
+template <typename T>
+struct is_trivially_relocatable
+    : std::integral_constant<
+          bool, std::is_trivially_copyable<T>::value ||
+                    internal::marked_trivially_relocatable<T>::value> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::allocator<T>> : std::true_type {};
+
+// Relocates *src to the uninitialized storage at dest.
+template <typename T>
+void relocate_at(T* src, T* dest) noexcept(
+    is_trivially_relocatable<T>::value ||
+    std::is_nothrow_move_constructible<T>::value) {
+  if (is_trivially_relocatable<T>::value) {
+    std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src),
+                sizeof(T));
+  } else {
+    ::new (static_cast<void*>(dest)) T(std::move(*src));
+    src->~T();
+  }
+}
+
+namespace internal {
+
+template <typename T>
+void relocate_elements(T* first, size_t n, T* d_first,
+                       std::true_type /* nothrow */) noexcept {
+  for (size_t i = 0; i < n; ++i) relocate_at(first + i, d_first + i);
+}
+
+template <typename T>
+void relocate_elements(T* first, size_t n, T* d_first,
+                       std::false_type /* nothrow */) {
+  size_t i = 0;
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+  try {
+    for (; i < n; ++i) relocate_at(first + i, d_first + i);
+  } catch (...) {
+    for (size_t j = 0; j < i; ++j) d_first[j].~T();
+    for (size_t j = i; j < n; ++j) first[j].~T();
+    throw;
+  }
+#else
+  for (; i < n; ++i) relocate_at(first + i, d_first + i);
+#endif
+}
+
+}  // namespace internal
+
+// Relocates [first, first + n) to the uninitialized storage at d_first and
+// returns the end of the relocated range. The ranges may overlap when
+// d_first <= first.
+//
+// If a move constructor throws, the objects of both ranges are destroyed
+// before the exception propagates: none is left to the caller.
+template <typename T>
+T* uninitialized_relocate_n(T* first, size_t n, T* d_first) noexcept(
+    is_trivially_relocatable<T>::value ||
+    std::is_nothrow_move_constructible<T>::value) {
+  if (is_trivially_relocatable<T>::value) {
+    if (n != 0) {
+      std::memmove(static_cast<void*>(d_first),
+                   static_cast<const void*>(first), n * sizeof(T));
+    }
+  } else {
+    internal::relocate_elements(
+        first, n, d_first,
+        std::integral_constant<
+            bool, std::is_nothrow_move_constructible<T>::value>());
+  }
+  return d_first + n;
+}
+
+template <typename T>
+T* uninitialized_relocate(T* first, T* last, T* d_first) noexcept(
+    noexcept(uninitialized_relocate_n(first, 0, d_first))) {
+  return uninitialized_relocate_n(first, static_cast<size_t>(last - first),
+                                  d_first);
+}
+
+}  // namespace david
+
+#endif  // TYPES_RELOCATE
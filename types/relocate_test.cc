@@ -0,0 +1,101 @@
+#include "types/relocate.h"
+
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+struct Marked {
+  using trivially_relocatable = Marked;
+  Marked() = default;
+  Marked(const Marked&) {}
+  int value = 0;
+};
+
+struct Unmarked {
+  using trivially_relocatable =
+      internal::trivially_relocatable_if<false, Unmarked>;
+  Unmarked() = default;
+  Unmarked(const Unmarked&) {}
+};
+
+// Derives from a marked class, but does not inherit its mark: it points
+// into itself.
+struct DerivedSelfPointer : Marked {
+  DerivedSelfPointer() : self(&value) {}
+  DerivedSelfPointer(const DerivedSelfPointer& other)
+      : Marked(other), self(&value) {}
+  int* self;
+};
+
+// Points into itself, so it must be moved by its constructor.
+struct SelfPointer {
+  explicit SelfPointer(int v) : value(v), self(&value) {}
+  SelfPointer(SelfPointer&& other) noexcept
+      : value(other.value), self(&value) {}
+  int value;
+  int* self;
+};
+
+TEST(Relocate, Trait) {
+  EXPECT_TRUE(is_trivially_relocatable<int>::value);
+  EXPECT_TRUE(is_trivially_relocatable<const int>::value);
+  EXPECT_TRUE(is_trivially_relocatable<int*>::value);
+  EXPECT_TRUE(is_trivially_relocatable<Marked>::value);
+  EXPECT_TRUE(is_trivially_relocatable<const Marked>::value);
+  EXPECT_FALSE(is_trivially_relocatable<Unmarked>::value);
+  EXPECT_FALSE(is_trivially_relocatable<DerivedSelfPointer>::value);
+  EXPECT_FALSE(is_trivially_relocatable<SelfPointer>::value);
+  EXPECT_TRUE(is_trivially_relocatable<std::unique_ptr<int>>::value);
+  EXPECT_TRUE(is_trivially_relocatable<std::shared_ptr<int>>::value);
+  EXPECT_TRUE(is_trivially_relocatable<std::allocator<char>>::value);
+  EXPECT_FALSE(is_trivially_relocatable<std::string>::value);
+}
+
+TEST(Relocate, RelocateAt) {
+  using ptr = std::unique_ptr<int>;
+  alignas(ptr) unsigned char from[sizeof(ptr)];
+  alignas(ptr) unsigned char to[sizeof(ptr)];
+  ptr* src = ::new (from) ptr(new int(7));
+  ptr* dest = reinterpret_cast<ptr*>(to);
+  relocate_at(src, dest);
+  EXPECT_EQ(**dest, 7);
+  dest->~ptr();
+}
+
+TEST(Relocate, RelocatesNonTrivialTypes) {
+  alignas(SelfPointer) unsigned char from[3 * sizeof(SelfPointer)];
+  alignas(SelfPointer) unsigned char to[3 * sizeof(SelfPointer)];
+  auto* src = reinterpret_cast<SelfPointer*>(from);
+  auto* dest = reinterpret_cast<SelfPointer*>(to);
+  for (int i = 0; i < 3; ++i) ::new (src + i) SelfPointer(i);
+
+  EXPECT_EQ(uninitialized_relocate(src, src + 3, dest), dest + 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(dest[i].value, i);
+    EXPECT_EQ(dest[i].self, &dest[i].value);
+  }
+}
+
+TEST(Relocate, OverlappingRanges) {
+  std::unique_ptr<int> ptrs[4] = {nullptr, std::unique_ptr<int>(new int(1)),
+                                  std::unique_ptr<int>(new int(2)),
+                                  std::unique_ptr<int>(new int(3))};
+  // Relocates [1, 4) to [0, 3), then builds the slot that is left.
+  ptrs[0].~unique_ptr();
+  uninitialized_relocate_n(ptrs + 1, 3, ptrs);
+  ::new (ptrs + 3) std::unique_ptr<int>();
+  EXPECT_EQ(*ptrs[0], 1);
+  EXPECT_EQ(*ptrs[1], 2);
+  EXPECT_EQ(*ptrs[2], 3);
+  EXPECT_EQ(ptrs[3], nullptr);
+}
+
+}  // namespace
+}  // namespace david
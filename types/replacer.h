@@ -0,0 +1,225 @@
+#ifndef TYPES_REPLACER
+#define TYPES_REPLACER
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types/internal/string_kernels.h"
+#include "types/string_arena.h"
+#include "types/string_view.h"
+
+namespace david {
+
+// Replaces every occurrence of any of a set of patterns in one pass over a
+// text, where a find and a new string per pattern would take a pass and an
+// allocation each:
+//
+//   const replacer escape({{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}});
+//   std::string html = escape.replace(text);
+//
+// Matches are found left to right and do not overlap. Where several
+// patterns match at the same position, the one given first wins, so put
+// "<<" before "<" to replace it as a whole. Replacements are not scanned
+// again.
+//
+// The text is scanned once, for the matches and the size of the output,
+// which is then written in one buffer of exactly that size, the chars
+// between matches with memcpy. A text with no match is scanned once and not
+// copied by the arena form of replace().
+class replacer {
+ public:
+  using rule = std::pair<string_view, string_view>;
+
+  // Replaces each rules[i].first with rules[i].second. The strings are
+  // copied. Throws std::invalid_argument if a pattern is empty.
+  replacer(const rule* rules, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      if (rules[i].first.empty()) {
+        throw std::invalid_argument("empty replacer pattern");
+      }
+      patterns_.emplace_back(rules[i].first.data(), rules[i].first.size());
+      replacements_.emplace_back(rules[i].second.data(),
+                                 rules[i].second.size());
+    }
+    index_by_first_char();
+  }
+  replacer(std::initializer_list<rule> rules)
+      : replacer(rules.begin(), rules.size()) {}
+
+  // Number of chars of replace(text).
+  size_t replaced_size(string_view text) const {
+    size_t size = text.size();
+    scan(text, 0, [&](size_t, size_t r) {
+      size += replacements_[r].size() - patterns_[r].size();
+      return true;
+    });
+    return size;
+  }
+
+  // A copy of text with every match replaced.
+  std::string replace(string_view text) const {
+    std::string out;
+    const bool matched = replace(text, [&](size_t size) {
+      out.resize(size);
+      return buffer_writer{&out[0]};
+    });
+    if (!matched) out.assign(text.data(), text.size());
+    return out;
+  }
+
+  // text with every match replaced, in a buffer of arena, or text itself if
+  // nothing matches.
+  string_view replace(string_view text, string_arena* arena) const {
+    char* out = nullptr;
+    size_t out_size = 0;
+    const bool matched = replace(text, [&](size_t size) {
+      out = arena->allocate(size);
+      out_size = size;
+      return buffer_writer{out};
+    });
+    if (!matched) return text;
+    // Every char of text was deleted.
+    if (out_size == 0) return text.substr_unchecked(0, 0);
+    return string_view(out, out_size);
+  }
+
+ private:
+  static const size_t kNoRule = ~size_t(0);
+  // Matches that the size scan keeps on the stack for the write. Texts with
+  // more keep the others in a vector.
+  static const size_t kKeptMatches = 256;
+  // Chars looked up in the table before a scan with find_first_of.
+  static const size_t kTableScan = 8;
+
+  struct match {
+    size_t pos;
+    size_t rule;
+  };
+
+  struct buffer_writer {
+    void operator()(const char* p, size_t n) {
+      std::memcpy(out, p, n);
+      out += n;
+    }
+    char* out;
+  };
+
+  // Groups the rules by the first char of their pattern, in rule order.
+  void index_by_first_char() {
+    size_t counts[256] = {};
+    for (const std::string& p : patterns_) {
+      ++counts[static_cast<unsigned char>(p[0])];
+    }
+    bucket_[0] = 0;
+    for (size_t c = 0; c < 256; ++c) {
+      bucket_[c + 1] = bucket_[c] + counts[c];
+      if (counts[c] != 0) first_chars_.push_back(static_cast<char>(c));
+    }
+    by_first_char_.resize(patterns_.size());
+    size_t next[256];
+    std::memcpy(next, bucket_, sizeof(next));
+    for (size_t r = 0; r < patterns_.size(); ++r) {
+      by_first_char_[next[static_cast<unsigned char>(patterns_[r][0])]++] = r;
+    }
+  }
+
+  // The first rule whose pattern starts p, of n chars, or kNoRule.
+  size_t rule_at(const char* p, size_t n) const {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    for (size_t i = bucket_[c]; i < bucket_[c + 1]; ++i) {
+      const std::string& pattern = patterns_[by_first_char_[i]];
+      if (pattern.size() <= n &&
+          std::memcmp(p + 1, pattern.data() + 1, pattern.size() - 1) == 0) {
+        return by_first_char_[i];
+      }
+    }
+    return kNoRule;
+  }
+
+  // Calls on_match(pos, rule) for each match in text from pos on, until it
+  // returns false.
+  template <class OnMatch>
+  void scan(string_view text, size_t pos, const OnMatch& on_match) const {
+    const char* const data = text.data();
+    const size_t n = text.size();
+    // The vector kernels of find_first_of take sets of a few chars; a table
+    // is faster for more, and for the chars right after a match, which in
+    // dense texts are often where the next one is.
+    const bool use_find =
+        first_chars_.size() <= internal::kMaxVectorSetSize;
+    while (pos < n) {
+      const size_t table_end = use_find ? std::min(pos + kTableScan, n) : n;
+      while (pos < table_end && bucket_size(data[pos]) == 0) ++pos;
+      if (pos == table_end) {
+        if (pos == n) return;
+        pos = text.find_first_of(first_chars_, pos);
+        if (pos == string_view::npos) return;
+      }
+      const size_t r = rule_at(data + pos, n - pos);
+      if (r == kNoRule) {
+        ++pos;
+        continue;
+      }
+      if (!on_match(pos, r)) return;
+      pos += patterns_[r].size();
+    }
+  }
+
+  size_t bucket_size(char c) const {
+    const unsigned char u = static_cast<unsigned char>(c);
+    return bucket_[u + 1] - bucket_[u];
+  }
+
+  // Scans text for its size, then, if anything matched, writes the output
+  // with the writer that start(size) returns. Returns whether anything
+  // matched.
+  template <class Start>
+  bool replace(string_view text, const Start& start) const {
+    match kept[kKeptMatches];
+    size_t num_kept = 0;
+    std::vector<match> more;
+    size_t size = text.size();
+    scan(text, 0, [&](size_t pos, size_t r) {
+      if (num_kept < kKeptMatches) {
+        kept[num_kept++] = match{pos, r};
+      } else {
+        more.push_back(match{pos, r});
+      }
+      size += replacements_[r].size() - patterns_[r].size();
+      return true;
+    });
+    if (num_kept == 0) return false;
+
+    auto write = start(size);
+    if (size == 0) return true;
+    size_t done = 0;
+    const auto write_match = [&](const match& m) {
+      write(text.data() + done, m.pos - done);
+      write(replacements_[m.rule].data(), replacements_[m.rule].size());
+      done = m.pos + patterns_[m.rule].size();
+    };
+    for (size_t i = 0; i < num_kept; ++i) write_match(kept[i]);
+    for (const match& m : more) write_match(m);
+    write(text.data() + done, text.size() - done);
+    return true;
+  }
+
+  std::vector<std::string> patterns_;
+  std::vector<std::string> replacements_;
+  // Distinct first chars of the patterns.
+  std::string first_chars_;
+  // Rules whose pattern starts with c, in rule order, are
+  // by_first_char_[bucket_[c], bucket_[c + 1]).
+  std::vector<size_t> by_first_char_;
+  size_t bucket_[257];
+};
+
+}  // namespace david
+
+#endif  // TYPES_REPLACER
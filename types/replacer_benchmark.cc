@@ -0,0 +1,140 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/replacer.h"
+
+namespace david {
+namespace {
+
+// 20 template variables, {{var0}} to {{var19}}, and their values.
+std::vector<std::string> variables() {
+  std::vector<std::string> vars;
+  for (int i = 0; i < 20; ++i) {
+    vars.push_back("{{var" + std::to_string(i) + "}}");
+  }
+  return vars;
+}
+
+std::vector<std::string> values() {
+  std::vector<std::string> vals;
+  for (int i = 0; i < 20; ++i) {
+    vals.push_back("value number " + std::to_string(i));
+  }
+  return vals;
+}
+
+// A 16 KiB document of words with a variable every matches_per_kib / 1024
+// chars, or none when matches_per_kib is 0.
+std::string document(int matches_per_kib) {
+  std::mt19937 rng(42);
+  const std::vector<std::string> vars = variables();
+  std::string doc;
+  while (doc.size() < (16 << 10)) {
+    if (matches_per_kib != 0 && rng() % 1024 < 8u * matches_per_kib) {
+      doc += vars[rng() % vars.size()];
+    } else {
+      doc.append(1 + rng() % 8, static_cast<char>('a' + rng() % 26));
+    }
+    doc.push_back(' ');
+  }
+  return doc;
+}
+
+// A find and a new string per rule, as the pipeline did.
+std::string replace_each(std::string doc, const std::vector<std::string>& from,
+                         const std::vector<std::string>& to) {
+  for (size_t r = 0; r < from.size(); ++r) {
+    std::string out;
+    size_t done = 0;
+    for (size_t pos = doc.find(from[r]); pos != std::string::npos;
+         pos = doc.find(from[r], done)) {
+      out.append(doc, done, pos - done);
+      out += to[r];
+      done = pos + from[r].size();
+    }
+    out.append(doc, done, std::string::npos);
+    doc.swap(out);
+  }
+  return doc;
+}
+
+void BM_ReplaceEach(benchmark::State& state) {
+  const std::string doc = document(state.range(0));
+  const std::vector<std::string> from = variables();
+  const std::vector<std::string> to = values();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(replace_each(doc, from, to));
+  }
+  state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_ReplaceEach)->Arg(0)->Arg(1)->Arg(16);
+
+replacer template_replacer() {
+  const std::vector<std::string> from = variables();
+  const std::vector<std::string> to = values();
+  std::vector<replacer::rule> rules;
+  for (size_t r = 0; r < from.size(); ++r) rules.emplace_back(from[r], to[r]);
+  return replacer(rules.data(), rules.size());
+}
+
+void BM_Replacer(benchmark::State& state) {
+  const std::string doc = document(state.range(0));
+  const replacer r = template_replacer();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(r.replace(doc));
+  }
+  state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_Replacer)->Arg(0)->Arg(1)->Arg(16);
+
+void BM_ReplacerArena(benchmark::State& state) {
+  const std::string doc = document(state.range(0));
+  const replacer r = template_replacer();
+  string_arena arena(64 << 10);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(r.replace(doc, &arena));
+    if (arena.bytes_used() > (1 << 20)) arena.clear();
+  }
+  state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_ReplacerArena)->Arg(0)->Arg(1)->Arg(16);
+
+// 16 KiB of text with a char to escape every 64 chars on average, or none
+// when with_specials is false.
+std::string markup(bool with_specials) {
+  std::mt19937 rng(7);
+  std::string doc(16 << 10, ' ');
+  for (char& c : doc) {
+    c = with_specials && rng() % 64 == 0 ? "<>&\""[rng() % 4]
+                                         : static_cast<char>('a' + rng() % 27);
+  }
+  return doc;
+}
+
+// Escaping, with patterns of one char.
+void BM_ReplaceEachEscape(benchmark::State& state) {
+  const std::string doc = markup(state.range(0) != 0);
+  const std::vector<std::string> from = {"&", "<", ">", "\""};
+  const std::vector<std::string> to = {"&amp;", "&lt;", "&gt;", "&quot;"};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(replace_each(doc, from, to));
+  }
+  state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_ReplaceEachEscape)->Arg(0)->Arg(1);
+
+void BM_ReplacerEscape(benchmark::State& state) {
+  const std::string doc = markup(state.range(0) != 0);
+  const replacer escape(
+      {{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"\"", "&quot;"}});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(escape.replace(doc));
+  }
+  state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_ReplacerEscape)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,122 @@
+#include "types/replacer.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+// Replacement by trying each rule at each position, in rule order.
+std::string reference_replace(const std::vector<replacer::rule>& rules,
+                              const std::string& text) {
+  std::string out;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    bool matched = false;
+    for (const replacer::rule& r : rules) {
+      if (text.compare(pos, r.first.size(), r.first.data(), r.first.size()) ==
+          0) {
+        out.append(r.second.data(), r.second.size());
+        pos += r.first.size();
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) out.push_back(text[pos++]);
+  }
+  return out;
+}
+
+TEST(Replacer, Escape) {
+  const replacer escape({{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}});
+  EXPECT_EQ(escape.replace("a < b && c > d"),
+            "a &lt; b &amp;&amp; c &gt; d");
+  EXPECT_EQ(escape.replace("<>"), "&lt;&gt;");
+  EXPECT_EQ(escape.replace("plain"), "plain");
+  EXPECT_EQ(escape.replace(""), "");
+  EXPECT_EQ(escape.replaced_size("a < b"), 8u);
+}
+
+TEST(Replacer, FirstRuleWins) {
+  const replacer longer_first({{"<<", "L"}, {"<", "l"}});
+  EXPECT_EQ(longer_first.replace("<<<"), "Ll");
+  const replacer shorter_first({{"<", "l"}, {"<<", "L"}});
+  EXPECT_EQ(shorter_first.replace("<<<"), "lll");
+}
+
+TEST(Replacer, NonOverlapping) {
+  const replacer r({{"aa", "b"}});
+  EXPECT_EQ(r.replace("aaaaa"), "bba");
+  // Replacements are not scanned again.
+  const replacer grow({{"a", "aa"}});
+  EXPECT_EQ(grow.replace("aba"), "aabaa");
+}
+
+TEST(Replacer, Templating) {
+  const replacer fill({{"{{name}}", "world"}, {"{{greeting}}", "Hello"}});
+  EXPECT_EQ(fill.replace("{{greeting}}, {{name}}! {{other}} {{"),
+            "Hello, world! {{other}} {{");
+}
+
+TEST(Replacer, Deletion) {
+  const replacer strip({{"\r", ""}, {"\t", ""}});
+  EXPECT_EQ(strip.replace("a\r\tb\r"), "ab");
+  EXPECT_EQ(strip.replace("\r\t\r"), "");
+  string_arena arena;
+  EXPECT_TRUE(strip.replace("\r\t\r", &arena).empty());
+}
+
+TEST(Replacer, EmptyPattern) {
+  EXPECT_THROW(replacer({{"", "x"}}), std::invalid_argument);
+  const replacer none({});
+  EXPECT_EQ(none.replace("text"), "text");
+}
+
+TEST(Replacer, Arena) {
+  const replacer r({{"cat", "dog"}});
+  string_arena arena;
+  const std::string text = "no match here";
+  const string_view unchanged = r.replace(text, &arena);
+  EXPECT_EQ(unchanged.data(), text.data());
+  EXPECT_EQ(arena.bytes_used(), 0u);
+
+  const string_view replaced = r.replace("a cat and a cat", &arena);
+  EXPECT_EQ(replaced, "a dog and a dog");
+  EXPECT_EQ(arena.bytes_used(), replaced.size());
+}
+
+TEST(Replacer, MatchesReference) {
+  std::mt19937 rng(42);
+  for (int iter = 0; iter < 2000; ++iter) {
+    // Past kMaxVectorSetSize first chars, to take both scans, and past the
+    // matches kept by the size scan.
+    std::vector<std::string> strings;
+    const size_t num_rules = 1 + rng() % (iter % 2 == 0 ? 4 : 20);
+    const int alphabet = iter % 2 == 0 ? 3 : 16;
+    for (size_t i = 0; i < 2 * num_rules; ++i) {
+      std::string s(i % 2 == 0 ? 1 + rng() % 3 : rng() % 4, '\0');
+      for (char& c : s) c = static_cast<char>('a' + rng() % alphabet);
+      strings.push_back(s);
+    }
+    std::vector<replacer::rule> rules;
+    for (size_t i = 0; i < num_rules; ++i) {
+      rules.emplace_back(strings[2 * i], strings[2 * i + 1]);
+    }
+    std::string text(rng() % (iter % 10 == 0 ? 3000 : 100), '\0');
+    for (char& c : text) c = static_cast<char>('a' + rng() % alphabet);
+
+    const replacer r(rules.data(), rules.size());
+    const std::string want = reference_replace(rules, text);
+    ASSERT_EQ(r.replace(text), want) << text;
+    ASSERT_EQ(r.replaced_size(text), want.size());
+    string_arena arena;
+    ASSERT_EQ(r.replace(text, &arena), want);
+  }
+}
+
+}  // namespace
+}  // namespace david
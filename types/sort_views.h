@@ -0,0 +1,336 @@
+#ifndef TYPES_SORT_VIEWS
+#define TYPES_SORT_VIEWS
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "types/string_view.h"
+#include "types/thread_pool.h"
+
+namespace david {
+namespace internal {
+
+// A view together with 8 of its bytes, starting at the current sort depth,
+// loaded big-endian and zero padded. Comparing prefixes as integers orders
+// like comparing those bytes one by one, without touching the string data.
+struct prefixed_view {
+  uint64_t prefix;
+  string_view view;
+};
+
+inline uint64_t load_prefix(string_view s, size_t depth) {
+  if (depth >= s.size()) return 0;
+  uint64_t word = 0;
+  std::memcpy(&word, s.data() + depth, std::min<size_t>(s.size() - depth, 8));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+// Compares a and b knowing that their first depth bytes are equal.
+inline bool view_less_from(const prefixed_view& a, const prefixed_view& b,
+                           size_t depth) {
+  if (a.prefix != b.prefix) return a.prefix < b.prefix;
+  const size_t skip = depth + 8;
+  const size_t a_size = a.view.size();
+  const size_t b_size = b.view.size();
+  if (a_size <= skip || b_size <= skip) return a_size < b_size;
+  const size_t n = std::min(a_size, b_size) - skip;
+  const int c = std::memcmp(a.view.data() + skip, b.view.data() + skip, n);
+  return c != 0 ? c < 0 : a_size < b_size;
+}
+
+inline void insertion_sort(prefixed_view* v, size_t n, size_t depth) {
+  for (size_t i = 1; i < n; ++i) {
+    const prefixed_view x = v[i];
+    size_t j = i;
+    for (; j > 0 && view_less_from(x, v[j - 1], depth); --j) v[j] = v[j - 1];
+    v[j] = x;
+  }
+}
+
+inline uint64_t median_of_three(uint64_t a, uint64_t b, uint64_t c) {
+  if (a < b) {
+    if (b < c) return b;
+    return a < c ? c : a;
+  }
+  if (a < c) return a;
+  return b < c ? c : b;
+}
+
+// Median of three prefixes for small ranges, and Tukey's ninther, the
+// median of three medians of three, for larger ones.
+inline uint64_t choose_pivot(const prefixed_view* v, size_t n) {
+  static const size_t kNintherThreshold = 128;
+  if (n < kNintherThreshold) {
+    return median_of_three(v[0].prefix, v[n / 2].prefix, v[n - 1].prefix);
+  }
+  const size_t step = n / 8;
+  const auto median_at = [v](size_t i, size_t d) {
+    return median_of_three(v[i - d].prefix, v[i].prefix, v[i + d].prefix);
+  };
+  return median_of_three(median_at(step, step), median_at(n / 2, step),
+                         median_at(n - 1 - step, step));
+}
+
+// Number of partitions a range of n views gets at one depth before it is
+// sorted with std::sort instead, as in introsort.
+inline size_t partition_budget(size_t n) {
+  size_t log2 = 0;
+  while (n >>= 1) ++log2;
+  return 2 * log2;
+}
+
+// Multikey quicksort (Bentley and Sedgewick) that uses 8-byte prefixes as
+// its keys. All views in v[0, n) share their first depth bytes and have
+// their prefixes loaded at depth.
+//
+// Of the three parts of each partition, the two smaller ones are sorted by
+// recursion and the largest by the loop, so recursion is at most log2(n)
+// deep. A range that takes more than budget partitions at one depth, as
+// on inputs that defeat the pivot choice, is finished with std::sort.
+inline void multikey_quicksort(prefixed_view* v, size_t n, size_t depth,
+                               size_t budget) {
+  static const size_t kInsertionSortThreshold = 16;
+  while (n > kInsertionSortThreshold) {
+    if (budget == 0) {
+      std::sort(v, v + n,
+                [depth](const prefixed_view& a, const prefixed_view& b) {
+                  return view_less_from(a, b, depth);
+                });
+      return;
+    }
+    --budget;
+    const uint64_t pivot = choose_pivot(v, n);
+
+    // Dutch national flag partition: [0, lt) < pivot, [lt, gt) == pivot,
+    // [gt, n) > pivot.
+    size_t lt = 0, i = 0, gt = n;
+    while (i < gt) {
+      if (v[i].prefix < pivot) {
+        std::swap(v[lt++], v[i++]);
+      } else if (v[i].prefix > pivot) {
+        std::swap(v[i], v[--gt]);
+      } else {
+        ++i;
+      }
+    }
+
+    // Views in the middle share depth + 8 bytes. Those that end within them
+    // are prefixes of the others and go first, shortest first, since they
+    // can only differ in trailing '\0's.
+    prefixed_view* equal = v + lt;
+    size_t m = gt - lt;
+    const size_t next_depth = depth + 8;
+    prefixed_view* rest =
+        std::partition(equal, equal + m, [next_depth](const prefixed_view& x) {
+          return x.view.size() <= next_depth;
+        });
+    std::sort(equal, rest, [](const prefixed_view& a, const prefixed_view& b) {
+      return a.view.size() < b.view.size();
+    });
+    m -= rest - equal;
+    for (size_t k = 0; k < m; ++k) {
+      rest[k].prefix = load_prefix(rest[k].view, next_depth);
+    }
+
+    const size_t greater = n - gt;
+    if (m >= lt && m >= greater) {
+      multikey_quicksort(v, lt, depth, budget);
+      multikey_quicksort(v + gt, greater, depth, budget);
+      v = rest;
+      n = m;
+      depth = next_depth;
+      budget = partition_budget(m);
+    } else {
+      multikey_quicksort(rest, m, next_depth, partition_budget(m));
+      if (lt >= greater) {
+        multikey_quicksort(v + gt, greater, depth, budget);
+        n = lt;
+      } else {
+        multikey_quicksort(v, lt, depth, budget);
+        v += gt;
+        n = greater;
+      }
+    }
+  }
+  insertion_sort(v, n, depth);
+}
+
+inline void multikey_quicksort(prefixed_view* v, size_t n, size_t depth) {
+  multikey_quicksort(v, n, depth, partition_budget(n));
+}
+
+// Up to num_buckets - 1 distinct views, in order, picked from a sorted
+// sample of views[0, n) to split it into buckets of about equal size. They
+// are whole views, not prefixes, so keys that share their first bytes, as
+// URLs or paths do, still split evenly. Their prefixes are loaded at depth
+// 0.
+inline std::vector<prefixed_view> sample_splitters(const string_view* views,
+                                                   size_t n,
+                                                   size_t num_buckets) {
+  static const size_t kOversampling = 16;
+  std::vector<string_view> sample(num_buckets * kOversampling);
+  std::mt19937_64 rng(n);
+  for (size_t i = 0; i < sample.size(); ++i) sample[i] = views[rng() % n];
+  std::sort(sample.begin(), sample.end());
+  std::vector<prefixed_view> splitters;
+  for (size_t b = 1; b < num_buckets; ++b) {
+    const string_view s = sample[b * sample.size() / num_buckets];
+    if (splitters.empty() || splitters.back().view != s) {
+      splitters.push_back(prefixed_view{load_prefix(s, 0), s});
+    }
+  }
+  return splitters;
+}
+
+// The bucket of x: the first b with x <= splitters[b], or
+// splitters.size(). x's prefix is loaded at depth 0.
+inline size_t bucket_of(const std::vector<prefixed_view>& splitters,
+                        const prefixed_view& x) {
+  return std::lower_bound(splitters.begin(), splitters.end(), x,
+                          [](const prefixed_view& a, const prefixed_view& b) {
+                            return view_less_from(a, b, 0);
+                          }) -
+         splitters.begin();
+}
+
+}  // namespace internal
+
+// Sorts views[0, n) in the order of operator<.
+//
+// Each view is paired with 8 of its bytes, loaded big-endian into an integer,
+// and the pairs are sorted with a multikey quicksort on those integers. Most
+// comparisons never dereference the views, and a view's data is read once
+// per 8 bytes of common prefix rather than once per comparison.
+inline void sort_views(string_view* views, size_t n) {
+  std::vector<internal::prefixed_view> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    v[i].prefix = internal::load_prefix(views[i], 0);
+    v[i].view = views[i];
+  }
+  internal::multikey_quicksort(v.data(), n, 0);
+  for (size_t i = 0; i < n; ++i) views[i] = v[i].view;
+}
+
+// Same result as sort_views, computed on pool. The views are split into
+// buckets by splitters picked from a sample, and the buckets are sorted in
+// parallel, each from the prefix that all of its views share.
+inline void parallel_sort_views(
+    string_view* views, size_t n,
+    thread_pool& pool = thread_pool::default_pool()) {
+  static const size_t kMinParallelSize = 1 << 16;
+  static const size_t kBlockSize = 1 << 14;
+  if (n < kMinParallelSize || pool.size() == 1) {
+    sort_views(views, n);
+    return;
+  }
+
+  // Bucket b holds the views in (splitters[b - 1], splitters[b]], so equal
+  // views always share a bucket.
+  const std::vector<internal::prefixed_view> splitters =
+      internal::sample_splitters(views, n, pool.size() * 8);
+  const size_t num_buckets = splitters.size() + 1;
+
+  // Classify blocks in parallel, then scatter each block to its place in a
+  // bucket-ordered copy.
+  const size_t num_blocks = (n + kBlockSize - 1) / kBlockSize;
+  std::vector<internal::prefixed_view> items(n);
+  std::vector<uint32_t> bucket_of(n);
+  std::vector<size_t> counts(num_blocks * num_buckets);
+  pool.parallel_for(num_blocks, [&](size_t block) {
+    const size_t end = std::min(n, (block + 1) * kBlockSize);
+    size_t* block_counts = &counts[block * num_buckets];
+    for (size_t i = block * kBlockSize; i < end; ++i) {
+      items[i].prefix = internal::load_prefix(views[i], 0);
+      items[i].view = views[i];
+      bucket_of[i] =
+          static_cast<uint32_t>(internal::bucket_of(splitters, items[i]));
+      ++block_counts[bucket_of[i]];
+    }
+  });
+
+  // offsets[block * num_buckets + b] is where the block writes bucket b.
+  std::vector<size_t> offsets(num_blocks * num_buckets);
+  std::vector<size_t> bucket_begin(num_buckets + 1);
+  size_t total = 0;
+  for (size_t b = 0; b < num_buckets; ++b) {
+    bucket_begin[b] = total;
+    for (size_t block = 0; block < num_blocks; ++block) {
+      offsets[block * num_buckets + b] = total;
+      total += counts[block * num_buckets + b];
+    }
+  }
+  bucket_begin[num_buckets] = total;
+
+  std::vector<internal::prefixed_view> sorted(n);
+  pool.parallel_for(num_blocks, [&](size_t block) {
+    const size_t end = std::min(n, (block + 1) * kBlockSize);
+    size_t* block_offsets = &offsets[block * num_buckets];
+    for (size_t i = block * kBlockSize; i < end; ++i) {
+      sorted[block_offsets[bucket_of[i]]++] = items[i];
+    }
+  });
+
+  // The views between two splitters share the splitters' common prefix.
+  pool.parallel_for(num_buckets, [&](size_t b) {
+    internal::prefixed_view* bucket = &sorted[bucket_begin[b]];
+    const size_t size = bucket_begin[b + 1] - bucket_begin[b];
+    size_t depth = 0;
+    if (b > 0 && b < splitters.size()) {
+      depth = common_prefix_length(splitters[b - 1].view, splitters[b].view);
+    }
+    if (depth != 0) {
+      for (size_t i = 0; i < size; ++i) {
+        bucket[i].prefix = internal::load_prefix(bucket[i].view, depth);
+      }
+    }
+    internal::multikey_quicksort(bucket, size, depth);
+  });
+
+  pool.parallel_for(num_blocks, [&](size_t block) {
+    const size_t end = std::min(n, (block + 1) * kBlockSize);
+    for (size_t i = block * kBlockSize; i < end; ++i) views[i] = sorted[i].view;
+  });
+}
+
+// Sets lcp[i] to common_prefix_length(views[i - 1], views[i]) for every i in
+// [1, n), and lcp[0] to 0. Run on views sorted by sort_views, this is their
+// LCP array, as used to front-code them or to build a trie.
+inline void lcp_array(const string_view* views, size_t n, size_t* lcp) {
+  if (n == 0) return;
+  lcp[0] = 0;
+  for (size_t i = 1; i < n; ++i) {
+    lcp[i] = common_prefix_length(views[i - 1], views[i]);
+  }
+}
+
+// Same result as lcp_array, computed on pool in blocks of views.
+inline void parallel_lcp_array(
+    const string_view* views, size_t n, size_t* lcp,
+    thread_pool& pool = thread_pool::default_pool()) {
+  static const size_t kMinParallelSize = 1 << 16;
+  static const size_t kBlockSize = 1 << 14;
+  if (n < kMinParallelSize || pool.size() == 1) {
+    lcp_array(views, n, lcp);
+    return;
+  }
+  lcp[0] = 0;
+  pool.parallel_for((n + kBlockSize - 1) / kBlockSize, [&](size_t block) {
+    const size_t begin = std::max<size_t>(block * kBlockSize, 1);
+    const size_t end = std::min(n, (block + 1) * kBlockSize);
+    for (size_t i = begin; i < end; ++i) {
+      lcp[i] = common_prefix_length(views[i - 1], views[i]);
+    }
+  });
+}
+
+}  // namespace david
+
+#endif  // TYPES_SORT_VIEWS
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/sort_views.h"
+
+namespace david {
+namespace {
+
+// URL-like keys: a handful of hosts and paths followed by random ids.
+std::vector<std::string> make_urls(size_t n) {
+  std::mt19937 rng(42);
+  const char* hosts[] = {"https://www.example.com/", "https://api.example.org/",
+                         "http://static.example.net/"};
+  const char* paths[] = {"users/", "items/", "search?q=", "images/large/"};
+  std::vector<std::string> urls(n);
+  for (size_t i = 0; i < n; ++i) {
+    urls[i] = std::string(hosts[rng() % 3]) + paths[rng() % 4];
+    for (int j = 0; j < 12; ++j) {
+      urls[i].push_back(static_cast<char>('a' + rng() % 26));
+    }
+  }
+  // Shuffle the heap placement as well as the order.
+  std::shuffle(urls.begin(), urls.end(), rng);
+  return urls;
+}
+
+void BM_StdSort(benchmark::State& state) {
+  const std::vector<std::string> urls = make_urls(state.range(0));
+  const std::vector<string_view> input(urls.begin(), urls.end());
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<string_view> views = input;
+    state.ResumeTiming();
+    std::sort(views.begin(), views.end());
+    benchmark::DoNotOptimize(views.data());
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_StdSort)->Arg(1 << 20);
+
+void BM_SortViews(benchmark::State& state) {
+  const std::vector<std::string> urls = make_urls(state.range(0));
+  const std::vector<string_view> input(urls.begin(), urls.end());
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<string_view> views = input;
+    state.ResumeTiming();
+    sort_views(views.data(), views.size());
+    benchmark::DoNotOptimize(views.data());
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_SortViews)->Arg(1 << 20);
+
+void BM_ParallelSortViews(benchmark::State& state) {
+  const std::vector<std::string> urls = make_urls(state.range(0));
+  const std::vector<string_view> input(urls.begin(), urls.end());
+  thread_pool pool(state.range(1));
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<string_view> views = input;
+    state.ResumeTiming();
+    parallel_sort_views(views.data(), views.size(), pool);
+    benchmark::DoNotOptimize(views.data());
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParallelSortViews)
+    ->Args({1 << 20, 1})
+    ->Args({1 << 20, 2})
+    ->Args({1 << 20, 4})
+    ->Args({1 << 20, 8})
+    ->UseRealTime();
+
+// Keys of one site: the first 30 bytes of every key are the same.
+std::vector<std::string> make_site_urls(size_t n) {
+  std::mt19937 rng(42);
+  std::vector<std::string> urls(n);
+  for (std::string& url : urls) {
+    url = "https://www.example.com/users/";
+    for (int j = 0; j < 12; ++j) {
+      url.push_back(static_cast<char>('a' + rng() % 26));
+    }
+  }
+  return urls;
+}
+
+void BM_ParallelSortSharedPrefix(benchmark::State& state) {
+  const std::vector<std::string> urls = make_site_urls(state.range(0));
+  const std::vector<string_view> input(urls.begin(), urls.end());
+  thread_pool pool(state.range(1));
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<string_view> views = input;
+    state.ResumeTiming();
+    parallel_sort_views(views.data(), views.size(), pool);
+    benchmark::DoNotOptimize(views.data());
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParallelSortSharedPrefix)
+    ->Args({1 << 20, 1})
+    ->Args({1 << 20, 2})
+    ->Args({1 << 20, 4})
+    ->Args({1 << 20, 8})
+    ->UseRealTime();
+
+// The LCP array of sorted URLs, a char at a time as a baseline.
+void BM_LcpByteLoop(benchmark::State& state) {
+  const std::vector<std::string> urls = make_urls(state.range(0));
+  std::vector<string_view> views(urls.begin(), urls.end());
+  sort_views(views.data(), views.size());
+  std::vector<size_t> lcp(views.size());
+  for (auto _ : state) {
+    for (size_t i = 1; i < views.size(); ++i) {
+      const string_view a = views[i - 1];
+      const string_view b = views[i];
+      const size_t n = std::min(a.size(), b.size());
+      size_t k = 0;
+      while (k < n && a[k] == b[k]) ++k;
+      lcp[i] = k;
+    }
+    benchmark::DoNotOptimize(lcp.data());
+  }
+  state.SetItemsProcessed(state.iterations() * views.size());
+}
+BENCHMARK(BM_LcpByteLoop)->Arg(1 << 20);
+
+void BM_LcpArray(benchmark::State& state) {
+  const std::vector<std::string> urls = make_urls(state.range(0));
+  std::vector<string_view> views(urls.begin(), urls.end());
+  sort_views(views.data(), views.size());
+  std::vector<size_t> lcp(views.size());
+  for (auto _ : state) {
+    lcp_array(views.data(), views.size(), lcp.data());
+    benchmark::DoNotOptimize(lcp.data());
+  }
+  state.SetItemsProcessed(state.iterations() * views.size());
+}
+BENCHMARK(BM_LcpArray)->Arg(1 << 20);
+
+void BM_ParallelLcpArray(benchmark::State& state) {
+  const std::vector<std::string> urls = make_urls(state.range(0));
+  std::vector<string_view> views(urls.begin(), urls.end());
+  sort_views(views.data(), views.size());
+  std::vector<size_t> lcp(views.size());
+  thread_pool pool(state.range(1));
+  for (auto _ : state) {
+    parallel_lcp_array(views.data(), views.size(), lcp.data(), pool);
+    benchmark::DoNotOptimize(lcp.data());
+  }
+  state.SetItemsProcessed(state.iterations() * views.size());
+}
+BENCHMARK(BM_ParallelLcpArray)->Args({1 << 20, 4})->UseRealTime();
+
+}  // namespace
+}  // namespace david
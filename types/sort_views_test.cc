@@ -0,0 +1,189 @@
+#include "types/sort_views.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<std::string> random_strings(size_t n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> strings(n);
+  const std::string prefixes[] = {"", "https://www.example.com/",
+                                  "https://www.example.com/path/to/",
+                                  std::string("\0\0\0\0\0\0\0\0", 8)};
+  for (size_t i = 0; i < n; ++i) {
+    std::string& s = strings[i];
+    s = prefixes[rng() % 4];
+    const size_t len = rng() % 20;
+    for (size_t j = 0; j < len; ++j) {
+      // A tiny alphabet with '\0' and 0xff makes ties and edge bytes common.
+      const char alphabet[] = {'\0', 'a', 'b', '\xff'};
+      s.push_back(alphabet[rng() % 4]);
+    }
+  }
+  return strings;
+}
+
+TEST(SortViews, Small) {
+  std::vector<string_view> views = {"pear", "apple", "", "fig", "apple",
+                                    "applesauce"};
+  sort_views(views.data(), views.size());
+  EXPECT_THAT(views,
+              ElementsAre("", "apple", "apple", "applesauce", "fig", "pear"));
+}
+
+TEST(SortViews, TrailingNulls) {
+  const std::string a("abcdefgh", 8);
+  const std::string b("abcdefgh\0", 9);
+  const std::string c("abcdefgh\0\0", 10);
+  const std::string d("abcdefg", 7);
+  std::vector<string_view> views = {c, a, d, b};
+  sort_views(views.data(), views.size());
+  EXPECT_THAT(views, ElementsAre(string_view(d), string_view(a),
+                                 string_view(b), string_view(c)));
+}
+
+TEST(SortViews, MatchesStdSort) {
+  for (size_t n : {0, 1, 2, 17, 100, 5000}) {
+    const std::vector<std::string> strings = random_strings(n, n);
+    std::vector<string_view> views(strings.begin(), strings.end());
+    std::vector<string_view> expected = views;
+    std::sort(expected.begin(), expected.end());
+    sort_views(views.data(), views.size());
+    ASSERT_EQ(views, expected) << n;
+  }
+}
+
+// Orders that defeat a median of three pivot, on keys that share their
+// first 8 bytes, so they are partitioned at depth 8.
+TEST(SortViews, AdversarialOrders) {
+  const size_t n = 100000;
+  std::vector<std::string> strings(n);
+  for (size_t i = 0; i < n; ++i) {
+    char key[17];
+    snprintf(key, sizeof(key), "%016zu", i);
+    strings[i] = key;
+  }
+  std::vector<std::vector<string_view>> orders;
+  orders.emplace_back(strings.begin(), strings.end());
+  orders.emplace_back(strings.rbegin(), strings.rend());
+  std::vector<string_view> organ_pipe;
+  for (size_t i = 0; i < n; i += 2) organ_pipe.push_back(strings[i]);
+  for (size_t i = n - 1; i < n; i -= 2) organ_pipe.push_back(strings[i]);
+  orders.push_back(organ_pipe);
+  std::vector<string_view> sawtooth;
+  for (size_t i = 0; i < n; ++i) sawtooth.push_back(strings[i % 1000]);
+  orders.push_back(sawtooth);
+
+  for (std::vector<string_view>& views : orders) {
+    std::vector<string_view> expected = views;
+    std::sort(expected.begin(), expected.end());
+    sort_views(views.data(), views.size());
+    ASSERT_EQ(views, expected);
+  }
+}
+
+TEST(SortViews, FallbackSortMatchesStdSort) {
+  const std::vector<std::string> strings = random_strings(5000, 11);
+  std::vector<internal::prefixed_view> v(strings.size());
+  for (size_t i = 0; i < strings.size(); ++i) {
+    v[i].view = strings[i];
+    v[i].prefix = internal::load_prefix(v[i].view, 0);
+  }
+  // No partitions at depth 0: it is all std::sort.
+  internal::multikey_quicksort(v.data(), v.size(), 0, 0);
+  std::vector<string_view> expected(strings.begin(), strings.end());
+  std::sort(expected.begin(), expected.end());
+  for (size_t i = 0; i < v.size(); ++i) ASSERT_EQ(v[i].view, expected[i]) << i;
+}
+
+TEST(SortViews, ParallelMatchesStdSort) {
+  thread_pool pool(4);
+  const std::vector<std::string> strings = random_strings(200000, 3);
+  std::vector<string_view> views(strings.begin(), strings.end());
+  std::vector<string_view> expected = views;
+  std::sort(expected.begin(), expected.end());
+  parallel_sort_views(views.data(), views.size(), pool);
+  EXPECT_EQ(views, expected);
+}
+
+// Keys whose first 30 bytes are the same, as the URLs of one site are.
+TEST(SortViews, ParallelSharedPrefix) {
+  std::mt19937 rng(9);
+  std::vector<std::string> strings(200000);
+  for (std::string& s : strings) {
+    s = "https://www.example.com/users/";
+    for (int j = 0; j < 10; ++j) {
+      s.push_back(static_cast<char>('a' + rng() % 26));
+    }
+  }
+  std::vector<string_view> views(strings.begin(), strings.end());
+
+  // The splitters split past the shared prefix, into buckets of about equal
+  // size.
+  const size_t num_buckets = 32;
+  const std::vector<internal::prefixed_view> splitters =
+      internal::sample_splitters(views.data(), views.size(), num_buckets);
+  ASSERT_EQ(splitters.size(), num_buckets - 1);
+  std::vector<size_t> sizes(num_buckets);
+  for (const string_view v : views) {
+    ++sizes[internal::bucket_of(
+        splitters, internal::prefixed_view{internal::load_prefix(v, 0), v})];
+  }
+  EXPECT_LT(*std::max_element(sizes.begin(), sizes.end()),
+            3 * views.size() / num_buckets);
+
+  thread_pool pool(4);
+  std::vector<string_view> expected = views;
+  std::sort(expected.begin(), expected.end());
+  parallel_sort_views(views.data(), views.size(), pool);
+  EXPECT_EQ(views, expected);
+}
+
+TEST(SortViews, ParallelWithManyDuplicates) {
+  thread_pool pool(3);
+  std::vector<std::string> strings(100000, "same");
+  strings[500] = "different";
+  std::vector<string_view> views(strings.begin(), strings.end());
+  std::vector<string_view> expected = views;
+  std::sort(expected.begin(), expected.end());
+  parallel_sort_views(views.data(), views.size(), pool);
+  EXPECT_EQ(views, expected);
+}
+
+TEST(SortViews, LcpArray) {
+  const std::vector<string_view> views = {"", "apple", "apple", "applesauce",
+                                          "apply", "fig"};
+  std::vector<size_t> lcp(views.size());
+  lcp_array(views.data(), views.size(), lcp.data());
+  EXPECT_THAT(lcp, ElementsAre(0, 0, 5, 5, 4, 0));
+}
+
+TEST(SortViews, ParallelLcpArray) {
+  thread_pool pool(4);
+  const std::vector<std::string> strings = random_strings(200000, 5);
+  std::vector<string_view> views(strings.begin(), strings.end());
+  sort_views(views.data(), views.size());
+  std::vector<size_t> lcp(views.size());
+  parallel_lcp_array(views.data(), views.size(), lcp.data(), pool);
+  EXPECT_EQ(lcp[0], 0u);
+  for (size_t i = 1; i < views.size(); ++i) {
+    const string_view a = views[i - 1];
+    const string_view b = views[i];
+    size_t want = 0;
+    while (want < a.size() && want < b.size() && a[want] == b[want]) ++want;
+    ASSERT_EQ(lcp[i], want) << i;
+  }
+}
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,394 @@
+#ifndef TYPES_SORTED_DICTIONARY
+#define TYPES_SORTED_DICTIONARY
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types/internal/little_endian.h"
+#include "types/string_view.h"
+
+namespace david {
+namespace internal {
+
+// LEB128 variable-width integers, as stored in a sorted_dictionary.
+inline void append_varint(std::vector<char>* out, uint64_t x) {
+  while (x >= 0x80) {
+    out->push_back(static_cast<char>(x | 0x80));
+    x >>= 7;
+  }
+  out->push_back(static_cast<char>(x));
+}
+
+// Reads a varint at p, which must be well formed.
+inline uint64_t read_varint(const char*& p) {
+  uint64_t x = 0;
+  for (int shift = 0;; shift += 7) {
+    const unsigned char byte = static_cast<unsigned char>(*p++);
+    x |= uint64_t(byte & 0x7f) << shift;
+    if (byte < 0x80) return x;
+  }
+}
+
+// Defined in a template so that the header can define it without breaking
+// the one definition rule.
+template <typename T = void>
+struct sorted_dictionary_constants {
+  // Returned by lookup() for keys that are not in the dictionary.
+  static const size_t npos;
+};
+
+template <typename T>
+const size_t sorted_dictionary_constants<T>::npos = ~size_t(0);
+
+}  // namespace internal
+
+// An immutable set of strings, sorted and numbered from 0, stored in about as
+// many bytes as their distinct suffixes.
+//
+// Keys are front-coded in blocks: the first key of each block is stored
+// whole and every other key as the length of the prefix it shares with the
+// previous key plus the rest of its chars. A lookup binary searches the first
+// keys of the blocks, then decodes a single block.
+//
+// The whole dictionary is one flat buffer, returned by bytes(). Write it to a
+// file and attach a dictionary to the file's mapping with from_bytes(), which
+// reads nothing but the header. The layout, with integers little-endian:
+//
+//   char magic[4] = "SDIC"  uint32 version  uint64 size
+//   uint32 block_size  uint32 reserved  uint64 num_blocks
+//   uint64 block_offsets[num_blocks + 1]
+//   blocks: varint size, chars; then, for every other key,
+//           varint shared prefix, varint suffix size, suffix chars.
+//
+// Keys decode into a caller-provided scratch string or into an iterator, so
+// queries never allocate once those have grown to fit the longest key.
+class sorted_dictionary : public internal::sorted_dictionary_constants<> {
+ public:
+  static const uint32_t kVersion = 1;
+  static const size_t kDefaultBlockSize = 32;
+
+  // Sequential access to keys in id order. Dereferencing returns a view into
+  // the iterator, valid until it is incremented or destroyed.
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const string_view*;
+    using reference = string_view;
+
+    iterator() noexcept : dict_(nullptr), id_(0), pos_(nullptr) {}
+
+    size_t id() const noexcept { return id_; }
+    string_view operator*() const noexcept { return key_; }
+
+    iterator& operator++() {
+      ++id_;
+      if (id_ < dict_->size_) {
+        if (id_ % dict_->block_size_ == 0) {
+          pos_ = dict_->block_begin(id_ / dict_->block_size_);
+          dict_->decode_first(pos_, &key_);
+        } else {
+          dict_->decode_next(pos_, &key_);
+        }
+      }
+      return *this;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) noexcept {
+      return a.id_ == b.id_;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) noexcept {
+      return a.id_ != b.id_;
+    }
+
+   private:
+    friend class sorted_dictionary;
+
+    const sorted_dictionary* dict_;
+    size_t id_;
+    // Start of the key after id_ within its block.
+    const char* pos_;
+    std::string key_;
+  };
+
+  // An empty dictionary.
+  sorted_dictionary() : sorted_dictionary(build(nullptr, 0)) {}
+
+  // Copies of a dictionary built in memory own a copy of its bytes; copies
+  // of one made with from_bytes() share the caller's buffer.
+  sorted_dictionary(const sorted_dictionary& other)
+      : sorted_dictionary(other.storage_.empty()
+                              ? from_bytes(other.bytes_)
+                              : from_storage(other.storage_)) {}
+  sorted_dictionary& operator=(const sorted_dictionary& other) {
+    if (this != &other) *this = sorted_dictionary(other);
+    return *this;
+  }
+  // Moving a vector keeps its buffer, so views into it survive moves.
+  sorted_dictionary(sorted_dictionary&&) = default;
+  sorted_dictionary& operator=(sorted_dictionary&&) = default;
+
+  // Encodes keys[0, n), which must be strictly increasing, in blocks of
+  // block_size keys. Throws std::invalid_argument if the keys are not sorted
+  // or block_size is outside [1, 1024].
+  static sorted_dictionary build(const string_view* keys, size_t n,
+                                 size_t block_size = kDefaultBlockSize) {
+    if (block_size < 1 || block_size > 1024) {
+      throw std::invalid_argument("block_size must be in [1, 1024]");
+    }
+    const size_t num_blocks = (n + block_size - 1) / block_size;
+
+    std::vector<char> data;
+    std::vector<uint64_t> offsets(num_blocks + 1);
+    for (size_t i = 0; i < n; ++i) {
+      if (i > 0 && !(keys[i - 1] < keys[i])) {
+        throw std::invalid_argument("keys must be strictly increasing");
+      }
+      if (i % block_size == 0) {
+        offsets[i / block_size] = data.size();
+        internal::append_varint(&data, keys[i].size());
+        data.insert(data.end(), keys[i].begin(), keys[i].end());
+        continue;
+      }
+      const string_view prev = keys[i - 1];
+      const string_view key = keys[i];
+      size_t shared = 0;
+      const size_t limit = prev.size() < key.size() ? prev.size() : key.size();
+      while (shared < limit && prev[shared] == key[shared]) ++shared;
+      internal::append_varint(&data, shared);
+      internal::append_varint(&data, key.size() - shared);
+      data.insert(data.end(), key.begin() + shared, key.end());
+    }
+    offsets[num_blocks] = data.size();
+
+    std::vector<char> bytes;
+    bytes.reserve(kHeaderSize + 8 * offsets.size() + data.size());
+    bytes.insert(bytes.end(), magic(), magic() + 4);
+    internal::append_le32(&bytes, kVersion);
+    internal::append_le64(&bytes, n);
+    internal::append_le32(&bytes, static_cast<uint32_t>(block_size));
+    internal::append_le32(&bytes, 0);
+    internal::append_le64(&bytes, num_blocks);
+    for (size_t b = 0; b <= num_blocks; ++b) {
+      internal::append_le64(&bytes, offsets[b]);
+    }
+    bytes.insert(bytes.end(), data.begin(), data.end());
+
+    return from_storage(std::move(bytes));
+  }
+  static sorted_dictionary build(const std::vector<string_view>& keys,
+                                 size_t block_size = kDefaultBlockSize) {
+    return build(keys.data(), keys.size(), block_size);
+  }
+
+  // A dictionary over bytes produced by bytes(), such as a mapped file. The
+  // bytes are not copied and must outlive the dictionary. Checks the header
+  // and the size of the buffer, and throws std::invalid_argument when they
+  // do not match; the blocks themselves are trusted.
+  static sorted_dictionary from_bytes(string_view bytes) {
+    if (bytes.size() < kHeaderSize ||
+        std::memcmp(bytes.data(), magic(), 4) != 0) {
+      throw std::invalid_argument("not a sorted_dictionary");
+    }
+    const char* p = bytes.data();
+    if (internal::load_le32(p + 4) != kVersion) {
+      throw std::invalid_argument("unsupported sorted_dictionary version");
+    }
+    const uint64_t size = internal::load_le64(p + 8);
+    const uint32_t block_size = internal::load_le32(p + 16);
+    const uint64_t num_blocks = internal::load_le64(p + 24);
+    if (block_size == 0 || num_blocks != (size + block_size - 1) / block_size ||
+        num_blocks >= (bytes.size() - kHeaderSize) / 8) {
+      throw std::invalid_argument("corrupt sorted_dictionary header");
+    }
+    const size_t data_begin = kHeaderSize + 8 * (num_blocks + 1);
+    if (internal::load_le64(p + data_begin - 8) != bytes.size() - data_begin) {
+      throw std::invalid_argument("sorted_dictionary size mismatch");
+    }
+
+    sorted_dictionary dict(nullptr);
+    dict.bytes_ = bytes;
+    dict.size_ = size;
+    dict.block_size_ = block_size;
+    dict.num_blocks_ = num_blocks;
+    dict.offsets_ = p + kHeaderSize;
+    dict.data_ = p + data_begin;
+    return dict;
+  }
+
+  // The serialized dictionary.
+  string_view bytes() const noexcept { return bytes_; }
+
+  // Capacity.
+  size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  size_t block_size() const noexcept { return block_size_; }
+
+  // Id of key, or npos if it is not in the dictionary.
+  size_t lookup(string_view key) const {
+    std::string scratch;
+    return lookup(key, &scratch);
+  }
+  size_t lookup(string_view key, std::string* scratch) const {
+    const size_t id = lower_bound(key, scratch);
+    return id < size_ && string_view(*scratch) == key ? id : npos;
+  }
+
+  // Id of the first key not less than key, or size() if there is none.
+  size_t lower_bound(string_view key) const {
+    std::string scratch;
+    return lower_bound(key, &scratch);
+  }
+  // Leaves the key with the returned id, if any, in scratch.
+  size_t lower_bound(string_view key, std::string* scratch) const {
+    if (size_ == 0) return 0;
+    // Last block whose first key is not greater than key.
+    size_t lo = 0, hi = num_blocks_;
+    while (hi - lo > 1) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (first_key(mid) <= key) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+
+    const char* p = block_begin(lo);
+    decode_first(p, scratch);
+    size_t id = lo * block_size_;
+    const size_t end = std::min<size_t>(size_, id + block_size_);
+    while (string_view(*scratch) < key) {
+      if (++id == size_) return id;
+      if (id == end) {
+        decode_first(p = block_begin(lo + 1), scratch);
+        return id;
+      }
+      decode_next(p, scratch);
+    }
+    return id;
+  }
+
+  // Key with the given id, decoded into scratch. Throws std::out_of_range if
+  // id >= size().
+  string_view at(size_t id, std::string* scratch) const {
+    if (id >= size_) throw std::out_of_range("sorted_dictionary::at");
+    const char* p = block_begin(id / block_size_);
+    decode_first(p, scratch);
+    for (size_t i = id % block_size_; i > 0; --i) decode_next(p, scratch);
+    return *scratch;
+  }
+  std::string at(size_t id) const {
+    std::string key;
+    at(id, &key);
+    return key;
+  }
+
+  // Iterator support.
+  iterator begin() const { return iterator_at(0); }
+  iterator end() const { return iterator_at(size_); }
+  // Iterator to the key with the given id, or end() if id >= size().
+  iterator iterator_at(size_t id) const {
+    iterator it;
+    it.dict_ = this;
+    it.id_ = id < size_ ? id : size_;
+    if (it.id_ < size_) {
+      it.pos_ = block_begin(id / block_size_);
+      decode_first(it.pos_, &it.key_);
+      for (size_t i = id % block_size_; i > 0; --i) {
+        decode_next(it.pos_, &it.key_);
+      }
+    }
+    return it;
+  }
+
+  // Ids [first, last) of the keys that start with prefix.
+  std::pair<size_t, size_t> prefix_range(string_view prefix) const {
+    std::string scratch;
+    const size_t first = lower_bound(prefix, &scratch);
+    size_t last = first;
+    if (first < size_ && string_view(scratch).starts_with(prefix)) {
+      // The keys with the prefix end before the first key not less than the
+      // prefix with its last char incremented, dropping trailing '\xff's.
+      std::string upper(prefix.data(), prefix.size());
+      while (!upper.empty() && upper.back() == '\xff') upper.pop_back();
+      if (upper.empty()) {
+        last = size_;
+      } else {
+        ++upper.back();
+        last = lower_bound(upper, &scratch);
+      }
+    }
+    return std::make_pair(first, last);
+  }
+  // The keys that start with prefix, in order.
+  std::pair<iterator, iterator> prefix_iterators(string_view prefix) const {
+    const std::pair<size_t, size_t> range = prefix_range(prefix);
+    return std::make_pair(iterator_at(range.first), iterator_at(range.second));
+  }
+
+ private:
+  static const size_t kHeaderSize = 32;
+  static const char* magic() { return "SDIC"; }
+
+  explicit sorted_dictionary(std::nullptr_t)
+      : size_(0),
+        block_size_(1),
+        num_blocks_(0),
+        offsets_(nullptr),
+        data_(nullptr) {}
+
+  static sorted_dictionary from_storage(std::vector<char> bytes) {
+    sorted_dictionary dict =
+        from_bytes(string_view(bytes.data(), bytes.size()));
+    dict.storage_ = std::move(bytes);
+    return dict;
+  }
+
+  const char* block_begin(size_t block) const {
+    return data_ + internal::load_le64(offsets_ + 8 * block);
+  }
+
+  // The first key of block, read in place.
+  string_view first_key(size_t block) const {
+    const char* p = block_begin(block);
+    const size_t size = internal::read_varint(p);
+    return string_view(p, size);
+  }
+
+  // Decodes the key at p, the first of its block, into key, and moves p past
+  // it.
+  static void decode_first(const char*& p, std::string* key) {
+    const size_t size = internal::read_varint(p);
+    key->assign(p, size);
+    p += size;
+  }
+  // Decodes the key at p, which follows key in its block.
+  static void decode_next(const char*& p, std::string* key) {
+    const size_t shared = internal::read_varint(p);
+    const size_t suffix = internal::read_varint(p);
+    key->resize(shared);
+    key->append(p, suffix);
+    p += suffix;
+  }
+
+  // Owns the bytes of a built dictionary; empty for one from from_bytes().
+  std::vector<char> storage_;
+  string_view bytes_;
+  size_t size_;
+  size_t block_size_;
+  size_t num_blocks_;
+  const char* offsets_;
+  const char* data_;
+};
+
+}  // namespace david
+
+#endif  // TYPES_SORTED_DICTIONARY
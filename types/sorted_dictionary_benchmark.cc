@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/sorted_dictionary.h"
+
+namespace david {
+namespace {
+
+// Sorted vocabulary-like terms: random words with shared stems.
+std::vector<std::string> make_terms(size_t n) {
+  std::mt19937 rng(42);
+  std::vector<std::string> terms(n);
+  for (std::string& term : terms) {
+    const size_t size = 4 + rng() % 12;
+    for (size_t i = 0; i < size; ++i) {
+      term.push_back(static_cast<char>('a' + rng() % 8));
+    }
+  }
+  std::sort(terms.begin(), terms.end());
+  terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+  return terms;
+}
+
+std::vector<std::string> make_queries(const std::vector<std::string>& terms) {
+  std::mt19937 rng(7);
+  std::vector<std::string> queries(1 << 16);
+  for (std::string& query : queries) query = terms[rng() % terms.size()];
+  return queries;
+}
+
+void BM_VectorLookup(benchmark::State& state) {
+  const std::vector<std::string> terms = make_terms(state.range(0));
+  const std::vector<std::string> queries = make_queries(terms);
+  size_t bytes = terms.capacity() * sizeof(std::string);
+  for (const std::string& term : terms) {
+    // Heap blocks for strings longer than the inline buffer.
+    if (term.capacity() > 15) bytes += term.capacity() + 1;
+  }
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (const std::string& query : queries) {
+      sum += std::lower_bound(terms.begin(), terms.end(), query) -
+             terms.begin();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+  state.counters["bytes_per_term"] = double(bytes) / terms.size();
+}
+BENCHMARK(BM_VectorLookup)->Arg(1 << 20);
+
+void BM_DictionaryLookup(benchmark::State& state) {
+  const std::vector<std::string> terms = make_terms(state.range(0));
+  const std::vector<std::string> queries = make_queries(terms);
+  const std::vector<string_view> views(terms.begin(), terms.end());
+  const sorted_dictionary dict =
+      sorted_dictionary::build(views, state.range(1));
+  std::string scratch;
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (const std::string& query : queries) {
+      sum += dict.lookup(query, &scratch);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+  state.counters["bytes_per_term"] =
+      double(dict.bytes().size()) / terms.size();
+}
+BENCHMARK(BM_DictionaryLookup)
+    ->Args({1 << 20, 16})
+    ->Args({1 << 20, 32})
+    ->Args({1 << 20, 64});
+
+void BM_DictionaryAt(benchmark::State& state) {
+  const std::vector<std::string> terms = make_terms(state.range(0));
+  const std::vector<string_view> views(terms.begin(), terms.end());
+  const sorted_dictionary dict = sorted_dictionary::build(views);
+  std::mt19937 rng(7);
+  std::vector<size_t> ids(1 << 16);
+  for (size_t& id : ids) id = rng() % terms.size();
+  std::string scratch;
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (size_t id : ids) sum += dict.at(id, &scratch).size();
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+BENCHMARK(BM_DictionaryAt)->Arg(1 << 20);
+
+}  // namespace
+}  // namespace david
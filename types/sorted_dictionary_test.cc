@@ -0,0 +1,209 @@
+#include "types/sorted_dictionary.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+std::vector<string_view> views(const std::vector<std::string>& strings) {
+  return std::vector<string_view>(strings.begin(), strings.end());
+}
+
+std::vector<std::string> keys_of(sorted_dictionary::iterator begin,
+                                 sorted_dictionary::iterator end) {
+  std::vector<std::string> keys;
+  for (; begin != end; ++begin) {
+    keys.push_back(std::string((*begin).data(), (*begin).size()));
+  }
+  return keys;
+}
+
+// Random sorted, distinct keys drawn from a small alphabet so that they
+// share long prefixes.
+std::vector<std::string> random_keys(size_t n) {
+  std::mt19937 rng(5);
+  std::vector<std::string> keys(n);
+  for (std::string& key : keys) {
+    const size_t size = rng() % 12;
+    for (size_t i = 0; i < size; ++i) key.push_back("ab\0\xff"[rng() % 4]);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+TEST(SortedDictionary, Empty) {
+  const sorted_dictionary dict;
+  EXPECT_TRUE(dict.empty());
+  EXPECT_EQ(dict.lookup("a"), sorted_dictionary::npos);
+  EXPECT_EQ(dict.lower_bound("a"), 0);
+  EXPECT_THAT(dict.prefix_range(""), Pair(0, 0));
+  EXPECT_TRUE(dict.begin() == dict.end());
+  std::string scratch;
+  EXPECT_THROW(dict.at(0, &scratch), std::out_of_range);
+}
+
+TEST(SortedDictionary, LookupAndAt) {
+  const std::vector<std::string> keys = {"apple", "applet", "apply", "banana",
+                                         "band", "bandana", "can"};
+  const sorted_dictionary dict = sorted_dictionary::build(views(keys), 2);
+  EXPECT_EQ(dict.size(), keys.size());
+  std::string scratch;
+  for (size_t id = 0; id < keys.size(); ++id) {
+    EXPECT_EQ(dict.lookup(keys[id]), id);
+    EXPECT_EQ(dict.at(id, &scratch), keys[id]);
+    EXPECT_EQ(dict.at(id), keys[id]);
+  }
+  EXPECT_EQ(dict.lookup(""), sorted_dictionary::npos);
+  EXPECT_EQ(dict.lookup("app"), sorted_dictionary::npos);
+  EXPECT_EQ(dict.lookup("bandanas"), sorted_dictionary::npos);
+  EXPECT_EQ(dict.lookup("zebra"), sorted_dictionary::npos);
+  EXPECT_EQ(dict.lower_bound("app"), 0);
+  EXPECT_EQ(dict.lower_bound("b"), 3);
+  EXPECT_EQ(dict.lower_bound("bane"), 6);
+  EXPECT_EQ(dict.lower_bound("zebra"), 7);
+  EXPECT_THROW(dict.at(7, &scratch), std::out_of_range);
+}
+
+TEST(SortedDictionary, RejectsBadInput) {
+  const std::vector<std::string> unsorted = {"b", "a"};
+  EXPECT_THROW(sorted_dictionary::build(views(unsorted)),
+               std::invalid_argument);
+  const std::vector<std::string> duplicates = {"a", "a"};
+  EXPECT_THROW(sorted_dictionary::build(views(duplicates)),
+               std::invalid_argument);
+  EXPECT_THROW(sorted_dictionary::build(views(duplicates), 0),
+               std::invalid_argument);
+}
+
+TEST(SortedDictionary, Iteration) {
+  const std::vector<std::string> keys = {"a", "ab", "abc", "b", "bc"};
+  const sorted_dictionary dict = sorted_dictionary::build(views(keys), 2);
+  EXPECT_EQ(keys_of(dict.begin(), dict.end()), keys);
+  sorted_dictionary::iterator it = dict.iterator_at(3);
+  EXPECT_EQ(it.id(), 3);
+  EXPECT_EQ(*it, "b");
+  EXPECT_TRUE(dict.iterator_at(10) == dict.end());
+}
+
+TEST(SortedDictionary, PrefixRange) {
+  const std::vector<std::string> keys = {
+      "car", "card", "care", "cart", "cat", std::string("ca\xff"),
+      std::string("ca\xff\xff"), "cb"};
+  const sorted_dictionary dict = sorted_dictionary::build(views(keys), 3);
+  EXPECT_THAT(dict.prefix_range("car"), Pair(0, 4));
+  EXPECT_THAT(dict.prefix_range("ca"), Pair(0, 7));
+  EXPECT_THAT(dict.prefix_range("ca\xff"), Pair(5, 7));
+  EXPECT_THAT(dict.prefix_range(""), Pair(0, 8));
+  EXPECT_THAT(dict.prefix_range("dog"), Pair(8, 8));
+  EXPECT_THAT(dict.prefix_range("cars"), Pair(3, 3));
+
+  const auto range = dict.prefix_iterators("car");
+  EXPECT_THAT(keys_of(range.first, range.second),
+              ElementsAre("car", "card", "care", "cart"));
+}
+
+TEST(SortedDictionary, MatchesSortedVector) {
+  const std::vector<std::string> keys = random_keys(5000);
+  for (size_t block_size : {1, 16, 64}) {
+    const sorted_dictionary dict =
+        sorted_dictionary::build(views(keys), block_size);
+    EXPECT_EQ(keys_of(dict.begin(), dict.end()), keys);
+    std::string scratch;
+    for (size_t id = 0; id < keys.size(); id += 7) {
+      EXPECT_EQ(dict.at(id, &scratch), keys[id]);
+      EXPECT_EQ(dict.lookup(keys[id], &scratch), id);
+      const std::string missing = keys[id] + "c";
+      EXPECT_EQ(dict.lookup(missing), sorted_dictionary::npos);
+      EXPECT_EQ(dict.lower_bound(missing),
+                std::lower_bound(keys.begin(), keys.end(), missing) -
+                    keys.begin());
+    }
+  }
+}
+
+TEST(SortedDictionary, CompressesSharedPrefixes) {
+  std::vector<std::string> keys;
+  size_t raw_size = 0;
+  for (int i = 0; i < 10000; ++i) {
+    char key[64];
+    std::snprintf(key, sizeof(key), "https://example.com/items/%08d", i);
+    keys.push_back(key);
+    raw_size += keys.back().size();
+  }
+  const sorted_dictionary dict = sorted_dictionary::build(views(keys));
+  EXPECT_LT(dict.bytes().size(), raw_size / 4);
+}
+
+TEST(SortedDictionary, CopyAndMove) {
+  const std::vector<std::string> keys = random_keys(100);
+  sorted_dictionary dict = sorted_dictionary::build(views(keys), 16);
+  const sorted_dictionary copy = dict;
+  EXPECT_NE(copy.bytes().data(), dict.bytes().data());
+  const sorted_dictionary moved = std::move(dict);
+  EXPECT_EQ(keys_of(copy.begin(), copy.end()), keys);
+  EXPECT_EQ(keys_of(moved.begin(), moved.end()), keys);
+}
+
+TEST(SortedDictionary, FromBytes) {
+  const std::vector<std::string> keys = random_keys(1000);
+  const sorted_dictionary dict = sorted_dictionary::build(views(keys), 16);
+  const std::string bytes(dict.bytes().data(), dict.bytes().size());
+  const sorted_dictionary view = sorted_dictionary::from_bytes(bytes);
+  EXPECT_EQ(view.bytes().data(), bytes.data());
+  EXPECT_EQ(view.block_size(), 16);
+  EXPECT_EQ(keys_of(view.begin(), view.end()), keys);
+
+  EXPECT_THROW(sorted_dictionary::from_bytes("SDIC"), std::invalid_argument);
+  EXPECT_THROW(sorted_dictionary::from_bytes(string_view(bytes).substr(1)),
+               std::invalid_argument);
+  EXPECT_THROW(sorted_dictionary::from_bytes(
+                   string_view(bytes.data(), bytes.size() - 1)),
+               std::invalid_argument);
+  std::string bad_version = bytes;
+  bad_version[4] = 2;
+  EXPECT_THROW(sorted_dictionary::from_bytes(bad_version),
+               std::invalid_argument);
+}
+
+TEST(SortedDictionary, QueriesMappedFile) {
+  const std::vector<std::string> keys = random_keys(1000);
+  const sorted_dictionary dict = sorted_dictionary::build(views(keys));
+  char path[] = "/tmp/sorted_dictionary_test.XXXXXX";
+  const int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(write(fd, dict.bytes().data(), dict.bytes().size()),
+            static_cast<ssize_t>(dict.bytes().size()));
+  void* mapping =
+      mmap(nullptr, dict.bytes().size(), PROT_READ, MAP_PRIVATE, fd, 0);
+  ASSERT_NE(mapping, MAP_FAILED);
+
+  const sorted_dictionary mapped = sorted_dictionary::from_bytes(
+      string_view(static_cast<const char*>(mapping), dict.bytes().size()));
+  std::string scratch;
+  for (size_t id = 0; id < keys.size(); ++id) {
+    EXPECT_EQ(mapped.lookup(keys[id], &scratch), id);
+  }
+
+  munmap(mapping, dict.bytes().size());
+  close(fd);
+  unlink(path);
+}
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,637 @@
+#ifndef TYPES_STRING
+#define TYPES_STRING
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "types/relocate.h"
+#include "types/string_view.h"
+
+namespace david {
+
+// An owning string with the same interface as std::basic_string, where every
+// search and comparison runs the basic_string_view implementation.
+//
+// The object is 24 bytes. Short strings, up to 23 chars (11 char16_t, 5
+// char32_t), are stored inline. The last byte holds the number of unused
+// inline slots, so it doubles as the null terminator of a full inline string.
+// Longer strings store {data, size, capacity} and tag the last byte, which is
+// the most significant byte of the capacity, with its top bit.
+//
+// The layout relies on a little-endian target and an allocator that is empty
+// and hands out raw pointers. Nothing points into the object, so it is
+// trivially relocatable when the allocator is.
+template <class CharT, class Traits = std::char_traits<CharT>,
+          class Allocator = std::allocator<CharT>>
+class basic_string {
+  typedef std::allocator_traits<Allocator> alloc_traits;
+
+ public:
+  // Types.
+  using trivially_relocatable = internal::trivially_relocatable_if<
+      is_trivially_relocatable<Allocator>::value, basic_string>;
+  using traits_type = Traits;
+  using value_type = CharT;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = CharT&;
+  using const_reference = const CharT&;
+  using pointer = CharT*;
+  using const_pointer = const CharT*;
+  using iterator = CharT*;
+  using const_iterator = const CharT*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using view_type = basic_string_view<CharT, Traits>;
+  static constexpr size_type npos = size_type(-1);
+
+  static_assert(std::is_same<typename alloc_traits::pointer, CharT*>::value,
+                "basic_string needs an allocator with raw pointers");
+  static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                "basic_string's layout assumes a little-endian target");
+
+  // Construction.
+  basic_string() noexcept { set_inline_size(0); }
+  explicit basic_string(const Allocator& alloc) noexcept : storage_(alloc) {
+    set_inline_size(0);
+  }
+  basic_string(const_pointer str, const Allocator& alloc = Allocator())
+      : storage_(alloc) {
+    init(str, traits_type::length(str));
+  }
+  basic_string(const_pointer str, size_type count,
+               const Allocator& alloc = Allocator())
+      : storage_(alloc) {
+    init(str, count);
+  }
+  basic_string(size_type count, value_type c,
+               const Allocator& alloc = Allocator())
+      : storage_(alloc) {
+    init_uninitialized(count);
+    traits_type::assign(data(), count, c);
+  }
+  explicit basic_string(view_type s, const Allocator& alloc = Allocator())
+      : storage_(alloc) {
+    init(s.data(), s.size());
+  }
+  basic_string(const basic_string& other)
+      : storage_(alloc_traits::select_on_container_copy_construction(
+            other.get_allocator())) {
+    init(other.data(), other.size());
+  }
+  basic_string(basic_string&& other) noexcept
+      : storage_(std::move(other.allocator())) {
+    storage_.rep = other.storage_.rep;
+    other.set_inline_size(0);
+  }
+
+  ~basic_string() { deallocate(); }
+
+  // Assignment.
+  basic_string& operator=(const basic_string& other) {
+    if (this == &other) return *this;
+    if (alloc_traits::propagate_on_container_copy_assignment::value &&
+        allocator() != other.allocator()) {
+      deallocate();
+      set_inline_size(0);
+      allocator() = other.allocator();
+    }
+    return assign(other.data(), other.size());
+  }
+  basic_string& operator=(basic_string&& other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value) {
+    if (this == &other) return *this;
+    if (!alloc_traits::propagate_on_container_move_assignment::value &&
+        allocator() != other.allocator()) {
+      // The other buffer cannot be freed by our allocator.
+      return assign(other.data(), other.size());
+    }
+    deallocate();
+    if (alloc_traits::propagate_on_container_move_assignment::value) {
+      allocator() = std::move(other.allocator());
+    }
+    storage_.rep = other.storage_.rep;
+    other.set_inline_size(0);
+    return *this;
+  }
+  basic_string& operator=(view_type s) { return assign(s.data(), s.size()); }
+  basic_string& operator=(const_pointer s) { return assign(s); }
+  basic_string& assign(const_pointer s, size_type count) {
+    // s may point into this string, so it is copied before anything is
+    // freed.
+    if (count <= capacity()) {
+      traits_type::move(data(), s, count);
+      set_size(count);
+      return *this;
+    }
+    basic_string tmp(s, count, allocator());
+    swap(tmp);
+    return *this;
+  }
+  basic_string& assign(const_pointer s) {
+    return assign(s, traits_type::length(s));
+  }
+  basic_string& assign(view_type s) { return assign(s.data(), s.size()); }
+
+  allocator_type get_allocator() const { return allocator(); }
+
+  // Iterator support.
+  iterator begin() noexcept { return data(); }
+  const_iterator begin() const noexcept { return data(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept { return data() + size(); }
+  const_iterator end() const noexcept { return data() + size(); }
+  const_iterator cend() const noexcept { return end(); }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // Element access.
+  reference operator[](size_type pos) { return data()[pos]; }
+  const_reference operator[](size_type pos) const { return data()[pos]; }
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("Out of range");
+    }
+
+    return data()[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("Out of range");
+    }
+
+    return data()[pos];
+  }
+  reference front() { return data()[0]; }
+  const_reference front() const { return data()[0]; }
+  reference back() { return data()[size() - 1]; }
+  const_reference back() const { return data()[size() - 1]; }
+  pointer data() noexcept {
+    return is_long() ? storage_.rep.l.data : storage_.rep.s;
+  }
+  const_pointer data() const noexcept {
+    return is_long() ? storage_.rep.l.data : storage_.rep.s;
+  }
+  const_pointer c_str() const noexcept { return data(); }
+
+  // Conversion to a view only reads the pointer and the size.
+  operator view_type() const noexcept { return view_type(data(), size()); }
+  view_type view() const noexcept { return view_type(data(), size()); }
+
+  // Capacity.
+  size_type size() const noexcept {
+    return is_long() ? storage_.rep.l.size : kInlineCapacity - tag();
+  }
+  size_type length() const noexcept { return size(); }
+  size_type max_size() const noexcept {
+    return std::min<size_type>(alloc_traits::max_size(allocator()) - 1,
+                               ~kLongFlag);
+  }
+  size_type capacity() const noexcept {
+    return is_long() ? storage_.rep.l.capacity & ~kLongFlag : kInlineCapacity;
+  }
+  bool empty() const noexcept { return size() == 0; }
+  // Makes room for at least new_cap chars without changing the contents.
+  void reserve(size_type new_cap) {
+    if (new_cap > capacity()) reallocate(recommended_capacity(new_cap));
+  }
+  void shrink_to_fit() {
+    if (!is_long()) return;
+    const size_type n = size();
+    if (n <= kInlineCapacity) {
+      pointer old = storage_.rep.l.data;
+      const size_type old_capacity = capacity();
+      traits_type::copy(storage_.rep.s, old, n);
+      set_inline_size(n);
+      alloc_traits::deallocate(allocator(), old, old_capacity + 1);
+    } else if (recommended_capacity(n) < capacity()) {
+      reallocate(recommended_capacity(n));
+    }
+  }
+
+  // Modifiers.
+  void clear() noexcept { set_size(0); }
+  // Sets the size to count. New chars are left uninitialized, so the caller
+  // can fill them in without paying for zeroing them first.
+  void resize_uninitialized(size_type count) {
+    reserve(count);
+    set_size(count);
+  }
+  // Resizes to at most count chars and lets op fill the buffer in place:
+  // op(data(), count) returns the final size, which must not exceed count.
+  template <class Operation>
+  void resize_and_overwrite(size_type count, Operation op) {
+    reserve(count);
+    set_size(op(data(), count));
+  }
+  void resize(size_type count) { resize(count, value_type()); }
+  void resize(size_type count, value_type c) {
+    const size_type old_size = size();
+    resize_uninitialized(count);
+    if (count > old_size) {
+      traits_type::assign(data() + old_size, count - old_size, c);
+    }
+  }
+  void push_back(value_type c) {
+    const size_type n = size();
+    if (n == capacity()) reallocate(recommended_capacity(n + 1));
+    data()[n] = c;
+    set_size(n + 1);
+  }
+  void pop_back() { set_size(size() - 1); }
+  basic_string& append(const_pointer s, size_type count) {
+    const size_type n = size();
+    if (count > capacity() - n) {
+      reallocate_and_insert(n, s, count);
+      return *this;
+    }
+    traits_type::move(data() + n, s, count);
+    set_size(n + count);
+    return *this;
+  }
+  basic_string& append(const_pointer s) {
+    return append(s, traits_type::length(s));
+  }
+  basic_string& append(view_type s) { return append(s.data(), s.size()); }
+  basic_string& append(size_type count, value_type c) {
+    const size_type n = size();
+    reserve_for_append(n + count);
+    traits_type::assign(data() + n, count, c);
+    set_size(n + count);
+    return *this;
+  }
+  basic_string& operator+=(view_type s) { return append(s); }
+  basic_string& operator+=(const_pointer s) { return append(s); }
+  basic_string& operator+=(value_type c) {
+    push_back(c);
+    return *this;
+  }
+  basic_string& insert(size_type pos, view_type s) {
+    const size_type n = size();
+    if (pos > n) {
+      throw std::out_of_range("Out of range");
+    }
+
+    const size_type count = s.size();
+    if (count > capacity() - n) {
+      reallocate_and_insert(pos, s.data(), count);
+      return *this;
+    }
+    pointer p = data();
+    const_pointer src = s.data();
+    traits_type::move(p + pos + count, p + pos, n - pos);
+    // The chars of s that were in the tail have just moved count places
+    // right; those before pos, and [pos, pos + count), are untouched.
+    std::less<const_pointer> less;
+    if (!less(src, p + pos) && less(src, p + n)) src += count;
+    traits_type::move(p + pos, src, count);
+    set_size(n + count);
+    return *this;
+  }
+  basic_string& erase(size_type pos = 0, size_type count = npos) {
+    const size_type n = size();
+    if (pos > n) {
+      throw std::out_of_range("Out of range");
+    }
+
+    count = std::min(count, n - pos);
+    traits_type::move(data() + pos, data() + pos + count, n - pos - count);
+    set_size(n - count);
+    return *this;
+  }
+  void swap(basic_string& other) noexcept {
+    if (alloc_traits::propagate_on_container_swap::value) {
+      std::swap(allocator(), other.allocator());
+    }
+    std::swap(storage_.rep, other.storage_.rep);
+  }
+
+  // Operations. All of them forward to the basic_string_view members with the
+  // same name and arguments.
+  size_type copy(pointer dest, size_type count, size_type pos = 0) const {
+    return view().copy(dest, count, pos);
+  }
+  basic_string substr(size_type pos = 0, size_type count = npos) const {
+    return basic_string(view().substr(pos, count), allocator());
+  }
+  template <class... Args>
+  int compare(Args&&... args) const {
+    return view().compare(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  bool starts_with(Args&&... args) const {
+    return view().starts_with(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  bool ends_with(Args&&... args) const {
+    return view().ends_with(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  size_type find(Args&&... args) const {
+    return view().find(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  size_type rfind(Args&&... args) const {
+    return view().rfind(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  size_type find_first_of(Args&&... args) const {
+    return view().find_first_of(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  size_type find_last_of(Args&&... args) const {
+    return view().find_last_of(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  size_type find_first_not_of(Args&&... args) const {
+    return view().find_first_not_of(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  size_type find_last_not_of(Args&&... args) const {
+    return view().find_last_not_of(std::forward<Args>(args)...);
+  }
+
+  // Overloads for const_pointer avoid ambiguities between converting it to a
+  // view and to a basic_string.
+  friend inline bool operator==(const basic_string& a,
+                                const basic_string& b) noexcept {
+    return a.view() == b.view();
+  }
+  friend inline bool operator==(const basic_string& a, view_type b) noexcept {
+    return a.view() == b;
+  }
+  friend inline bool operator==(view_type a, const basic_string& b) noexcept {
+    return a == b.view();
+  }
+  friend inline bool operator==(const basic_string& a,
+                                const_pointer b) noexcept {
+    return a.view() == view_type(b);
+  }
+  friend inline bool operator==(const_pointer a,
+                                const basic_string& b) noexcept {
+    return view_type(a) == b.view();
+  }
+  friend inline bool operator!=(const basic_string& a,
+                                const basic_string& b) noexcept {
+    return a.view() != b.view();
+  }
+  friend inline bool operator!=(const basic_string& a, view_type b) noexcept {
+    return a.view() != b;
+  }
+  friend inline bool operator!=(view_type a, const basic_string& b) noexcept {
+    return a != b.view();
+  }
+  friend inline bool operator!=(const basic_string& a,
+                                const_pointer b) noexcept {
+    return a.view() != view_type(b);
+  }
+  friend inline bool operator!=(const_pointer a,
+                                const basic_string& b) noexcept {
+    return view_type(a) != b.view();
+  }
+  friend inline bool operator<(const basic_string& a,
+                               const basic_string& b) noexcept {
+    return a.view() < b.view();
+  }
+  friend inline bool operator<(const basic_string& a, view_type b) noexcept {
+    return a.view() < b;
+  }
+  friend inline bool operator<(view_type a, const basic_string& b) noexcept {
+    return a < b.view();
+  }
+  friend inline bool operator<(const basic_string& a,
+                               const_pointer b) noexcept {
+    return a.view() < view_type(b);
+  }
+  friend inline bool operator<(const_pointer a,
+                               const basic_string& b) noexcept {
+    return view_type(a) < b.view();
+  }
+  friend inline bool operator>(const basic_string& a,
+                               const basic_string& b) noexcept {
+    return a.view() > b.view();
+  }
+  friend inline bool operator>(const basic_string& a, view_type b) noexcept {
+    return a.view() > b;
+  }
+  friend inline bool operator>(view_type a, const basic_string& b) noexcept {
+    return a > b.view();
+  }
+  friend inline bool operator>(const basic_string& a,
+                               const_pointer b) noexcept {
+    return a.view() > view_type(b);
+  }
+  friend inline bool operator>(const_pointer a,
+                               const basic_string& b) noexcept {
+    return view_type(a) > b.view();
+  }
+  friend inline bool operator<=(const basic_string& a,
+                                const basic_string& b) noexcept {
+    return a.view() <= b.view();
+  }
+  friend inline bool operator<=(const basic_string& a, view_type b) noexcept {
+    return a.view() <= b;
+  }
+  friend inline bool operator<=(view_type a, const basic_string& b) noexcept {
+    return a <= b.view();
+  }
+  friend inline bool operator<=(const basic_string& a,
+                                const_pointer b) noexcept {
+    return a.view() <= view_type(b);
+  }
+  friend inline bool operator<=(const_pointer a,
+                                const basic_string& b) noexcept {
+    return view_type(a) <= b.view();
+  }
+  friend inline bool operator>=(const basic_string& a,
+                                const basic_string& b) noexcept {
+    return a.view() >= b.view();
+  }
+  friend inline bool operator>=(const basic_string& a, view_type b) noexcept {
+    return a.view() >= b;
+  }
+  friend inline bool operator>=(view_type a, const basic_string& b) noexcept {
+    return a >= b.view();
+  }
+  friend inline bool operator>=(const basic_string& a,
+                                const_pointer b) noexcept {
+    return a.view() >= view_type(b);
+  }
+  friend inline bool operator>=(const_pointer a,
+                                const basic_string& b) noexcept {
+    return view_type(a) >= b.view();
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const basic_string& s) {
+    return os << s.view();
+  }
+
+ private:
+  struct long_rep {
+    pointer data;
+    size_type size;
+    // Tagged with kLongFlag.
+    size_type capacity;
+  };
+  static constexpr size_type kRepBytes = sizeof(long_rep);
+  static constexpr size_type kInlineCapacity = kRepBytes / sizeof(CharT) - 1;
+  static constexpr size_type kLongFlag = size_type(1)
+                                         << (sizeof(size_type) * 8 - 1);
+  static constexpr unsigned char kLongTag = 0x80;
+
+  union representation {
+    long_rep l;
+    CharT s[kInlineCapacity + 1];
+  };
+
+  // Empty base optimization: an empty allocator takes no space.
+  struct storage : Allocator {
+    storage() = default;
+    explicit storage(const Allocator& alloc) : Allocator(alloc) {}
+    explicit storage(Allocator&& alloc) : Allocator(std::move(alloc)) {}
+    representation rep;
+  };
+
+  Allocator& allocator() noexcept { return storage_; }
+  const Allocator& allocator() const noexcept { return storage_; }
+
+  unsigned char tag() const noexcept {
+    const unsigned char* bytes =
+        reinterpret_cast<const unsigned char*>(&storage_.rep);
+    return bytes[kRepBytes - 1];
+  }
+  bool is_long() const noexcept { return (tag() & kLongTag) != 0; }
+
+  void set_inline_size(size_type n) noexcept {
+    // The terminator is written first: for a full string it is the tag.
+    storage_.rep.s[n] = value_type();
+    reinterpret_cast<unsigned char*>(&storage_.rep)[kRepBytes - 1] =
+        static_cast<unsigned char>(kInlineCapacity - n);
+  }
+  // Sets the size without touching the chars, which must fit the capacity.
+  void set_size(size_type n) noexcept {
+    if (is_long()) {
+      storage_.rep.l.size = n;
+      storage_.rep.l.data[n] = value_type();
+    } else {
+      set_inline_size(n);
+    }
+  }
+
+  // Rounds a heap buffer for at least n chars up to the 16-byte granularity
+  // of the allocator, since those bytes would be wasted otherwise.
+  static size_type good_capacity(size_type n) {
+    const size_type bytes = ((n + 1) * sizeof(CharT) + 15) & ~size_type(15);
+    return bytes / sizeof(CharT) - 1;
+  }
+  // Capacity to use when growing to n chars: geometric growth by 1.5x, so
+  // freed blocks can be reused by later reallocations.
+  size_type recommended_capacity(size_type n) const {
+    if (n > max_size()) {
+      throw std::length_error("basic_string too long");
+    }
+    const size_type current = capacity();
+    return good_capacity(std::max(n, current + current / 2));
+  }
+  void reserve_for_append(size_type n) {
+    if (n > capacity()) reallocate(recommended_capacity(n));
+  }
+
+  void init_uninitialized(size_type n) {
+    if (n <= kInlineCapacity) {
+      set_inline_size(n);
+      return;
+    }
+    if (n > max_size()) {
+      throw std::length_error("basic_string too long");
+    }
+    const size_type cap = good_capacity(n);
+    storage_.rep.l.data = alloc_traits::allocate(allocator(), cap + 1);
+    storage_.rep.l.size = n;
+    storage_.rep.l.capacity = cap | kLongFlag;
+    storage_.rep.l.data[n] = value_type();
+  }
+  void init(const_pointer s, size_type n) {
+    init_uninitialized(n);
+    traits_type::copy(data(), s, n);
+  }
+
+  void reallocate(size_type new_cap) {
+    const size_type n = size();
+    pointer p = alloc_traits::allocate(allocator(), new_cap + 1);
+    traits_type::copy(p, data(), n + 1);
+    deallocate();
+    storage_.rep.l.data = p;
+    storage_.rep.l.size = n;
+    storage_.rep.l.capacity = new_cap | kLongFlag;
+  }
+  // Grows to recommended_capacity(size() + count) with s inserted at pos.
+  // s may point into this string, so it is copied before the old buffer is
+  // freed.
+  void reallocate_and_insert(size_type pos, const_pointer s, size_type count) {
+    const size_type n = size();
+    if (count > max_size() - n) {
+      throw std::length_error("basic_string too long");
+    }
+    const size_type new_cap = recommended_capacity(n + count);
+    pointer p = alloc_traits::allocate(allocator(), new_cap + 1);
+    traits_type::copy(p, data(), pos);
+    traits_type::copy(p + pos, s, count);
+    traits_type::copy(p + pos + count, data() + pos, n - pos);
+    p[n + count] = value_type();
+    deallocate();
+    storage_.rep.l.data = p;
+    storage_.rep.l.size = n + count;
+    storage_.rep.l.capacity = new_cap | kLongFlag;
+  }
+  void deallocate() noexcept {
+    if (is_long()) {
+      alloc_traits::deallocate(allocator(), storage_.rep.l.data,
+                               capacity() + 1);
+    }
+  }
+
+  storage storage_;
+};
+
+template <class CharT, class Traits, class Allocator>
+constexpr typename basic_string<CharT, Traits, Allocator>::size_type
+    basic_string<CharT, Traits, Allocator>::npos;
+
+using string = basic_string<char>;
+using u16string = basic_string<char16_t>;
+using u32string = basic_string<char32_t>;
+using wstring = basic_string<wchar_t>;
+
+static_assert(sizeof(string) == 24, "string must stay 24 bytes");
+
+}  // namespace david
+
+namespace std {
+template <>
+struct hash<david::string> {
+  size_t operator()(const david::string& s) const {
+    return hash<david::string_view>()(s);
+  }
+};
+}  // namespace std
+
+#endif  // TYPES_STRING
@@ -0,0 +1,117 @@
+#ifndef TYPES_STRING_ARENA
+#define TYPES_STRING_ARENA
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "types/string_view.h"
+
+namespace david {
+
+// Owns copies of strings in a few large blocks, so that many string_views can
+// outlive the buffers they were made from without one allocation per string.
+// Strings are freed all at once when the arena is destroyed or cleared.
+//
+// Views returned by copy() stay valid until then: blocks are never moved or
+// resized. An arena is not thread-safe.
+class string_arena {
+ public:
+  // Blocks start at initial_block_size bytes and double up to kMaxBlockSize.
+  explicit string_arena(size_t initial_block_size = 4096)
+      : next_block_size_(initial_block_size > 0 ? initial_block_size : 1),
+        pos_(nullptr),
+        end_(nullptr),
+        bytes_used_(0),
+        bytes_reserved_(0) {}
+
+  string_arena(const string_arena&) = delete;
+  string_arena& operator=(const string_arena&) = delete;
+  // A moved-from arena is empty. Views into it stay valid, now owned by the
+  // arena it was moved to.
+  string_arena(string_arena&& other) noexcept
+      : blocks_(std::move(other.blocks_)),
+        next_block_size_(other.next_block_size_),
+        pos_(other.pos_),
+        end_(other.end_),
+        bytes_used_(other.bytes_used_),
+        bytes_reserved_(other.bytes_reserved_) {
+    other.clear();
+  }
+  string_arena& operator=(string_arena&& other) noexcept {
+    if (this != &other) {
+      blocks_ = std::move(other.blocks_);
+      next_block_size_ = other.next_block_size_;
+      pos_ = other.pos_;
+      end_ = other.end_;
+      bytes_used_ = other.bytes_used_;
+      bytes_reserved_ = other.bytes_reserved_;
+      other.clear();
+    }
+    return *this;
+  }
+
+  // Copies s into the arena and returns a view of the copy. The copy is not
+  // null-terminated.
+  string_view copy(string_view s) {
+    if (s.empty()) return string_view();
+    char* p = allocate(s.size());
+    std::memcpy(p, s.data(), s.size());
+    return string_view(p, s.size());
+  }
+
+  // Returns n uninitialized bytes, with no alignment guarantees.
+  char* allocate(size_t n) {
+    char* p;
+    if (static_cast<size_t>(end_ - pos_) >= n) {
+      p = pos_;
+      pos_ += n;
+    } else if (n > next_block_size_ / 4) {
+      // Strings that would take more than a quarter of a block get a block
+      // of their own, so that the tail of the current block stays in use.
+      p = new_block(n);
+    } else {
+      p = new_block(next_block_size_);
+      pos_ = p + n;
+      end_ = p + next_block_size_;
+      if (next_block_size_ < kMaxBlockSize) next_block_size_ *= 2;
+    }
+    bytes_used_ += n;
+    return p;
+  }
+
+  // Frees every string. Views returned so far dangle.
+  void clear() noexcept {
+    blocks_.clear();
+    pos_ = end_ = nullptr;
+    bytes_used_ = bytes_reserved_ = 0;
+  }
+
+  // Bytes handed out so far.
+  size_t bytes_used() const noexcept { return bytes_used_; }
+  // Bytes allocated from the system, including unused block tails.
+  size_t bytes_reserved() const noexcept { return bytes_reserved_; }
+
+ private:
+  static const size_t kMaxBlockSize = 1 << 20;
+
+  char* new_block(size_t size) {
+    std::unique_ptr<char[]> block(new char[size]);
+    blocks_.push_back(std::move(block));
+    bytes_reserved_ += size;
+    return blocks_.back().get();
+  }
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  size_t next_block_size_;
+  char* pos_;
+  char* end_;
+  size_t bytes_used_;
+  size_t bytes_reserved_;
+};
+
+}  // namespace david
+
+#endif  // TYPES_STRING_ARENA
@@ -0,0 +1,72 @@
+#include "types/string_arena.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+TEST(StringArena, CopiesOutliveTheirSource) {
+  string_arena arena;
+  std::vector<string_view> views;
+  for (int i = 0; i < 1000; ++i) {
+    const std::string s = "key-" + std::to_string(i);
+    views.push_back(arena.copy(s));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(views[i], "key-" + std::to_string(i));
+  }
+}
+
+TEST(StringArena, EmptyCopyTakesNoSpace) {
+  string_arena arena;
+  EXPECT_TRUE(arena.copy("").empty());
+  EXPECT_EQ(arena.bytes_used(), 0);
+  EXPECT_EQ(arena.bytes_reserved(), 0);
+}
+
+TEST(StringArena, PacksSmallStringsIntoBlocks) {
+  string_arena arena(64);
+  const string_view a = arena.copy("abcd");
+  const string_view b = arena.copy("efgh");
+  EXPECT_EQ(b.data(), a.data() + 4);
+  EXPECT_EQ(arena.bytes_used(), 8);
+  EXPECT_EQ(arena.bytes_reserved(), 64);
+}
+
+TEST(StringArena, LargeStringsGetTheirOwnBlock) {
+  string_arena arena(64);
+  const string_view a = arena.copy("abcd");
+  const std::string large(100, 'x');
+  EXPECT_EQ(arena.copy(large), large);
+  // The current block is still in use.
+  EXPECT_EQ(arena.copy("efgh").data(), a.data() + 4);
+  EXPECT_EQ(arena.bytes_used(), 108);
+  EXPECT_EQ(arena.bytes_reserved(), 164);
+}
+
+TEST(StringArena, Move) {
+  string_arena arena;
+  const string_view a = arena.copy("hello");
+  string_arena other = std::move(arena);
+  EXPECT_EQ(a, "hello");
+  EXPECT_EQ(other.bytes_used(), 5);
+  EXPECT_EQ(arena.bytes_used(), 0);
+  EXPECT_EQ(arena.copy("world"), "world");
+}
+
+TEST(StringArena, Clear) {
+  string_arena arena;
+  arena.copy("hello");
+  arena.clear();
+  EXPECT_EQ(arena.bytes_used(), 0);
+  EXPECT_EQ(arena.bytes_reserved(), 0);
+  EXPECT_EQ(arena.copy("world"), "world");
+}
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,521 @@
+#ifndef TYPES_STRING_TABLE
+#define TYPES_STRING_TABLE
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "types/internal/little_endian.h"
+#include "types/string_view.h"
+
+// A file format for a large array of strings that is used in place, mapped,
+// rather than read into strings: opening a table reads its header, and
+// string i is a view into the mapping found in O(1). All integers are
+// little-endian, and read as such on any host, so a table written on one
+// machine opens on any other.
+//
+//   offset  0  char magic[4] = "STBL"      uint32 version
+//           8  uint64 size                 number of strings
+//          16  uint64 blob_offset          start of the chars
+//          24  uint64 blob_size
+//          32  uint64 ends_offset          start of the packed ends
+//          40  uint32 end_bits             width of each end
+//          44  uint32 alignment            of the start of each string
+//          48  uint64 data_checksum        of every byte after the header
+//          56  uint64 header_checksum      of bytes [0, 56)
+//          64  ...
+//
+// The blob holds the strings back to back, each padded to start at a
+// multiple of alignment from blob_offset, itself a multiple of alignment.
+// The ends array holds, for each string, the offset in the blob just past
+// it, in end_bits bits, the fewest that hold blob_size, packed from the low
+// bits of the first byte up and followed by 8 bytes of padding, so that each
+// end is one unaligned 64-bit load. String i runs from the end of string
+// i - 1, rounded up to alignment, to its own end.
+namespace david {
+namespace internal {
+
+const uint64_t kChecksumKeys[4] = {
+    0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL,
+    0xd6e8feb86659fd93ULL};
+
+// Checksum of a stream of bytes, fed in pieces of any size, that reads them
+// as four independent lanes of little-endian 64-bit words, so that it gives
+// the same value on every host and its multiplies overlap.
+class stream_checksum {
+ public:
+  stream_checksum() : size_(0), pending_(0) {
+    for (size_t j = 0; j < 4; ++j) acc_[j] = kChecksumKeys[j];
+  }
+
+  void update(const char* p, size_t n) {
+    size_ += n;
+    if (pending_ > 0) {
+      const size_t take = n < kStripe - pending_ ? n : kStripe - pending_;
+      std::memcpy(buffer_ + pending_, p, take);
+      pending_ += take;
+      p += take;
+      n -= take;
+      if (pending_ < kStripe) return;
+      mix_stripe(buffer_);
+      pending_ = 0;
+    }
+    for (; n >= kStripe; p += kStripe, n -= kStripe) mix_stripe(p);
+    std::memcpy(buffer_, p, n);
+    pending_ = n;
+  }
+
+  uint64_t value() const {
+    uint64_t acc[4] = {acc_[0], acc_[1], acc_[2], acc_[3]};
+    if (pending_ > 0) {
+      char last[kStripe] = {};
+      std::memcpy(last, buffer_, pending_);
+      mix_stripe(last, acc);
+    }
+    uint64_t h = size_ * kChecksumKeys[0];
+    for (size_t j = 0; j < 4; ++j) h = fmix(h ^ acc[j]);
+    return h;
+  }
+
+ private:
+  static const size_t kStripe = 32;
+
+  static uint64_t fmix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static void mix_stripe(const char* p, uint64_t* acc) {
+    for (size_t j = 0; j < 4; ++j) {
+      const uint64_t w = load_le64(p + 8 * j);
+      acc[j] = (acc[j] ^ w) * kChecksumKeys[j];
+      acc[j] ^= acc[j] >> 29;
+    }
+  }
+  void mix_stripe(const char* p) { mix_stripe(p, acc_); }
+
+  uint64_t acc_[4];
+  uint64_t size_;
+  size_t pending_;
+  char buffer_[kStripe];
+};
+
+inline uint64_t checksum(const char* p, size_t n) {
+  stream_checksum sum;
+  sum.update(p, n);
+  return sum.value();
+}
+
+inline uint64_t align_up(uint64_t x, uint64_t alignment) {
+  return (x + alignment - 1) & ~(alignment - 1);
+}
+
+struct string_table_layout {
+  static const size_t kHeaderSize = 64;
+  static const uint32_t kVersion = 1;
+  // The largest alignment, and the widest end that one 64-bit load holds
+  // at any bit offset.
+  static const uint32_t kMaxAlignment = 4096;
+  static const uint32_t kMaxEndBits = 57;
+
+  static const char* magic() { return "STBL"; }
+
+  static uint32_t end_bits(uint64_t blob_size) {
+    uint32_t bits = 1;
+    while (bits < 64 && (blob_size >> bits) != 0) ++bits;
+    return bits;
+  }
+
+  static uint64_t ends_bytes(uint64_t size, uint32_t end_bits) {
+    return (size * end_bits + 7) / 8 + 8;
+  }
+};
+
+inline void write_all(int fd, const char* p, size_t n) {
+  while (n > 0) {
+    const ssize_t written = ::write(fd, p, n);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(),
+                              "string_table_writer: write failed");
+    }
+    p += written;
+    n -= static_cast<size_t>(written);
+  }
+}
+
+}  // namespace internal
+
+struct string_table_options {
+  // Each string starts at a multiple of this many bytes from the start of
+  // the table, for strings read with aligned loads from a mapping. A power
+  // of two of at most 4096.
+  size_t alignment = 1;
+  // Bytes buffered between writes to the file.
+  size_t buffer_size = 1 << 20;
+};
+
+// Writes a string table to a file descriptor, one string at a time, without
+// holding the strings: only their ends are kept until finish(). The table
+// starts at the current offset of fd, which must be seekable, as finish()
+// writes the header last; until then the table is not valid. The writer does
+// not own or close fd.
+//
+//   string_table_writer writer(fd);
+//   for (string_view s : strings) writer.add(s);
+//   writer.finish();
+class string_table_writer {
+ public:
+  // Throws std::invalid_argument if opts.alignment is not a power of two of
+  // at most 4096 or opts.buffer_size is 0, and std::system_error if fd is not
+  // seekable.
+  explicit string_table_writer(
+      int fd, const string_table_options& opts = string_table_options())
+      : fd_(fd),
+        alignment_(opts.alignment),
+        blob_offset_(internal::align_up(layout::kHeaderSize, opts.alignment)),
+        blob_size_(0),
+        buffered_(0),
+        finished_(false) {
+    if (opts.alignment == 0 || (opts.alignment & (opts.alignment - 1)) != 0 ||
+        opts.alignment > layout::kMaxAlignment) {
+      throw std::invalid_argument(
+          "string_table alignment must be a power of two of at most 4096");
+    }
+    if (opts.buffer_size == 0) {
+      throw std::invalid_argument("string_table_writer needs a buffer");
+    }
+    start_ = ::lseek(fd_, 0, SEEK_CUR);
+    if (start_ < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "string_table_writer: fd is not seekable");
+    }
+    buffer_size_ = opts.buffer_size;
+    buffer_.reset(new char[buffer_size_]);
+    // Room for the header, written by finish().
+    const char header[layout::kHeaderSize] = {};
+    internal::write_all(fd_, header, sizeof(header));
+    append_zeros(blob_offset_ - layout::kHeaderSize);
+  }
+
+  string_table_writer(const string_table_writer&) = delete;
+  string_table_writer& operator=(const string_table_writer&) = delete;
+
+  // Number of strings added so far.
+  size_t size() const noexcept { return ends_.size(); }
+
+  // Appends s to the table. Throws std::system_error if writing fails.
+  void add(string_view s) {
+    if (finished_) throw std::logic_error("string_table_writer is finished");
+    const uint64_t begin = internal::align_up(blob_size_, alignment_);
+    append_zeros(begin - blob_size_);
+    append(s.data(), s.size());
+    blob_size_ = begin + s.size();
+    ends_.push_back(blob_size_);
+  }
+
+  // Writes the ends and the header. The table is complete when it returns.
+  // Throws std::system_error if writing fails.
+  void finish() {
+    if (finished_) return;
+    finished_ = true;
+    const uint32_t end_bits = layout::end_bits(blob_size_);
+    if (end_bits > layout::kMaxEndBits) {
+      throw std::length_error("string_table blob too large");
+    }
+
+    // The ends, 8 bytes at a time: bits go into acc from the low end, and
+    // each full word is written out.
+    uint64_t acc = 0;
+    uint32_t acc_bits = 0;
+    const auto emit_word = [&](uint64_t w, size_t bytes) {
+      char le[8];
+      for (size_t k = 0; k < 8; ++k) le[k] = static_cast<char>(w >> (8 * k));
+      append(le, bytes);
+    };
+    for (const uint64_t end : ends_) {
+      acc |= end << acc_bits;
+      acc_bits += end_bits;
+      if (acc_bits >= 64) {
+        emit_word(acc, 8);
+        acc_bits -= 64;
+        acc = acc_bits == 0 ? 0 : end >> (end_bits - acc_bits);
+      }
+    }
+    emit_word(acc, (acc_bits + 7) / 8);
+    emit_word(0, 8);
+    flush();
+
+    const uint64_t ends_offset = blob_offset_ + blob_size_;
+    std::vector<char> header;
+    header.reserve(layout::kHeaderSize);
+    header.insert(header.end(), layout::magic(), layout::magic() + 4);
+    internal::append_le32(&header, layout::kVersion);
+    internal::append_le64(&header, ends_.size());
+    internal::append_le64(&header, blob_offset_);
+    internal::append_le64(&header, blob_size_);
+    internal::append_le64(&header, ends_offset);
+    internal::append_le32(&header, end_bits);
+    internal::append_le32(&header, static_cast<uint32_t>(alignment_));
+    internal::append_le64(&header, data_checksum_.value());
+    internal::append_le64(&header,
+                          internal::checksum(header.data(), header.size()));
+
+    ssize_t written;
+    do {
+      written = ::pwrite(fd_, header.data(), header.size(), start_);
+    } while (written < 0 && errno == EINTR);
+    if (written != static_cast<ssize_t>(header.size())) {
+      throw std::system_error(written < 0 ? errno : EIO,
+                              std::generic_category(),
+                              "string_table_writer: write failed");
+    }
+    ends_.clear();
+    ends_.shrink_to_fit();
+  }
+
+ private:
+  using layout = internal::string_table_layout;
+
+  void append(const char* p, size_t n) {
+    while (n > 0) {
+      if (buffered_ == buffer_size_) flush();
+      const size_t take =
+          n < buffer_size_ - buffered_ ? n : buffer_size_ - buffered_;
+      std::memcpy(buffer_.get() + buffered_, p, take);
+      buffered_ += take;
+      p += take;
+      n -= take;
+    }
+  }
+
+  void append_zeros(size_t n) {
+    static const char kZeros[64] = {};
+    for (; n > sizeof(kZeros); n -= sizeof(kZeros)) {
+      append(kZeros, sizeof(kZeros));
+    }
+    append(kZeros, n);
+  }
+
+  void flush() {
+    data_checksum_.update(buffer_.get(), buffered_);
+    internal::write_all(fd_, buffer_.get(), buffered_);
+    buffered_ = 0;
+  }
+
+  int fd_;
+  off_t start_;
+  size_t alignment_;
+  uint64_t blob_offset_;
+  uint64_t blob_size_;
+  // End of each string in the blob.
+  std::vector<uint64_t> ends_;
+  std::unique_ptr<char[]> buffer_;
+  size_t buffer_size_;
+  size_t buffered_;
+  internal::stream_checksum data_checksum_;
+  bool finished_;
+};
+
+// A string table written by string_table_writer, read in place: nothing is
+// parsed or copied past the 64-byte header, so a table opens in the same
+// time whatever its size, and its pages are read from disk as strings on
+// them are used.
+class string_table {
+ public:
+  // A table over bytes, which are not copied and must outlive it. Checks the
+  // header and its checksum, and the size of bytes, and throws
+  // std::invalid_argument when they do not match; the chars and the ends are
+  // checked by verify().
+  static string_table from_bytes(string_view bytes) {
+    const char* p = bytes.data();
+    if (bytes.size() < layout::kHeaderSize ||
+        std::memcmp(p, layout::magic(), 4) != 0) {
+      throw std::invalid_argument("not a string_table");
+    }
+    if (internal::load_le32(p + 4) != layout::kVersion) {
+      throw std::invalid_argument("unsupported string_table version");
+    }
+    if (internal::load_le64(p + 56) != internal::checksum(p, 56)) {
+      throw std::invalid_argument("corrupt string_table header");
+    }
+    const uint64_t size = internal::load_le64(p + 8);
+    const uint64_t blob_offset = internal::load_le64(p + 16);
+    const uint64_t blob_size = internal::load_le64(p + 24);
+    const uint64_t ends_offset = internal::load_le64(p + 32);
+    const uint32_t end_bits = internal::load_le32(p + 40);
+    const uint32_t alignment = internal::load_le32(p + 44);
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 ||
+        alignment > layout::kMaxAlignment || blob_offset % alignment != 0 ||
+        end_bits == 0 || end_bits > layout::kMaxEndBits ||
+        blob_offset < layout::kHeaderSize || blob_offset > bytes.size() ||
+        blob_size > bytes.size() - blob_offset ||
+        ends_offset != blob_offset + blob_size ||
+        (blob_size >> end_bits) != 0 ||
+        size > (bytes.size() - ends_offset) * 8 / end_bits ||
+        bytes.size() - ends_offset != layout::ends_bytes(size, end_bits)) {
+      throw std::invalid_argument("string_table size mismatch");
+    }
+
+    string_table table;
+    table.bytes_ = bytes;
+    table.size_ = size;
+    table.blob_ = p + blob_offset;
+    table.ends_ = p + ends_offset;
+    table.end_bits_ = end_bits;
+    table.end_mask_ = (uint64_t(1) << end_bits) - 1;
+    table.alignment_ = alignment;
+    return table;
+  }
+
+  // Maps the table in the file at path. Throws std::system_error if the file
+  // cannot be opened or mapped, and std::invalid_argument as from_bytes().
+  static string_table open(const char* path) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "string_table: open failed");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(),
+                              "string_table: stat failed");
+    }
+    const size_t length = static_cast<size_t>(st.st_size);
+    void* mapping = length == 0 ? MAP_FAILED
+                                : ::mmap(nullptr, length, PROT_READ,
+                                         MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (length == 0) throw std::invalid_argument("not a string_table");
+    if (mapping == MAP_FAILED) {
+      throw std::system_error(error, std::generic_category(),
+                              "string_table: mmap failed");
+    }
+
+    const string_view bytes(static_cast<const char*>(mapping), length);
+    try {
+      string_table table = from_bytes(bytes);
+      table.mapping_ = mapping;
+      return table;
+    } catch (...) {
+      ::munmap(mapping, length);
+      throw;
+    }
+  }
+
+  string_table(string_table&& other) noexcept : mapping_(nullptr) {
+    *this = std::move(other);
+  }
+  string_table& operator=(string_table&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      bytes_ = other.bytes_;
+      size_ = other.size_;
+      blob_ = other.blob_;
+      ends_ = other.ends_;
+      end_bits_ = other.end_bits_;
+      end_mask_ = other.end_mask_;
+      alignment_ = other.alignment_;
+      mapping_ = other.mapping_;
+      other.mapping_ = nullptr;
+    }
+    return *this;
+  }
+  string_table(const string_table&) = delete;
+  string_table& operator=(const string_table&) = delete;
+
+  // Unmaps the file of a table made by open(). Views returned so far dangle.
+  ~string_table() { unmap(); }
+
+  // Number of strings.
+  size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  // Of the start of each string, from the start of the table.
+  size_t alignment() const noexcept { return alignment_; }
+  // The whole table, as written.
+  string_view bytes() const noexcept { return bytes_; }
+
+  // String i, which must be less than size().
+  string_view operator[](size_t i) const noexcept {
+    const uint64_t begin =
+        i == 0 ? 0 : internal::align_up(end(i - 1), alignment_);
+    return string_view(blob_ + begin, end(i) - begin);
+  }
+
+  // String i. Throws std::out_of_range if i >= size().
+  string_view at(size_t i) const {
+    if (i >= size_) throw std::out_of_range("string_table index");
+    return (*this)[i];
+  }
+
+  // Whether every byte after the header matches the checksum the writer
+  // computed, and the ends are in order and within the blob. Reads the whole
+  // table, so it costs a pass over the file.
+  bool verify() const {
+    const char* p = bytes_.data();
+    const size_t header = layout::kHeaderSize;
+    if (internal::checksum(p + header, bytes_.size() - header) !=
+        internal::load_le64(p + 48)) {
+      return false;
+    }
+    const uint64_t blob_size = static_cast<uint64_t>(ends_ - blob_);
+    uint64_t last = 0;
+    for (size_t i = 0; i < size_; ++i) {
+      const uint64_t e = end(i);
+      if (e < internal::align_up(last, alignment_) || e > blob_size) {
+        return false;
+      }
+      last = e;
+    }
+    return true;
+  }
+
+ private:
+  using layout = internal::string_table_layout;
+
+  string_table() : size_(0), mapping_(nullptr) {}
+
+  uint64_t end(size_t i) const noexcept {
+    const uint64_t bit = static_cast<uint64_t>(i) * end_bits_;
+    return (internal::load_le64(ends_ + bit / 8) >> (bit % 8)) & end_mask_;
+  }
+
+  void unmap() noexcept {
+    if (mapping_ != nullptr) {
+      ::munmap(mapping_, bytes_.size());
+      mapping_ = nullptr;
+    }
+  }
+
+  string_view bytes_;
+  size_t size_;
+  const char* blob_;
+  const char* ends_;
+  uint32_t end_bits_;
+  uint64_t end_mask_;
+  size_t alignment_;
+  // The mapping of a table made by open(), which the table unmaps.
+  void* mapping_;
+};
+
+}  // namespace david
+
+#endif  // TYPES_STRING_TABLE
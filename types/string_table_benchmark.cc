@@ -0,0 +1,153 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/internal/little_endian.h"
+#include "types/string_table.h"
+
+namespace david {
+namespace {
+
+// Tables of state.range(0) strings of 8 to 64 chars, as a vocabulary or a
+// list of keys.
+std::vector<std::string> strings(size_t n) {
+  std::mt19937 rng(42);
+  std::vector<std::string> s(n);
+  for (std::string& x : s) {
+    x.resize(8 + rng() % 57);
+    for (char& c : x) c = static_cast<char>('a' + rng() % 26);
+  }
+  return s;
+}
+
+std::string temp_path() {
+  char path[] = "/tmp/string_table_benchmark.XXXXXX";
+  close(mkstemp(path));
+  return path;
+}
+
+// The format that string_table replaces: each string as a 32-bit length and
+// its chars, read back into a vector of strings.
+std::string write_length_prefixed(const std::vector<std::string>& s) {
+  const std::string path = temp_path();
+  std::vector<char> out;
+  for (const std::string& x : s) {
+    internal::append_le32(&out, static_cast<uint32_t>(x.size()));
+    out.insert(out.end(), x.begin(), x.end());
+  }
+  const int fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+  if (write(fd, out.data(), out.size()) !=
+      static_cast<ssize_t>(out.size())) {
+    std::abort();
+  }
+  close(fd);
+  return path;
+}
+
+std::string write_string_table(const std::vector<std::string>& s) {
+  const std::string path = temp_path();
+  const int fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+  string_table_writer writer(fd);
+  for (const std::string& x : s) writer.add(x);
+  writer.finish();
+  close(fd);
+  return path;
+}
+
+void BM_LoadVector(benchmark::State& state) {
+  const std::string path = write_length_prefixed(strings(state.range(0)));
+  for (auto _ : state) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    const off_t size = lseek(fd, 0, SEEK_END);
+    std::string bytes(static_cast<size_t>(size), '\0');
+    if (pread(fd, &bytes[0], bytes.size(), 0) != size) std::abort();
+    close(fd);
+    std::vector<std::string> loaded;
+    for (size_t pos = 0; pos < bytes.size();) {
+      const uint32_t n = internal::load_le32(&bytes[pos]);
+      loaded.emplace_back(&bytes[pos + 4], n);
+      pos += 4 + n;
+    }
+    benchmark::DoNotOptimize(loaded.data());
+  }
+  unlink(path.c_str());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadVector)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20)
+    ->Arg(1 << 23)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_OpenStringTable(benchmark::State& state) {
+  const std::string path = write_string_table(strings(state.range(0)));
+  for (auto _ : state) {
+    const string_table table = string_table::open(path.c_str());
+    benchmark::DoNotOptimize(table[table.size() / 2].data());
+  }
+  unlink(path.c_str());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_OpenStringTable)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20)
+    ->Arg(1 << 23)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_WriteStringTable(benchmark::State& state) {
+  const std::vector<std::string> s = strings(state.range(0));
+  const std::string path = temp_path();
+  size_t bytes = 0;
+  for (auto _ : state) {
+    const int fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+    string_table_writer writer(fd);
+    for (const std::string& x : s) writer.add(x);
+    writer.finish();
+    bytes = static_cast<size_t>(lseek(fd, 0, SEEK_END));
+    close(fd);
+  }
+  unlink(path.c_str());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_WriteStringTable)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+void BM_VectorRandomAccess(benchmark::State& state) {
+  const std::vector<std::string> s = strings(state.range(0));
+  std::mt19937 rng(7);
+  size_t chars = 0;
+  for (auto _ : state) chars += s[rng() % s.size()].size();
+  benchmark::DoNotOptimize(chars);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VectorRandomAccess)->Arg(1 << 20);
+
+void BM_StringTableRandomAccess(benchmark::State& state) {
+  const std::string path = write_string_table(strings(state.range(0)));
+  const string_table table = string_table::open(path.c_str());
+  std::mt19937 rng(7);
+  size_t chars = 0;
+  for (auto _ : state) chars += table[rng() % table.size()].size();
+  benchmark::DoNotOptimize(chars);
+  unlink(path.c_str());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StringTableRandomAccess)->Arg(1 << 20);
+
+void BM_Verify(benchmark::State& state) {
+  const std::string path = write_string_table(strings(state.range(0)));
+  const string_table table = string_table::open(path.c_str());
+  for (auto _ : state) benchmark::DoNotOptimize(table.verify());
+  unlink(path.c_str());
+  state.SetBytesProcessed(state.iterations() * table.bytes().size());
+}
+BENCHMARK(BM_Verify)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,245 @@
+#include "types/string_table.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+// A temporary file, removed when it goes out of scope.
+class temp_file {
+ public:
+  temp_file() {
+    char path[] = "/tmp/string_table_test.XXXXXX";
+    fd_ = mkstemp(path);
+    path_ = path;
+  }
+  ~temp_file() {
+    close(fd_);
+    unlink(path_.c_str());
+  }
+
+  int fd() const { return fd_; }
+  const char* path() const { return path_.c_str(); }
+
+  std::string contents() const {
+    std::string s(static_cast<size_t>(lseek(fd_, 0, SEEK_END)), '\0');
+    if (!s.empty() && pread(fd_, &s[0], s.size(), 0) < 0) s.clear();
+    return s;
+  }
+
+ private:
+  int fd_;
+  std::string path_;
+};
+
+void write_table(const temp_file& file, const std::vector<std::string>& strings,
+                 const string_table_options& opts = string_table_options()) {
+  string_table_writer writer(file.fd(), opts);
+  for (const std::string& s : strings) writer.add(s);
+  EXPECT_EQ(writer.size(), strings.size());
+  writer.finish();
+}
+
+std::vector<std::string> random_strings(size_t n, size_t max_size) {
+  std::mt19937 rng(42);
+  std::vector<std::string> strings(n);
+  for (std::string& s : strings) {
+    s.resize(rng() % (max_size + 1));
+    for (char& c : s) c = static_cast<char>(rng());
+  }
+  return strings;
+}
+
+void set_le64(std::string* bytes, size_t pos, uint64_t x) {
+  for (int i = 0; i < 8; ++i) {
+    (*bytes)[pos + i] = static_cast<char>(x >> (8 * i));
+  }
+}
+
+void expect_strings(const string_table& table,
+                    const std::vector<std::string>& strings) {
+  ASSERT_EQ(table.size(), strings.size());
+  for (size_t i = 0; i < strings.size(); ++i) {
+    ASSERT_EQ(table[i], strings[i]) << i;
+  }
+  EXPECT_THROW(table.at(strings.size()), std::out_of_range);
+}
+
+TEST(StringTable, RoundTrip) {
+  const std::vector<std::string> strings = {"alpha", "", "beta", "gamma",
+                                            std::string(300, 'x'), ""};
+  temp_file file;
+  write_table(file, strings);
+  const string_table table = string_table::open(file.path());
+  expect_strings(table, strings);
+  EXPECT_EQ(table.at(3), "gamma");
+  EXPECT_EQ(table.alignment(), 1u);
+  EXPECT_TRUE(table.verify());
+}
+
+TEST(StringTable, Empty) {
+  temp_file file;
+  write_table(file, {});
+  const string_table table = string_table::open(file.path());
+  EXPECT_TRUE(table.empty());
+  EXPECT_THROW(table.at(0), std::out_of_range);
+  EXPECT_TRUE(table.verify());
+
+  temp_file empty_strings;
+  write_table(empty_strings, {"", "", ""});
+  expect_strings(string_table::open(empty_strings.path()), {"", "", ""});
+}
+
+TEST(StringTable, ManyStrings) {
+  // Blobs of several sizes, for ends of several widths.
+  for (size_t max_size : {1, 7, 100, 3000}) {
+    const std::vector<std::string> strings = random_strings(5000, max_size);
+    temp_file file;
+    write_table(file, strings);
+    const string_table table = string_table::open(file.path());
+    expect_strings(table, strings);
+    EXPECT_TRUE(table.verify());
+  }
+}
+
+TEST(StringTable, Alignment) {
+  const std::vector<std::string> strings = random_strings(500, 40);
+  for (size_t alignment : {2, 8, 64, 4096}) {
+    temp_file file;
+    string_table_options opts;
+    opts.alignment = alignment;
+    write_table(file, strings, opts);
+    const string_table table = string_table::open(file.path());
+    EXPECT_EQ(table.alignment(), alignment);
+    expect_strings(table, strings);
+    for (size_t i = 0; i < table.size(); ++i) {
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(table[i].data()) % alignment, 0u);
+    }
+    EXPECT_TRUE(table.verify());
+  }
+
+  string_table_options opts;
+  temp_file file;
+  opts.alignment = 3;
+  EXPECT_THROW(string_table_writer(file.fd(), opts), std::invalid_argument);
+  opts.alignment = 8192;
+  EXPECT_THROW(string_table_writer(file.fd(), opts), std::invalid_argument);
+}
+
+TEST(StringTable, SmallBuffer) {
+  const std::vector<std::string> strings = random_strings(300, 50);
+  temp_file file;
+  string_table_options opts;
+  opts.buffer_size = 7;
+  opts.alignment = 16;
+  write_table(file, strings, opts);
+  const string_table table = string_table::open(file.path());
+  expect_strings(table, strings);
+  EXPECT_TRUE(table.verify());
+}
+
+TEST(StringTable, FromBytes) {
+  const std::vector<std::string> strings = random_strings(100, 20);
+  temp_file file;
+  write_table(file, strings);
+  const std::string bytes = file.contents();
+  const string_table table = string_table::from_bytes(bytes);
+  expect_strings(table, strings);
+  EXPECT_EQ(table.bytes().data(), bytes.data());
+
+  EXPECT_THROW(string_table::from_bytes("STBL"), std::invalid_argument);
+  EXPECT_THROW(string_table::from_bytes(string_view(bytes).substr(1)),
+               std::invalid_argument);
+  EXPECT_THROW(string_table::from_bytes(
+                   string_view(bytes.data(), bytes.size() - 1)),
+               std::invalid_argument);
+  std::string bad_version = bytes;
+  bad_version[4] = 2;
+  EXPECT_THROW(string_table::from_bytes(bad_version), std::invalid_argument);
+  std::string bad_size = bytes;
+  bad_size[8] ^= 1;
+  EXPECT_THROW(string_table::from_bytes(bad_size), std::invalid_argument);
+}
+
+TEST(StringTable, FromBytesRejectsOverflowingOffsets) {
+  // 20 strings of 30 chars: a blob of 600 bytes at 64, with 10-bit ends.
+  temp_file file;
+  write_table(file, std::vector<std::string>(20, std::string(30, 'x')));
+  std::string bytes = file.contents();
+  ASSERT_EQ(internal::load_le64(&bytes[32]), 664u);
+  // A header whose blob_offset + blob_size wraps around to ends_offset, with
+  // a checksum that matches.
+  set_le64(&bytes, 16, ~uint64_t(0) - 63);
+  set_le64(&bytes, 24, 728);
+  set_le64(&bytes, 56, internal::checksum(bytes.data(), 56));
+  EXPECT_THROW(string_table::from_bytes(bytes), std::invalid_argument);
+}
+
+TEST(StringTable, VerifyFindsCorruption) {
+  const std::vector<std::string> strings = random_strings(100, 20);
+  temp_file file;
+  write_table(file, strings);
+  std::string bytes = file.contents();
+  EXPECT_TRUE(string_table::from_bytes(bytes).verify());
+  bytes[100] ^= 1;
+  // The header still checks out, so the table opens.
+  EXPECT_FALSE(string_table::from_bytes(bytes).verify());
+}
+
+TEST(StringTable, OpenErrors) {
+  EXPECT_THROW(string_table::open("/nonexistent/string_table"),
+               std::system_error);
+  temp_file empty;
+  EXPECT_THROW(string_table::open(empty.path()), std::invalid_argument);
+  temp_file unfinished;
+  string_table_writer(unfinished.fd()).add("never finished");
+  EXPECT_THROW(string_table::open(unfinished.path()), std::invalid_argument);
+}
+
+TEST(StringTable, AfterOtherData) {
+  temp_file file;
+  ASSERT_EQ(write(file.fd(), "prefix", 6), 6);
+  write_table(file, {"a", "bc"});
+  const std::string bytes = file.contents();
+  expect_strings(string_table::from_bytes(string_view(bytes).substr(6)),
+                 {"a", "bc"});
+}
+
+TEST(StringTable, Move) {
+  temp_file file;
+  write_table(file, {"one", "two"});
+  string_table table = string_table::open(file.path());
+  string_table moved = std::move(table);
+  EXPECT_EQ(moved[1], "two");
+  temp_file other;
+  write_table(other, {"three"});
+  moved = string_table::open(other.path());
+  EXPECT_EQ(moved[0], "three");
+}
+
+TEST(StringTable, StreamChecksum) {
+  const std::string data = random_strings(1, 1000)[0] + "tail";
+  const uint64_t whole = internal::checksum(data.data(), data.size());
+  for (size_t piece : {1, 3, 31, 32, 33, 500}) {
+    internal::stream_checksum sum;
+    for (size_t i = 0; i < data.size(); i += piece) {
+      sum.update(data.data() + i, std::min(piece, data.size() - i));
+    }
+    EXPECT_EQ(sum.value(), whole) << piece;
+  }
+  EXPECT_NE(internal::checksum("a", 1), internal::checksum("a\0", 2));
+}
+
+}  // namespace
+}  // namespace david
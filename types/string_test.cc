@@ -0,0 +1,286 @@
+#include "types/string.h"
+
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+using ::testing::StrEq;
+
+TEST(String, Layout) {
+  EXPECT_EQ(sizeof(string), 24);
+  EXPECT_EQ(sizeof(u16string), 24);
+  EXPECT_EQ(string().capacity(), 23);
+  EXPECT_EQ(u16string().capacity(), 11);
+  EXPECT_EQ(u32string().capacity(), 5);
+}
+
+TEST(String, DefaultConstructor) {
+  const string s;
+  EXPECT_THAT(s, IsEmpty());
+  EXPECT_THAT(s.c_str(), StrEq(""));
+}
+
+TEST(String, InlineBoundary) {
+  const string inline_full(23, 'x');
+  EXPECT_THAT(inline_full, SizeIs(23));
+  EXPECT_EQ(inline_full.capacity(), 23);
+  EXPECT_EQ(inline_full.c_str()[23], '\0');
+  // The buffer lives inside the object.
+  EXPECT_GE(inline_full.data(), reinterpret_cast<const char*>(&inline_full));
+  EXPECT_LT(inline_full.data(),
+            reinterpret_cast<const char*>(&inline_full) + sizeof(string));
+
+  const string heap(24, 'y');
+  EXPECT_THAT(heap, SizeIs(24));
+  EXPECT_THAT(heap.capacity(), Ge(24));
+  EXPECT_EQ(heap.c_str()[24], '\0');
+  EXPECT_EQ(heap, std::string(24, 'y'));
+}
+
+TEST(String, Constructors) {
+  EXPECT_EQ(string("hello"), "hello");
+  EXPECT_EQ(string("hello", 3), "hel");
+  EXPECT_EQ(string(string_view("view")), "view");
+  const string long_string("a string that does not fit inline");
+  const string copy(long_string);
+  EXPECT_EQ(copy, long_string);
+  EXPECT_NE(copy.data(), long_string.data());
+}
+
+TEST(String, Move) {
+  string a("a string that does not fit inline");
+  const char* data = a.data();
+  string b(std::move(a));
+  EXPECT_EQ(b.data(), data);
+  EXPECT_THAT(a, IsEmpty());
+
+  string c;
+  c = std::move(b);
+  EXPECT_EQ(c.data(), data);
+  EXPECT_THAT(b, IsEmpty());
+}
+
+TEST(String, Assign) {
+  string s("short");
+  s = "a string that does not fit inline";
+  EXPECT_EQ(s, "a string that does not fit inline");
+  s = string_view("tiny");
+  EXPECT_EQ(s, "tiny");
+  const string other("another long string, longer than 23");
+  s = other;
+  EXPECT_EQ(s, other);
+  // Assigning a part of itself.
+  s.assign(s.data() + 8, 4);
+  EXPECT_EQ(s, "long");
+}
+
+TEST(String, ViewConversion) {
+  const string s("a string that does not fit inline");
+  const string_view v = s;
+  EXPECT_EQ(v.data(), s.data());
+  EXPECT_EQ(v.size(), s.size());
+}
+
+TEST(String, AppendAndGrowth) {
+  string s;
+  std::string expected;
+  for (int i = 0; i < 1000; ++i) {
+    const char c = static_cast<char>('a' + i % 26);
+    s.push_back(c);
+    expected.push_back(c);
+    ASSERT_EQ(s, expected);
+    ASSERT_EQ(s.c_str()[s.size()], '\0');
+  }
+  s.append(" tail");
+  s += string_view("!");
+  s += '?';
+  s.append(3, '.');
+  EXPECT_EQ(s, expected + " tail!?...");
+}
+
+TEST(String, AppendSelf) {
+  string s("abcdefghijklmnopqrstuvw");
+  s.append(s.data(), s.size());
+  EXPECT_EQ(s, "abcdefghijklmnopqrstuvwabcdefghijklmnopqrstuvw");
+}
+
+TEST(String, AppendGrowsGeometrically) {
+  string s;
+  int reallocations = 0;
+  for (int i = 0; i < 100000; ++i) {
+    const size_t capacity = s.capacity();
+    if (i % 2 == 0) {
+      s.append("x", 1);
+    } else {
+      s += string_view("y");
+    }
+    if (s.capacity() != capacity) {
+      EXPECT_THAT(s.capacity(), Ge(capacity + capacity / 2));
+      ++reallocations;
+    }
+  }
+  EXPECT_THAT(s, SizeIs(100000));
+  EXPECT_LT(reallocations, 30);
+}
+
+TEST(String, InsertInPlace) {
+  string s("ab");
+  s.insert(1, "x");
+  EXPECT_EQ(s, "axb");
+  EXPECT_EQ(s.capacity(), 23);
+
+  s.reserve(1000);
+  const size_t capacity = s.capacity();
+  const char* const data = s.data();
+  for (int i = 0; i < 10; ++i) s.insert(1, "y");
+  EXPECT_EQ(s, "ayyyyyyyyyyxb");
+  EXPECT_EQ(s.capacity(), capacity);
+  EXPECT_EQ(s.data(), data);
+}
+
+TEST(String, InsertSelf) {
+  string s("abcdef");
+  s.insert(2, string_view(s.data() + 1, 3));  // "bcd" straddles pos.
+  EXPECT_EQ(s, "abbcdcdef");
+  s = "abcdef";
+  s.insert(1, string_view(s.data() + 3, 3));  // "def" is in the tail.
+  EXPECT_EQ(s, "adefbcdef");
+  s = "abcdef";
+  s.insert(4, string_view(s.data(), 2));  // "ab" is before pos.
+  EXPECT_EQ(s, "abcdabef");
+}
+
+TEST(String, InsertGrowsGeometricallyWhenFull) {
+  string s(100, 'x');
+  s.resize(s.capacity());
+  const size_t capacity = s.capacity();
+  s.insert(50, s.substr(0, 1));
+  EXPECT_THAT(s.capacity(), Ge(capacity + capacity / 2));
+  EXPECT_THAT(s, SizeIs(capacity + 1));
+}
+
+TEST(String, GrowthIsRoundedToAllocatorGranularity) {
+  string s;
+  s.reserve(24);
+  EXPECT_EQ((s.capacity() + 1) % 16, 0);
+}
+
+TEST(String, ResizeUninitialized) {
+  string s("abc");
+  s.resize_uninitialized(100);
+  EXPECT_THAT(s, SizeIs(100));
+  EXPECT_EQ(s.c_str()[100], '\0');
+  EXPECT_EQ(s.substr(0, 3), "abc");
+
+  s.resize_and_overwrite(10, [](char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) p[i] = 'z';
+    return n / 2;
+  });
+  EXPECT_EQ(s, "zzzzz");
+}
+
+TEST(String, Resize) {
+  string s("abc");
+  s.resize(5, '!');
+  EXPECT_EQ(s, "abc!!");
+  s.resize(30);
+  EXPECT_THAT(s, SizeIs(30));
+  EXPECT_EQ(s[29], '\0');
+  s.resize(2);
+  EXPECT_EQ(s, "ab");
+}
+
+TEST(String, ShrinkToFit) {
+  string s(100, 'x');
+  s.resize(3);
+  s.shrink_to_fit();
+  EXPECT_EQ(s.capacity(), 23);
+  EXPECT_EQ(s, "xxx");
+}
+
+TEST(String, InsertEraseClear) {
+  string s("hello world");
+  s.insert(5, ",");
+  EXPECT_EQ(s, "hello, world");
+  s.erase(5, 1);
+  EXPECT_EQ(s, "hello world");
+  s.erase(5);
+  EXPECT_EQ(s, "hello");
+  s.pop_back();
+  EXPECT_EQ(s, "hell");
+  s.clear();
+  EXPECT_THAT(s, IsEmpty());
+}
+
+TEST(String, AtFailsWhenOutOfRange) {
+  const string s("hello");
+  EXPECT_EQ(s.at(4), 'o');
+  EXPECT_THROW(s.at(5), std::out_of_range);
+}
+
+TEST(String, SearchForwardsToView) {
+  const string s("hello world, hello");
+  EXPECT_EQ(s.find("hello"), 0);
+  EXPECT_EQ(s.find("hello", 1), 13);
+  EXPECT_EQ(s.find('w'), 6);
+  EXPECT_EQ(s.rfind("hello"), 13);
+  EXPECT_EQ(s.find_first_of("ol"), 2);
+  EXPECT_EQ(s.find_last_of("ol"), 17);
+  EXPECT_EQ(s.find_first_not_of("hel"), 4);
+  EXPECT_EQ(s.find_last_not_of("hel"), 17);
+  EXPECT_EQ(s.find(string("world")), 6);
+  EXPECT_TRUE(s.starts_with("hello"));
+  EXPECT_TRUE(s.ends_with('o'));
+  EXPECT_EQ(s.compare("hello"), 1);
+  EXPECT_EQ(s.compare(0, 5, "hello"), 0);
+}
+
+TEST(String, Comparisons) {
+  const string a("abc");
+  const string b("abd");
+  EXPECT_TRUE(a == "abc");
+  EXPECT_TRUE("abc" == a);
+  EXPECT_TRUE(a == string_view("abc"));
+  EXPECT_TRUE(a != b);
+  EXPECT_TRUE(a < b);
+  EXPECT_TRUE(b > a);
+  EXPECT_TRUE(a <= "abc");
+  EXPECT_TRUE(a >= "abb");
+}
+
+TEST(String, StreamAndHash) {
+  std::ostringstream os;
+  os << string("hello");
+  EXPECT_THAT(os.str(), Eq("hello"));
+
+  std::unordered_set<string> set;
+  set.insert(string("a"));
+  set.insert(string("a string that does not fit inline"));
+  EXPECT_EQ(set.count(string("a")), 1);
+  EXPECT_EQ(std::hash<string>()(string("abc")),
+            std::hash<string_view>()("abc"));
+}
+
+TEST(String, WideChars) {
+  u16string s(u"hello");
+  s.append(u" world, a longer string");
+  EXPECT_EQ(s.find(u"world"), 6);
+  EXPECT_EQ(s.c_str()[s.size()], u'\0');
+  const u32string full(5, U'x');
+  EXPECT_EQ(full.capacity(), 5);
+  EXPECT_EQ(full.c_str()[5], U'\0');
+}
+
+}  // namespace
+}  // namespace david
@@ -8,11 +8,149 @@
 #include <ios>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <utility>
+
+#include "types/cpu_dispatch.h"
+#include "types/expected.h"
+
+// Builds with -DDAVID_STRING_VIEW_STATS=1 count the calls of the search and
+// compare operations, see types/string_view_stats.h. Other builds expand the
+// hook to the bare result.
+#if defined(DAVID_STRING_VIEW_STATS) && DAVID_STRING_VIEW_STATS
+#include "types/string_view_stats.h"
+#define DAVID_STRING_VIEW_RECORD(op, s, result)                      \
+  ::david::internal::record_string_view_op(::david::string_view_op::op, \
+                                           len_, (s).len_, (result))
+#else
+#define DAVID_STRING_VIEW_RECORD(op, s, result) (result)
+#endif
+
+// Bounds checks of basic_string_view, chosen for the whole build with
+// -DDAVID_STRING_VIEW_CHECKS=<mode>:
+//   0: unchecked. No member checks its arguments and none throws.
+//   1: standard, the default. at, substr and copy throw std::out_of_range,
+//      the other members trust their arguments. Builds without exceptions
+//      trap instead of throwing.
+//   2: hardened. at, substr, copy, operator[], front, back, remove_prefix and
+//      remove_suffix trap on a bad argument. Nothing throws.
+// All translation units of a program must use the same mode. The *_unchecked
+// members never check, whatever the mode.
+#ifndef DAVID_STRING_VIEW_CHECKS
+#define DAVID_STRING_VIEW_CHECKS 1
+#endif
+
+#if DAVID_STRING_VIEW_CHECKS >= 2
+#define DAVID_STRING_VIEW_HARDEN(cond) ((cond) ? void(0) : __builtin_trap())
+#else
+#define DAVID_STRING_VIEW_HARDEN(cond) void(0)
+#endif
+
+#if DAVID_STRING_VIEW_CHECKS == 1 && defined(__cpp_exceptions)
+#define DAVID_STRING_VIEW_THROWS 1
+#else
+#define DAVID_STRING_VIEW_THROWS 0
+#endif
 
 namespace david {
+namespace internal {
+
+// Loops behind the search and compare operations of basic_string_view. They
+// take a haystack h[0, n) and a needle or set s[0, m), and return an offset
+// into h or npos. find and rfind need 1 <= m <= n.
+template <class CharT, class Traits>
+struct string_search {
+  static const size_t npos = static_cast<size_t>(-1);
+
+  static int compare(const CharT* a, const CharT* b, size_t n) {
+    return Traits::compare(a, b, n);
+  }
+  // Offset of the first char where a and b differ, or n if they do not.
+  static size_t mismatch(const CharT* a, const CharT* b, size_t n) {
+    size_t i = 0;
+    while (i < n && Traits::eq(a[i], b[i])) ++i;
+    return i;
+  }
+  static bool equal(const CharT* a, const CharT* b, size_t n) {
+    return Traits::compare(a, b, n) == 0;
+  }
+  static size_t count(const CharT* h, size_t n, CharT c) {
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += Traits::eq(h[i], c);
+    return total;
+  }
+  static size_t find(const CharT* h, size_t n, const CharT* s, size_t m) {
+    for (size_t pos = 0; pos + m <= n; ++pos) {
+      if (Traits::compare(h + pos, s, m) == 0) return pos;
+    }
+    return npos;
+  }
+  static size_t rfind(const CharT* h, size_t n, const CharT* s, size_t m) {
+    for (size_t pos = n - m + 1; pos-- > 0;) {
+      if (Traits::compare(h + pos, s, m) == 0) return pos;
+    }
+    return npos;
+  }
+  // First char of h that is in s or, with negate, that is not.
+  static size_t find_of(const CharT* h, size_t n, const CharT* s, size_t m,
+                        bool negate) {
+    for (size_t pos = 0; pos < n; ++pos) {
+      if ((Traits::find(s, m, h[pos]) != nullptr) != negate) return pos;
+    }
+    return npos;
+  }
+  // Last char of h that is in s or, with negate, that is not.
+  static size_t rfind_of(const CharT* h, size_t n, const CharT* s, size_t m,
+                         bool negate) {
+    for (size_t pos = n; pos-- > 0;) {
+      if ((Traits::find(s, m, h[pos]) != nullptr) != negate) return pos;
+    }
+    return npos;
+  }
+};
+
+// Plain chars go through the vector kernels of the CPU, see
+// types/cpu_dispatch.h.
+template <>
+struct string_search<char, std::char_traits<char>> {
+  static int compare(const char* a, const char* b, size_t n) {
+    return string_kernels().compare(a, b, n);
+  }
+  // Up to 16 chars, as most prefixes are, take two loads inline rather than
+  // a call. Past that, equal is memcmp, which beats mismatch when the offset
+  // is not needed.
+  static size_t mismatch(const char* a, const char* b, size_t n) {
+    if (n <= 16) return scalar::mismatch(a, b, n);
+    return string_kernels().mismatch(a, b, n);
+  }
+  static bool equal(const char* a, const char* b, size_t n) {
+    if (n <= 16) return scalar::mismatch(a, b, n) == n;
+    return string_kernels().compare(a, b, n) == 0;
+  }
+  static size_t count(const char* h, size_t n, char c) {
+    return string_kernels().count(h, n, c);
+  }
+  static size_t find(const char* h, size_t n, const char* s, size_t m) {
+    return string_kernels().find(h, n, s, m);
+  }
+  static size_t rfind(const char* h, size_t n, const char* s, size_t m) {
+    return string_kernels().rfind(h, n, s, m);
+  }
+  static size_t find_of(const char* h, size_t n, const char* s, size_t m,
+                        bool negate) {
+    return string_kernels().find_of(h, n, s, m, negate);
+  }
+  static size_t rfind_of(const char* h, size_t n, const char* s, size_t m,
+                         bool negate) {
+    return string_kernels().rfind_of(h, n, s, m, negate);
+  }
+};
+
+}  // namespace internal
 
 // NOTE: using https://en.cppreference.com/w/cpp/string/basic_string_view as a
 // guide.
@@ -66,17 +204,22 @@ class basic_string_view {
 
   // Element access.
   constexpr const_reference operator[](size_type pos) const {
+    return DAVID_STRING_VIEW_HARDEN(pos < len_), data_[pos];
+  }
+  const_reference at(size_type pos) const noexcept(kNoThrow) {
+    check_range(pos < len_);
     return data_[pos];
   }
-  const_reference at(size_type pos) const {
-    if (pos > len_) {
-      throw std::out_of_range("Out of range");
-    }
-
-    return this->operator[](pos);
+  // at() without the check: pos must be less than size().
+  constexpr const_reference at_unchecked(size_type pos) const noexcept {
+    return data_[pos];
+  }
+  constexpr const_reference front() const {
+    return DAVID_STRING_VIEW_HARDEN(len_ > 0), data_[0];
+  }
+  constexpr const_reference back() const {
+    return DAVID_STRING_VIEW_HARDEN(len_ > 0), data_[len_ - 1];
   }
-  constexpr const_reference front() const { return data_[0]; }
-  constexpr const_reference back() const { return data_[len_ - 1]; }
   constexpr const_pointer data() const noexcept { return data_; }
 
   // Capacity.
@@ -87,10 +230,20 @@ class basic_string_view {
 
   // Modifiers.
   void remove_prefix(size_type n) {
+    DAVID_STRING_VIEW_HARDEN(n <= len_);
+    remove_prefix_unchecked(n);
+  }
+  void remove_suffix(size_type n) {
+    DAVID_STRING_VIEW_HARDEN(n <= len_);
+    remove_suffix_unchecked(n);
+  }
+  // remove_prefix() and remove_suffix() without the checks of hardened
+  // builds: n must be at most size().
+  void remove_prefix_unchecked(size_type n) noexcept {
     data_ = data_ + n;
     len_ -= n;
   }
-  void remove_suffix(size_type n) { len_ -= n; }
+  void remove_suffix_unchecked(size_type n) noexcept { len_ -= n; }
   void swap(basic_string_view& s) noexcept {
     basic_string_view other = *this;
     *this = s;
@@ -100,35 +253,50 @@ class basic_string_view {
   // Operations.
   // Copies the substring [pos, pos + rcount) to the character string pointed to
   // by dest, where rcount is the smaller of count and size() - pos.
-  size_type copy(pointer dest, size_type count, size_type pos = 0) const {
-    if (pos > len_) {
-      throw std::out_of_range("Out of range");
-    }
-
+  size_type copy(pointer dest, size_type count, size_type pos = 0) const
+      noexcept(kNoThrow) {
+    check_range(pos <= len_);
+    return copy_unchecked(dest, count, pos);
+  }
+  // copy() without the check: pos must be at most size().
+  size_type copy_unchecked(pointer dest, size_type count,
+                           size_type pos = 0) const noexcept {
     const size_type rcount = std::min(count, len_ - pos);
     traits_type::copy(dest, data_ + pos, rcount);
     return rcount;
   }
   // Returns a view of the substring [pos, pos + rcount), where rcount is the
   // smaller of count and size() - pos.
-  basic_string_view substr(size_type pos = 0, size_type count = npos) const {
-    if (pos > len_) {
-      throw std::out_of_range("Out of range");
-    }
-
-    const size_type rcount = std::min(count, len_ - pos);
-    if (rcount > 0) {
-      return basic_string_view(data_ + pos, rcount);
-    }
-    return basic_string_view();
+  basic_string_view substr(size_type pos = 0, size_type count = npos) const
+      noexcept(kNoThrow) {
+    check_range(pos <= len_);
+    return substr_unchecked(pos, count);
+  }
+  // substr() without the check: pos must be at most size().
+  constexpr basic_string_view substr_unchecked(
+      size_type pos = 0, size_type count = npos) const noexcept {
+    return basic_string_view(data_ + pos,
+                             count < len_ - pos ? count : len_ - pos);
+  }
+  // Forms of at(), substr() and copy() that return
+  // std::errc::result_out_of_range rather than throw, in every mode.
+  expected<value_type, std::errc> try_at(size_type pos) const noexcept {
+    if (pos >= len_) return out_of_range_error();
+    return data_[pos];
+  }
+  expected<basic_string_view, std::errc> try_substr(
+      size_type pos = 0, size_type count = npos) const noexcept {
+    if (pos > len_) return out_of_range_error();
+    return substr_unchecked(pos, count);
+  }
+  expected<size_type, std::errc> try_copy(pointer dest, size_type count,
+                                          size_type pos = 0) const noexcept {
+    if (pos > len_) return out_of_range_error();
+    return copy_unchecked(dest, count, pos);
   }
   // Compares two character sequences.
   int compare(basic_string_view s) const noexcept {
-    const size_t rlen = std::min(len_, s.len_);
-    const int comparison = traits_type::compare(data_, s.data_, rlen);
-    if (comparison != 0) return comparison;
-    if (len_ == s.len_) return 0;
-    return len_ < s.len_ ? -1 : 1;
+    return DAVID_STRING_VIEW_RECORD(kCompare, s, compare_impl(s));
   }
   // Compare substring(pos1, count1) with s.
   int compare(size_type pos1, size_type count1, basic_string_view s) const {
@@ -148,7 +316,7 @@ class basic_string_view {
     return substr(pos1, count1).compare(basic_string_view(s, count2));
   }
   bool starts_with(basic_string_view s) const noexcept {
-    return len_ >= s.len_ && substr(0, s.len_) == s;
+    return len_ >= s.len_ && search::equal(data_, s.data_, s.len_);
   }
   bool starts_with(value_type c) const noexcept {
     return !empty() && traits_type::eq(front(), c);
@@ -157,7 +325,8 @@ class basic_string_view {
     return starts_with(basic_string_view<CharT, Traits>(s));
   }
   bool ends_with(basic_string_view s) const noexcept {
-    return len_ >= s.len_ && substr(len_ - s.len_, npos) == s;
+    return len_ >= s.len_ &&
+           search::equal(data_ + (len_ - s.len_), s.data_, s.len_);
   }
   bool ends_with(value_type c) const noexcept {
     return !empty() && traits_type::eq(back(), c);
@@ -166,21 +335,7 @@ class basic_string_view {
     return ends_with(basic_string_view<CharT, Traits>(s));
   }
   size_type find(basic_string_view s, size_type pos = 0) const noexcept {
-    if (empty() && s.empty() && pos == 0) {
-      return 0;
-    }
-    if (pos > len_ || s.len_ > (len_ - pos)) {
-      return npos;
-    }
-    while (pos + s.len_ <= len_) {
-      if (traits_type::compare(data_ + pos, s.data_, s.len_) == 0) {
-        return pos;
-      }
-
-      pos++;
-    }
-
-    return npos;
+    return DAVID_STRING_VIEW_RECORD(kFind, s, find_impl(s, pos));
   }
   size_type find(value_type c, size_type pos = 0) const noexcept {
     return find(basic_string_view(&c, 1), pos);
@@ -192,22 +347,7 @@ class basic_string_view {
     return find(basic_string_view(s), pos);
   }
   size_type rfind(basic_string_view s, size_type pos = npos) const noexcept {
-    if (s.empty()) {
-      return std::min(pos, len_);
-    }
-    if (s.len_ > len_) {
-      return npos;
-    }
-    pos = std::min(pos, len_ - s.len_);
-    while (pos != npos) {
-      if (traits_type::compare(data_ + pos, s.data_, s.len_) == 0) {
-        return pos;
-      }
-
-      pos--;
-    }
-
-    return npos;
+    return DAVID_STRING_VIEW_RECORD(kRfind, s, rfind_impl(s, pos));
   }
   size_type rfind(value_type c, size_type pos = npos) const noexcept {
     return rfind(basic_string_view(&c, 1), pos);
@@ -220,15 +360,8 @@ class basic_string_view {
   }
   size_type find_first_of(basic_string_view s,
                           size_type pos = 0) const noexcept {
-    while (pos < len_) {
-      if (traits_type::find(s.data_, s.len_, data_[pos]) != nullptr) {
-        return pos;
-      }
-
-      pos++;
-    }
-
-    return npos;
+    return DAVID_STRING_VIEW_RECORD(kFindFirstOf, s,
+                                    find_first_of_impl(s, pos));
   }
   size_type find_first_of(value_type c, size_type pos = 0) const noexcept {
     return find_first_of(basic_string_view(&c, 1), pos);
@@ -241,20 +374,8 @@ class basic_string_view {
   }
   size_type find_last_of(basic_string_view s,
                          size_type pos = npos) const noexcept {
-    if (empty()) {
-      return npos;
-    }
-
-    pos = std::min(pos, len_ - 1);
-    while (pos != npos) {
-      if (traits_type::find(s.data_, s.len_, data_[pos]) != nullptr) {
-        return pos;
-      }
-
-      pos--;
-    }
-
-    return npos;
+    return DAVID_STRING_VIEW_RECORD(kFindLastOf, s,
+                                    find_last_of_impl(s, pos));
   }
   size_type find_last_of(value_type c, size_type pos = npos) const noexcept {
     return find_last_of(basic_string_view(&c, 1), pos);
@@ -267,15 +388,8 @@ class basic_string_view {
   }
   size_type find_first_not_of(basic_string_view s,
                               size_type pos = 0) const noexcept {
-    while (pos < len_) {
-      if (traits_type::find(s.data_, s.len_, data_[pos]) == nullptr) {
-        return pos;
-      }
-
-      pos++;
-    }
-
-    return npos;
+    return DAVID_STRING_VIEW_RECORD(kFindFirstNotOf, s,
+                                    find_first_not_of_impl(s, pos));
   }
   size_type find_first_not_of(value_type c, size_type pos = 0) const noexcept {
     return find_first_not_of(basic_string_view(&c, 1), pos);
@@ -289,20 +403,8 @@ class basic_string_view {
   }
   size_type find_last_not_of(basic_string_view s,
                              size_type pos = npos) const noexcept {
-    if (empty()) {
-      return npos;
-    }
-
-    pos = std::min(pos, len_ - 1);
-    while (pos != npos) {
-      if (traits_type::find(s.data_, s.len_, data_[pos]) == nullptr) {
-        return pos;
-      }
-
-      pos--;
-    }
-
-    return npos;
+    return DAVID_STRING_VIEW_RECORD(kFindLastNotOf, s,
+                                    find_last_not_of_impl(s, pos));
   }
   size_type find_last_not_of(value_type c,
                              size_type pos = npos) const noexcept {
@@ -375,6 +477,91 @@ class basic_string_view {
   }
 
  private:
+  using search = internal::string_search<CharT, Traits>;
+
+  static constexpr bool kUnchecked = DAVID_STRING_VIEW_CHECKS == 0;
+  static constexpr bool kNoThrow = !DAVID_STRING_VIEW_THROWS;
+
+  // Throws std::out_of_range, or traps where nothing throws, if ok is false,
+  // unless checks are off. The failure is kept out of line, so that the
+  // check costs a compare and a branch.
+  static void check_range(bool ok) noexcept(kNoThrow) {
+    if (!kUnchecked && !ok) out_of_range();
+  }
+  static unexpected<std::errc> out_of_range_error() noexcept {
+    return unexpected<std::errc>(std::errc::result_out_of_range);
+  }
+  [[noreturn]] __attribute__((noinline, cold)) static void out_of_range() {
+#if DAVID_STRING_VIEW_THROWS
+    throw std::out_of_range("Out of range");
+#else
+    __builtin_trap();
+#endif
+  }
+
+  int compare_impl(basic_string_view s) const noexcept {
+    const size_t rlen = std::min(len_, s.len_);
+    const int comparison = search::compare(data_, s.data_, rlen);
+    if (comparison != 0) return comparison;
+    if (len_ == s.len_) return 0;
+    return len_ < s.len_ ? -1 : 1;
+  }
+  size_type find_impl(basic_string_view s, size_type pos) const noexcept {
+    if (pos > len_ || s.len_ > (len_ - pos)) {
+      return npos;
+    }
+    if (s.empty()) {
+      return pos;
+    }
+    const size_type found =
+        search::find(data_ + pos, len_ - pos, s.data_, s.len_);
+    return found == npos ? npos : pos + found;
+  }
+  size_type rfind_impl(basic_string_view s, size_type pos) const noexcept {
+    if (s.empty()) {
+      return std::min(pos, len_);
+    }
+    if (s.len_ > len_) {
+      return npos;
+    }
+    pos = std::min(pos, len_ - s.len_);
+    return search::rfind(data_, pos + s.len_, s.data_, s.len_);
+  }
+  size_type find_first_of_impl(basic_string_view s,
+                               size_type pos) const noexcept {
+    if (pos >= len_) {
+      return npos;
+    }
+    const size_type found =
+        search::find_of(data_ + pos, len_ - pos, s.data_, s.len_, false);
+    return found == npos ? npos : pos + found;
+  }
+  size_type find_last_of_impl(basic_string_view s,
+                              size_type pos) const noexcept {
+    if (empty()) {
+      return npos;
+    }
+    pos = std::min(pos, len_ - 1);
+    return search::rfind_of(data_, pos + 1, s.data_, s.len_, false);
+  }
+  size_type find_first_not_of_impl(basic_string_view s,
+                                   size_type pos) const noexcept {
+    if (pos >= len_) {
+      return npos;
+    }
+    const size_type found =
+        search::find_of(data_ + pos, len_ - pos, s.data_, s.len_, true);
+    return found == npos ? npos : pos + found;
+  }
+  size_type find_last_not_of_impl(basic_string_view s,
+                                  size_type pos) const noexcept {
+    if (empty()) {
+      return npos;
+    }
+    pos = std::min(pos, len_ - 1);
+    return search::rfind_of(data_, pos + 1, s.data_, s.len_, true);
+  }
+
   constexpr static size_type internal_strlen(const_pointer str) {
     return str ? traits_type::length(str) : 0;
   }
@@ -392,6 +579,30 @@ template <class CharT, class Traits>
 constexpr typename basic_string_view<CharT, Traits>::size_type
     basic_string_view<CharT, Traits>::kMaxSize;
 
+// Number of leading chars that a and b have in common.
+template <class CharT, class Traits>
+size_t common_prefix_length(basic_string_view<CharT, Traits> a,
+                            basic_string_view<CharT, Traits> b) noexcept {
+  return internal::string_search<CharT, Traits>::mismatch(
+      a.data(), b.data(), std::min(a.size(), b.size()));
+}
+
+// The first chars of a and b that differ, as in std::mismatch: the pair of
+// a.begin() + n and b.begin() + n, with n = common_prefix_length(a, b).
+template <class CharT, class Traits>
+std::pair<const CharT*, const CharT*> mismatch(
+    basic_string_view<CharT, Traits> a,
+    basic_string_view<CharT, Traits> b) noexcept {
+  const size_t n = common_prefix_length(a, b);
+  return std::make_pair(a.begin() + n, b.begin() + n);
+}
+
+// Number of chars of s equal to c.
+template <class CharT, class Traits>
+size_t count(basic_string_view<CharT, Traits> s, CharT c) noexcept {
+  return internal::string_search<CharT, Traits>::count(s.data(), s.size(), c);
+}
+
 using string_view = basic_string_view<char>;
 using u16string_view = basic_string_view<char16_t>;
 using u32string_view = basic_string_view<char32_t>;
@@ -0,0 +1,166 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/string_view.h"
+
+namespace david {
+namespace {
+
+// The benchmarks compare the checked members with their *_unchecked
+// variants. Building this file with -DDAVID_STRING_VIEW_CHECKS=0 or 2 shows
+// the cost of each mode of the checked members.
+
+std::string make_text(size_t size) {
+  std::string text;
+  for (size_t i = 0; text.size() < size; ++i) {
+    text += std::to_string(i * 7919 % 100000);
+    text += ',';
+  }
+  return text;
+}
+
+// Positions the compiler cannot prove to be in range, so that at() keeps its
+// check on each access.
+std::vector<uint32_t> make_positions(size_t size) {
+  std::vector<uint32_t> positions(4096);
+  for (size_t i = 0; i < positions.size(); ++i) {
+    positions[i] = static_cast<uint32_t>(i * 2654435761u % size);
+  }
+  return positions;
+}
+
+void BM_GatherAt(benchmark::State& state) {
+  const std::string text = make_text(state.range(0));
+  const string_view s(text);
+  const std::vector<uint32_t> positions = make_positions(text.size());
+  for (auto _ : state) {
+    uint32_t sum = 0;
+    for (uint32_t pos : positions) sum += s.at(pos);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_GatherAt)->Arg(4096);
+
+void BM_GatherAtUnchecked(benchmark::State& state) {
+  const std::string text = make_text(state.range(0));
+  const string_view s(text);
+  const std::vector<uint32_t> positions = make_positions(text.size());
+  for (auto _ : state) {
+    uint32_t sum = 0;
+    for (uint32_t pos : positions) sum += s.at_unchecked(pos);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_GatherAtUnchecked)->Arg(4096);
+
+// Slices fields whose bounds come from an index, as a reader of a columnar
+// file would.
+void BM_SliceSubstr(benchmark::State& state) {
+  const std::string text = make_text(state.range(0));
+  const string_view s(text);
+  const std::vector<uint32_t> positions = make_positions(text.size());
+  for (auto _ : state) {
+    size_t total = 0;
+    for (uint32_t pos : positions) total += s.substr(pos, 8).size();
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_SliceSubstr)->Arg(4096);
+
+void BM_SliceSubstrUnchecked(benchmark::State& state) {
+  const std::string text = make_text(state.range(0));
+  const string_view s(text);
+  const std::vector<uint32_t> positions = make_positions(text.size());
+  for (auto _ : state) {
+    size_t total = 0;
+    for (uint32_t pos : positions) total += s.substr_unchecked(pos, 8).size();
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_SliceSubstrUnchecked)->Arg(4096);
+
+// Consumes the text field by field with remove_prefix.
+void BM_RemovePrefix(benchmark::State& state) {
+  const std::string text = make_text(state.range(0));
+  for (auto _ : state) {
+    string_view rest(text);
+    size_t fields = 0;
+    while (!rest.empty()) {
+      size_t i = 0;
+      while (rest[i] != ',') ++i;
+      rest.remove_prefix(i + 1);
+      ++fields;
+    }
+    benchmark::DoNotOptimize(fields);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_RemovePrefix)->Arg(4096);
+
+void BM_RemovePrefixUnchecked(benchmark::State& state) {
+  const std::string text = make_text(state.range(0));
+  for (auto _ : state) {
+    string_view rest(text);
+    size_t fields = 0;
+    while (!rest.empty()) {
+      size_t i = 0;
+      while (rest.at_unchecked(i) != ',') ++i;
+      rest.remove_prefix_unchecked(i + 1);
+      ++fields;
+    }
+    benchmark::DoNotOptimize(fields);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_RemovePrefixUnchecked)->Arg(4096);
+
+// Keys that share a prefix of prefix chars with the probe, and half of which
+// then continue like it.
+std::vector<std::string> make_keys(size_t prefix) {
+  std::vector<std::string> keys(4096, std::string(prefix, 'k'));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] += i % 2 == 0 ? "/match/" : "/other/";
+    keys[i] += std::to_string(i);
+  }
+  return keys;
+}
+
+// starts_with as it was, through substr and operator==.
+void BM_StartsWithSubstr(benchmark::State& state) {
+  const std::vector<std::string> keys = make_keys(state.range(0));
+  const std::string probe = std::string(state.range(0), 'k') + "/match/";
+  const string_view p(probe);
+  for (auto _ : state) {
+    size_t hits = 0;
+    for (const std::string& key : keys) {
+      const string_view k(key);
+      hits += k.size() >= p.size() && k.substr(0, p.size()) == p;
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_StartsWithSubstr)->Arg(8)->Arg(64);
+
+void BM_StartsWith(benchmark::State& state) {
+  const std::vector<std::string> keys = make_keys(state.range(0));
+  const std::string probe = std::string(state.range(0), 'k') + "/match/";
+  for (auto _ : state) {
+    size_t hits = 0;
+    for (const std::string& key : keys) {
+      hits += string_view(key).starts_with(probe);
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_StartsWith)->Arg(8)->Arg(64);
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,53 @@
+#include "types/string_view.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+static_assert(DAVID_STRING_VIEW_CHECKS == 2, "build with hardened checks");
+
+TEST(StringViewHardenedDeathTest, TrapsOnBadAccess) {
+  string_view s = "abc";
+  EXPECT_DEATH(s[3], "");
+  EXPECT_DEATH(string_view().front(), "");
+  EXPECT_DEATH(string_view().back(), "");
+  EXPECT_DEATH(s.remove_prefix(4), "");
+  EXPECT_DEATH(s.remove_suffix(4), "");
+}
+
+TEST(StringViewHardenedTest, AllowsGoodAccess) {
+  string_view s = "abc";
+  EXPECT_EQ(s[2], 'c');
+  EXPECT_EQ(s.front(), 'a');
+  EXPECT_EQ(s.back(), 'c');
+  s.remove_prefix(3);
+  EXPECT_TRUE(s.empty());
+  s.remove_suffix(0);
+  EXPECT_TRUE(s.empty());
+}
+
+TEST(StringViewHardenedDeathTest, TrapsWhereTheStandardThrows) {
+  const string_view s = "abc";
+  char buf[4];
+  EXPECT_DEATH(s.at(3), "");
+  EXPECT_DEATH(s.substr(4), "");
+  EXPECT_DEATH(s.copy(buf, 1, 4), "");
+  EXPECT_EQ(s.substr(3), "");
+}
+
+TEST(StringViewHardenedTest, DoesNotThrow) {
+  const string_view s = "abc";
+  EXPECT_TRUE(noexcept(s.at(0)));
+  EXPECT_TRUE(noexcept(s.substr(0)));
+}
+
+TEST(StringViewHardenedTest, UncheckedVariantsDoNotTrap) {
+  const string_view s = "abc";
+  EXPECT_EQ(s.substr_unchecked(1, 1), "b");
+  EXPECT_EQ(s.at_unchecked(0), 'a');
+}
+
+}  // namespace
+}  // namespace david
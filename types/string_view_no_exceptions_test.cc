@@ -0,0 +1,31 @@
+#include "types/string_view.h"
+
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+#ifdef __cpp_exceptions
+#error "build with -fno-exceptions"
+#endif
+
+TEST(StringViewNoExceptionsDeathTest, TrapsWhereTheStandardThrows) {
+  const string_view s = "abc";
+  char buf[4];
+  EXPECT_DEATH(s.at(3), "");
+  EXPECT_DEATH(s.substr(4), "");
+  EXPECT_DEATH(s.copy(buf, 1, 4), "");
+}
+
+TEST(StringViewNoExceptionsTest, AllowsGoodAccess) {
+  const string_view s = "abc";
+  char buf[4];
+  EXPECT_EQ(s.at(2), 'c');
+  EXPECT_EQ(s.substr(1), "bc");
+  EXPECT_EQ(s.substr(3), "");
+  EXPECT_EQ(s.copy(buf, 4, 1), 2u);
+  EXPECT_TRUE(noexcept(s.substr(0)));
+}
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,308 @@
+#ifndef TYPES_STRING_VIEW_STATS
+#define TYPES_STRING_VIEW_STATS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace david {
+
+// Usage statistics for the search and compare operations of
+// basic_string_view, to see which kernels real workloads lean on.
+//
+// Collection is off unless the whole program is built with
+// -DDAVID_STRING_VIEW_STATS=1; otherwise string_view calls no hook and
+// snapshots are all zero. Mixing translation units built with and without
+// the flag breaks the one definition rule.
+//
+// Each thread counts into its own block of relaxed atomics, so recording
+// costs a few uncontended loads and stores. Snapshots add the blocks up
+// without stopping the threads, so a snapshot taken while they run may miss
+// their latest calls.
+enum class string_view_op {
+  kFind,
+  kRfind,
+  kFindFirstOf,
+  kFindLastOf,
+  kFindFirstNotOf,
+  kFindLastNotOf,
+  kCompare,
+};
+
+static const size_t kNumStringViewOps = 7;
+// Bucket 0 counts lengths of 0 and bucket b > 0 lengths in [2^(b-1), 2^b).
+static const size_t kNumLengthBuckets = 65;
+
+inline const char* string_view_op_name(string_view_op op) {
+  static const char* const kNames[kNumStringViewOps] = {
+      "find",           "rfind",           "find_first_of", "find_last_of",
+      "find_first_not_of", "find_last_not_of", "compare"};
+  return kNames[static_cast<size_t>(op)];
+}
+
+struct string_view_op_stats {
+  uint64_t calls = 0;
+  // Searches that found something, and compares that found equal strings.
+  uint64_t hits = 0;
+  uint64_t haystack_lengths[kNumLengthBuckets] = {};
+  // Needle size for searches, and size of the argument for compares.
+  uint64_t needle_lengths[kNumLengthBuckets] = {};
+};
+
+struct string_view_stats_snapshot {
+  string_view_op_stats ops[kNumStringViewOps];
+
+  const string_view_op_stats& operator[](string_view_op op) const {
+    return ops[static_cast<size_t>(op)];
+  }
+
+  // One block per operation that was called:
+  //   find: 120 calls, 75.0% hits
+  //     haystack [16, 32): 100
+  //     ...
+  std::string to_text() const {
+    std::string out;
+    for (size_t i = 0; i < kNumStringViewOps; ++i) {
+      const string_view_op_stats& s = ops[i];
+      if (s.calls == 0) continue;
+      out += string_view_op_name(static_cast<string_view_op>(i));
+      out += ": " + std::to_string(s.calls) + " calls, ";
+      char rate[32];
+      snprintf(rate, sizeof(rate), "%.1f%%", 100.0 * s.hits / s.calls);
+      out += rate;
+      out += " hits\n";
+      append_histogram_text("haystack", s.haystack_lengths, &out);
+      append_histogram_text("needle", s.needle_lengths, &out);
+    }
+    return out;
+  }
+
+  // {"find": {"calls": 120, "hits": 90, "haystack_log2": [0, 3, ...],
+  //  "needle_log2": [...]}, ...}, with the histograms cut after their last
+  // non-zero bucket.
+  std::string to_json() const {
+    std::string out = "{";
+    for (size_t i = 0; i < kNumStringViewOps; ++i) {
+      const string_view_op_stats& s = ops[i];
+      if (i > 0) out += ", ";
+      out += "\"";
+      out += string_view_op_name(static_cast<string_view_op>(i));
+      out += "\": {\"calls\": " + std::to_string(s.calls) +
+             ", \"hits\": " + std::to_string(s.hits) +
+             ", \"haystack_log2\": ";
+      append_histogram_json(s.haystack_lengths, &out);
+      out += ", \"needle_log2\": ";
+      append_histogram_json(s.needle_lengths, &out);
+      out += "}";
+    }
+    out += "}";
+    return out;
+  }
+
+ private:
+  static void append_histogram_text(const char* name,
+                                    const uint64_t* buckets,
+                                    std::string* out) {
+    for (size_t b = 0; b < kNumLengthBuckets; ++b) {
+      if (buckets[b] == 0) continue;
+      *out += "  ";
+      *out += name;
+      if (b == 0) {
+        *out += " 0: ";
+      } else {
+        *out += " [" + std::to_string(uint64_t(1) << (b - 1)) + ", " +
+                (b == 64 ? std::string("2^64")
+                         : std::to_string(uint64_t(1) << b)) +
+                "): ";
+      }
+      *out += std::to_string(buckets[b]) + "\n";
+    }
+  }
+
+  static void append_histogram_json(const uint64_t* buckets,
+                                    std::string* out) {
+    size_t end = kNumLengthBuckets;
+    while (end > 0 && buckets[end - 1] == 0) --end;
+    *out += "[";
+    for (size_t b = 0; b < end; ++b) {
+      if (b > 0) *out += ", ";
+      *out += std::to_string(buckets[b]);
+    }
+    *out += "]";
+  }
+};
+
+namespace internal {
+
+// Counters of one thread. Blocks are linked into a list that only grows, and
+// the block of a thread that exits is taken over by the next new thread, so
+// its counts are never lost.
+struct string_view_stats_block {
+  struct op_counters {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> haystack_lengths[kNumLengthBuckets];
+    std::atomic<uint64_t> needle_lengths[kNumLengthBuckets];
+  };
+
+  string_view_stats_block() : next(nullptr), in_use(true) {
+    for (op_counters& op : ops) {
+      op.calls.store(0, std::memory_order_relaxed);
+      op.hits.store(0, std::memory_order_relaxed);
+      for (size_t b = 0; b < kNumLengthBuckets; ++b) {
+        op.haystack_lengths[b].store(0, std::memory_order_relaxed);
+        op.needle_lengths[b].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  op_counters ops[kNumStringViewOps];
+  string_view_stats_block* next;
+  std::atomic<bool> in_use;
+};
+
+inline std::atomic<string_view_stats_block*>& string_view_stats_head() {
+  static std::atomic<string_view_stats_block*> head(nullptr);
+  return head;
+}
+
+inline string_view_stats_block* acquire_string_view_stats_block() {
+  std::atomic<string_view_stats_block*>& head = string_view_stats_head();
+  for (string_view_stats_block* b = head.load(std::memory_order_acquire);
+       b != nullptr; b = b->next) {
+    bool expected = false;
+    if (b->in_use.compare_exchange_strong(expected, true,
+                                          std::memory_order_acquire)) {
+      return b;
+    }
+  }
+  string_view_stats_block* b = new string_view_stats_block();
+  b->next = head.load(std::memory_order_relaxed);
+  while (!head.compare_exchange_weak(b->next, b, std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+  }
+  return b;
+}
+
+// Owns the block of the current thread until the thread exits.
+class string_view_stats_owner {
+ public:
+  string_view_stats_owner() : block_(acquire_string_view_stats_block()) {}
+  ~string_view_stats_owner() {
+    block_->in_use.store(false, std::memory_order_release);
+  }
+  string_view_stats_block* block() const { return block_; }
+
+ private:
+  string_view_stats_block* block_;
+};
+
+inline string_view_stats_block& local_string_view_stats() {
+  static thread_local string_view_stats_owner owner;
+  return *owner.block();
+}
+
+// Only the owning thread writes a block, so a relaxed load and store make an
+// increment without a locked instruction.
+inline void bump(std::atomic<uint64_t>& counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+inline size_t length_bucket(size_t n) {
+  return n == 0 ? 0 : 64 - __builtin_clzll(static_cast<uint64_t>(n));
+}
+
+// Counts a call of op that returned result and passes result through, so
+// that string_view can wrap its return expressions.
+template <typename T>
+inline T record_string_view_op(string_view_op op, size_t haystack,
+                               size_t needle, T result) {
+  const bool hit = op == string_view_op::kCompare ? result == 0
+                                                  : result != T(-1);
+  string_view_stats_block::op_counters& c =
+      local_string_view_stats().ops[static_cast<size_t>(op)];
+  bump(c.calls);
+  if (hit) bump(c.hits);
+  bump(c.haystack_lengths[length_bucket(haystack)]);
+  bump(c.needle_lengths[length_bucket(needle)]);
+  return result;
+}
+
+// Sum of every block since the program started.
+inline string_view_stats_snapshot raw_string_view_stats() {
+  string_view_stats_snapshot s;
+  for (const string_view_stats_block* b =
+           string_view_stats_head().load(std::memory_order_acquire);
+       b != nullptr; b = b->next) {
+    for (size_t i = 0; i < kNumStringViewOps; ++i) {
+      const string_view_stats_block::op_counters& c = b->ops[i];
+      string_view_op_stats& out = s.ops[i];
+      out.calls += c.calls.load(std::memory_order_relaxed);
+      out.hits += c.hits.load(std::memory_order_relaxed);
+      for (size_t k = 0; k < kNumLengthBuckets; ++k) {
+        out.haystack_lengths[k] +=
+            c.haystack_lengths[k].load(std::memory_order_relaxed);
+        out.needle_lengths[k] +=
+            c.needle_lengths[k].load(std::memory_order_relaxed);
+      }
+    }
+  }
+  return s;
+}
+
+// reset_string_view_stats() records a baseline that later snapshots
+// subtract, rather than clearing counters that other threads write to.
+struct string_view_stats_baseline {
+  std::mutex mu;
+  string_view_stats_snapshot snapshot;
+};
+
+inline string_view_stats_baseline& string_view_stats_baseline_instance() {
+  static string_view_stats_baseline baseline;
+  return baseline;
+}
+
+}  // namespace internal
+
+inline bool string_view_stats_enabled() {
+#if defined(DAVID_STRING_VIEW_STATS) && DAVID_STRING_VIEW_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Counts of every thread since the last reset.
+inline string_view_stats_snapshot string_view_stats() {
+  string_view_stats_snapshot s = internal::raw_string_view_stats();
+  internal::string_view_stats_baseline& baseline =
+      internal::string_view_stats_baseline_instance();
+  std::lock_guard<std::mutex> lock(baseline.mu);
+  for (size_t i = 0; i < kNumStringViewOps; ++i) {
+    string_view_op_stats& out = s.ops[i];
+    const string_view_op_stats& base = baseline.snapshot.ops[i];
+    out.calls -= base.calls;
+    out.hits -= base.hits;
+    for (size_t k = 0; k < kNumLengthBuckets; ++k) {
+      out.haystack_lengths[k] -= base.haystack_lengths[k];
+      out.needle_lengths[k] -= base.needle_lengths[k];
+    }
+  }
+  return s;
+}
+
+inline void reset_string_view_stats() {
+  const string_view_stats_snapshot now = internal::raw_string_view_stats();
+  internal::string_view_stats_baseline& baseline =
+      internal::string_view_stats_baseline_instance();
+  std::lock_guard<std::mutex> lock(baseline.mu);
+  baseline.snapshot = now;
+}
+
+}  // namespace david
+
+#endif  // TYPES_STRING_VIEW_STATS
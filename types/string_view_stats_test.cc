@@ -0,0 +1,133 @@
+#include "types/string_view_stats.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "types/string_view.h"
+
+namespace david {
+namespace {
+
+using ::testing::HasSubstr;
+
+class StringViewStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override { reset_string_view_stats(); }
+};
+
+TEST_F(StringViewStatsTest, Enabled) {
+  EXPECT_TRUE(string_view_stats_enabled());
+}
+
+TEST_F(StringViewStatsTest, CountsFind) {
+  const string_view haystack = "hello world";
+  EXPECT_EQ(haystack.find("world"), 6);
+  EXPECT_EQ(haystack.find("xyz"), string_view::npos);
+  EXPECT_EQ(haystack.find('o'), 4);
+
+  const string_view_stats_snapshot s = string_view_stats();
+  const string_view_op_stats& find = s[string_view_op::kFind];
+  EXPECT_EQ(find.calls, 3);
+  EXPECT_EQ(find.hits, 2);
+  // 11 is in [8, 16).
+  EXPECT_EQ(find.haystack_lengths[4], 3);
+  // 5 is in [4, 8), 3 in [2, 4) and 1 in [1, 2).
+  EXPECT_EQ(find.needle_lengths[3], 1);
+  EXPECT_EQ(find.needle_lengths[2], 1);
+  EXPECT_EQ(find.needle_lengths[1], 1);
+  EXPECT_EQ(s[string_view_op::kRfind].calls, 0);
+}
+
+TEST_F(StringViewStatsTest, CountsEachOperation) {
+  const string_view s = "a,b;c";
+  s.rfind("b");
+  s.find_first_of(",;");
+  s.find_last_of(",;");
+  s.find_first_not_of("a");
+  s.find_last_not_of("abc,;");
+
+  const string_view_stats_snapshot stats = string_view_stats();
+  EXPECT_EQ(stats[string_view_op::kRfind].calls, 1);
+  EXPECT_EQ(stats[string_view_op::kRfind].hits, 1);
+  EXPECT_EQ(stats[string_view_op::kFindFirstOf].calls, 1);
+  EXPECT_EQ(stats[string_view_op::kFindLastOf].calls, 1);
+  EXPECT_EQ(stats[string_view_op::kFindFirstNotOf].hits, 1);
+  EXPECT_EQ(stats[string_view_op::kFindLastNotOf].calls, 1);
+  EXPECT_EQ(stats[string_view_op::kFindLastNotOf].hits, 0);
+}
+
+TEST_F(StringViewStatsTest, CountsCompare) {
+  const string_view a = "abc";
+  EXPECT_TRUE(a == "abc");
+  EXPECT_TRUE(a < "abd");
+  EXPECT_EQ(a.compare(""), 1);
+
+  const string_view_stats_snapshot s = string_view_stats();
+  const string_view_op_stats& compare = s[string_view_op::kCompare];
+  EXPECT_EQ(compare.calls, 3);
+  EXPECT_EQ(compare.hits, 1);
+  EXPECT_EQ(compare.haystack_lengths[2], 3);
+  EXPECT_EQ(compare.needle_lengths[0], 1);
+  EXPECT_EQ(compare.needle_lengths[2], 2);
+}
+
+TEST_F(StringViewStatsTest, ResetStartsOver) {
+  string_view("abc").find('b');
+  reset_string_view_stats();
+  EXPECT_EQ(string_view_stats()[string_view_op::kFind].calls, 0);
+  string_view("abc").find('b');
+  EXPECT_EQ(string_view_stats()[string_view_op::kFind].calls, 1);
+}
+
+TEST_F(StringViewStatsTest, SumsThreads) {
+  const int kThreads = 4;
+  const int kCalls = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([] {
+      const std::string text(100, 'a');
+      for (int i = 0; i < kCalls; ++i) string_view(text).find("b");
+    });
+  }
+  for (std::thread& t : threads) t.join();
+
+  // The blocks of the threads that exited still count, and are reused.
+  std::thread([] { string_view("ab").find("b"); }).join();
+
+  const string_view_stats_snapshot s = string_view_stats();
+  const string_view_op_stats& find = s[string_view_op::kFind];
+  EXPECT_EQ(find.calls, kThreads * kCalls + 1);
+  EXPECT_EQ(find.hits, 1);
+  EXPECT_EQ(find.haystack_lengths[7], kThreads * kCalls);
+}
+
+TEST_F(StringViewStatsTest, Text) {
+  string_view("hello").find("ll");
+  string_view("hello").find("x");
+
+  const std::string text = string_view_stats().to_text();
+  EXPECT_THAT(text, HasSubstr("find: 2 calls, 50.0% hits\n"));
+  EXPECT_THAT(text, HasSubstr("  haystack [4, 8): 2\n"));
+  EXPECT_THAT(text, HasSubstr("  needle [1, 2): 1\n"));
+  EXPECT_THAT(text, HasSubstr("  needle [2, 4): 1\n"));
+  EXPECT_THAT(text, ::testing::Not(HasSubstr("rfind")));
+}
+
+TEST_F(StringViewStatsTest, Json) {
+  string_view("hello").find("ll");
+
+  const std::string json = string_view_stats().to_json();
+  EXPECT_THAT(json, HasSubstr("\"find\": {\"calls\": 1, \"hits\": 1, "
+                              "\"haystack_log2\": [0, 0, 0, 1], "
+                              "\"needle_log2\": [0, 0, 1]}"));
+  EXPECT_THAT(json, HasSubstr("\"rfind\": {\"calls\": 0, \"hits\": 0, "
+                              "\"haystack_log2\": [], \"needle_log2\": []}"));
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_EQ(json.back(), '}');
+}
+
+}  // namespace
+}  // namespace david
@@ -3,6 +3,7 @@
 #include <exception>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -118,6 +119,29 @@ TEST(StringView, AtFailsWhenOutOfRange) {
   }
 }
 
+TEST(StringView, AtFailsAtSize) {
+  const string_view s = "hello";
+  EXPECT_THROW(s.at(s.size()), std::out_of_range);
+}
+
+TEST(StringView, UncheckedVariants) {
+  string_view s = "hello world";
+  EXPECT_EQ(s.at_unchecked(4), 'o');
+  EXPECT_EQ(s.substr_unchecked(6), "world");
+  EXPECT_EQ(s.substr_unchecked(0, 5), "hello");
+  EXPECT_TRUE(s.substr_unchecked(s.size()).empty());
+  char buf[5];
+  EXPECT_EQ(s.copy_unchecked(buf, sizeof(buf), 6), 5);
+  EXPECT_EQ(string_view(buf, 5), "world");
+  s.remove_prefix_unchecked(6);
+  s.remove_suffix_unchecked(1);
+  EXPECT_EQ(s, "worl");
+
+  static_assert(noexcept(s.substr_unchecked(1)), "");
+  static_assert(noexcept(s.at_unchecked(1)), "");
+  static_assert(noexcept(s.substr(1)) == (DAVID_STRING_VIEW_CHECKS == 0), "");
+}
+
 TEST(StringView, MaxSize) {
   const string_view s = "hello";
   EXPECT_THAT(s.max_size(), Gt(0));
@@ -289,6 +313,17 @@ TEST(StringView, CompareEqualTo) {
   EXPECT_EQ(s.compare("hello"), 0);
 }
 
+TEST(StringView, CompareEmpty) {
+  // Default-constructed views have null data, which memcmp must not see.
+  const string_view a;
+  const string_view b;
+  EXPECT_EQ(a.compare(b), 0);
+  EXPECT_TRUE(a == b);
+  EXPECT_FALSE(a < b);
+  EXPECT_EQ(a.compare(string_view("")), 0);
+  EXPECT_LT(a.compare(string_view("x")), 0);
+}
+
 TEST(StringView, CompareSubstringEqualTo) {
   const string_view s = "abc";
   EXPECT_EQ(s.compare(1, 2, string_view("bc")), 0);
@@ -323,6 +358,48 @@ TEST(StringView, EndsWith) {
   EXPECT_FALSE(s.ends_with("too large some text"));
 }
 
+TEST(StringView, StartsAndEndsWithEmpty) {
+  EXPECT_TRUE(string_view().starts_with(string_view()));
+  EXPECT_TRUE(string_view().ends_with(string_view()));
+  EXPECT_TRUE(string_view("text").starts_with(""));
+  EXPECT_TRUE(string_view("text").ends_with(""));
+  EXPECT_FALSE(string_view().starts_with('t'));
+}
+
+TEST(StringView, CommonPrefixLength) {
+  EXPECT_EQ(common_prefix_length(string_view("prefix"), string_view("pre")),
+            3u);
+  EXPECT_EQ(common_prefix_length(string_view("pre"), string_view("prefix")),
+            3u);
+  EXPECT_EQ(common_prefix_length(string_view("abc"), string_view("abd")), 2u);
+  EXPECT_EQ(common_prefix_length(string_view("abc"), string_view("xbc")), 0u);
+  EXPECT_EQ(common_prefix_length(string_view("same"), string_view("same")),
+            4u);
+  EXPECT_EQ(common_prefix_length(string_view(), string_view("abc")), 0u);
+  const std::string a = std::string(100, 'x') + "a";
+  const std::string b = std::string(100, 'x') + "b";
+  EXPECT_EQ(common_prefix_length(string_view(a), string_view(b)), 100u);
+}
+
+TEST(StringView, Count) {
+  EXPECT_EQ(count(string_view("a\nb\n\nc"), '\n'), 3u);
+  EXPECT_EQ(count(string_view("abc"), '\n'), 0u);
+  EXPECT_EQ(count(string_view(""), 'a'), 0u);
+  EXPECT_EQ(count(string_view(std::string(100, 'z')), 'z'), 100u);
+  EXPECT_EQ(count(u16string_view(u"banana"), u'a'), 3u);
+}
+
+TEST(StringView, Mismatch) {
+  const string_view a = "front-coded";
+  const string_view b = "front-end";
+  const std::pair<const char*, const char*> m = mismatch(a, b);
+  EXPECT_EQ(m.first, a.begin() + 6);
+  EXPECT_EQ(m.second, b.begin() + 6);
+  const string_view c = "front";
+  EXPECT_EQ(mismatch(a, c).first, a.begin() + 5);
+  EXPECT_EQ(mismatch(a, c).second, c.end());
+}
+
 TEST(StringView, FindPosTooLarge) {
   const string_view s = "pattern here";
   EXPECT_EQ(s.find(string_view("pattern"), 30), string_view::npos);
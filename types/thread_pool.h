@@ -0,0 +1,186 @@
+#ifndef TYPES_THREAD_POOL
+#define TYPES_THREAD_POOL
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace david {
+
+// A fixed set of worker threads that run parallel_for loops.
+//
+// Tasks are split into one contiguous block per thread. A thread runs its own
+// block front to back and, once it runs dry, steals the back half of the
+// block of another thread, so uneven tasks still keep every thread busy.
+//
+// The thread calling parallel_for takes part in the loop, so a pool of size n
+// runs n - 1 background threads. A pool runs one loop at a time: concurrent
+// calls are serialized and calling parallel_for from inside a task deadlocks.
+class thread_pool {
+ public:
+  // Creates a pool that runs loops on num_threads threads, including the
+  // calling one. Zero means std::thread::hardware_concurrency().
+  explicit thread_pool(size_t num_threads = 0)
+      : queues_(new queue[resolve(num_threads)]) {
+    const size_t n = resolve(num_threads);
+    threads_.reserve(n - 1);
+    for (size_t i = 1; i < n; ++i) {
+      threads_.emplace_back(&thread_pool::worker_main, this, i);
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      shutdown_ = true;
+    }
+    job_ready_.notify_all();
+    for (size_t i = 0; i < threads_.size(); ++i) threads_[i].join();
+  }
+
+  // Number of threads that run a loop, including the calling one.
+  size_t size() const noexcept { return threads_.size() + 1; }
+
+  // Calls f(i) once for every i in [0, num_tasks) and returns when all calls
+  // are done. Calls run concurrently and in no particular order, but each
+  // thread runs the tasks of its own block in increasing order. f must not
+  // throw.
+  template <class F>
+  void parallel_for(size_t num_tasks, const F& f) {
+    if (num_tasks == 0) return;
+    if (num_tasks == 1 || threads_.empty()) {
+      for (size_t i = 0; i < num_tasks; ++i) f(i);
+      return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mu_);
+    const size_t n = std::min(size(), num_tasks);
+    for (size_t i = 0; i < size(); ++i) {
+      std::lock_guard<std::mutex> lock(queues_[i].mu);
+      queues_[i].begin = i < n ? num_tasks * i / n : 0;
+      queues_[i].end = i < n ? num_tasks * (i + 1) / n : 0;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      job_fn_ = &f;
+      job_invoke_ = &invoke<F>;
+      job_threads_ = n;
+      pending_ = n - 1;
+      ++generation_;
+    }
+    job_ready_.notify_all();
+
+    run_tasks(0);
+
+    std::unique_lock<std::mutex> lock(mu_);
+    job_done_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+  // A process-wide pool with one thread per hardware thread, created on first
+  // use.
+  static thread_pool& default_pool() {
+    static thread_pool pool;
+    return pool;
+  }
+
+ private:
+  struct queue {
+    std::mutex mu;
+    size_t begin = 0;
+    size_t end = 0;
+    // Keeps the queues of different threads in different cache lines.
+    char padding[64];
+  };
+
+  static size_t resolve(size_t num_threads) {
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    return num_threads == 0 ? 1 : num_threads;
+  }
+
+  template <class F>
+  static void invoke(const void* f, size_t i) {
+    (*static_cast<const F*>(f))(i);
+  }
+
+  bool pop(size_t self, size_t* task) {
+    queue& q = queues_[self];
+    std::lock_guard<std::mutex> lock(q.mu);
+    if (q.begin == q.end) return false;
+    *task = q.begin++;
+    return true;
+  }
+
+  // Takes the back half of the first non empty block found after self.
+  bool steal(size_t self, size_t num_threads, size_t* task) {
+    for (size_t k = 1; k < num_threads; ++k) {
+      queue& victim = queues_[(self + k) % num_threads];
+      size_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mu);
+        const size_t available = victim.end - victim.begin;
+        if (available == 0) continue;
+        end = victim.end;
+        begin = end - (available + 1) / 2;
+        victim.end = begin;
+      }
+      *task = begin;
+      queue& q = queues_[self];
+      std::lock_guard<std::mutex> lock(q.mu);
+      q.begin = begin + 1;
+      q.end = end;
+      return true;
+    }
+    return false;
+  }
+
+  void run_tasks(size_t self) {
+    size_t task;
+    while (pop(self, &task) || steal(self, job_threads_, &task)) {
+      job_invoke_(job_fn_, task);
+    }
+  }
+
+  void worker_main(size_t self) {
+    size_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        job_ready_.wait(lock,
+                        [&] { return shutdown_ || generation_ != seen; });
+        if (shutdown_) return;
+        seen = generation_;
+        if (self >= job_threads_) continue;
+      }
+
+      run_tasks(self);
+
+      std::lock_guard<std::mutex> lock(mu_);
+      if (--pending_ == 0) job_done_.notify_one();
+    }
+  }
+
+  std::unique_ptr<queue[]> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex run_mu_;
+  std::mutex mu_;
+  std::condition_variable job_ready_;
+  std::condition_variable job_done_;
+  bool shutdown_ = false;
+  size_t generation_ = 0;
+  const void* job_fn_ = nullptr;
+  void (*job_invoke_)(const void*, size_t) = nullptr;
+  size_t job_threads_ = 0;
+  size_t pending_ = 0;
+};
+
+}  // namespace david
+
+#endif  // TYPES_THREAD_POOL
@@ -0,0 +1,56 @@
+#include "types/thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+using ::testing::Each;
+using ::testing::Eq;
+
+TEST(ThreadPool, Size) {
+  thread_pool pool(3);
+  EXPECT_EQ(pool.size(), 3);
+  EXPECT_GE(thread_pool::default_pool().size(), 1);
+}
+
+TEST(ThreadPool, RunsEveryTaskOnce) {
+  for (size_t threads = 1; threads <= 4; ++threads) {
+    thread_pool pool(threads);
+    for (size_t n : {0, 1, 2, 7, 1000}) {
+      std::vector<std::atomic<int>> calls(n);
+      for (size_t i = 0; i < n; ++i) calls[i] = 0;
+      pool.parallel_for(n, [&](size_t i) { calls[i]++; });
+      for (size_t i = 0; i < n; ++i) ASSERT_EQ(calls[i].load(), 1);
+    }
+  }
+}
+
+TEST(ThreadPool, UnevenTasks) {
+  thread_pool pool(4);
+  std::vector<int> done(64, 0);
+  pool.parallel_for(done.size(), [&](size_t i) {
+    // The first block is much slower than the rest, so other threads have
+    // to steal from it.
+    volatile size_t spin = i < 16 ? 200000 : 0;
+    while (spin > 0) spin = spin - 1;
+    done[i] = 1;
+  });
+  EXPECT_THAT(done, Each(Eq(1)));
+}
+
+TEST(ThreadPool, Reusable) {
+  thread_pool pool(2);
+  std::atomic<size_t> sum(0);
+  for (int round = 0; round < 100; ++round) {
+    pool.parallel_for(10, [&](size_t i) { sum += i; });
+  }
+  EXPECT_EQ(sum.load(), 100 * 45);
+}
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,899 @@
+#ifndef TYPES_VARIANT
+#define TYPES_VARIANT
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "types/internal/enable_copy_move.h"
+#include "types/relocate.h"
+
+namespace david {
+
+template <typename... Ts>
+class variant;
+
+// Alternative that holds nothing, to make a variant default constructible.
+struct monostate {};
+
+constexpr bool operator==(monostate, monostate) noexcept { return true; }
+constexpr bool operator!=(monostate, monostate) noexcept { return false; }
+constexpr bool operator<(monostate, monostate) noexcept { return false; }
+
+// Thrown by get() for an alternative that is not held, and by visit() for a
+// variant that holds none. Builds without exceptions abort instead.
+class bad_variant_access : public std::exception {
+ public:
+  const char* what() const noexcept override { return "bad variant access"; }
+};
+
+// Index of a variant that holds no alternative, after an exception.
+constexpr size_t variant_npos = static_cast<size_t>(-1);
+
+// Tags to construct an alternative in place.
+template <size_t I>
+struct in_place_index_t {
+  explicit constexpr in_place_index_t() = default;
+};
+
+template <typename T>
+struct in_place_type_t {
+  explicit constexpr in_place_type_t() = default;
+};
+
+template <typename V>
+struct variant_size;
+
+template <typename... Ts>
+struct variant_size<variant<Ts...>>
+    : std::integral_constant<size_t, sizeof...(Ts)> {};
+
+template <typename V>
+struct variant_size<const V> : variant_size<V> {};
+
+template <size_t I, typename V>
+struct variant_alternative;
+
+template <size_t I, typename T, typename... Ts>
+struct variant_alternative<I, variant<T, Ts...>>
+    : variant_alternative<I - 1, variant<Ts...>> {};
+
+template <typename T, typename... Ts>
+struct variant_alternative<0, variant<T, Ts...>> {
+  using type = T;
+};
+
+template <size_t I, typename V>
+struct variant_alternative<I, const V> {
+  using type = const typename variant_alternative<I, V>::type;
+};
+
+namespace internal {
+
+template <size_t... Is>
+struct index_sequence {};
+
+template <size_t N, size_t... Is>
+struct make_index_sequence_impl
+    : make_index_sequence_impl<N - 1, N - 1, Is...> {};
+
+template <size_t... Is>
+struct make_index_sequence_impl<0, Is...> {
+  using type = index_sequence<Is...>;
+};
+
+template <size_t N>
+using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+template <bool...>
+struct bool_pack;
+
+template <bool... Bs>
+using all_of = std::is_same<bool_pack<true, Bs...>, bool_pack<Bs..., true>>;
+
+template <typename...>
+struct make_void {
+  using type = void;
+};
+
+template <size_t I, typename T, typename... Ts>
+struct nth_type : nth_type<I - 1, Ts...> {};
+
+template <typename T, typename... Ts>
+struct nth_type<0, T, Ts...> {
+  using type = T;
+};
+
+// Position of the first T in Ts, or sizeof...(Ts) if there is none.
+template <typename T, typename... Ts>
+struct type_index : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename U, typename... Ts>
+struct type_index<T, U, Ts...>
+    : std::integral_constant<size_t,
+                             std::is_same<T, U>::value
+                                 ? 0
+                                 : 1 + type_index<T, Ts...>::value> {};
+
+template <typename T, typename... Ts>
+struct type_count : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename U, typename... Ts>
+struct type_count<T, U, Ts...>
+    : std::integral_constant<size_t, std::is_same<T, U>::value +
+                                         type_count<T, Ts...>::value> {};
+
+// The smallest type that holds the indexes of N alternatives, and the
+// largest value of the type for a variant without one.
+template <size_t N>
+using variant_index_t = typename std::conditional<
+    (N < UINT8_MAX), uint8_t,
+    typename std::conditional<(N < UINT16_MAX), uint16_t,
+                              uint32_t>::type>::type;
+
+[[noreturn]] inline void throw_bad_variant_access() {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+  throw bad_variant_access();
+#else
+  std::abort();
+#endif
+}
+
+// Calls f(std::integral_constant<size_t, I>()) for I = index < N.
+//
+// Variants of up to kMaxSwitchSize alternatives branch with a switch, where
+// each case inlines its call of f, and which compiles to a jump table. Larger
+// ones call through a table of function pointers.
+constexpr size_t kMaxSwitchSize = 16;
+
+template <typename R, size_t I, typename F>
+R dispatch_case(std::true_type /* I < N */, F&& f) {
+  return std::forward<F>(f)(std::integral_constant<size_t, I>());
+}
+
+template <typename R, size_t I, typename F>
+R dispatch_case(std::false_type /* I < N */, F&&) {
+  __builtin_unreachable();
+}
+
+#define DAVID_VARIANT_CASE(I)                                                \
+  case I:                                                                    \
+    return dispatch_case<R, I>(std::integral_constant<bool, (I < N)>(),      \
+                               std::forward<F>(f))
+
+template <typename R, size_t N, typename F>
+R dispatch_index(size_t index, F&& f, std::true_type /* switch */) {
+  static_assert(kMaxSwitchSize == 16, "DAVID_VARIANT_CASE must cover it");
+  switch (index) {
+    DAVID_VARIANT_CASE(0);
+    DAVID_VARIANT_CASE(1);
+    DAVID_VARIANT_CASE(2);
+    DAVID_VARIANT_CASE(3);
+    DAVID_VARIANT_CASE(4);
+    DAVID_VARIANT_CASE(5);
+    DAVID_VARIANT_CASE(6);
+    DAVID_VARIANT_CASE(7);
+    DAVID_VARIANT_CASE(8);
+    DAVID_VARIANT_CASE(9);
+    DAVID_VARIANT_CASE(10);
+    DAVID_VARIANT_CASE(11);
+    DAVID_VARIANT_CASE(12);
+    DAVID_VARIANT_CASE(13);
+    DAVID_VARIANT_CASE(14);
+    DAVID_VARIANT_CASE(15);
+  }
+  __builtin_unreachable();
+}
+
+#undef DAVID_VARIANT_CASE
+
+template <typename R, size_t I, typename F>
+R dispatch_entry(F&& f) {
+  return std::forward<F>(f)(std::integral_constant<size_t, I>());
+}
+
+template <typename R, typename F, size_t... Is>
+R dispatch_table(size_t index, F&& f, index_sequence<Is...>) {
+  static constexpr R (*kTable[])(F&&) = {&dispatch_entry<R, Is, F>...};
+  return kTable[index](std::forward<F>(f));
+}
+
+template <typename R, size_t N, typename F>
+R dispatch_index(size_t index, F&& f, std::false_type /* switch */) {
+  return dispatch_table<R>(index, std::forward<F>(f),
+                           make_index_sequence<N>());
+}
+
+template <typename R, size_t N, typename F>
+R dispatch_index(size_t index, F&& f) {
+  return dispatch_index<R, N>(
+      index, std::forward<F>(f),
+      std::integral_constant<bool, (N <= kMaxSwitchSize)>());
+}
+
+// Union of the alternatives, as a recursive union of the first one and a
+// union of the others. Destroying it is trivial when it is for all of them.
+template <bool /* trivially destructible */, typename... Ts>
+union variadic_union {};
+
+template <typename T, typename... Ts>
+union variadic_union<true, T, Ts...> {
+  constexpr variadic_union() : dummy_() {}
+  template <typename... Args>
+  constexpr explicit variadic_union(in_place_index_t<0>, Args&&... args)
+      : first_(std::forward<Args>(args)...) {}
+  template <size_t I, typename... Args>
+  constexpr explicit variadic_union(in_place_index_t<I>, Args&&... args)
+      : rest_(in_place_index_t<I - 1>(), std::forward<Args>(args)...) {}
+
+  char dummy_;
+  T first_;
+  variadic_union<true, Ts...> rest_;
+};
+
+template <typename T, typename... Ts>
+union variadic_union<false, T, Ts...> {
+  constexpr variadic_union() : dummy_() {}
+  template <typename... Args>
+  constexpr explicit variadic_union(in_place_index_t<0>, Args&&... args)
+      : first_(std::forward<Args>(args)...) {}
+  template <size_t I, typename... Args>
+  constexpr explicit variadic_union(in_place_index_t<I>, Args&&... args)
+      : rest_(in_place_index_t<I - 1>(), std::forward<Args>(args)...) {}
+  // variant_storage destroys the alternative it holds.
+  ~variadic_union() {}
+
+  char dummy_;
+  T first_;
+  variadic_union<false, Ts...> rest_;
+};
+
+// Alternative I of a variadic_union, with the value category of the union.
+//
+// A union and its members are pointer-interconvertible, so every alternative
+// is at the address of the outermost union. Casting it, rather than going
+// down I levels of rest_, instantiates one function per alternative instead
+// of I, which keeps large variants quick to compile.
+template <size_t I>
+struct union_get {
+  template <bool B, typename... Ts>
+  static typename nth_type<I, Ts...>::type& get(
+      variadic_union<B, Ts...>& u) noexcept {
+    return *reinterpret_cast<typename nth_type<I, Ts...>::type*>(
+        std::addressof(u));
+  }
+  template <bool B, typename... Ts>
+  static const typename nth_type<I, Ts...>::type& get(
+      const variadic_union<B, Ts...>& u) noexcept {
+    return *reinterpret_cast<const typename nth_type<I, Ts...>::type*>(
+        std::addressof(u));
+  }
+  template <bool B, typename... Ts>
+  static typename nth_type<I, Ts...>::type&& get(
+      variadic_union<B, Ts...>&& u) noexcept {
+    return std::move(get(u));
+  }
+  template <bool B, typename... Ts>
+  static const typename nth_type<I, Ts...>::type&& get(
+      const variadic_union<B, Ts...>&& u) noexcept {
+    return std::move(get(u));
+  }
+};
+
+template <typename T>
+void destroy_object(T& obj) noexcept {
+  obj.~T();
+}
+
+struct variant_uninit_tag {};
+
+// Holds one of Ts, or none after an exception, with its index.
+template <bool /* trivially destructible */, typename... Ts>
+class variant_storage {
+ public:
+  using index_type = variant_index_t<sizeof...(Ts)>;
+  static constexpr index_type kValueless = static_cast<index_type>(-1);
+
+  template <size_t I, typename... Args>
+  constexpr explicit variant_storage(in_place_index_t<I>, Args&&... args)
+      : data_(in_place_index_t<I>(), std::forward<Args>(args)...),
+        index_(static_cast<index_type>(I)) {}
+  // Leaves the storage empty, for construct_from() to fill.
+  explicit variant_storage(variant_uninit_tag) : index_(kValueless) {}
+
+ protected:
+  void destroy() noexcept { index_ = kValueless; }
+
+  variadic_union<true, Ts...> data_;
+  index_type index_;
+};
+
+template <typename... Ts>
+class variant_storage<false, Ts...> {
+ public:
+  using index_type = variant_index_t<sizeof...(Ts)>;
+  static constexpr index_type kValueless = static_cast<index_type>(-1);
+
+  template <size_t I, typename... Args>
+  constexpr explicit variant_storage(in_place_index_t<I>, Args&&... args)
+      : data_(in_place_index_t<I>(), std::forward<Args>(args)...),
+        index_(static_cast<index_type>(I)) {}
+  explicit variant_storage(variant_uninit_tag) : index_(kValueless) {}
+  ~variant_storage() { destroy(); }
+
+ protected:
+  struct destroy_alt {
+    variant_storage* self;
+    template <size_t I>
+    void operator()(std::integral_constant<size_t, I>) const noexcept {
+      destroy_object(union_get<I>::get(self->data_));
+    }
+  };
+
+  void destroy() noexcept {
+    if (index_ != kValueless) {
+      dispatch_index<void, sizeof...(Ts)>(index_, destroy_alt{this});
+      index_ = kValueless;
+    }
+  }
+
+  variadic_union<false, Ts...> data_;
+  index_type index_;
+};
+
+// Construction and assignment of the alternatives. Other is a
+// variant_storage, as an lvalue to copy or an rvalue to move.
+template <typename... Ts>
+class variant_ops
+    : public variant_storage<
+          all_of<std::is_trivially_destructible<Ts>::value...>::value, Ts...> {
+  using storage = variant_storage<
+      all_of<std::is_trivially_destructible<Ts>::value...>::value, Ts...>;
+
+ public:
+  using storage::storage;
+
+ protected:
+  template <size_t I, typename... Args>
+  void construct_alt(Args&&... args) {
+    using T = typename nth_type<I, Ts...>::type;
+    ::new (static_cast<void*>(std::addressof(union_get<I>::get(this->data_))))
+        T(std::forward<Args>(args)...);
+    this->index_ = static_cast<typename storage::index_type>(I);
+  }
+
+  // Replaces the alternative with alternative I built from args. If building
+  // it throws, the variant holds none, unless T can be built aside and moved
+  // in without throwing.
+  template <size_t I, typename... Args>
+  void emplace_alt(Args&&... args) {
+    using T = typename nth_type<I, Ts...>::type;
+    using build_aside = std::integral_constant<
+        bool, !std::is_nothrow_constructible<T, Args...>::value &&
+                  std::is_nothrow_move_constructible<T>::value>;
+    emplace_alt_impl<I>(build_aside(), std::forward<Args>(args)...);
+  }
+  template <size_t I, typename... Args>
+  void emplace_alt_impl(std::false_type /* build aside */, Args&&... args) {
+    this->destroy();
+    construct_alt<I>(std::forward<Args>(args)...);
+  }
+  template <size_t I, typename... Args>
+  void emplace_alt_impl(std::true_type /* build aside */, Args&&... args) {
+    typename nth_type<I, Ts...>::type tmp(std::forward<Args>(args)...);
+    this->destroy();
+    construct_alt<I>(std::move(tmp));
+  }
+
+  template <typename Other>
+  struct construct_alt_from {
+    variant_ops* self;
+    typename std::remove_reference<Other>::type* other;
+    template <size_t I>
+    void operator()(std::integral_constant<size_t, I>) const {
+      self->template construct_alt<I>(
+          union_get<I>::get(std::forward<Other>(*other).data_));
+    }
+  };
+
+  template <typename Other>
+  struct assign_alt_from {
+    variant_ops* self;
+    typename std::remove_reference<Other>::type* other;
+    template <size_t I>
+    void operator()(std::integral_constant<size_t, I>) const {
+      if (self->index_ == I) {
+        union_get<I>::get(self->data_) =
+            union_get<I>::get(std::forward<Other>(*other).data_);
+      } else {
+        self->template emplace_alt<I>(
+            union_get<I>::get(std::forward<Other>(*other).data_));
+      }
+    }
+  };
+
+  template <typename Other>
+  void construct_from(Other&& other) {
+    if (other.index_ == storage::kValueless) return;
+    dispatch_index<void, sizeof...(Ts)>(
+        other.index_, construct_alt_from<Other>{this, &other});
+  }
+
+  template <typename Other>
+  void assign_from(Other&& other) {
+    if (other.index_ == storage::kValueless) {
+      this->destroy();
+      return;
+    }
+    dispatch_index<void, sizeof...(Ts)>(other.index_,
+                                        assign_alt_from<Other>{this, &other});
+  }
+};
+
+template <typename... Ts>
+using variant_trivial_copy =
+    all_of<(std::is_trivially_copy_constructible<Ts>::value &&
+            std::is_trivially_copy_assignable<Ts>::value &&
+            std::is_trivially_destructible<Ts>::value)...>;
+
+template <typename... Ts>
+using variant_trivial_move =
+    all_of<(std::is_trivially_move_constructible<Ts>::value &&
+            std::is_trivially_move_assignable<Ts>::value &&
+            std::is_trivially_destructible<Ts>::value)...>;
+
+template <typename... Ts>
+using variant_nothrow_move =
+    all_of<(std::is_nothrow_move_constructible<Ts>::value &&
+            std::is_nothrow_move_assignable<Ts>::value)...>;
+
+// As with optional_base, the copy and move members are only user-provided
+// when an alternative needs it, so that a variant of trivially copyable types
+// is trivially copyable itself.
+template <bool /* trivial copy */, bool /* trivial move */, typename... Ts>
+class variant_base : public variant_ops<Ts...> {
+ public:
+  using variant_ops<Ts...>::variant_ops;
+
+  variant_base(const variant_base& other)
+      : variant_ops<Ts...>(variant_uninit_tag()) {
+    this->construct_from(other);
+  }
+  variant_base(variant_base&& other) noexcept(
+      all_of<std::is_nothrow_move_constructible<Ts>::value...>::value)
+      : variant_ops<Ts...>(variant_uninit_tag()) {
+    this->construct_from(std::move(other));
+  }
+  variant_base& operator=(const variant_base& other) {
+    this->assign_from(other);
+    return *this;
+  }
+  variant_base& operator=(variant_base&& other) noexcept(
+      variant_nothrow_move<Ts...>::value) {
+    this->assign_from(std::move(other));
+    return *this;
+  }
+};
+
+template <typename... Ts>
+class variant_base<true, true, Ts...> : public variant_ops<Ts...> {
+ public:
+  using variant_ops<Ts...>::variant_ops;
+};
+
+template <typename... Ts>
+class variant_base<false, true, Ts...> : public variant_ops<Ts...> {
+ public:
+  using variant_ops<Ts...>::variant_ops;
+
+  variant_base(const variant_base& other)
+      : variant_ops<Ts...>(variant_uninit_tag()) {
+    this->construct_from(other);
+  }
+  variant_base(variant_base&&) = default;
+  variant_base& operator=(const variant_base& other) {
+    this->assign_from(other);
+    return *this;
+  }
+  variant_base& operator=(variant_base&&) = default;
+};
+
+template <typename... Ts>
+class variant_base<true, false, Ts...> : public variant_ops<Ts...> {
+ public:
+  using variant_ops<Ts...>::variant_ops;
+
+  variant_base(const variant_base&) = default;
+  variant_base(variant_base&& other) noexcept(
+      all_of<std::is_nothrow_move_constructible<Ts>::value...>::value)
+      : variant_ops<Ts...>(variant_uninit_tag()) {
+    this->construct_from(std::move(other));
+  }
+  variant_base& operator=(const variant_base&) = default;
+  variant_base& operator=(variant_base&& other) noexcept(
+      variant_nothrow_move<Ts...>::value) {
+    this->assign_from(std::move(other));
+    return *this;
+  }
+};
+
+// Chooses the alternative that variant(U&&) constructs: the one whose
+// constructor overload resolution picks, as in std::variant. bool is only a
+// candidate for a bool, so that a string literal does not pick it over a
+// string.
+struct no_alternative {};
+
+template <typename U, size_t I, typename... Ts>
+struct alternative_overloads {
+  static void pick();
+};
+
+template <typename U, size_t I, typename T, typename... Ts>
+struct alternative_overloads<U, I, T, Ts...>
+    : alternative_overloads<U, I + 1, Ts...> {
+  using alternative_overloads<U, I + 1, Ts...>::pick;
+  static std::integral_constant<size_t, I> pick(typename std::conditional<
+      std::is_same<typename std::remove_cv<T>::type, bool>::value &&
+          !std::is_same<typename std::decay<U>::type, bool>::value,
+      no_alternative, T>::type);
+};
+
+template <typename Enable, typename U, typename... Ts>
+struct accepted_index {};
+
+template <typename U, typename... Ts>
+struct accepted_index<
+    typename make_void<decltype(alternative_overloads<U, 0, Ts...>::pick(
+        std::declval<U>()))>::type,
+    U, Ts...>
+    : decltype(alternative_overloads<U, 0, Ts...>::pick(std::declval<U>())) {
+};
+
+// Access to the storage of a variant, for the functions below.
+struct variant_access {
+  template <size_t I, typename V>
+  static auto get_alt(V&& v) noexcept
+      -> decltype(union_get<I>::get(std::forward<V>(v).data_)) {
+    return union_get<I>::get(std::forward<V>(v).data_);
+  }
+  // The index, or a value of at least variant_size for a variant without
+  // an alternative.
+  template <typename V>
+  static constexpr size_t raw_index(const V& v) noexcept {
+    return v.index_;
+  }
+};
+
+template <typename R, typename F, typename V>
+struct visit_alt {
+  F&& f;
+  V&& v;
+  template <size_t I>
+  R operator()(std::integral_constant<size_t, I>) const {
+    return std::forward<F>(f)(
+        variant_access::get_alt<I>(std::forward<V>(v)));
+  }
+};
+
+template <typename R>
+struct multi_visit;
+
+// f with a first argument bound.
+template <typename F, typename A>
+struct prepend_arg {
+  F&& f;
+  A&& a;
+  template <typename... Args>
+  auto operator()(Args&&... args) const -> decltype(std::forward<F>(f)(
+      std::forward<A>(a), std::forward<Args>(args)...)) {
+    return std::forward<F>(f)(std::forward<A>(a),
+                              std::forward<Args>(args)...);
+  }
+};
+
+// Takes an alternative of the first variant, and visits the other variants
+// with it bound to f.
+template <typename R, typename F, typename... Vs>
+struct visit_rest {
+  F&& f;
+  std::tuple<Vs&&...> vs;
+  template <typename A>
+  R operator()(A&& a) {
+    return visit(prepend_arg<F, A>{std::forward<F>(f), std::forward<A>(a)},
+                 make_index_sequence<sizeof...(Vs)>());
+  }
+  template <typename G, size_t... Is>
+  R visit(G&& g, index_sequence<Is...>) {
+    return multi_visit<R>::run(std::forward<G>(g),
+                               std::get<Is>(std::move(vs))...);
+  }
+};
+
+// Visiting several variants visits each in turn, so that every step is a
+// dispatch on a single index.
+template <typename R>
+struct multi_visit {
+  template <typename F, typename V>
+  static R run(F&& f, V&& v) {
+    constexpr size_t kSize =
+        variant_size<typename std::remove_reference<V>::type>::value;
+    const size_t index = variant_access::raw_index(v);
+    if (index >= kSize) throw_bad_variant_access();
+    return dispatch_index<R, kSize>(
+        index, visit_alt<R, F, V>{std::forward<F>(f), std::forward<V>(v)});
+  }
+  template <typename F, typename V0, typename V1, typename... Vs>
+  static R run(F&& f, V0&& v0, V1&& v1, Vs&&... vs) {
+    return run(visit_rest<R, F, V1, Vs...>{std::forward<F>(f),
+                                           std::forward_as_tuple(
+                                               std::forward<V1>(v1),
+                                               std::forward<Vs>(vs)...)},
+               std::forward<V0>(v0));
+  }
+};
+
+template <typename V>
+struct variant_equal {
+  const V& a;
+  const V& b;
+  template <size_t I>
+  bool operator()(std::integral_constant<size_t, I>) const {
+    return variant_access::get_alt<I>(a) == variant_access::get_alt<I>(b);
+  }
+};
+
+template <typename V>
+struct variant_less {
+  const V& a;
+  const V& b;
+  template <size_t I>
+  bool operator()(std::integral_constant<size_t, I>) const {
+    return variant_access::get_alt<I>(a) < variant_access::get_alt<I>(b);
+  }
+};
+
+}  // namespace internal
+
+// A type-safe union: holds one of Ts, and its index in Ts.
+//
+// The index is stored in the smallest unsigned type that fits, so a variant
+// of small alternatives takes one byte more than the largest of them. A
+// variant of trivially copyable alternatives is trivially copyable, and one
+// of trivially relocatable alternatives is trivially relocatable.
+//
+//   using message = variant<heartbeat, quote, trade>;
+//   visit(handler, m);  // One jump through a table for up to 16 types.
+//
+// Interface from https://en.cppreference.com/w/cpp/utility/variant. As with
+// std::variant, a variant holds no alternative, and has index()
+// variant_npos, only when an exception leaves it so.
+template <typename... Ts>
+class variant
+    : private internal::variant_base<
+          internal::variant_trivial_copy<Ts...>::value,
+          internal::variant_trivial_move<Ts...>::value, Ts...>,
+      private internal::enable_copy_move<
+          internal::all_of<std::is_copy_constructible<Ts>::value...>::value,
+          internal::all_of<(std::is_copy_constructible<Ts>::value &&
+                            std::is_copy_assignable<Ts>::value)...>::value,
+          internal::all_of<std::is_move_constructible<Ts>::value...>::value,
+          internal::all_of<(std::is_move_constructible<Ts>::value &&
+                            std::is_move_assignable<Ts>::value)...>::value> {
+  static_assert(sizeof...(Ts) > 0, "variant needs an alternative");
+
+  using base =
+      internal::variant_base<internal::variant_trivial_copy<Ts...>::value,
+                             internal::variant_trivial_move<Ts...>::value,
+                             Ts...>;
+  template <size_t I>
+  using alternative = typename internal::nth_type<I, Ts...>::type;
+  template <typename T>
+  using index_of = internal::type_index<T, Ts...>;
+  template <typename U>
+  using accepted_index = internal::accepted_index<void, U, Ts...>;
+
+  friend struct internal::variant_access;
+
+ public:
+  using trivially_relocatable = internal::trivially_relocatable_if<
+      internal::all_of<is_trivially_relocatable<Ts>::value...>::value,
+      variant>;
+
+  // Constructors. The default one value-initializes the first alternative.
+  template <typename T = alternative<0>,
+            typename = typename std::enable_if<
+                std::is_default_constructible<T>::value>::type>
+  constexpr variant() noexcept(std::is_nothrow_default_constructible<T>::value)
+      : base(in_place_index_t<0>()) {}
+  template <typename U,
+            typename = typename std::enable_if<!std::is_same<
+                typename std::decay<U>::type, variant>::value>::type,
+            size_t I = accepted_index<U>::value>
+  constexpr variant(U&& value) noexcept(
+      std::is_nothrow_constructible<alternative<I>, U>::value)
+      : base(in_place_index_t<I>(), std::forward<U>(value)) {}
+  template <typename T, typename... Args,
+            size_t I = index_of<T>::value,
+            typename = typename std::enable_if<(I < sizeof...(Ts))>::type>
+  constexpr explicit variant(in_place_type_t<T>, Args&&... args)
+      : base(in_place_index_t<I>(), std::forward<Args>(args)...) {}
+  template <size_t I, typename... Args>
+  constexpr explicit variant(in_place_index_t<I>, Args&&... args)
+      : base(in_place_index_t<I>(), std::forward<Args>(args)...) {}
+
+  // Assigns the alternative that variant(U&&) would construct.
+  template <typename U,
+            typename = typename std::enable_if<!std::is_same<
+                typename std::decay<U>::type, variant>::value>::type,
+            size_t I = accepted_index<U>::value>
+  variant& operator=(U&& value) {
+    if (this->index_ == I) {
+      internal::union_get<I>::get(this->data_) = std::forward<U>(value);
+    } else {
+      this->template emplace_alt<I>(std::forward<U>(value));
+    }
+    return *this;
+  }
+
+  // Observers.
+  constexpr size_t index() const noexcept {
+    return this->index_ == base::kValueless ? variant_npos : this->index_;
+  }
+  constexpr bool valueless_by_exception() const noexcept {
+    return this->index_ == base::kValueless;
+  }
+
+  // Modifiers.
+  template <size_t I, typename... Args>
+  alternative<I>& emplace(Args&&... args) {
+    static_assert(I < sizeof...(Ts), "variant has no such alternative");
+    this->template emplace_alt<I>(std::forward<Args>(args)...);
+    return internal::union_get<I>::get(this->data_);
+  }
+  template <typename T, typename... Args>
+  T& emplace(Args&&... args) {
+    static_assert(internal::type_count<T, Ts...>::value == 1,
+                  "T must occur once in the alternatives");
+    return emplace<index_of<T>::value>(std::forward<Args>(args)...);
+  }
+
+  void swap(variant& other) {
+    variant tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  // Comparisons. A variant without an alternative is less than the others.
+  friend bool operator==(const variant& a, const variant& b) {
+    if (a.index_ != b.index_) return false;
+    if (a.index_ == base::kValueless) return true;
+    return internal::dispatch_index<bool, sizeof...(Ts)>(
+        a.index_, internal::variant_equal<variant>{a, b});
+  }
+  friend bool operator!=(const variant& a, const variant& b) {
+    return !(a == b);
+  }
+  friend bool operator<(const variant& a, const variant& b) {
+    if (a.index() + 1 != b.index() + 1) return a.index() + 1 < b.index() + 1;
+    if (a.index_ == base::kValueless) return false;
+    return internal::dispatch_index<bool, sizeof...(Ts)>(
+        a.index_, internal::variant_less<variant>{a, b});
+  }
+};
+
+template <typename T, typename... Ts>
+constexpr bool holds_alternative(const variant<Ts...>& v) noexcept {
+  static_assert(internal::type_count<T, Ts...>::value == 1,
+                "T must occur once in the alternatives");
+  return internal::variant_access::raw_index(v) ==
+         internal::type_index<T, Ts...>::value;
+}
+
+// The alternative I, or bad_variant_access if v holds another one.
+template <size_t I, typename... Ts>
+typename variant_alternative<I, variant<Ts...>>::type& get(
+    variant<Ts...>& v) {
+  if (internal::variant_access::raw_index(v) != I) {
+    internal::throw_bad_variant_access();
+  }
+  return internal::variant_access::get_alt<I>(v);
+}
+
+template <size_t I, typename... Ts>
+const typename variant_alternative<I, variant<Ts...>>::type& get(
+    const variant<Ts...>& v) {
+  if (internal::variant_access::raw_index(v) != I) {
+    internal::throw_bad_variant_access();
+  }
+  return internal::variant_access::get_alt<I>(v);
+}
+
+template <size_t I, typename... Ts>
+typename variant_alternative<I, variant<Ts...>>::type&& get(
+    variant<Ts...>&& v) {
+  if (internal::variant_access::raw_index(v) != I) {
+    internal::throw_bad_variant_access();
+  }
+  return internal::variant_access::get_alt<I>(std::move(v));
+}
+
+template <typename T, typename... Ts>
+T& get(variant<Ts...>& v) {
+  static_assert(internal::type_count<T, Ts...>::value == 1,
+                "T must occur once in the alternatives");
+  return get<internal::type_index<T, Ts...>::value>(v);
+}
+
+template <typename T, typename... Ts>
+const T& get(const variant<Ts...>& v) {
+  static_assert(internal::type_count<T, Ts...>::value == 1,
+                "T must occur once in the alternatives");
+  return get<internal::type_index<T, Ts...>::value>(v);
+}
+
+template <typename T, typename... Ts>
+T&& get(variant<Ts...>&& v) {
+  static_assert(internal::type_count<T, Ts...>::value == 1,
+                "T must occur once in the alternatives");
+  return get<internal::type_index<T, Ts...>::value>(std::move(v));
+}
+
+// A pointer to the alternative I, or null if v holds another one.
+template <size_t I, typename... Ts>
+typename std::add_pointer<
+    typename variant_alternative<I, variant<Ts...>>::type>::type
+get_if(variant<Ts...>* v) noexcept {
+  return v != nullptr && internal::variant_access::raw_index(*v) == I
+             ? std::addressof(internal::variant_access::get_alt<I>(*v))
+             : nullptr;
+}
+
+template <size_t I, typename... Ts>
+typename std::add_pointer<
+    const typename variant_alternative<I, variant<Ts...>>::type>::type
+get_if(const variant<Ts...>* v) noexcept {
+  return v != nullptr && internal::variant_access::raw_index(*v) == I
+             ? std::addressof(internal::variant_access::get_alt<I>(*v))
+             : nullptr;
+}
+
+template <typename T, typename... Ts>
+T* get_if(variant<Ts...>* v) noexcept {
+  static_assert(internal::type_count<T, Ts...>::value == 1,
+                "T must occur once in the alternatives");
+  return get_if<internal::type_index<T, Ts...>::value>(v);
+}
+
+template <typename T, typename... Ts>
+const T* get_if(const variant<Ts...>* v) noexcept {
+  static_assert(internal::type_count<T, Ts...>::value == 1,
+                "T must occur once in the alternatives");
+  return get_if<internal::type_index<T, Ts...>::value>(v);
+}
+
+// Calls f with the alternatives that vs hold, and throws
+// bad_variant_access if one holds none. f must return the same type for
+// every combination of alternatives.
+template <typename F, typename... Vs>
+auto visit(F&& f, Vs&&... vs) -> decltype(std::forward<F>(f)(
+    internal::variant_access::get_alt<0>(std::forward<Vs>(vs))...)) {
+  using result = decltype(std::forward<F>(f)(
+      internal::variant_access::get_alt<0>(std::forward<Vs>(vs))...));
+  return internal::multi_visit<result>::run(std::forward<F>(f),
+                                            std::forward<Vs>(vs)...);
+}
+
+template <typename... Ts>
+void swap(variant<Ts...>& a, variant<Ts...>& b) {
+  a.swap(b);
+}
+
+}  // namespace david
+
+#endif  // TYPES_VARIANT
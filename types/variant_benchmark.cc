@@ -0,0 +1,145 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <variant>
+#endif
+
+#include "benchmark/benchmark.h"
+#include "types/variant.h"
+
+namespace david {
+namespace {
+
+// A decoded message of a market data feed, with 6 alternatives.
+struct heartbeat {
+  uint64_t time;
+};
+struct quote {
+  uint32_t instrument;
+  uint32_t bid_size;
+  double bid;
+  double ask;
+};
+struct trade {
+  uint32_t instrument;
+  uint32_t size;
+  double price;
+};
+struct cancel {
+  uint64_t order;
+};
+struct status {
+  uint8_t code;
+};
+struct text {
+  char data[15];
+  uint8_t size;
+};
+
+// Sums a field of each alternative, so that every case does some work.
+struct handler {
+  uint64_t operator()(const heartbeat& m) const { return m.time; }
+  uint64_t operator()(const quote& m) const {
+    return m.instrument + static_cast<uint64_t>(m.bid);
+  }
+  uint64_t operator()(const trade& m) const { return m.size; }
+  uint64_t operator()(const cancel& m) const { return m.order; }
+  uint64_t operator()(const status& m) const { return m.code; }
+  uint64_t operator()(const text& m) const { return m.size; }
+};
+
+// Messages with random alternatives. Unless shuffled, they are grouped by
+// alternative, so the branch on the index is predictable and the benchmarks
+// measure the cost of dispatch rather than of mispredictions.
+template <typename Message>
+std::vector<Message> make_messages(bool shuffled) {
+  std::mt19937 rng(42);
+  std::vector<Message> messages;
+  for (int i = 0; i < 4096; ++i) {
+    switch (shuffled ? rng() % 6 : i * 6 / 4096) {
+      case 0:
+        messages.push_back(heartbeat{rng()});
+        break;
+      case 1:
+        messages.push_back(
+            quote{static_cast<uint32_t>(rng()), 100, 1.5, 1.75});
+        break;
+      case 2:
+        messages.push_back(trade{static_cast<uint32_t>(rng()), 10, 1.5});
+        break;
+      case 3:
+        messages.push_back(cancel{rng()});
+        break;
+      case 4:
+        messages.push_back(status{static_cast<uint8_t>(rng())});
+        break;
+      default:
+        messages.push_back(text{"hello", 5});
+        break;
+    }
+  }
+  return messages;
+}
+
+using message = variant<heartbeat, quote, trade, cancel, status, text>;
+
+void BM_Visit(benchmark::State& state) {
+  const std::vector<message> messages =
+      make_messages<message>(state.range(0));
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (const message& m : messages) sum += visit(handler(), m);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * messages.size());
+  state.SetLabel("sizeof " + std::to_string(sizeof(message)));
+}
+BENCHMARK(BM_Visit)->Arg(0)->Arg(1);
+
+// Copies the messages, which is a memcpy for trivially copyable variants.
+void BM_Copy(benchmark::State& state) {
+  const std::vector<message> messages =
+      make_messages<message>(state.range(0));
+  for (auto _ : state) {
+    std::vector<message> copy = messages;
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetBytesProcessed(state.iterations() * messages.size() *
+                          sizeof(message));
+}
+BENCHMARK(BM_Copy)->Arg(1);
+
+#if __cplusplus >= 201703L
+using std_message =
+    std::variant<heartbeat, quote, trade, cancel, status, text>;
+
+void BM_StdVisit(benchmark::State& state) {
+  const std::vector<std_message> messages =
+      make_messages<std_message>(state.range(0));
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (const std_message& m : messages) sum += std::visit(handler(), m);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * messages.size());
+  state.SetLabel("sizeof " + std::to_string(sizeof(std_message)));
+}
+BENCHMARK(BM_StdVisit)->Arg(0)->Arg(1);
+
+void BM_StdCopy(benchmark::State& state) {
+  const std::vector<std_message> messages =
+      make_messages<std_message>(state.range(0));
+  for (auto _ : state) {
+    std::vector<std_message> copy = messages;
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetBytesProcessed(state.iterations() * messages.size() *
+                          sizeof(std_message));
+}
+BENCHMARK(BM_StdCopy)->Arg(1);
+#endif
+
+}  // namespace
+}  // namespace david
@@ -0,0 +1,227 @@
+#include "types/variant.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace david {
+namespace {
+
+static_assert(sizeof(variant<int8_t, uint8_t>) == 2, "");
+static_assert(sizeof(variant<int32_t, float>) == 8, "");
+static_assert(sizeof(variant<char, int64_t, double>) == 16, "");
+static_assert(std::is_trivially_copyable<variant<int, float, char*>>::value,
+              "");
+static_assert(std::is_trivially_destructible<variant<int, float>>::value,
+              "");
+static_assert(!std::is_trivially_copyable<variant<int, std::string>>::value,
+              "");
+static_assert(!std::is_copy_constructible<
+                  variant<int, std::unique_ptr<int>>>::value,
+              "");
+static_assert(
+    std::is_move_constructible<variant<int, std::unique_ptr<int>>>::value,
+    "");
+static_assert(
+    is_trivially_relocatable<variant<int, std::unique_ptr<int>>>::value, "");
+static_assert(!is_trivially_relocatable<variant<int, std::string>>::value,
+              "");
+static_assert(variant_size<variant<int, char>>::value == 2, "");
+static_assert(std::is_same<variant_alternative<1, variant<int, char>>::type,
+                           char>::value,
+              "");
+
+// 300 distinct alternatives, to check the 16-bit index and the table of
+// visit().
+template <int N>
+struct tag {
+  uint16_t value = N;
+};
+
+template <typename Seq>
+struct many_tags;
+
+template <size_t... Is>
+struct many_tags<internal::index_sequence<Is...>> {
+  using type = variant<tag<static_cast<int>(Is)>...>;
+};
+
+using big_variant = many_tags<internal::make_index_sequence<300>>::type;
+static_assert(sizeof(big_variant) == 4, "");
+
+TEST(Variant, DefaultConstructsFirstAlternative) {
+  const variant<int, std::string> v;
+  EXPECT_EQ(v.index(), 0u);
+  EXPECT_EQ(get<0>(v), 0);
+  EXPECT_TRUE(holds_alternative<int>(v));
+  EXPECT_FALSE(v.valueless_by_exception());
+}
+
+TEST(Variant, ConvertingConstructor) {
+  const variant<int, std::string> a = 7;
+  EXPECT_EQ(get<int>(a), 7);
+  const variant<int, std::string> b = "text";
+  EXPECT_EQ(get<std::string>(b), "text");
+  // A string literal does not pick bool.
+  const variant<bool, std::string> c = "text";
+  EXPECT_EQ(c.index(), 1u);
+  const variant<bool, std::string> d = true;
+  EXPECT_EQ(d.index(), 0u);
+}
+
+TEST(Variant, InPlaceConstructors) {
+  const variant<int, std::string> a(in_place_index_t<1>(), 3, 'x');
+  EXPECT_EQ(get<1>(a), "xxx");
+  const variant<int, std::string> b(in_place_type_t<std::string>(), "yy");
+  EXPECT_EQ(get<1>(b), "yy");
+  const variant<int, int> c(in_place_index_t<1>(), 4);
+  EXPECT_EQ(c.index(), 1u);
+}
+
+TEST(Variant, GetThrowsForOtherAlternative) {
+  variant<int, std::string> v = 1;
+  EXPECT_THROW(get<std::string>(v), bad_variant_access);
+  EXPECT_EQ(get_if<std::string>(&v), nullptr);
+  ASSERT_NE(get_if<int>(&v), nullptr);
+  EXPECT_EQ(*get_if<0>(&v), 1);
+}
+
+TEST(Variant, CopyAndAssign) {
+  variant<int, std::string> a = std::string("a long string, not inline");
+  variant<int, std::string> b = a;
+  EXPECT_EQ(get<1>(b), get<1>(a));
+  b = 5;
+  EXPECT_EQ(get<0>(b), 5);
+  b = a;
+  EXPECT_EQ(a, b);
+  a = std::string("other");
+  EXPECT_NE(a, b);
+  b = std::move(a);
+  EXPECT_EQ(get<1>(b), "other");
+  a.emplace<0>(9);
+  EXPECT_EQ(get<0>(a), 9);
+  a.emplace<std::string>("s");
+  EXPECT_EQ(get<1>(a), "s");
+  swap(a, b);
+  EXPECT_EQ(get<1>(a), "other");
+  EXPECT_EQ(get<1>(b), "s");
+}
+
+TEST(Variant, MoveOnly) {
+  variant<int, std::unique_ptr<int>> a(std::unique_ptr<int>(new int(3)));
+  variant<int, std::unique_ptr<int>> b = std::move(a);
+  EXPECT_EQ(*get<1>(b), 3);
+  std::unique_ptr<int> p = get<1>(std::move(b));
+  EXPECT_EQ(*p, 3);
+}
+
+// Not nothrow movable, so that emplace() destroys the old alternative before
+// building it.
+struct ThrowsOnConstruction {
+  explicit ThrowsOnConstruction(int) { throw std::runtime_error("boom"); }
+  ThrowsOnConstruction(const ThrowsOnConstruction&) {}
+  bool operator==(const ThrowsOnConstruction&) const { return true; }
+  bool operator<(const ThrowsOnConstruction&) const { return false; }
+};
+
+struct Ignore {
+  template <typename T>
+  void operator()(const T&) const {}
+};
+
+TEST(Variant, ValuelessByException) {
+  variant<std::string, ThrowsOnConstruction> v = std::string("s");
+  EXPECT_THROW(v.emplace<1>(0), std::runtime_error);
+  EXPECT_TRUE(v.valueless_by_exception());
+  EXPECT_EQ(v.index(), variant_npos);
+  EXPECT_THROW(visit(Ignore(), v), bad_variant_access);
+  EXPECT_FALSE(holds_alternative<std::string>(v));
+
+  variant<std::string, ThrowsOnConstruction> w = v;
+  EXPECT_TRUE(w.valueless_by_exception());
+  EXPECT_EQ(v, w);
+  v = std::string("t");
+  EXPECT_LT(w, v);
+}
+
+struct NothrowMovable {
+  explicit NothrowMovable(int) { throw std::runtime_error("boom"); }
+};
+
+TEST(Variant, EmplaceKeepsValueIfBuiltAside) {
+  variant<std::string, NothrowMovable> v = std::string("s");
+  EXPECT_THROW(v.emplace<1>(0), std::runtime_error);
+  EXPECT_EQ(get<0>(v), "s");
+}
+
+struct Describe {
+  std::string operator()(int i) const { return "int " + std::to_string(i); }
+  std::string operator()(const std::string& s) const { return "string " + s; }
+  std::string operator()(double) const { return "double"; }
+};
+
+TEST(Variant, Visit) {
+  const variant<int, std::string, double> a = 4;
+  EXPECT_EQ(visit(Describe(), a), "int 4");
+  const variant<int, std::string, double> b = std::string("x");
+  EXPECT_EQ(visit(Describe(), b), "string x");
+  variant<int, std::string, double> c = 0.5;
+  EXPECT_EQ(visit(Describe(), c), "double");
+}
+
+struct Combine {
+  template <typename A, typename B>
+  std::string operator()(const A&, const B&) const {
+    return "other";
+  }
+  std::string operator()(int a, const std::string& b) const {
+    return std::to_string(a) + b;
+  }
+};
+
+TEST(Variant, VisitsSeveralVariants) {
+  const variant<int, std::string> a = 1;
+  const variant<int, std::string> b = std::string("b");
+  EXPECT_EQ(visit(Combine(), a, b), "1b");
+  EXPECT_EQ(visit(Combine(), b, a), "other");
+  const variant<char, int> c = 'c';
+  EXPECT_EQ(visit([](int x, int y, char z) { return x + y + z; },
+                  variant<int, char>(1), variant<int>(2), c),
+            1 + 2 + 'c');
+}
+
+struct TagValue {
+  template <typename T>
+  int operator()(const T& t) const {
+    return t.value;
+  }
+};
+
+TEST(Variant, VisitsLargeVariants) {
+  big_variant v;
+  EXPECT_EQ(visit(TagValue(), v), 0);
+  v.emplace<299>();
+  EXPECT_EQ(v.index(), 299u);
+  EXPECT_EQ(visit(TagValue(), v), 299);
+  v = tag<150>();
+  EXPECT_EQ(visit(TagValue(), v), 150);
+}
+
+TEST(Variant, Compare) {
+  using v = variant<int, std::string>;
+  EXPECT_EQ(v(1), v(1));
+  EXPECT_NE(v(1), v(2));
+  EXPECT_LT(v(1), v(2));
+  EXPECT_LT(v(9), v("a"));
+  EXPECT_LT(v("a"), v("b"));
+  EXPECT_FALSE(v("b") < v("a"));
+}
+
+}  // namespace
+}  // namespace david
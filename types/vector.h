@@ -0,0 +1,385 @@
+#ifndef TYPES_VECTOR
+#define TYPES_VECTOR
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "types/relocate.h"
+
+namespace david {
+
+// A contiguous container with the common members of std::vector, that
+// relocates its elements rather than moving them one by one. When T is
+// trivially relocatable, see types/relocate.h, growing the buffer is a
+// single memcpy and erasing shifts the tail with a single memmove, where
+// std::vector runs a move and a destruction per element.
+//
+//   vector<optional<string>> column;
+//   column.push_back(string("a"));  // Reallocations are memcpy.
+//
+// Elements are constructed in place and the allocator only provides the
+// memory, which must be addressed by raw pointers. Allocators of different
+// vectors are assumed to compare equal.
+template <typename T, typename Allocator = std::allocator<T>>
+class vector {
+  typedef std::allocator_traits<Allocator> alloc_traits;
+
+ public:
+  // Types.
+  using trivially_relocatable = internal::trivially_relocatable_if<
+      is_trivially_relocatable<Allocator>::value, vector>;
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Constructors. Those that fill the vector delegate to vector(alloc), so
+  // that the destructor frees what they built if an element throws.
+  vector() noexcept : storage_() {}
+  explicit vector(const Allocator& alloc) noexcept : storage_(alloc) {}
+  explicit vector(size_type n, const Allocator& alloc = Allocator())
+      : vector(alloc) {
+    resize(n);
+  }
+  vector(size_type n, const T& value, const Allocator& alloc = Allocator())
+      : vector(alloc) {
+    resize(n, value);
+  }
+  vector(std::initializer_list<T> init, const Allocator& alloc = Allocator())
+      : vector(alloc) {
+    reserve(init.size());
+    for (const T& value : init) emplace_back(value);
+  }
+  vector(const vector& other)
+      : vector(alloc_traits::select_on_container_copy_construction(
+            other.allocator())) {
+    reserve(other.size());
+    for (const T& value : other) emplace_back(value);
+  }
+  vector(vector&& other) noexcept : storage_(std::move(other.allocator())) {
+    storage_.first = other.storage_.first;
+    storage_.last = other.storage_.last;
+    storage_.end_of_storage = other.storage_.end_of_storage;
+    other.storage_.first = nullptr;
+    other.storage_.last = nullptr;
+    other.storage_.end_of_storage = nullptr;
+  }
+
+  ~vector() {
+    destroy(storage_.first, storage_.last);
+    deallocate();
+  }
+
+  // Assignment.
+  vector& operator=(const vector& other) {
+    if (this != &other) {
+      vector tmp(other);
+      swap(tmp);
+    }
+    return *this;
+  }
+  vector& operator=(vector&& other) noexcept {
+    vector tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+  vector& operator=(std::initializer_list<T> init) {
+    vector tmp(init, allocator());
+    swap(tmp);
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept { return allocator(); }
+
+  // Iterators.
+  iterator begin() noexcept { return storage_.first; }
+  const_iterator begin() const noexcept { return storage_.first; }
+  const_iterator cbegin() const noexcept { return storage_.first; }
+  iterator end() noexcept { return storage_.last; }
+  const_iterator end() const noexcept { return storage_.last; }
+  const_iterator cend() const noexcept { return storage_.last; }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  // Capacity.
+  bool empty() const noexcept { return storage_.first == storage_.last; }
+  size_type size() const noexcept {
+    return static_cast<size_type>(storage_.last - storage_.first);
+  }
+  size_type capacity() const noexcept {
+    return static_cast<size_type>(storage_.end_of_storage - storage_.first);
+  }
+  size_type max_size() const noexcept {
+    return std::min<size_type>(alloc_traits::max_size(allocator()),
+                               PTRDIFF_MAX / sizeof(T));
+  }
+  void reserve(size_type n) {
+    if (n > capacity()) {
+      if (n > max_size()) throw std::length_error("vector too long");
+      reallocate(n);
+    }
+  }
+
+  // Element access.
+  reference operator[](size_type pos) noexcept { return storage_.first[pos]; }
+  const_reference operator[](size_type pos) const noexcept {
+    return storage_.first[pos];
+  }
+  reference at(size_type pos) {
+    if (pos >= size()) throw std::out_of_range("Out of range");
+    return storage_.first[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) throw std::out_of_range("Out of range");
+    return storage_.first[pos];
+  }
+  reference front() noexcept { return *storage_.first; }
+  const_reference front() const noexcept { return *storage_.first; }
+  reference back() noexcept { return storage_.last[-1]; }
+  const_reference back() const noexcept { return storage_.last[-1]; }
+  T* data() noexcept { return storage_.first; }
+  const T* data() const noexcept { return storage_.first; }
+
+  // Modifiers.
+  void clear() noexcept {
+    destroy(storage_.first, storage_.last);
+    storage_.last = storage_.first;
+  }
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (storage_.last == storage_.end_of_storage) {
+      return grow_and_emplace_back(std::forward<Args>(args)...);
+    }
+    ::new (static_cast<void*>(storage_.last)) T(std::forward<Args>(args)...);
+    return *storage_.last++;
+  }
+  void pop_back() noexcept {
+    --storage_.last;
+    storage_.last->~T();
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+  // Trivially relocatable elements are destroyed and the tail relocated over
+  // them. Others take the tail by move assignment, as in std::vector.
+  iterator erase(const_iterator first, const_iterator last) {
+    T* const f = storage_.first + (first - cbegin());
+    T* const l = storage_.first + (last - cbegin());
+    if (f == l) return f;
+    if (is_trivially_relocatable<T>::value) {
+      destroy(f, l);
+      storage_.last = uninitialized_relocate(l, storage_.last, f);
+    } else {
+      T* const new_last = std::move(l, storage_.last, f);
+      destroy(new_last, storage_.last);
+      storage_.last = new_last;
+    }
+    return f;
+  }
+
+  // Value-initializes the new elements.
+  void resize(size_type n) {
+    if (n <= size()) {
+      truncate(n);
+      return;
+    }
+    if (n > capacity()) reallocate(recommended_capacity(n));
+    while (size() < n) emplace_back();
+  }
+  void resize(size_type n, const T& value) {
+    if (n <= size()) {
+      truncate(n);
+      return;
+    }
+    if (n > capacity()) {
+      grow_and_fill(n, value);
+      return;
+    }
+    while (size() < n) emplace_back(value);
+  }
+
+  void swap(vector& other) noexcept {
+    if (alloc_traits::propagate_on_container_swap::value) {
+      std::swap(allocator(), other.allocator());
+    }
+    std::swap(storage_.first, other.storage_.first);
+    std::swap(storage_.last, other.storage_.last);
+    std::swap(storage_.end_of_storage, other.storage_.end_of_storage);
+  }
+
+  friend bool operator==(const vector& a, const vector& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+  }
+  friend bool operator!=(const vector& a, const vector& b) {
+    return !(a == b);
+  }
+
+ private:
+  // Empty base optimization: an empty allocator takes no space.
+  struct storage : Allocator {
+    storage() = default;
+    explicit storage(const Allocator& alloc) : Allocator(alloc) {}
+    explicit storage(Allocator&& alloc) : Allocator(std::move(alloc)) {}
+    T* first = nullptr;
+    T* last = nullptr;
+    T* end_of_storage = nullptr;
+  };
+
+  // Owns a new buffer until release(), and frees it if a reallocation
+  // throws before then.
+  class buffer_guard {
+   public:
+    buffer_guard(Allocator& alloc, size_type n)
+        : alloc_(alloc), data_(alloc_traits::allocate(alloc, n)), size_(n) {}
+    buffer_guard(const buffer_guard&) = delete;
+    buffer_guard& operator=(const buffer_guard&) = delete;
+    ~buffer_guard() {
+      if (data_ != nullptr) alloc_traits::deallocate(alloc_, data_, size_);
+    }
+
+    T* get() const noexcept { return data_; }
+    T* release() noexcept {
+      T* data = data_;
+      data_ = nullptr;
+      return data;
+    }
+
+   private:
+    Allocator& alloc_;
+    T* data_;
+    size_type size_;
+  };
+
+  Allocator& allocator() noexcept { return storage_; }
+  const Allocator& allocator() const noexcept { return storage_; }
+
+  static void destroy(T* first, T* last) noexcept {
+    if (!std::is_trivially_destructible<T>::value) {
+      for (; first != last; ++first) first->~T();
+    }
+  }
+  void truncate(size_type n) noexcept {
+    T* const new_last = storage_.first + n;
+    destroy(new_last, storage_.last);
+    storage_.last = new_last;
+  }
+  void deallocate() noexcept {
+    if (storage_.first != nullptr) {
+      alloc_traits::deallocate(allocator(), storage_.first, capacity());
+    }
+  }
+
+  // Capacity to use when growing to n elements: geometric growth by 2x.
+  size_type recommended_capacity(size_type n) const {
+    if (n > max_size()) throw std::length_error("vector too long");
+    const size_type current = capacity();
+    return std::max(n, current > max_size() / 2 ? max_size() : 2 * current);
+  }
+
+  // Moves the elements to the buffer at dest, leaving the vector empty.
+  // Elements that may throw when moved are copied if they can be, so that
+  // an exception leaves the vector as it was, as in std::vector.
+  void transfer_to(T* dest) {
+    transfer_to(dest,
+                std::integral_constant<
+                    bool, is_trivially_relocatable<T>::value ||
+                              std::is_nothrow_move_constructible<T>::value ||
+                              !std::is_copy_constructible<T>::value>());
+  }
+  void transfer_to(T* dest, std::true_type /* relocate */) {
+    T* const first = storage_.first;
+    T* const last = storage_.last;
+    // The elements belong to the relocation from here: if it throws, it
+    // destroys them, and the vector is left empty.
+    storage_.last = storage_.first;
+    uninitialized_relocate(first, last, dest);
+  }
+  void transfer_to(T* dest, std::false_type /* relocate */) {
+    std::uninitialized_copy(storage_.first, storage_.last, dest);
+    clear();
+  }
+
+  void adopt(T* data, size_type n, size_type cap) noexcept {
+    deallocate();
+    storage_.first = data;
+    storage_.last = data + n;
+    storage_.end_of_storage = data + cap;
+  }
+
+  void reallocate(size_type new_cap) {
+    const size_type n = size();
+    buffer_guard buffer(allocator(), new_cap);
+    transfer_to(buffer.get());
+    adopt(buffer.release(), n, new_cap);
+  }
+
+  // The slow path of emplace_back(), kept out of line so that the fast one
+  // inlines.
+  template <typename... Args>
+  __attribute__((noinline)) reference grow_and_emplace_back(Args&&... args) {
+    const size_type n = size();
+    const size_type new_cap = recommended_capacity(n + 1);
+    buffer_guard buffer(allocator(), new_cap);
+    // The new element is built first, since args may refer to an element.
+    T* const element = ::new (static_cast<void*>(buffer.get() + n))
+        T(std::forward<Args>(args)...);
+    struct element_guard {
+      T* element;
+      ~element_guard() {
+        if (element != nullptr) element->~T();
+      }
+    } guard{element};
+    transfer_to(buffer.get());
+    guard.element = nullptr;
+    adopt(buffer.release(), n + 1, new_cap);
+    return *element;
+  }
+
+  // resize(n, value) past the capacity.
+  void grow_and_fill(size_type n, const T& value) {
+    const size_type old_size = size();
+    const size_type new_cap = recommended_capacity(n);
+    buffer_guard buffer(allocator(), new_cap);
+    // The new elements are built first, since value may refer to an element.
+    struct fill_guard {
+      T* first;
+      T* last;
+      ~fill_guard() { destroy(first, last); }
+    } guard{buffer.get() + old_size, buffer.get() + old_size};
+    for (; guard.last != buffer.get() + n; ++guard.last) {
+      ::new (static_cast<void*>(guard.last)) T(value);
+    }
+    transfer_to(buffer.get());
+    guard.last = guard.first;
+    adopt(buffer.release(), n, new_cap);
+  }
+
+  storage storage_;
+};
+
+}  // namespace david
+
+#endif  // TYPES_VECTOR
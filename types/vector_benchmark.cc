@@ -0,0 +1,81 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "types/optional.h"
+#include "types/string.h"
+#include "types/vector.h"
+
+namespace david {
+namespace {
+
+// The benchmarks compare std::vector with david::vector, on optionals of
+// strings: trivially relocatable with david::string, but not with
+// std::string.
+
+template <typename Optional>
+Optional make_element(size_t i) {
+  if (i % 4 == 0) return Optional();
+  return Optional(typename Optional::value_type(std::to_string(i).c_str()));
+}
+
+// Appends state.range(0) elements without reserving, so the time includes
+// every reallocation.
+template <typename Vector>
+void BM_Growth(benchmark::State& state) {
+  using element = typename Vector::value_type;
+  const size_t n = state.range(0);
+  const element value = make_element<element>(123);
+  for (auto _ : state) {
+    Vector v;
+    for (size_t i = 0; i < n; ++i) v.push_back(value);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_Growth, std::vector<optional<std::string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, std::vector<optional<string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, vector<optional<std::string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, vector<optional<string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+
+// Erases an element at a pseudo-random position of a vector of
+// state.range(0) elements, and appends one to keep its size.
+template <typename Vector>
+void BM_Erase(benchmark::State& state) {
+  using element = typename Vector::value_type;
+  const size_t n = state.range(0);
+  Vector v;
+  for (size_t i = 0; i < n; ++i) v.push_back(make_element<element>(i));
+  const element value = make_element<element>(123);
+  size_t pos = 0;
+  for (auto _ : state) {
+    pos = (pos + 7919) % n;
+    v.erase(v.begin() + pos);
+    v.push_back(value);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Erase, std::vector<optional<std::string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Erase, std::vector<optional<string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Erase, vector<optional<std::string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Erase, vector<optional<string>>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16);
+
+}  // namespace
+}  // namespace david
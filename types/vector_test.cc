@@ -0,0 +1,211 @@
+#include "types/vector.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "types/optional.h"
+#include "types/string.h"
+
+namespace david {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+static_assert(sizeof(vector<int>) == 3 * sizeof(int*), "");
+static_assert(is_trivially_relocatable<vector<std::string>>::value, "");
+static_assert(is_trivially_relocatable<string>::value, "");
+static_assert(is_trivially_relocatable<optional<string>>::value, "");
+static_assert(!is_trivially_relocatable<optional<std::string>>::value, "");
+
+// Counts the live objects, and the moves that relocation avoids.
+struct Counted {
+  static int live;
+  static int moves;
+
+  explicit Counted(int v = 0) : value(v) { ++live; }
+  Counted(const Counted& other) : value(other.value) { ++live; }
+  Counted(Counted&& other) noexcept : value(other.value) {
+    ++live;
+    ++moves;
+  }
+  Counted& operator=(const Counted&) = default;
+  Counted& operator=(Counted&& other) noexcept {
+    value = other.value;
+    ++moves;
+    return *this;
+  }
+  ~Counted() { --live; }
+
+  int value;
+};
+int Counted::live = 0;
+int Counted::moves = 0;
+
+struct Relocatable : Counted {
+  using trivially_relocatable = Relocatable;
+  using Counted::Counted;
+};
+
+template <typename T>
+std::vector<int> values(const vector<T>& v) {
+  std::vector<int> result;
+  for (const T& e : v) result.push_back(e.value);
+  return result;
+}
+
+TEST(Vector, PushBackAndGrow) {
+  vector<std::string> v;
+  EXPECT_THAT(v, IsEmpty());
+  for (int i = 0; i < 100; ++i) v.push_back(std::to_string(i));
+  ASSERT_EQ(v.size(), 100u);
+  EXPECT_GE(v.capacity(), 100u);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(v[i], std::to_string(i));
+  EXPECT_EQ(v.front(), "0");
+  EXPECT_EQ(v.back(), "99");
+  EXPECT_THROW(v.at(100), std::out_of_range);
+}
+
+TEST(Vector, EmplaceBackOfOwnElement) {
+  vector<std::string> v = {"a long string that does not fit inline"};
+  for (int i = 0; i < 10; ++i) v.emplace_back(v.front());
+  for (const std::string& s : v) EXPECT_EQ(s, v.front());
+}
+
+TEST(Vector, ResizeWithOwnElement) {
+  vector<std::string> v = {"a long string that does not fit inline", "b"};
+  const size_t n = v.capacity() + 5;
+  v.resize(n, v[0]);
+  ASSERT_EQ(v.size(), n);
+  EXPECT_EQ(v[1], "b");
+  for (size_t i = 2; i < n; ++i) EXPECT_EQ(v[i], v[0]) << i;
+  // Within the capacity.
+  v.reserve(n + 10);
+  v.resize(n + 10, v[1]);
+  for (size_t i = n; i < n + 10; ++i) EXPECT_EQ(v[i], "b") << i;
+}
+
+TEST(Vector, RelocatesWithoutMoves) {
+  Counted::live = 0;
+  {
+    vector<Relocatable> v;
+    Counted::moves = 0;
+    for (int i = 0; i < 1000; ++i) v.emplace_back(i);
+    EXPECT_EQ(Counted::moves, 0);
+    EXPECT_EQ(Counted::live, 1000);
+
+    v.erase(v.begin() + 10, v.begin() + 20);
+    EXPECT_EQ(Counted::moves, 0);
+    EXPECT_EQ(Counted::live, 990);
+    EXPECT_EQ(v[10].value, 20);
+    EXPECT_EQ(v.back().value, 999);
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(Vector, MovesOtherTypes) {
+  Counted::live = 0;
+  {
+    vector<Counted> v;
+    Counted::moves = 0;
+    for (int i = 0; i < 4; ++i) v.emplace_back(i);
+    EXPECT_GT(Counted::moves, 0);
+    v.erase(v.begin() + 1);
+    EXPECT_THAT(values(v), ElementsAre(0, 2, 3));
+    EXPECT_EQ(Counted::live, 3);
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(Vector, Erase) {
+  vector<string> v = {"a", "b", "c", "d", "e"};
+  EXPECT_EQ(*v.erase(v.begin()), "b");
+  const string* const last = v.erase(v.end() - 1);
+  EXPECT_EQ(last, v.end());
+  v.erase(v.begin() + 1, v.begin() + 1);
+  EXPECT_THAT(v, ElementsAre("b", "c", "d"));
+  v.erase(v.begin(), v.end());
+  EXPECT_THAT(v, IsEmpty());
+}
+
+TEST(Vector, OptionalsOfStrings) {
+  vector<optional<string>> v;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 3 == 0) {
+      v.emplace_back();
+    } else {
+      v.emplace_back(string(std::string(i, 'x')));
+    }
+  }
+  v.erase(v.begin());
+  ASSERT_EQ(v.size(), 99u);
+  for (int i = 1; i < 100; ++i) {
+    const optional<string>& e = v[i - 1];
+    ASSERT_EQ(e.has_value(), i % 3 != 0);
+    if (e) {
+      EXPECT_EQ(e->size(), static_cast<size_t>(i));
+    }
+  }
+}
+
+TEST(Vector, MoveOnly) {
+  vector<std::unique_ptr<int>> v;
+  for (int i = 0; i < 10; ++i) v.emplace_back(new int(i));
+  vector<std::unique_ptr<int>> w = std::move(v);
+  EXPECT_THAT(v, IsEmpty());
+  ASSERT_EQ(w.size(), 10u);
+  EXPECT_EQ(*w[9], 9);
+  w.pop_back();
+  EXPECT_EQ(w.size(), 9u);
+}
+
+TEST(Vector, CopyAndCompare) {
+  const vector<int> a = {1, 2, 3};
+  vector<int> b = a;
+  EXPECT_EQ(a, b);
+  b.push_back(4);
+  EXPECT_NE(a, b);
+  b = a;
+  EXPECT_EQ(a, b);
+  b = {5};
+  EXPECT_THAT(b, ElementsAre(5));
+}
+
+TEST(Vector, ResizeAndReserve) {
+  vector<int> v(3);
+  EXPECT_THAT(v, ElementsAre(0, 0, 0));
+  v.resize(5, 7);
+  EXPECT_THAT(v, ElementsAre(0, 0, 0, 7, 7));
+  v.resize(1);
+  EXPECT_THAT(v, ElementsAre(0));
+  v.reserve(100);
+  EXPECT_EQ(v.capacity(), 100u);
+  EXPECT_THAT(v, ElementsAre(0));
+  v.clear();
+  EXPECT_THAT(v, IsEmpty());
+  EXPECT_THROW(v.reserve(v.max_size() + 1), std::length_error);
+}
+
+TEST(Vector, ResizeGrowsGeometrically) {
+  vector<int> v;
+  vector<int> filled;
+  int reallocations = 0;
+  for (int i = 0; i < 10000; ++i) {
+    const size_t capacity = v.capacity() + filled.capacity();
+    v.resize(v.size() + 1);
+    filled.resize(filled.size() + 1, i);
+    if (v.capacity() + filled.capacity() != capacity) ++reallocations;
+  }
+  EXPECT_EQ(v.size(), 10000u);
+  EXPECT_EQ(filled.back(), 9999);
+  // About log2(10000) for each of them.
+  EXPECT_LT(reallocations, 40);
+}
+
+}  // namespace
+}  // namespace david